@@ -0,0 +1,88 @@
+/**
+  ******************************************************************************
+  * @file    usbd_audio_fb.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_audio_fb.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_AUDIO_FB_H
+#define __USBD_AUDIO_FB_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_AUDIO_FB
+  * @brief Feedback of an asynchronous audio sink
+  * @{
+  */
+
+/** @defgroup USBD_AUDIO_FB_Exported_Defines
+  * @{
+  */
+#define USBD_AUDIO_FB_FRAC              14    /* Full speed feedback format, 10.14 samples per frame */
+#define USBD_AUDIO_FB_HISTORY           16    /* Windows the rate is measured over */
+#define USBD_AUDIO_FB_LEVEL_SHIFT       8     /* A sample off the target level corrects 2^-8 sample per frame */
+/**
+  * @}
+  */
+
+/** @defgroup USBD_AUDIO_FB_Exported_Types
+  * @{
+  */
+typedef struct
+{
+  uint32_t nominal;                       /* Samples per frame, 10.14 */
+  uint32_t value;                         /* Feedback to the host, 10.14 */
+  uint32_t rate;                          /* Sink clock, 10.14 */
+  uint32_t target;                        /* Samples kept buffered */
+  uint16_t window;                        /* Frames per window */
+  uint16_t frames;                        /* Frames in the current window */
+  uint16_t idle;                          /* Frames the sink clock did not move */
+  uint8_t  running;                       /* The sink clock moves */
+  uint8_t  windows;                       /* Clocks held in history */
+  uint8_t  next;                          /* Oldest clock of history, next replaced */
+  uint32_t last_clock;
+  uint32_t level_sum;                     /* Buffered samples, summed over the window */
+  uint32_t history[USBD_AUDIO_FB_HISTORY]; /* Sink clock at the start of the last windows */
+} USBD_AUDIO_FbTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_AUDIO_FB_Exported_FunctionsPrototype
+  * @{
+  */
+void     USBD_AUDIO_Fb_Init  (USBD_AUDIO_FbTypeDef *pFb, uint32_t freq, uint32_t target, uint8_t window_log2);
+
+void     USBD_AUDIO_Fb_Frame (USBD_AUDIO_FbTypeDef *pFb, uint32_t clock, uint32_t level);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_AUDIO_FB_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file    usbd_audio_if.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_audio_if file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_AUDIO_IF_H
+#define __USBD_AUDIO_IF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+/* Includes ------------------------------------------------------------------*/
+#include "../../Class/AUDIO/inc/usbd_audio.h"
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_AUDIO_IF
+  * @brief header
+  * @{
+  */
+
+/** @defgroup USBD_AUDIO_IF_Exported_Defines
+  * @{
+  */
+/* Twice the latency and two packets, the level swings around the target by
+a packet and by what the playback takes at once */
+#define AUDIO_RING_SIZE		((2 * AUDIO_LATENCY_SAMPLES + 2 * (AUDIO_OUT_PACKET_MAX / AUDIO_SAMPLE_BYTES)) * AUDIO_SAMPLE_BYTES + 1)
+/**
+  * @}
+  */
+
+/** @defgroup USBD_AUDIO_IF_Exported_Types
+  * @{
+  */
+/* Playback counters, read with AUDIO_GetStats */
+typedef struct
+{
+	uint32_t Played;				/* Samples from the host */
+	uint32_t Silence;				/* Samples of silence, while priming or on underrun */
+	uint32_t Underruns;				/* The ring ran dry while playing */
+} AUDIO_StatsTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_AUDIO_IF_Exported_Variables
+  * @{
+  */
+extern USBD_AUDIO_ItfTypeDef  USBD_AUDIO_Interface_fops_FS;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_AUDIO_IF_Exported_FunctionsPrototype
+  * @{
+  */
+/* Playback side, one consumer at the speaker clock */
+void AUDIO_Read_FS(uint8_t* Buf, uint32_t Len);
+uint8_t AUDIO_IsStreaming_FS(void);
+void AUDIO_GetStats(AUDIO_StatsTypeDef *pStats);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_AUDIO_IF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
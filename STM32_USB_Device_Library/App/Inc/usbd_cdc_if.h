@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc_if.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_cdc_if file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_CDC_IF_H
+#define __USBD_CDC_IF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+/* Includes ------------------------------------------------------------------*/
+#include "../../Class/CDC/inc/usbd_cdc.h"
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_CDC_IF
+  * @brief header
+  * @{
+  */
+
+/** @defgroup USBD_CDC_IF_Exported_Types
+  * @{
+  */
+/* Stream counters, read with CDC_GetStats */
+typedef struct
+{
+	uint32_t TxBytes;				/* Committed to the transmit ring */
+	uint32_t TxRefused;				/* Not taken by CDC_Transmit_FS, the ring was full */
+	uint32_t RxBytes;				/* Received into the receive ring */
+} CDC_StatsTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CDC_IF_Exported_Variables
+  * @{
+  */
+extern USBD_CDC_ItfTypeDef  USBD_CDC_Interface_fops_FS;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CDC_IF_Exported_FunctionsPrototype
+  * @{
+  */
+/* Transmit side, one producer task */
+uint8_t *CDC_TxReserve_FS(uint32_t *Len);
+void CDC_TxCommit_FS(uint32_t Len);
+uint32_t CDC_Transmit_FS(const uint8_t* Buf, uint32_t Len);
+
+/* Receive side, one consumer task */
+uint8_t *CDC_RxPeek_FS(uint32_t *Len);
+void CDC_RxRelease_FS(uint32_t Len);
+uint32_t CDC_Receive_FS(uint8_t* Buf, uint32_t Len);
+uint32_t CDC_WaitReceive_FS(uint32_t TimeoutMs);
+
+uint16_t CDC_GetLineState_FS(void);
+void CDC_GetLineCoding_FS(USBD_CDC_LineCodingTypeDef *pLineCoding);
+void CDC_GetStats(CDC_StatsTypeDef *pStats);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_CDC_IF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -79,7 +79,7 @@
 /*---------- -----------*/
 #define USBD_MAX_STR_DESC_SIZ     		512
 /*---------- -----------*/
-#define USBD_SUPPORT_USER_STRING     	0
+#define USBD_SUPPORT_USER_STRING     	1	/* NCM iMACAddress */
  /*---------- -----------*/
 #define USBD_DEBUG_LEVEL    			0
 /*---------- -----------*/
@@ -87,12 +87,66 @@
 /*---------- -----------*/
 #define USBD_SELF_POWERED     			0
 /*---------- -----------*/
-#define MSC_MEDIA_PACKET     			512
+#define MSC_MEDIA_PACKET     			4096	/* Bytes per storage access, x2 media buffers */
+/*---------- -----------*/
+#define USBD_LLEX_QUEUE_DEPTH     		4
+/*---------- -----------*/
+#define USBD_LLEX_MAX_EP     			4
+/*---------- -----------*/
+#define USBD_LLEX_MAX_SEGMENTS     		4
+/*---------- -----------*/
+#define USBD_DEFERRED_EVENTS     		0
+/*---------- -----------*/
+/* Bus and EP0 events: SETUP, EP0 IN and OUT, reset, suspend, resume, connect,
+disconnect, ISO IN and OUT incomplete */
+#define USBD_EVENT_CONTROL_EVENTS     	10
+/* Every bus and EP0 event, every transfer the LLEx queues of the other
+endpoints can complete, and a coalesced SOF: the queue only fills when the
+event task falls behind, and then nothing is dropped, see usbd_conf.c */
+#define USBD_EVENT_QUEUE_LENGTH     	(USBD_EVENT_CONTROL_EVENTS + 2 * (USBD_LLEX_MAX_EP - 1) * USBD_LLEX_QUEUE_DEPTH + 1)
+/*---------- -----------*/
+#define USBD_STATIC_POOL_BLOCKS     	2	/* Class handles allocated at once */
+/*---------- -----------*/
+#define USBD_PROFILING     			0	/* DWT cycle statistics, see usbd_prof.h */
+/*---------- -----------*/
+#define USBD_TRACE     				0	/* Binary event trace, see usbd_trace.h */
+/*---------- -----------*/
+#define USBD_TRACE_DEPTH     		256
+/*---------- -----------*/
+#define USBD_LOG_DEFERRED     		1	/* Binary USBD_xxxLog backend, see usbd_log.h */
+/*---------- -----------*/
+#define USBD_LOG_DEPTH     			32
+/*---------- -----------*/
+#define USBD_NET_CLASS     			USBD_NET_CLASS_RNDIS	/* Network function, see usb_device.c */
+/*---------- -----------*/
+#define USBD_CDC_FUNCTION     		0	/* Serial port, instead of the network function */
+/*---------- -----------*/
+#define CDC_TX_RING_SIZE     		4096	/* Bytes to the host, see usbd_cdc_if.c */
+/*---------- -----------*/
+#define CDC_RX_RING_SIZE     		1024	/* Bytes from the host, at least 2 packets + 1 */
+/*---------- -----------*/
+#define USBD_VENDOR_FUNCTION     		0	/* Raw bulk function, see usb_device.c */
+/*---------- -----------*/
+#define USBD_MSC_FUNCTION     			1	/* Mass storage, instead of the vendor function */
+/*---------- -----------*/
+#define USBD_AUDIO_FUNCTION     		0	/* Speaker, instead of mass storage or the vendor function */
+/*---------- -----------*/
+#define AUDIO_LATENCY_MS     			4	/* Samples kept buffered by the feedback, in frames */
+/*---------- -----------*/
+#define MSC_CACHE_BLOCKS     			32	/* Storage cache of 512 byte blocks, 0 for none */
+/*---------- -----------*/
+#define MSC_CACHE_LINE_BLOCKS     		8	/* Erase unit of the storage, written back whole */
+/*---------- -----------*/
+#define MSC_RAMDISK_BLOCKS     			0	/* RAM disk instead of the SD card, 0 for none */
 
 /****************************************/
 /* #define for FS and HS identification */
 #define DEVICE_FS 		0
 #define DEVICE_HS 		1
+
+/* USBD_NET_CLASS values: the OTG FS core has endpoints for only one of them */
+#define USBD_NET_CLASS_RNDIS	0
+#define USBD_NET_CLASS_NCM		1
 #define USBD_AUDIO_FREQ 48000
 
 /** @defgroup USBD_Exported_Macros
@@ -100,8 +154,8 @@
   */ 
 
  /* Memory management macros */   
-#define USBD_malloc               malloc
-#define USBD_free                 free
+#define USBD_malloc               USBD_static_malloc
+#define USBD_free                 USBD_static_free
 #define USBD_memset               memset
 #define USBD_memcpy               memcpy
 
@@ -109,7 +163,13 @@
     
  /* DEBUG macros */  
 
-#if (USBD_DEBUG_LEVEL > 0)
+#if (USBD_DEBUG_LEVEL > 0) && (USBD_LOG_DEFERRED == 1)
+#include "usbd_log.h"
+#endif
+
+#if (USBD_DEBUG_LEVEL > 0) && (USBD_LOG_DEFERRED == 1)
+#define  USBD_UsrLog(...)   USBD_LOG(USBD_LOG_LEVEL_USR, __VA_ARGS__)
+#elif (USBD_DEBUG_LEVEL > 0)
 #define  USBD_UsrLog(...)   printf(__VA_ARGS__);\
                             printf("\n");
 #else
@@ -117,7 +177,9 @@
 #endif 
                             
                             
-#if (USBD_DEBUG_LEVEL > 1)
+#if (USBD_DEBUG_LEVEL > 1) && (USBD_LOG_DEFERRED == 1)
+#define  USBD_ErrLog(...)   USBD_LOG(USBD_LOG_LEVEL_ERR, __VA_ARGS__)
+#elif (USBD_DEBUG_LEVEL > 1)
 
 #define  USBD_ErrLog(...)   printf("ERROR: ") ;\
                             printf(__VA_ARGS__);\
@@ -127,7 +189,9 @@
 #endif 
                             
                             
-#if (USBD_DEBUG_LEVEL > 2)                         
+#if (USBD_DEBUG_LEVEL > 2) && (USBD_LOG_DEFERRED == 1)
+#define  USBD_DbgLog(...)   USBD_LOG(USBD_LOG_LEVEL_DBG, __VA_ARGS__)
+#elif (USBD_DEBUG_LEVEL > 2)                         
 #define  USBD_DbgLog(...)   printf("DEBUG : ") ;\
                             printf(__VA_ARGS__);\
                             printf("\n");
@@ -169,6 +233,9 @@
 /** @defgroup USBD_CONF_Exported_FunctionsPrototype
   * @{
   */ 
+void *USBD_static_malloc(uint32_t size);
+void USBD_static_free(void *p);
+uint32_t USBD_static_highwater(void);
 /**
   * @}
   */ 
@@ -0,0 +1,144 @@
+/**
+  ******************************************************************************
+  * @file    usbd_ll_ex.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Extended low level interface (usbd_conf.c): queued transfers with
+  *          per transfer completion callbacks and gather transmission.
+  ******************************************************************************
+  * @attention
+  *
+  * Transfers submitted through this interface are completed by the PCD
+  * callbacks in usbd_conf.c, in submission order, and are not reported to the
+  * class DataIn/DataOut callbacks. Do not mix USBD_LL_Transmit /
+  * USBD_LL_PrepareReceive and the queued functions on the same endpoint.
+  *
+  * Gather transmissions are written to the endpoint FIFO by
+  * USBD_LLEx_IRQHandler, which OTG_FS_IRQHandler must call in place of
+  * HAL_PCD_IRQHandler. They are not available with the core DMA enabled nor
+  * on isochronous endpoints.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_LL_EX_H
+#define __USBD_LL_EX_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_def.h"
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_LL_EX
+  * @brief Extended low level driver interface
+  * @{
+  */
+
+/** @defgroup USBD_LL_EX_Exported_Types
+  * @{
+  */
+typedef struct
+{
+  uint8_t  *pbuf;                         /* Segment data, any alignment */
+  uint32_t length;                        /* Segment length, may be zero */
+} USBD_LLEx_SegmentTypeDef;
+
+struct _USBD_LLEx_Xfer;
+
+typedef void (* USBD_LLEx_CpltCallbackTypeDef)(USBD_HandleTypeDef *pdev, struct _USBD_LLEx_Xfer *xfer);
+
+typedef struct _USBD_LLEx_Xfer
+{
+  uint8_t  ep_addr;                       /* Endpoint address as seen by the class */
+  uint8_t  status;                        /* USBD_OK when completed, USBD_FAIL when aborted */
+  uint8_t  *pbuf;                         /* Data buffer */
+  uint32_t length;                        /* Requested length */
+  uint32_t actual;                        /* Transferred length */
+  USBD_LLEx_CpltCallbackTypeDef pCplt;    /* Completion callback, may be NULL */
+  void     *pContext;                     /* User context passed back to pCplt */
+  void     *pClassData;                   /* Class context restored around pCplt */
+  void     *pUserData;
+  USBD_LLEx_SegmentTypeDef segment[USBD_LLEX_MAX_SEGMENTS]; /* Gather list */
+  uint8_t  nsegment;                      /* 0 for a contiguous buffer */
+  uint8_t  seg_index;                     /* FIFO write position in the list */
+  uint32_t seg_offset;
+} USBD_LLEx_XferTypeDef;
+
+typedef struct
+{
+  uint8_t  queued;                        /* Transfers pending now */
+  uint8_t  high_water;                    /* Most transfers ever pending */
+  uint32_t submitted;                     /* Transfers accepted */
+  uint32_t busy;                          /* Transfers refused, queue full */
+} USBD_LLEx_StatsTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_LL_EX_Exported_FunctionsPrototype
+  * @{
+  */
+USBD_StatusTypeDef  USBD_LLEx_Transmit       (USBD_HandleTypeDef *pdev,
+                                               uint8_t  ep_addr,
+                                               uint8_t  *pbuf,
+                                               uint32_t size,
+                                               USBD_LLEx_CpltCallbackTypeDef pCplt,
+                                               void *pContext);
+
+USBD_StatusTypeDef  USBD_LLEx_TransmitGather (USBD_HandleTypeDef *pdev,
+                                               uint8_t  ep_addr,
+                                               const USBD_LLEx_SegmentTypeDef *pSegment,
+                                               uint8_t  nsegment,
+                                               USBD_LLEx_CpltCallbackTypeDef pCplt,
+                                               void *pContext);
+
+USBD_StatusTypeDef  USBD_LLEx_PrepareReceive (USBD_HandleTypeDef *pdev,
+                                               uint8_t  ep_addr,
+                                               uint8_t  *pbuf,
+                                               uint32_t size,
+                                               USBD_LLEx_CpltCallbackTypeDef pCplt,
+                                               void *pContext);
+
+USBD_StatusTypeDef  USBD_LLEx_Abort          (USBD_HandleTypeDef *pdev, uint8_t ep_addr);
+
+USBD_StatusTypeDef  USBD_LLEx_IsoInNextFrame (USBD_HandleTypeDef *pdev, uint8_t ep_addr);
+
+uint8_t             USBD_LLEx_GetQueued      (USBD_HandleTypeDef *pdev, uint8_t ep_addr);
+
+void                USBD_LLEx_GetStats       (USBD_HandleTypeDef *pdev, uint8_t ep_addr,
+                                               USBD_LLEx_StatsTypeDef *stats);
+
+void                USBD_LLEx_IRQHandler     (PCD_HandleTypeDef *hpcd);
+
+uint32_t            USBD_LLEx_GetEventsLost  (void);
+
+void                USBD_LLEx_EnableSOF      (USBD_HandleTypeDef *pdev, uint8_t enable);
+
+uint16_t            USBD_LLEx_GetFrameNumber (USBD_HandleTypeDef *pdev);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_LL_EX_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,148 @@
+/**
+  ******************************************************************************
+  * @file    usbd_log.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Deferred binary logging backend of USBD_UsrLog, USBD_ErrLog and
+  *          USBD_DbgLog.
+  ******************************************************************************
+  * @attention
+  *
+  * Selected with USBD_LOG_DEFERRED in usbd_conf.h when USBD_DEBUG_LEVEL is
+  * above 0. A log call only stores the format string address, up to
+  * USBD_LOG_MAX_ARGS raw 32 bit arguments and a cycle timestamp in the
+  * USBD_Log ring, from any context and without locking. The messages are
+  * formatted later by USBD_Log_Flush, from the low priority log task or
+  * from the application, or on the host from a dump of USBD_Log with
+  * Tools/usbd_log_decode.
+  *
+  * Arguments are stored by value when the call is made: integers, chars and
+  * pointers only, and %s arguments must point to constant strings. When the
+  * ring is full the oldest messages are overwritten and counted as lost.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_LOG_H
+#define __USBD_LOG_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_conf.h"
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_LOG
+  * @brief Deferred binary logging
+  * @{
+  */
+
+/** @defgroup USBD_LOG_Exported_Defines
+  * @{
+  */
+#ifndef USBD_LOG_DEPTH
+#define USBD_LOG_DEPTH                  32      /* Messages, power of two */
+#endif
+
+#ifndef USBD_LOG_FLUSH_TASK
+#define USBD_LOG_FLUSH_TASK             1       /* USBD_Log_Init starts the log task */
+#endif
+
+#define USBD_LOG_MAX_ARGS               4
+
+#define USBD_LOG_LEVEL_USR              0
+#define USBD_LOG_LEVEL_ERR              1
+#define USBD_LOG_LEVEL_DBG              2
+
+#define USBD_LOG_MAGIC                  0x474F4C55U     /* "ULOG" */
+#define USBD_LOG_VERSION                1
+/**
+  * @}
+  */
+
+/** @defgroup USBD_LOG_Exported_Types
+  * @{
+  */
+typedef struct
+{
+  __IO uint32_t seq;                      /* Sequence number + 1 once written,
+                                             0 while being written */
+  uint32_t timestamp;                     /* DWT cycle counter */
+  const char *fmt;                        /* Format string */
+  uint8_t  level;                         /* USBD_LOG_LEVEL_xxx */
+  uint8_t  argc;
+  uint16_t reserved;
+  uint32_t arg[USBD_LOG_MAX_ARGS];
+} USBD_Log_EntryTypeDef;
+
+typedef struct
+{
+  uint32_t magic;                         /* USBD_LOG_MAGIC */
+  uint16_t version;                       /* USBD_LOG_VERSION */
+  uint16_t entry_size;                    /* sizeof(USBD_Log_EntryTypeDef) */
+  uint32_t depth;                         /* USBD_LOG_DEPTH */
+  uint32_t clock;                         /* Timestamp frequency in Hz */
+  __IO uint32_t seq;                      /* Messages written so far */
+  __IO uint32_t rd;                       /* Messages formatted so far */
+  __IO uint32_t lost;                     /* Messages overwritten before formatting */
+  USBD_Log_EntryTypeDef entry[USBD_LOG_DEPTH];
+} USBD_Log_RingTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_LOG_Exported_Macros
+  * @{
+  */
+/* USBD_LOG(level, fmt, ...) takes up to USBD_LOG_MAX_ARGS arguments */
+#define USBD_LOG(level, ...)            USBD_LOG_(level, USBD_LOG_ARGC(__VA_ARGS__), __VA_ARGS__, 0, 0, 0, 0, 0)
+#define USBD_LOG_(level, argc, fmt, a0, a1, a2, a3, ...) \
+                                        USBD_Log_Write((level), (fmt), (argc), (uint32_t)(a0), \
+                                                       (uint32_t)(a1), (uint32_t)(a2), (uint32_t)(a3))
+#define USBD_LOG_ARGC(...)              USBD_LOG_ARGC_(__VA_ARGS__, 4, 3, 2, 1, 0, 0)
+#define USBD_LOG_ARGC_(fmt, a0, a1, a2, a3, n, ...) n
+/**
+  * @}
+  */
+
+/** @defgroup USBD_LOG_Exported_Variables
+  * @{
+  */
+extern USBD_Log_RingTypeDef USBD_Log;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_LOG_Exported_FunctionsPrototype
+  * @{
+  */
+void     USBD_Log_Init  (void);
+void     USBD_Log_Write (uint8_t level, const char *fmt, uint8_t argc,
+                         uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+uint32_t USBD_Log_Flush (void);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_LOG_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
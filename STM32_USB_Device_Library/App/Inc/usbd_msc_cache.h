@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file    usbd_msc_cache.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_msc_cache.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_MSC_CACHE_H
+#define __USBD_MSC_CACHE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_MSC_CACHE
+  * @brief Read-ahead and write-back block cache of the mass storage
+  * @{
+  */
+
+/** @defgroup USBD_MSC_CACHE_Exported_Defines
+  * @{
+  */
+#define USBD_MSC_CACHE_MAX_LINE_BLOCKS  32    /* Blocks per line, one bit each in the masks */
+/**
+  * @}
+  */
+
+/** @defgroup USBD_MSC_CACHE_Exported_Types
+  * @{
+  */
+/* Storage block access, the Read and Write of USBD_StorageTypeDef */
+typedef int8_t (* USBD_MSC_CacheIoTypeDef)(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+
+/* A line holds one erase unit of the storage */
+typedef struct
+{
+  uint32_t blk_addr;                      /* First block, a multiple of line_blocks */
+  uint32_t valid;                         /* Bit n set: block n is held */
+  uint32_t dirty;                         /* Bit n set: block n is not written back yet */
+  uint32_t stamp;                         /* Last use, the oldest line is replaced */
+  uint8_t  lun;
+  uint8_t  used;
+} USBD_MSC_CacheLineTypeDef;
+
+typedef struct
+{
+  uint32_t read_hits;                     /* Blocks read from the cache */
+  uint32_t read_misses;                   /* Blocks read from the storage on demand */
+  uint32_t read_ahead;                    /* Blocks read ahead of a sequential stream */
+  uint32_t write_blocks;                  /* Blocks written by the host */
+  uint32_t write_backs;                   /* Lines written back whole */
+  uint32_t bypassed;                      /* Blocks of whole lines moved without the cache */
+  uint32_t errors;                        /* Write-backs failed */
+} USBD_MSC_CacheStatsTypeDef;
+
+typedef struct
+{
+  USBD_MSC_CacheIoTypeDef Read;
+  USBD_MSC_CacheIoTypeDef Write;
+  USBD_MSC_CacheLineTypeDef *pLine;
+  uint8_t  *pData;                        /* lines * line_blocks * blk_size bytes */
+  uint16_t lines;
+  uint16_t line_blocks;
+  uint16_t blk_size;
+  uint32_t clock;                         /* Line use counter */
+  uint8_t  seq_lun;
+  uint32_t seq_next;                      /* Block after the last read */
+  uint8_t  ahead;                         /* A line is to be read ahead */
+  uint8_t  ahead_lun;
+  uint32_t ahead_addr;
+  int8_t   error;                         /* A write-back failed since the last sync */
+  USBD_MSC_CacheStatsTypeDef stats;
+} USBD_MSC_CacheTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_MSC_CACHE_Exported_FunctionsPrototype
+  * @{
+  */
+void     USBD_MSC_Cache_Init      (USBD_MSC_CacheTypeDef *pCache,
+                                   USBD_MSC_CacheIoTypeDef Read,
+                                   USBD_MSC_CacheIoTypeDef Write,
+                                   USBD_MSC_CacheLineTypeDef *pLine,
+                                   uint16_t lines,
+                                   uint16_t line_blocks,
+                                   uint8_t *pData,
+                                   uint16_t blk_size);
+
+int8_t   USBD_MSC_Cache_Read      (USBD_MSC_CacheTypeDef *pCache, uint8_t lun,
+                                   uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+
+int8_t   USBD_MSC_Cache_Write     (USBD_MSC_CacheTypeDef *pCache, uint8_t lun,
+                                   uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+
+uint8_t  USBD_MSC_Cache_ReadAhead (USBD_MSC_CacheTypeDef *pCache);
+
+void     USBD_MSC_Cache_WriteBack (USBD_MSC_CacheTypeDef *pCache);
+
+int8_t   USBD_MSC_Cache_Sync      (USBD_MSC_CacheTypeDef *pCache);
+
+uint8_t  USBD_MSC_Cache_IsDirty   (USBD_MSC_CacheTypeDef *pCache);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_MSC_CACHE_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file    usbd_msc_if.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_msc_if file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_MSC_IF_H
+#define __USBD_MSC_IF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+/* Includes ------------------------------------------------------------------*/
+#include "../../Class/MSC/inc/usbd_msc.h"
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_MSC_IF
+  * @brief header
+  * @{
+  */
+
+/** @defgroup USBD_MSC_IF_Exported_Variables
+  * @{
+  */
+extern USBD_MSC_ItfTypeDef  USBD_MSC_Interface_fops_FS;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_MSC_IF_Exported_FunctionsPrototype
+  * @{
+  */
+void MSC_Start_FS(void);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_MSC_IF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    usbd_ncm_if.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_ncm_if file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_NCM_IF_H
+#define __USBD_NCM_IF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+/* Includes ------------------------------------------------------------------*/
+#include "../../Class/NCM/inc/usbd_ncm.h"
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_NCM_IF
+  * @brief header
+  * @{
+  */
+
+/** @defgroup USBD_NCM_IF_Exported_Types
+  * @{
+  */
+/* Driver counters, read with NCM_GetStats */
+typedef struct
+{
+	uint32_t RxNtbs;				/* NTBs received */
+	uint32_t RxFrames;				/* Frames handed to the IP task */
+	uint32_t RxBatches;				/* Events sent to the IP task */
+	uint32_t RxDropMalformed;		/* NTBs or datagrams failing USBD_NCM_ParseNtb or the length checks */
+	uint32_t RxDropOverflow;		/* Datagrams beyond NCM_NTB_MAX_DATAGRAMS */
+	uint32_t RxDropNoTask;			/* NTBs received before the EMAC task ran */
+	uint32_t RxDropIpQueue;			/* IP task queue full */
+	uint32_t RxFiltered;			/* Not for this host */
+	uint32_t RxFlowStalls;			/* Times the host was NAKed for lack of buffers */
+	uint32_t TxNtbs;				/* NTBs sent */
+	uint32_t TxFrames;				/* Frames copied into an NTB */
+	uint32_t TxBusy;				/* Retries, both NTBs full */
+	uint32_t TxDrop;				/* Frames given up after the retries */
+	uint32_t EmacWakeups;
+} NCM_StatsTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_NCM_IF_Exported_Variables
+  * @{
+  */
+extern USBD_NCM_ItfTypeDef  USBD_NCM_Interface_fops_FS;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_NCM_IF_Exported_FunctionsPrototype
+  * @{
+  */
+uint8_t NCM_Transmit_FS(uint8_t* Buf, uint16_t Len);
+void NCM_GetStats(NCM_StatsTypeDef *pStats);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_NCM_IF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
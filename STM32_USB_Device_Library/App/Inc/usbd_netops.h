@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file    usbd_netops.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Frame copy and Internet checksum kernels of the RNDIS interface.
+  ******************************************************************************
+  * @attention
+  *
+  * On Thumb-2 cores (Cortex-M3/M4) the aligned bulk of the data is moved
+  * and summed 16 bytes at a time with LDM/STM bursts and an ADCS carry
+  * chain, the unaligned head and tail byte by byte. Elsewhere, or with
+  * USBD_NETOPS_ASM set to 0, portable C is used. Little endian only.
+  *
+  * The file does not depend on the HAL, so that Tools/netops_bench can
+  * build it on the host, natively or for qemu-arm.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_NETOPS_H
+#define __USBD_NETOPS_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_NETOPS
+  * @brief Frame copy and Internet checksum kernels
+  * @{
+  */
+
+/** @defgroup USBD_NETOPS_Exported_Defines
+  * @{
+  */
+#ifndef USBD_NETOPS_ASM
+#if defined(__GNUC__) && defined(__thumb2__)
+#define USBD_NETOPS_ASM                 1
+#else
+#define USBD_NETOPS_ASM                 0
+#endif
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_NETOPS_Exported_FunctionsPrototype
+  * @{
+  */
+void     USBD_NetOps_Copy     (void *dst, const void *src, uint32_t len);
+uint16_t USBD_NetOps_Checksum (uint32_t sum, const void *data, uint32_t len);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_NETOPS_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
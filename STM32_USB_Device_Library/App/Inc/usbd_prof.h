@@ -0,0 +1,166 @@
+/**
+  ******************************************************************************
+  * @file    usbd_prof.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Cycle counter profiling of the USB interrupt, LL callbacks and
+  *          class dispatch.
+  ******************************************************************************
+  * @attention
+  *
+  * Enabled with USBD_PROFILING in usbd_conf.h. Each probe pair measures the
+  * DWT cycle counter around a section and accumulates count, min, max, total
+  * and a log2 histogram in USBD_Prof_Stats, which can be read from the
+  * debugger or with USBD_Prof_Get. Times include any preemption by higher
+  * priority interrupts. When disabled the probes compile to nothing.
+  *
+  * The RNDIS interface also stamps each frame along its path (USBD_PROF_STAMP)
+  * and accounts the latency of every stage in the same way (USBD_PROF_SPAN).
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_PROF_H
+#define __USBD_PROF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_conf.h"
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_PROF
+  * @brief Cycle counter profiling
+  * @{
+  */
+
+/** @defgroup USBD_PROF_Exported_Defines
+  * @{
+  */
+#ifndef USBD_PROFILING
+#define USBD_PROFILING                  0
+#endif
+
+/* Histogram bin n counts the sections that took [2^n, 2^(n+1)) cycles, the
+last bin everything above */
+#define USBD_PROF_HIST_BINS             20
+/**
+  * @}
+  */
+
+/** @defgroup USBD_PROF_Exported_Types
+  * @{
+  */
+typedef enum
+{
+  /* USB interrupt, USBD_LLEx_IRQHandler */
+  USBD_PROF_IRQ = 0,
+  /* LL callbacks, in the order of the usbd_conf.c event types */
+  USBD_PROF_LL_SETUP,
+  USBD_PROF_LL_DATA_OUT,
+  USBD_PROF_LL_DATA_IN,
+  USBD_PROF_LL_SOF,
+  USBD_PROF_LL_RESET,
+  USBD_PROF_LL_SUSPEND,
+  USBD_PROF_LL_RESUME,
+  USBD_PROF_LL_ISO_OUT_INCOMPLETE,
+  USBD_PROF_LL_ISO_IN_INCOMPLETE,
+  USBD_PROF_LL_CONNECT,
+  USBD_PROF_LL_DISCONNECT,
+  /* Class callbacks called by the composite layer */
+  USBD_PROF_CLASS_SETUP,
+  USBD_PROF_CLASS_DATA_IN,
+  USBD_PROF_CLASS_DATA_OUT,
+  USBD_PROF_CLASS_EP0_RX_READY,
+  USBD_PROF_CLASS_EP0_TX_SENT,
+  USBD_PROF_CLASS_SOF,
+  USBD_PROF_CLASS_ISO_IN_INCOMPLETE,
+  USBD_PROF_CLASS_ISO_OUT_INCOMPLETE,
+  /* RNDIS interface callbacks */
+  USBD_PROF_RNDIS_CONTROL,
+  USBD_PROF_RNDIS_RECEIVE,
+  /* RNDIS frame latency, between two stamps of the same frame */
+  USBD_PROF_RNDIS_RX_WAKE,              /* Frame received to EMAC task wake up */
+  USBD_PROF_RNDIS_RX_REFILL,            /* Receive buffer allocation, off the frame path */
+  USBD_PROF_RNDIS_RX_HANDOFF,           /* Wake up to IP task hand-off, first frame of a batch */
+  USBD_PROF_RNDIS_RX_TOTAL,             /* Frame received to IP task hand-off, first frame of a batch */
+  USBD_PROF_RNDIS_TX_SUBMIT,            /* xNetworkInterfaceOutput to USB submit */
+  USBD_PROF_RNDIS_TX_USB,               /* USB submit to transfer completion */
+  USBD_PROF_RNDIS_TX_TOTAL,             /* xNetworkInterfaceOutput to completion */
+  USBD_PROF_COUNT
+} USBD_Prof_IdTypeDef;
+
+typedef struct
+{
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;                         /* average = total / count */
+  uint32_t hist[USBD_PROF_HIST_BINS];
+} USBD_Prof_StatTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_PROF_Exported_Macros
+  * @{
+  */
+#if (USBD_PROFILING == 1)
+#define USBD_PROF_START(t)              uint32_t t = DWT->CYCCNT
+#define USBD_PROF_STOP(id, t)           USBD_Prof_Record((id), DWT->CYCCNT - (t))
+#define USBD_PROF_STAMP(v)              ((v) = DWT->CYCCNT)
+#define USBD_PROF_SPAN(id, from, to)    USBD_Prof_Record((id), (to) - (from))
+#else
+#define USBD_PROF_START(t)
+#define USBD_PROF_STOP(id, t)
+#define USBD_PROF_STAMP(v)
+#define USBD_PROF_SPAN(id, from, to)
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_PROF_Exported_Variables
+  * @{
+  */
+#if (USBD_PROFILING == 1)
+extern USBD_Prof_StatTypeDef USBD_Prof_Stats[USBD_PROF_COUNT];
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_PROF_Exported_FunctionsPrototype
+  * @{
+  */
+void        USBD_Prof_Init   (void);
+void        USBD_Prof_Record (USBD_Prof_IdTypeDef id, uint32_t cycles);
+uint8_t     USBD_Prof_Get    (USBD_Prof_IdTypeDef id, USBD_Prof_StatTypeDef *stat);
+void        USBD_Prof_Reset  (void);
+const char *USBD_Prof_Name   (USBD_Prof_IdTypeDef id);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_PROF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file    usbd_ramdisk_if.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_ramdisk_if file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_RAMDISK_IF_H
+#define __USBD_RAMDISK_IF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+/* Includes ------------------------------------------------------------------*/
+#include "../../Class/MSC/inc/usbd_msc.h"
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_RAMDISK
+  * @brief header file for the usbd_ramdisk_if.c file
+  * @{
+  */
+
+/** @defgroup USBD_RAMDISK_Exported_Defines
+  * @{
+  */
+#define RAMDISK_BLK_SIZ				512
+/**
+  * @}
+  */
+
+/** @defgroup USBD_RAMDISK_Exported_Variables
+  * @{
+  */
+extern USBD_StorageTypeDef  USBD_RamDisk_fops_FS;
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_RAMDISK_IF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file    usbd_ring.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_ring.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_RING_H
+#define __USBD_RING_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_RING
+  * @brief Single producer, single consumer byte ring
+  * @{
+  */
+
+/** @defgroup USBD_RING_Exported_Types
+  * @{
+  */
+/* Data is [tail, head), or [tail, limit) then [0, head) once the producer
+has wrapped. Each index is written by one side only. */
+typedef struct
+{
+  uint8_t  *pBuffer;
+  uint32_t size;
+  volatile uint32_t head;                 /* Next byte written, producer */
+  volatile uint32_t tail;                 /* Next byte read, consumer */
+  volatile uint32_t limit;                /* End of the data before the wrap, producer */
+  uint32_t reserved;                      /* Start of the reservation, producer */
+} USBD_RingTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_RING_Exported_FunctionsPrototype
+  * @{
+  */
+void     USBD_Ring_Init    (USBD_RingTypeDef *pRing, uint8_t *pBuffer, uint32_t size);
+
+uint8_t *USBD_Ring_Reserve (USBD_RingTypeDef *pRing, uint32_t min, uint32_t *len);
+
+void     USBD_Ring_Commit  (USBD_RingTypeDef *pRing, uint32_t len);
+
+uint8_t *USBD_Ring_Peek    (USBD_RingTypeDef *pRing, uint32_t offset, uint32_t *len);
+
+void     USBD_Ring_Release (USBD_RingTypeDef *pRing, uint32_t len);
+
+uint32_t USBD_Ring_Count   (USBD_RingTypeDef *pRing);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_RING_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
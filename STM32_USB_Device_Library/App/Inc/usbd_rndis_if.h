@@ -71,6 +71,13 @@
   * @{
   */ 
 /* USER CODE BEGIN EXPORTED_DEFINES */
+/* Vendor specific OIDs (0xFF prefix), queried like any other OID */
+#define RNDIS_OID_VENDOR_DRIVER_STATS		0xFF757801	/* RNDIS_VendorStatsTypeDef */
+#define RNDIS_OID_VENDOR_TASK_STATS			0xFF757802	/* RNDIS_VendorTasksTypeDef */
+
+#define RNDIS_VENDOR_STATS_VERSION			1
+#define RNDIS_VENDOR_TASK_NAME_LEN			16
+#define RNDIS_VENDOR_MAX_TASKS				14
 /* USER CODE END EXPORTED_DEFINES */
 
 /**
@@ -81,6 +88,62 @@
   * @{
   */  
 /* USER CODE BEGIN EXPORTED_TYPES */
+/* Information buffers of the vendor OIDs, little endian 32 bit fields. New
+fields are only ever appended, Size tells the host which ones are there. */
+typedef struct
+{
+	uint32_t Version;				/* RNDIS_VENDOR_STATS_VERSION */
+	uint32_t Size;					/* sizeof(RNDIS_VendorStatsTypeDef) */
+	uint32_t Uptime;				/* ms */
+	uint32_t RxFrames;				/* Frames handed to the IP task */
+	uint32_t TxFrames;				/* Frames submitted to USB */
+	uint32_t TxZeroCopy;			/* Of which sent without copy */
+	uint32_t RxDropNoBuffer;		/* Received before the EMAC task ran */
+	uint32_t RxDropIpQueue;			/* IP task queue full */
+	uint32_t RxDropOversize;		/* Longer than the receive buffer */
+	uint32_t RxDropRunt;			/* Shorter than the RNDIS header */
+	uint32_t RxFiltered;			/* Not for this host */
+	uint32_t TxBusy;				/* Retries, previous frame still in flight */
+	uint32_t TxDrop;				/* Frames given up after the retries */
+	uint32_t TxQueued;				/* Data IN endpoint queue */
+	uint32_t TxQueueHighWater;
+	uint32_t TxQueueBusy;			/* Submissions refused, queue full */
+	uint32_t RxPending;				/* Received frames not yet consumed */
+	uint32_t NetBuffersFree;
+	uint32_t NetBuffersMinFree;
+	uint32_t UsbEventsLost;			/* USBD_DEFERRED_EVENTS queue overflows */
+	uint32_t IsrCount;				/* USBD_PROFILING, 0 when disabled */
+	uint32_t IsrCyclesMin;
+	uint32_t IsrCyclesAvg;
+	uint32_t IsrCyclesMax;
+	uint32_t EmacStackHighWater;	/* Words never used */
+	uint32_t StaticPoolHighWater;	/* Class handle blocks */
+	uint32_t EmacWakeups;
+	uint32_t RxPolling;				/* 1 while received frames are polled */
+	uint32_t RxBatches;				/* Events sent to the IP task, RxFrames / RxBatches
+									frames each with ipconfigUSE_LINKED_RX_MESSAGES */
+	uint32_t RxFlowStalls;			/* Times the host was NAKed for lack of buffers */
+	uint32_t RxFlowStalled;			/* 1 while it is */
+	uint32_t RxChecksumChecked;		/* Spot checks, ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM */
+	uint32_t RxChecksumErrors;		/* Of which failed, the frame is dropped */
+} RNDIS_VendorStatsTypeDef;
+
+typedef struct
+{
+	char     Name[RNDIS_VENDOR_TASK_NAME_LEN];
+	uint32_t RunTime;				/* Run time counter, 0 without run time stats */
+	uint32_t StackHighWater;		/* Words never used */
+	uint32_t Priority;
+	uint32_t State;					/* eTaskState */
+} RNDIS_VendorTaskTypeDef;
+
+typedef struct
+{
+	uint32_t Version;				/* RNDIS_VENDOR_STATS_VERSION */
+	uint32_t Count;					/* Tasks reported */
+	uint32_t TotalRunTime;
+	RNDIS_VendorTaskTypeDef Task[RNDIS_VENDOR_MAX_TASKS];
+} RNDIS_VendorTasksTypeDef;
 /* USER CODE END EXPORTED_TYPES */
 
 /**
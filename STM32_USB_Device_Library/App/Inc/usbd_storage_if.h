@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    usbd_storage_if.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_storage_if file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_STORAGE_IF_H
+#define __USBD_STORAGE_IF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+/* Includes ------------------------------------------------------------------*/
+#include "../../Class/MSC/inc/usbd_msc.h"
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_STORAGE
+  * @brief header file for the usbd_storage_if.c file
+  * @{
+  */
+
+/** @defgroup USBD_STORAGE_Exported_Defines
+  * @{
+  */
+#define STORAGE_LUN_NBR				1
+#define STORAGE_TIMEOUT				1000	/* ms for one access of the SD card */
+/**
+  * @}
+  */
+
+/** @defgroup USBD_STORAGE_Exported_Variables
+  * @{
+  */
+extern USBD_StorageTypeDef  USBD_Storage_Interface_fops_FS;
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_STORAGE_IF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,155 @@
+/**
+  ******************************************************************************
+  * @file    usbd_trace.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Binary event trace of the USB device and RNDIS interface.
+  ******************************************************************************
+  * @attention
+  *
+  * Enabled with USBD_TRACE in usbd_conf.h. Events are appended to the
+  * USBD_Trace ring from any context without locking: a slot is reserved with
+  * LDREX/STREX on the sequence counter, then filled. When the ring is full
+  * the oldest events are overwritten.
+  *
+  * To read the trace, freeze it with USBD_Trace_Freeze (or halt the core),
+  * dump the USBD_Trace variable, e.g. from gdb:
+  *
+  *   dump binary value usbd_trace.bin USBD_Trace
+  *
+  * and decode it on the host with Tools/usbd_trace_decode. The ring layout
+  * is part of that contract: update USBD_TRACE_VERSION and the decoder
+  * together with it.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_TRACE_H
+#define __USBD_TRACE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_conf.h"
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_TRACE
+  * @brief Binary event trace
+  * @{
+  */
+
+/** @defgroup USBD_TRACE_Exported_Defines
+  * @{
+  */
+#ifndef USBD_TRACE
+#define USBD_TRACE                      0
+#endif
+
+#ifndef USBD_TRACE_DEPTH
+#define USBD_TRACE_DEPTH                256     /* Entries, power of two */
+#endif
+
+#define USBD_TRACE_MAGIC                0x43525455U     /* "UTRC" */
+#define USBD_TRACE_VERSION              1
+/**
+  * @}
+  */
+
+/** @defgroup USBD_TRACE_Exported_Types
+  * @{
+  */
+typedef enum
+{
+  USBD_TRACE_SETUP = 1,         /* arg0/arg1: setup packet bytes 0-3/4-7 */
+  USBD_TRACE_EP_SUBMIT,         /* ep: device address, arg0: length, arg1: queued */
+  USBD_TRACE_EP_COMPLETE,       /* ep: device address, arg0: transferred length */
+  USBD_TRACE_EP_BUSY,           /* ep: device address, arg0: USBD status, arg1: length */
+  USBD_TRACE_BUS,               /* arg0: LL event (reset, suspend, resume...) */
+  USBD_TRACE_EVENT_LOST,        /* arg0: LL event held back, the event queue is full */
+  USBD_TRACE_RNDIS_MSG,         /* arg0: message type, arg1: request id */
+  USBD_TRACE_EMAC_NOTIFY,       /* arg0: notification bits, arg1: received size */
+  USBD_TRACE_NETBUF_FAIL,       /* arg0: requested size */
+  USBD_TRACE_USER               /* Free for the application */
+} USBD_Trace_TypeTypeDef;
+
+typedef struct
+{
+  uint32_t timestamp;                     /* DWT cycle counter */
+  uint8_t  type;                          /* USBD_Trace_TypeTypeDef */
+  uint8_t  ep;
+  uint16_t seq;                           /* Low half of the sequence number,
+                                             written last */
+  uint32_t arg0;
+  uint32_t arg1;
+} USBD_Trace_EntryTypeDef;
+
+typedef struct
+{
+  uint32_t magic;                         /* USBD_TRACE_MAGIC */
+  uint16_t version;                       /* USBD_TRACE_VERSION */
+  uint16_t entry_size;                    /* sizeof(USBD_Trace_EntryTypeDef) */
+  uint32_t depth;                         /* USBD_TRACE_DEPTH */
+  uint32_t clock;                         /* Timestamp frequency in Hz */
+  __IO uint32_t enabled;
+  __IO uint32_t seq;                      /* Entries recorded so far */
+  USBD_Trace_EntryTypeDef entry[USBD_TRACE_DEPTH];
+} USBD_Trace_RingTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_TRACE_Exported_Macros
+  * @{
+  */
+#if (USBD_TRACE == 1)
+#define USBD_TRACE_EVENT(type, ep, arg0, arg1)  USBD_Trace_Record((type), (ep), (arg0), (arg1))
+#else
+#define USBD_TRACE_EVENT(type, ep, arg0, arg1)
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_TRACE_Exported_Variables
+  * @{
+  */
+#if (USBD_TRACE == 1)
+extern USBD_Trace_RingTypeDef USBD_Trace;
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_TRACE_Exported_FunctionsPrototype
+  * @{
+  */
+void USBD_Trace_Init   (void);
+void USBD_Trace_Record (USBD_Trace_TypeTypeDef type, uint8_t ep, uint32_t arg0, uint32_t arg1);
+void USBD_Trace_Freeze (void);
+void USBD_Trace_Resume (void);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_TRACE_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file    usbd_vendor_if.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Header for usbd_vendor_if file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_VENDOR_IF_H
+#define __USBD_VENDOR_IF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+/* Includes ------------------------------------------------------------------*/
+#include "../../Class/Vendor/inc/usbd_vendor.h"
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_VENDOR_IF
+  * @brief header
+  * @{
+  */
+
+/** @defgroup USBD_VENDOR_IF_Exported_Defines
+  * @{
+  */
+/* Vendor requests to the interface, Tools/vendor_bench.c uses them */
+#define VENDOR_REQ_SET_SOURCE			0x01	/* wValue 1 starts the test pattern on the IN endpoint, 0 stops it */
+#define VENDOR_REQ_GET_STATS			0x02	/* VENDOR_StatsTypeDef */
+#define VENDOR_REQ_RESET_STATS			0x03
+
+#define VENDOR_PATTERN_WORDS			512		/* Word n of the IN stream is n % VENDOR_PATTERN_WORDS */
+/**
+  * @}
+  */
+
+/** @defgroup USBD_VENDOR_IF_Exported_Types
+  * @{
+  */
+/* Stream counters, read with VENDOR_GetStats or VENDOR_REQ_GET_STATS */
+typedef struct
+{
+	uint32_t TxBytes;				/* Sent on the IN endpoint */
+	uint32_t TxTransfers;
+	uint32_t TxBusy;				/* VENDOR_Transmit_FS calls with the queue full */
+	uint32_t RxBytes;				/* Received on the OUT endpoint */
+	uint32_t RxTransfers;
+	uint32_t Aborted;				/* Transfers given back unfinished */
+} VENDOR_StatsTypeDef;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_VENDOR_IF_Exported_Variables
+  * @{
+  */
+extern USBD_VENDOR_ItfTypeDef  USBD_VENDOR_Interface_fops_FS;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_VENDOR_IF_Exported_FunctionsPrototype
+  * @{
+  */
+uint8_t VENDOR_Transmit_FS(uint8_t* Buf, uint32_t Len);
+void VENDOR_GetStats(VENDOR_StatsTypeDef *pStats);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_VENDOR_IF_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
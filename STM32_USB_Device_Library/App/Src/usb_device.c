@@ -2,38 +2,90 @@
 #include "usb_device.h"
 #include "usbd_core.h"
 #include "usbd_desc.h"
-//#include "usbd_cdc.h"
-//#include "usbd_cdc_if.h"
-//#include "usbd_msc.h"
-//#include "usbd_storage_if.h"
-//#include "usbd_audio.h"
-//#include "usbd_audio_if.h"
+#if (USBD_CDC_FUNCTION == 1)
+#include "../../Class/CDC/inc/usbd_cdc.h"
+#include "../inc/usbd_cdc_if.h"
+#elif (USBD_NET_CLASS == USBD_NET_CLASS_NCM)
+#include "../../Class/NCM/inc/usbd_ncm.h"
+#include "../inc/usbd_ncm_if.h"
+#else
 #include "../../Class/RNDIS/inc/usbd_rndis.h"
 #include "../inc/usbd_rndis_if.h"
+#endif
+#if (USBD_VENDOR_FUNCTION == 1)
+#include "../../Class/Vendor/inc/usbd_vendor.h"
+#include "../inc/usbd_vendor_if.h"
+#endif
+#if (USBD_MSC_FUNCTION == 1)
+#include "../../Class/MSC/inc/usbd_msc.h"
+#include "../inc/usbd_msc_if.h"
+#endif
+#if (USBD_AUDIO_FUNCTION == 1)
+#include "../../Class/AUDIO/inc/usbd_audio.h"
+#include "../inc/usbd_audio_if.h"
+#endif
+
+#if (USBD_VENDOR_FUNCTION == 1) && (USBD_MSC_FUNCTION == 1)
+#error "USBD_VENDOR_FUNCTION and USBD_MSC_FUNCTION both need IN3 and OUT2"
+#endif
+#if (USBD_AUDIO_FUNCTION == 1) && ((USBD_VENDOR_FUNCTION == 1) || (USBD_MSC_FUNCTION == 1))
+#error "USBD_AUDIO_FUNCTION needs IN3 and OUT2, as USBD_VENDOR_FUNCTION and USBD_MSC_FUNCTION"
+#endif
+#if (USBD_AUDIO_FUNCTION == 1) && (USBD_DEFERRED_EVENTS == 1)
+#error "USBD_AUDIO_FUNCTION re-arms its isochronous endpoints within the frame, in the USB interrupt"
+#endif
 
 USBD_HandleTypeDef hUsbDeviceFS;
+void _Error_Handler(char * file, int line);
 
 void MX_USB_DEVICE_Init(void)
 {
 	USBD_Init(&hUsbDeviceFS, &FS_Desc, DEVICE_FS);
 
-
-//	USBD_RegisterClass(&hUsbDeviceFS, &USBD_AUDIO);
-//	USBD_AUDIO_RegisterInterface(&hUsbDeviceFS, &USBD_AUDIO_fops_FS);
-//	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0x01, 0x00, 0x00);
-
-//	USBD_RegisterClass(&hUsbDeviceFS, &USBD_CDC);
-//	USBD_CDC_RegisterInterface(&hUsbDeviceFS, &USBD_Interface_fops_FS);
-//	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0x02, 0x02, 0x00);
-
-//	USBD_RegisterClass(&hUsbDeviceFS, &USBD_MSC);
-//	USBD_MSC_RegisterStorage(&hUsbDeviceFS, &USBD_Storage_Interface_fops_FS);
-//	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0x08, 0x06, 0x50);
-
+	/* The serial port, RNDIS or NCM, the OTG FS core has not enough IN
+	endpoints for two of them. Each takes IN1, IN2 and OUT1. */
+#if (USBD_CDC_FUNCTION == 1)
+	USBD_RegisterClass(&hUsbDeviceFS, &USBD_CDC);
+	USBD_CDC_RegisterInterface(&hUsbDeviceFS, &USBD_CDC_Interface_fops_FS);
+	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0x02, 0x02, 0x01);
+#elif (USBD_NET_CLASS == USBD_NET_CLASS_NCM)
+	USBD_RegisterClass(&hUsbDeviceFS, &USBD_NCM);
+	USBD_NCM_RegisterInterface(&hUsbDeviceFS, &USBD_NCM_Interface_fops_FS);
+	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0x02, 0x0D, 0x00);
+#else
 	USBD_RegisterClass(&hUsbDeviceFS, &USBD_RNDIS);
 	USBD_RNDIS_RegisterInterface(&hUsbDeviceFS, &USBD_RNDIS_Interface_fops_FS);
 	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0xE0, 0x01, 0x03);
+#endif
+
+	/* Registered after the first function, task-context code of which reads
+	the class context from hUsbDeviceFS. It takes IN3 and OUT2. */
+#if (USBD_VENDOR_FUNCTION == 1)
+	USBD_RegisterClass(&hUsbDeviceFS, &USBD_VENDOR);
+	USBD_VENDOR_RegisterInterface(&hUsbDeviceFS, &USBD_VENDOR_Interface_fops_FS);
+	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0xFF, 0x00, 0x00);
+	USBD_COMPOSITE_RegisterDeviceRequest(&hUsbDeviceFS, USBD_VENDOR_DeviceRequest);
+#endif
+
+	/* Same endpoints as the vendor function, the media task is created
+	before the bus can configure the device */
+#if (USBD_MSC_FUNCTION == 1)
+	MSC_Start_FS();
+	USBD_RegisterClass(&hUsbDeviceFS, &USBD_MSC);
+	USBD_MSC_RegisterInterface(&hUsbDeviceFS, &USBD_MSC_Interface_fops_FS);
+	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0x08, 0x06, 0x50);
+#endif
+
+	/* Same endpoints again, isochronous OUT and its feedback IN */
+#if (USBD_AUDIO_FUNCTION == 1)
+	USBD_RegisterClass(&hUsbDeviceFS, &USBD_AUDIO);
+	USBD_AUDIO_RegisterInterface(&hUsbDeviceFS, &USBD_AUDIO_Interface_fops_FS);
+	USBD_COMPOSITE_RegisterClass(&hUsbDeviceFS, 0x01, 0x00, 0x00);
+#endif
 
-	USBD_Start(&hUsbDeviceFS);
+	/* Fails when the endpoints of the registered classes exceed the FIFO RAM */
+	if(USBD_Start(&hUsbDeviceFS) != USBD_OK){
+		_Error_Handler(__FILE__, __LINE__);
+	}
 
 }
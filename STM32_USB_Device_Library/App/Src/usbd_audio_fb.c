@@ -0,0 +1,155 @@
+/**
+  ******************************************************************************
+  * @file    usbd_audio_fb.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Feedback of an asynchronous audio sink: the number of samples
+  *          per frame the host is to send, so that the sink neither runs
+  *          dry nor overflows although its clock is not the bus clock.
+  *           - The rate is the sink clock, the samples it played, counted
+  *             over the last USBD_AUDIO_FB_HISTORY windows of frames. The
+  *             windows follow each other, so the error of one measurement
+  *             is not added to the next one.
+  *           - The level the sink has buffered, averaged over a window,
+  *             pulls the feedback toward the target level, which makes the
+  *             latency constant.
+  *          Called on every SOF. Free of FreeRTOS and HAL dependencies so
+  *          that Tools/audio_fb_bench builds on the host.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_audio_fb.h"
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_AUDIO_FB
+  * @brief Feedback of an asynchronous audio sink
+  * @{
+  */
+
+/** @defgroup USBD_AUDIO_FB_Exported_Functions
+  * @{
+  */
+/**
+  * @brief  Start over, the feedback is the nominal rate until the sink
+  *         clock moves
+  * @param  pFb: feedback state
+  * @param  freq: nominal sampling frequency, Hz
+  * @param  target: samples to keep buffered
+  * @param  window_log2: frames per window, log2
+  * @retval None
+  */
+void USBD_AUDIO_Fb_Init(USBD_AUDIO_FbTypeDef *pFb, uint32_t freq, uint32_t target, uint8_t window_log2)
+{
+  pFb->nominal = (uint32_t)(((uint64_t)freq << USBD_AUDIO_FB_FRAC) / 1000);
+  pFb->value = pFb->nominal;
+  pFb->rate = pFb->nominal;
+  pFb->target = target;
+  pFb->window = (uint16_t)(1U << window_log2);
+  pFb->frames = 0;
+  pFb->idle = 0;
+  pFb->running = 0;
+  pFb->windows = 0;
+  pFb->next = 0;
+  pFb->last_clock = 0;
+  pFb->level_sum = 0;
+}
+
+/**
+  * @brief  Account for one frame
+  * @param  pFb: feedback state
+  * @param  clock: samples played by the sink so far, wrapping
+  * @param  level: samples buffered for the sink
+  * @retval None
+  */
+void USBD_AUDIO_Fb_Frame(USBD_AUDIO_FbTypeDef *pFb, uint32_t clock, uint32_t level)
+{
+  uint32_t oldest;
+  uint32_t span;
+  int32_t correction;
+  int32_t value;
+
+  if (clock != pFb->last_clock)
+  {
+    pFb->idle = 0;
+    if (pFb->running == 0)
+    {
+      /* The first window starts with the sink */
+      pFb->running = 1;
+      pFb->windows = 1;
+      pFb->next = 0;
+      pFb->history[0] = clock;
+      pFb->frames = 0;
+      pFb->level_sum = 0;
+    }
+  }
+  else if ((pFb->running != 0) && (++pFb->idle >= pFb->window))
+  {
+    /* Stopped, back to the nominal rate */
+    pFb->running = 0;
+    pFb->rate = pFb->nominal;
+    pFb->value = pFb->nominal;
+  }
+  pFb->last_clock = clock;
+
+  if (pFb->running == 0)
+  {
+    return;
+  }
+
+  pFb->level_sum += level;
+  if (++pFb->frames < pFb->window)
+  {
+    return;
+  }
+
+  /* Samples played since the oldest window started. Over fewer windows
+  the bursts of the sink weigh too much, the level alone steers. */
+  if (pFb->windows < USBD_AUDIO_FB_HISTORY)
+  {
+    pFb->history[pFb->windows++] = clock;
+  }
+  else
+  {
+    oldest = pFb->history[pFb->next];
+    span = USBD_AUDIO_FB_HISTORY * pFb->window;
+    pFb->history[pFb->next] = clock;
+    pFb->next = (pFb->next + 1) % USBD_AUDIO_FB_HISTORY;
+    pFb->rate = (uint32_t)(((uint64_t)(clock - oldest) << USBD_AUDIO_FB_FRAC) / span);
+  }
+
+  correction = ((int32_t)pFb->target - (int32_t)(pFb->level_sum / pFb->window)) *
+               (1 << (USBD_AUDIO_FB_FRAC - USBD_AUDIO_FB_LEVEL_SHIFT));
+  pFb->frames = 0;
+  pFb->level_sum = 0;
+
+  /* One sample per frame more or less than nominal, as the packets allow */
+  value = (int32_t)pFb->rate + correction;
+  if (value > (int32_t)(pFb->nominal + (1U << USBD_AUDIO_FB_FRAC)))
+  {
+    value = (int32_t)(pFb->nominal + (1U << USBD_AUDIO_FB_FRAC));
+  }
+  else if (value < (int32_t)(pFb->nominal - (1U << USBD_AUDIO_FB_FRAC)))
+  {
+    value = (int32_t)(pFb->nominal - (1U << USBD_AUDIO_FB_FRAC));
+  }
+  pFb->value = (uint32_t)value;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
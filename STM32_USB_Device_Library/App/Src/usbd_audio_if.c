@@ -0,0 +1,220 @@
+/**
+ ******************************************************************************
+ * @file    usbd_audio_if.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   Speaker of the audio function. The class fills a byte ring with
+ *          16 bit stereo PCM from the host, the playback empties it at the
+ *          speaker clock with AUDIO_Read_FS, for instance from the I2S DMA
+ *          half and full transfer interrupts:
+ *           - Playback starts once the ring holds AUDIO_LATENCY_SAMPLES,
+ *             silence is played until then.
+ *           - Every sample played, silence included, counts on the clock
+ *             the feedback to the host follows: the ring stays around
+ *             AUDIO_LATENCY_SAMPLES and the latency with it.
+ *           - If the ring still runs dry the missing samples are silence
+ *             and playback waits for AUDIO_LATENCY_SAMPLES again.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_audio_if.h"
+
+#if (USBD_AUDIO_FUNCTION == 1)
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup USBD_AUDIO_IF
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_AUDIO_IF_Private_Variables
+ * @{
+ */
+static uint8_t ucRingBuffer[AUDIO_RING_SIZE];
+
+static USBD_RingTypeDef xRing = { ucRingBuffer, AUDIO_RING_SIZE, 0, 0, AUDIO_RING_SIZE, 0 };
+
+/* Samples played, read by the class at every SOF */
+static volatile uint32_t ulClock=0;
+static volatile uint8_t ucStreaming=0;
+static volatile uint8_t ucMute=0;
+/* Playing from the ring, cleared to prime it again */
+static volatile uint8_t ucPrimed=0;
+
+static AUDIO_StatsTypeDef audio_stats;
+/**
+ * @}
+ */
+
+/** @defgroup USBD_AUDIO_IF_Private_FunctionPrototypes
+ * @{
+ */
+static int8_t AUDIO_Init_FS      (uint32_t AudioFreq);
+static int8_t AUDIO_DeInit_FS    (void);
+static int8_t AUDIO_Streaming_FS (uint8_t Active);
+static int8_t AUDIO_MuteCtl_FS   (uint8_t Mute);
+static uint32_t AUDIO_GetClock_FS(void);
+/**
+ * @}
+ */
+
+USBD_AUDIO_ItfTypeDef USBD_AUDIO_Interface_fops_FS =
+{
+	AUDIO_Init_FS,
+	AUDIO_DeInit_FS,
+	AUDIO_Streaming_FS,
+	AUDIO_MuteCtl_FS,
+	AUDIO_GetClock_FS,
+	&xRing,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  AUDIO_Init_FS
+ *         Configured, not streaming yet
+ * @param  AudioFreq: sampling frequency, USBD_AUDIO_FREQ
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t AUDIO_Init_FS(uint32_t AudioFreq)
+{
+	ucStreaming=0;
+	ucMute=0;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  AUDIO_DeInit_FS
+ *         Unconfigured, what is left in the ring is played out
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t AUDIO_DeInit_FS(void)
+{
+	ucStreaming=0;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  AUDIO_Streaming_FS
+ *         The host opened or closed the stream. Called from the USB
+ *         interrupt.
+ * @param  Active: 1 once the host streams
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t AUDIO_Streaming_FS(uint8_t Active)
+{
+	ucStreaming=Active;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  AUDIO_MuteCtl_FS
+ *         Mute set by the host, the samples are still consumed
+ * @param  Mute: 1 to mute
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t AUDIO_MuteCtl_FS(uint8_t Mute)
+{
+	ucMute=Mute;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  AUDIO_GetClock_FS
+ *         Sink clock of the feedback. Called from the USB interrupt.
+ * @param  None
+ * @retval samples played so far, wrapping
+ */
+static uint32_t AUDIO_GetClock_FS(void)
+{
+	return ulClock;
+}
+
+/**
+ * @brief  AUDIO_Read_FS
+ *         Samples to play, always Len bytes of them. Called at the speaker
+ *         clock, from the playback interrupt or task.
+ * @param  Buf: destination
+ * @param  Len: bytes, a multiple of AUDIO_SAMPLE_BYTES
+ * @retval None
+ */
+void AUDIO_Read_FS(uint8_t* Buf, uint32_t Len)
+{
+	uint32_t copied=0;
+	uint32_t avail;
+	uint8_t *p;
+
+	if((ucPrimed==0) && (USBD_Ring_Count(&xRing)>=AUDIO_LATENCY_SAMPLES*AUDIO_SAMPLE_BYTES)){
+		ucPrimed=1;
+	}
+
+	if(ucPrimed!=0){
+		while(copied<Len){
+			p=USBD_Ring_Peek(&xRing, 0, &avail);
+			if(p==NULL){
+				break;
+			}
+			if(avail>Len-copied){
+				avail=Len-copied;
+			}
+			if(ucMute!=0){
+				USBD_memset(Buf+copied, 0, avail);
+			} else {
+				USBD_memcpy(Buf+copied, p, avail);
+			}
+			USBD_Ring_Release(&xRing, avail);
+			copied+=avail;
+		}
+		if(copied<Len){
+			ucPrimed=0;
+			audio_stats.Underruns++;
+		}
+	}
+
+	if(copied<Len){
+		USBD_memset(Buf+copied, 0, Len-copied);
+		audio_stats.Silence+=(Len-copied)/AUDIO_SAMPLE_BYTES;
+	}
+	audio_stats.Played+=copied/AUDIO_SAMPLE_BYTES;
+	ulClock+=Len/AUDIO_SAMPLE_BYTES;
+}
+
+/**
+ * @brief  AUDIO_IsStreaming_FS
+ *         Whether the host has the stream open, the playback may stop
+ *         while it has not and the ring is empty
+ * @param  None
+ * @retval 1 while streaming
+ */
+uint8_t AUDIO_IsStreaming_FS(void)
+{
+	return ucStreaming;
+}
+
+/**
+ * @brief  AUDIO_GetStats
+ *         Copy the playback counters
+ * @param  pStats: destination
+ * @retval None
+ */
+void AUDIO_GetStats(AUDIO_StatsTypeDef *pStats)
+{
+	*pStats=audio_stats;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif /* USBD_AUDIO_FUNCTION */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,362 @@
+/**
+ ******************************************************************************
+ * @file    usbd_cdc_if.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   Serial port of the CDC-ACM function. The application streams
+ *          through two byte rings the class keeps its endpoints armed from:
+ *           - Transmit: reserve space, write in place and commit, or copy
+ *             with CDC_Transmit_FS. Neither waits, what does not fit is
+ *             refused and counted.
+ *           - Receive: peek at the data, use it in place and release it, or
+ *             copy with CDC_Receive_FS. The host is held off while the ring
+ *             is full, no byte is lost.
+ *          Each ring has one producer and one consumer, the class being the
+ *          other side: one task transmits and one task receives.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_cdc_if.h"
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if (USBD_CDC_FUNCTION == 1)
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup USBD_CDC_IF
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_CDC_IF_Private_Variables
+ * @{
+ */
+static uint8_t ucTxBuffer[CDC_TX_RING_SIZE];
+static uint8_t ucRxBuffer[CDC_RX_RING_SIZE];
+
+static USBD_RingTypeDef xTxRing = { ucTxBuffer, CDC_TX_RING_SIZE, 0, 0, CDC_TX_RING_SIZE, 0 };
+static USBD_RingTypeDef xRxRing = { ucRxBuffer, CDC_RX_RING_SIZE, 0, 0, CDC_RX_RING_SIZE, 0 };
+
+static USBD_CDC_LineCodingTypeDef xLineCoding = { 115200, 0x00, 0x00, 0x08 };
+static volatile uint16_t usLineState=0;
+
+/* Task in CDC_WaitReceive_FS, notified by the next data */
+static TaskHandle_t volatile xRxTaskHandle=NULL;
+
+static CDC_StatsTypeDef cdc_stats;
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CDC_IF_Exported_Variables
+ * @{
+ */
+extern USBD_HandleTypeDef hUsbDeviceFS;
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CDC_IF_Private_FunctionPrototypes
+ * @{
+ */
+static int8_t CDC_Init_FS     (void);
+static int8_t CDC_DeInit_FS   (void);
+static int8_t CDC_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length);
+static int8_t CDC_Received_FS (uint32_t Len);
+/**
+ * @}
+ */
+
+USBD_CDC_ItfTypeDef USBD_CDC_Interface_fops_FS =
+{
+	CDC_Init_FS,
+	CDC_DeInit_FS,
+	CDC_Control_FS,
+	CDC_Received_FS,
+	&xTxRing,
+	&xRxRing,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  CDC_Init_FS
+ *         Configured, the class starts on the rings right after
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t CDC_Init_FS(void)
+{
+	usLineState=0;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  CDC_DeInit_FS
+ *         Unconfigured, the data left in the rings is kept
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t CDC_DeInit_FS(void)
+{
+	usLineState=0;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  CDC_Control_FS
+ *         Class requests to the serial port
+ * @param  cmd: request code
+ * @param  pbuf: its data, or the request itself without data stage
+ * @param  length: data length
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
+{
+	switch(cmd){
+	case CDC_SET_LINE_CODING:
+		if(length>=7){
+			xLineCoding.bitrate=(uint32_t)(pbuf[0] | (pbuf[1] << 8) | (pbuf[2] << 16) | (pbuf[3] << 24));
+			xLineCoding.format=pbuf[4];
+			xLineCoding.paritytype=pbuf[5];
+			xLineCoding.datatype=pbuf[6];
+		}
+		break;
+
+	case CDC_GET_LINE_CODING:
+		if(length>=7){
+			pbuf[0]=(uint8_t)(xLineCoding.bitrate);
+			pbuf[1]=(uint8_t)(xLineCoding.bitrate >> 8);
+			pbuf[2]=(uint8_t)(xLineCoding.bitrate >> 16);
+			pbuf[3]=(uint8_t)(xLineCoding.bitrate >> 24);
+			pbuf[4]=xLineCoding.format;
+			pbuf[5]=xLineCoding.paritytype;
+			pbuf[6]=xLineCoding.datatype;
+		}
+		break;
+
+	case CDC_SET_CONTROL_LINE_STATE:
+		usLineState=((USBD_SetupReqTypedef *)pbuf)->wValue;
+		break;
+
+	default:
+		break;
+	}
+	return (USBD_OK);
+}
+
+/**
+ * @brief  CDC_Received_FS
+ *         Data committed to the receive ring, wakes the waiting task.
+ *         Called from the USB interrupt.
+ * @param  Len: Number of data received (in bytes)
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t CDC_Received_FS(uint32_t Len)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	TaskHandle_t xTask = xRxTaskHandle;
+
+	cdc_stats.RxBytes+=Len;
+
+	if(xTask != NULL){
+		if(__get_IPSR() != 0){
+			vTaskNotifyGiveFromISR(xTask, &xHigherPriorityTaskWoken);
+			portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+		} else {
+			xTaskNotifyGive(xTask);
+		}
+	}
+	return (USBD_OK);
+}
+
+/**
+ * @brief  CDC_TxReserve_FS
+ *         Contiguous free space of the transmit ring, to write in place
+ * @param  Len: free bytes from the returned pointer
+ * @retval space, NULL while the ring is full
+ */
+uint8_t *CDC_TxReserve_FS(uint32_t *Len)
+{
+	return USBD_Ring_Reserve(&xTxRing, 1, Len);
+}
+
+/**
+ * @brief  CDC_TxCommit_FS
+ *         Send the start of the reserved space, queued at once if the IN
+ *         endpoint can take more
+ * @param  Len: bytes written, up to those reserved
+ * @retval None
+ */
+void CDC_TxCommit_FS(uint32_t Len)
+{
+	USBD_Ring_Commit(&xTxRing, Len);
+	cdc_stats.TxBytes+=Len;
+	USBD_CDC_TransmitPacket(&hUsbDeviceFS);
+}
+
+/**
+ * @brief  CDC_Transmit_FS
+ *         Copy data to the transmit ring, without waiting
+ * @param  Buf: Buffer of data to be sent
+ * @param  Len: Number of data to be sent (in bytes)
+ * @retval bytes taken, the rest is refused while the ring is full
+ */
+uint32_t CDC_Transmit_FS(const uint8_t* Buf, uint32_t Len)
+{
+	uint32_t taken=0;
+	uint32_t space;
+	uint8_t *p;
+
+	/* Up to the end of the buffer, then from its start */
+	while(taken<Len){
+		p=USBD_Ring_Reserve(&xTxRing, 1, &space);
+		if(p==NULL){
+			break;
+		}
+		if(space>Len-taken){
+			space=Len-taken;
+		}
+		USBD_memcpy(p, Buf+taken, space);
+		USBD_Ring_Commit(&xTxRing, space);
+		taken+=space;
+	}
+	cdc_stats.TxBytes+=taken;
+	cdc_stats.TxRefused+=Len-taken;
+
+	if(taken!=0){
+		USBD_CDC_TransmitPacket(&hUsbDeviceFS);
+	}
+	return taken;
+}
+
+/**
+ * @brief  CDC_RxPeek_FS
+ *         Contiguous data of the receive ring, to use in place
+ * @param  Len: bytes from the returned pointer
+ * @retval data, NULL while the ring is empty
+ */
+uint8_t *CDC_RxPeek_FS(uint32_t *Len)
+{
+	return USBD_Ring_Peek(&xRxRing, 0, Len);
+}
+
+/**
+ * @brief  CDC_RxRelease_FS
+ *         Done with the oldest data, the OUT endpoint is armed again if it
+ *         was held off
+ * @param  Len: bytes, up to those peeked
+ * @retval None
+ */
+void CDC_RxRelease_FS(uint32_t Len)
+{
+	USBD_Ring_Release(&xRxRing, Len);
+	USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+}
+
+/**
+ * @brief  CDC_Receive_FS
+ *         Copy data out of the receive ring, without waiting
+ * @param  Buf: destination
+ * @param  Len: room in Buf (in bytes)
+ * @retval bytes copied
+ */
+uint32_t CDC_Receive_FS(uint8_t* Buf, uint32_t Len)
+{
+	uint32_t copied=0;
+	uint32_t avail;
+	uint8_t *p;
+
+	while(copied<Len){
+		p=USBD_Ring_Peek(&xRxRing, 0, &avail);
+		if(p==NULL){
+			break;
+		}
+		if(avail>Len-copied){
+			avail=Len-copied;
+		}
+		USBD_memcpy(Buf+copied, p, avail);
+		USBD_Ring_Release(&xRxRing, avail);
+		copied+=avail;
+	}
+
+	if(copied!=0){
+		USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+	}
+	return copied;
+}
+
+/**
+ * @brief  CDC_WaitReceive_FS
+ *         Block the calling task until the receive ring holds data. Uses
+ *         the task notification of the caller.
+ * @param  TimeoutMs: longest wait, portMAX_DELAY for none
+ * @retval bytes in the receive ring, 0 on timeout
+ */
+uint32_t CDC_WaitReceive_FS(uint32_t TimeoutMs)
+{
+	uint32_t count=USBD_Ring_Count(&xRxRing);
+
+	if(count==0){
+		xRxTaskHandle=xTaskGetCurrentTaskHandle();
+		/* Data committed before the handle was seen wakes nobody */
+		count=USBD_Ring_Count(&xRxRing);
+		if(count==0){
+			ulTaskNotifyTake(pdTRUE, (TimeoutMs==portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(TimeoutMs));
+			count=USBD_Ring_Count(&xRxRing);
+		}
+		xRxTaskHandle=NULL;
+	}
+	return count;
+}
+
+/**
+ * @brief  CDC_GetLineState_FS
+ *         Control line state set by the host
+ * @param  None
+ * @retval CDC_CONTROL_LINE_DTR and CDC_CONTROL_LINE_RTS bits, DTR set while
+ *         a terminal has the port open
+ */
+uint16_t CDC_GetLineState_FS(void)
+{
+	return usLineState;
+}
+
+/**
+ * @brief  CDC_GetLineCoding_FS
+ *         Line coding set by the host, not applied to anything
+ * @param  pLineCoding: destination
+ * @retval None
+ */
+void CDC_GetLineCoding_FS(USBD_CDC_LineCodingTypeDef *pLineCoding)
+{
+	*pLineCoding=xLineCoding;
+}
+
+/**
+ * @brief  CDC_GetStats
+ *         Copy the stream counters
+ * @param  pStats: destination
+ * @retval None
+ */
+void CDC_GetStats(CDC_StatsTypeDef *pStats)
+{
+	*pStats=cdc_stats;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif /* USBD_CDC_FUNCTION */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -48,10 +48,34 @@
 */
 /* Includes ------------------------------------------------------------------*/
 #include "../../Class/Composite/inc/usbd_composite.h"
+#if (USBD_CDC_FUNCTION == 1)
+#include "../../Class/CDC/inc/usbd_cdc.h"
+#elif (USBD_NET_CLASS == USBD_NET_CLASS_NCM)
+#include "../../Class/NCM/inc/usbd_ncm.h"
+#else
+#include "../../Class/RNDIS/inc/usbd_rndis.h"
+#endif
+#if (USBD_VENDOR_FUNCTION == 1)
+#include "../../Class/Vendor/inc/usbd_vendor.h"
+#endif
+#if (USBD_MSC_FUNCTION == 1)
+#include "../../Class/MSC/inc/usbd_msc.h"
+#endif
+#if (USBD_AUDIO_FUNCTION == 1)
+#include "../../Class/AUDIO/inc/usbd_audio.h"
+#endif
 #include "stm32f4xx.h"
 #include "stm32f4xx_hal.h"
 #include "usbd_def.h"
 #include "usbd_core.h"
+#include "usbd_ll_ex.h"
+#include "usbd_prof.h"
+#include "usbd_trace.h"
+#if (USBD_DEFERRED_EVENTS == 1)
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#endif
 
 PCD_HandleTypeDef hpcd_USB_OTG_FS;
 void _Error_Handler(char * file, int line);
@@ -62,7 +86,142 @@ void SystemClock_Config(void);
 /* USER CODE BEGIN 0 */
 /* USER CODE END 0 */
 
+/* Private define ------------------------------------------------------------*/
+/* Data FIFO RAM of the OTG cores, in 32-bit words (1.25 Kbytes FS, 4 Kbytes HS) */
+#define USBD_FS_FIFO_WORDS              320
+#define USBD_HS_FIFO_WORDS              1024
+/* Smallest TX FIFO depth accepted by the core, in 32-bit words */
+#define USBD_TX_FIFO_MIN_WORDS          16
+
+/* Core register blocks, independent of the USBx_xxx macros of the LL driver */
+#define USBD_LL_DEVICE(hpcd)            ((USB_OTG_DeviceTypeDef *)((uint32_t)(hpcd)->Instance + USB_OTG_DEVICE_BASE))
+#define USBD_LL_INEP(hpcd, ep)          ((USB_OTG_INEndpointTypeDef *)((uint32_t)(hpcd)->Instance + USB_OTG_IN_ENDPOINT_BASE + (ep) * USB_OTG_EP_REG_SIZE))
+#define USBD_LL_OUTEP(hpcd, ep)         ((USB_OTG_OUTEndpointTypeDef *)((uint32_t)(hpcd)->Instance + USB_OTG_OUT_ENDPOINT_BASE + (ep) * USB_OTG_EP_REG_SIZE))
+#define USBD_LL_DFIFO(hpcd, ep)         (*(__IO uint32_t *)((uint32_t)(hpcd)->Instance + USB_OTG_FIFO_BASE + (ep) * USB_OTG_FIFO_SIZE))
+#define USBD_LL_IRQn(hpcd)              (((hpcd)->Instance == USB_OTG_FS) ? OTG_FS_IRQn : OTG_HS_IRQn)
+/* Wait for the core to acknowledge an endpoint NAK or disable, in microseconds,
+and in polls of about 8 cycles each */
+#define USBD_LL_EP_DISABLE_TIMEOUT_US   5U
+#define USBD_LL_EP_DISABLE_POLLS        (SystemCoreClock / 1000000U * USBD_LL_EP_DISABLE_TIMEOUT_US / 8U)
+
+#if (USBD_DEFERRED_EVENTS == 1)
+/* Events one pass of the USB interrupt can raise: the bus and EP0 events, a
+completion on every other endpoint and an SOF */
+#define USBD_EVENT_HELD_LENGTH          (USBD_EVENT_CONTROL_EVENTS + 2 * (USBD_LLEX_MAX_EP - 1) + 1)
+
+/* Default the event task to the highest priority, with twice the idle task
+stack, but allow FreeRTOSConfig.h to override them */
+#ifndef configUSBD_EVENT_TASK_STACK_SIZE
+#define configUSBD_EVENT_TASK_STACK_SIZE  ( 2 * configMINIMAL_STACK_SIZE )
+#endif
+#ifndef configUSBD_EVENT_TASK_PRIORITY
+#define configUSBD_EVENT_TASK_PRIORITY    ( configMAX_PRIORITIES - 1 )
+#endif
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/* Class handles served by USBD_static_malloc, one member per enabled class
+so the blocks are no larger than the biggest handle actually allocated */
+typedef union
+{
+#if (USBD_CDC_FUNCTION == 1)
+  USBD_CDC_HandleTypeDef cdc;
+#elif (USBD_NET_CLASS == USBD_NET_CLASS_NCM)
+  USBD_NCM_HandleTypeDef ncm;
+#else
+  USBD_RNDIS_HandleTypeDef rndis;
+#endif
+#if (USBD_VENDOR_FUNCTION == 1)
+  USBD_VENDOR_HandleTypeDef vendor;
+#endif
+#if (USBD_MSC_FUNCTION == 1)
+  USBD_MSC_BOT_HandleTypeDef msc;
+#endif
+#if (USBD_AUDIO_FUNCTION == 1)
+  USBD_AUDIO_HandleTypeDef audio;
+#endif
+} USBD_StaticBlockTypeDef;
+
+typedef enum
+{
+  USBD_LL_EVENT_SETUP = 0,
+  USBD_LL_EVENT_DATA_OUT,
+  USBD_LL_EVENT_DATA_IN,
+  USBD_LL_EVENT_SOF,
+  USBD_LL_EVENT_RESET,
+  USBD_LL_EVENT_SUSPEND,
+  USBD_LL_EVENT_RESUME,
+  USBD_LL_EVENT_ISO_OUT_INCOMPLETE,
+  USBD_LL_EVENT_ISO_IN_INCOMPLETE,
+  USBD_LL_EVENT_CONNECT,
+  USBD_LL_EVENT_DISCONNECT,
+} USBD_LL_EventIdTypeDef;
+
+/* PCD event, as captured in the interrupt */
+typedef struct
+{
+  uint8_t  type;                          /* USBD_LL_EventIdTypeDef */
+  uint8_t  epnum;                         /* Endpoint number, data and ISO events */
+  uint32_t param;                         /* Transferred length, or speed on reset */
+  uint8_t  setup[8];                      /* SETUP packet */
+} USBD_LL_EventTypeDef;
+
+typedef struct
+{
+  USBD_LLEx_XferTypeDef xfer[USBD_LLEX_QUEUE_DEPTH];
+  uint8_t hw_addr;
+  uint8_t head;
+  uint8_t count;
+  uint8_t high_water;                     /* Statistics, kept across resets */
+  uint32_t submitted;
+  uint32_t busy;
+} USBD_LLEx_QueueTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static USBD_LLEx_QueueTypeDef USBD_LLEx_InQueue[USBD_LLEX_MAX_EP];
+static USBD_LLEx_QueueTypeDef USBD_LLEx_OutQueue[USBD_LLEX_MAX_EP];
+/* Class handle pool: blocks of USBD_StaticBlockTypeDef and a stack of the
+free block indexes */
+static uint32_t USBD_StaticPool[USBD_STATIC_POOL_BLOCKS][(sizeof(USBD_StaticBlockTypeDef) + 3) / 4];
+static uint8_t USBD_StaticFree[USBD_STATIC_POOL_BLOCKS];
+static uint8_t USBD_StaticFreeCount = 0;
+static uint8_t USBD_StaticInit = 0;
+static uint8_t USBD_StaticHighWater = 0;
+#if (USBD_DEBUG_LEVEL > 0)
+/* Allocated blocks, to catch double frees */
+static uint8_t USBD_StaticInUse[USBD_STATIC_POOL_BLOCKS];
+#endif
+/* Set once USBD_LLEx_IRQHandler runs, gather transfers depend on it */
+static __IO uint8_t USBD_LLEx_GatherReady = 0;
+#if (USBD_DEFERRED_EVENTS == 1)
+static QueueHandle_t USBD_LL_EventQueue = NULL;
+static __IO uint8_t USBD_LL_SofPending = 0;
+static __IO uint32_t USBD_LL_EventsLost = 0;
+/* Events that found the queue full, in order. The interrupt is masked in the
+core meanwhile, until the task has handled the queue and them. */
+static USBD_LL_EventTypeDef USBD_LL_EventHeld[USBD_EVENT_HELD_LENGTH];
+static __IO uint8_t USBD_LL_EventsHeld = 0;
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
+static USBD_StatusTypeDef USBD_LL_ConfigureFifo(PCD_HandleTypeDef *hpcd);
+static void USBD_LL_HandleEvent(PCD_HandleTypeDef *hpcd, USBD_LL_EventTypeDef *event);
+static void USBD_LL_PostEvent(PCD_HandleTypeDef *hpcd, USBD_LL_EventTypeDef *event);
+#if (USBD_DEFERRED_EVENTS == 1)
+static void USBD_LL_EventTask(void *pvParameters);
+#endif
+static USBD_LLEx_QueueTypeDef *USBD_LLEx_GetQueue(uint8_t hw_addr);
+static USBD_StatusTypeDef USBD_LLEx_Submit(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint32_t size,
+                                           const USBD_LLEx_SegmentTypeDef *pSegment, uint8_t nsegment,
+                                           USBD_LLEx_CpltCallbackTypeDef pCplt, void *pContext);
+static uint8_t USBD_LLEx_WriteGather(PCD_HandleTypeDef *hpcd, uint8_t epnum, USBD_LLEx_XferTypeDef *xfer);
+static void USBD_LLEx_StartHead(PCD_HandleTypeDef *hpcd, USBD_LLEx_QueueTypeDef *queue);
+static void USBD_LLEx_Notify(USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+static uint8_t USBD_LLEx_Complete(PCD_HandleTypeDef *hpcd, uint8_t hw_addr, uint32_t actual);
+static void USBD_LLEx_Flush(USBD_HandleTypeDef *pdev, uint8_t hw_addr);
+static USBD_StatusTypeDef USBD_LL_DisableInEP(PCD_HandleTypeDef *hpcd, uint8_t epnum);
+static USBD_StatusTypeDef USBD_LL_DisableOutEP(PCD_HandleTypeDef *hpcd, uint8_t epnum);
+static void USBD_LL_PopRxFifo(PCD_HandleTypeDef *hpcd, uint8_t drop_epnum);
 /* Private functions ---------------------------------------------------------*/
 /* USER CODE BEGIN 1 */
 /* USER CODE END 1 */
@@ -138,6 +297,263 @@ void HAL_PCD_MspDeInit(PCD_HandleTypeDef* pcdHandle)
   }
 }
 
+/**
+  * @brief  Runs the USB Device Library for an event reported by the PCD
+  *         driver, in the USB interrupt or in the event task when
+  *         USBD_DEFERRED_EVENTS is enabled.
+  * @param  hpcd: PCD handle
+  * @param  event: Event record
+  * @retval None
+  */
+static void USBD_LL_HandleEvent(PCD_HandleTypeDef *hpcd, USBD_LL_EventTypeDef *event)
+{
+  USBD_HandleTypeDef *pdev = (USBD_HandleTypeDef*)hpcd->pData;
+  uint8_t epnum;
+  USBD_PROF_START(cycles);
+
+  switch (event->type)
+  {
+  case USBD_LL_EVENT_SETUP:
+    /* Vendor requests to the device and the BOS descriptor go to the class
+    handlers first, USBD_LL_SetupStage would reject the former */
+    if (USBD_COMPOSITE_DeviceRequest(pdev, event->setup) != USBD_OK)
+    {
+      USBD_LL_SetupStage(pdev, event->setup);
+    }
+    break;
+
+  case USBD_LL_EVENT_DATA_OUT:
+    if (USBD_LLEx_Complete(hpcd, event->epnum, event->param) != USBD_OK)
+    {
+      USBD_LL_DataOutStage(pdev, event->epnum, hpcd->OUT_ep[event->epnum].xfer_buff);
+    }
+    break;
+
+  case USBD_LL_EVENT_DATA_IN:
+    if (USBD_LLEx_Complete(hpcd, event->epnum | 0x80, event->param) != USBD_OK)
+    {
+      USBD_LL_DataInStage(pdev, event->epnum, hpcd->IN_ep[event->epnum].xfer_buff);
+    }
+    break;
+
+  case USBD_LL_EVENT_SOF:
+#if (USBD_DEFERRED_EVENTS == 1)
+    USBD_LL_SofPending = 0;
+#endif
+    USBD_LL_SOF(pdev);
+    break;
+
+  case USBD_LL_EVENT_RESET:
+    USBD_LL_SetSpeed(pdev, (USBD_SpeedTypeDef)event->param);
+
+    /* Give back the queued transfers, the core flushed the endpoints */
+    for (epnum = 1; epnum < USBD_LLEX_MAX_EP; epnum++)
+    {
+      USBD_LLEx_Flush(pdev, epnum | 0x80);
+      USBD_LLEx_Flush(pdev, epnum);
+    }
+
+    /*Reset Device*/
+    USBD_LL_Reset(pdev);
+    break;
+
+  case USBD_LL_EVENT_SUSPEND:
+    USBD_LL_Suspend(pdev);
+    break;
+
+  case USBD_LL_EVENT_RESUME:
+    USBD_LL_Resume(pdev);
+    break;
+
+  case USBD_LL_EVENT_ISO_OUT_INCOMPLETE:
+    USBD_LL_IsoOUTIncomplete(pdev, event->epnum);
+    break;
+
+  case USBD_LL_EVENT_ISO_IN_INCOMPLETE:
+    USBD_LL_IsoINIncomplete(pdev, event->epnum);
+    break;
+
+  case USBD_LL_EVENT_CONNECT:
+    USBD_LL_DevConnected(pdev);
+    break;
+
+  case USBD_LL_EVENT_DISCONNECT:
+    USBD_LL_DevDisconnected(pdev);
+    break;
+
+  default:
+    break;
+  }
+
+  USBD_PROF_STOP((USBD_Prof_IdTypeDef)(USBD_PROF_LL_SETUP + event->type), cycles);
+}
+
+/**
+  * @brief  Hands a PCD event to the USB Device Library: straight away, or
+  *         through the event queue when USBD_DEFERRED_EVENTS is enabled. An
+  *         event is never dropped: when the queue is full, it and the rest
+  *         of the interrupt pass are held and the USB interrupt is masked in
+  *         the core until the event task catches up. Only SOFs are
+  *         coalesced.
+  * @param  hpcd: PCD handle
+  * @param  event: Event record, copied
+  * @retval None
+  */
+static void USBD_LL_PostEvent(PCD_HandleTypeDef *hpcd, USBD_LL_EventTypeDef *event)
+{
+#if (USBD_DEFERRED_EVENTS == 1)
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+#endif
+
+#if (USBD_TRACE == 1)
+  switch (event->type)
+  {
+  case USBD_LL_EVENT_SETUP:
+    USBD_TRACE_EVENT(USBD_TRACE_SETUP, 0,
+                     event->setup[0] | (event->setup[1] << 8) | (event->setup[2] << 16) | ((uint32_t)event->setup[3] << 24),
+                     event->setup[4] | (event->setup[5] << 8) | (event->setup[6] << 16) | ((uint32_t)event->setup[7] << 24));
+    break;
+  case USBD_LL_EVENT_DATA_OUT:
+    USBD_TRACE_EVENT(USBD_TRACE_EP_COMPLETE, event->epnum, event->param, 0);
+    break;
+  case USBD_LL_EVENT_DATA_IN:
+    USBD_TRACE_EVENT(USBD_TRACE_EP_COMPLETE, event->epnum | 0x80, event->param, 0);
+    break;
+  case USBD_LL_EVENT_SOF:
+    break;
+  default:
+    USBD_TRACE_EVENT(USBD_TRACE_BUS, event->epnum, event->type, event->param);
+    break;
+  }
+#endif
+
+#if (USBD_DEFERRED_EVENTS == 1)
+  if (event->type == USBD_LL_EVENT_SOF)
+  {
+    /* Frames are only counted, one pending SOF is enough */
+    if (USBD_LL_SofPending != 0)
+    {
+      return;
+    }
+    USBD_LL_SofPending = 1;
+  }
+
+  /* Once one is held the following ones are too, they are handled in order */
+  if ((USBD_LL_EventsHeld == 0) &&
+      (xQueueSendFromISR(USBD_LL_EventQueue, event, &xHigherPriorityTaskWoken) == pdTRUE))
+  {
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    return;
+  }
+
+  if (USBD_LL_EventsHeld == 0)
+  {
+    /* The pass in progress still completes, no new one starts */
+    hpcd->Instance->GAHBCFG &= ~USB_OTG_GAHBCFG_GINT;
+    USBD_LL_EventsLost++;
+    USBD_TRACE_EVENT(USBD_TRACE_EVENT_LOST, event->epnum, event->type, 0);
+  }
+  if (USBD_LL_EventsHeld < USBD_EVENT_HELD_LENGTH)
+  {
+    USBD_LL_EventHeld[USBD_LL_EventsHeld++] = *event;
+  }
+#else
+  USBD_LL_HandleEvent(hpcd, event);
+#endif
+}
+
+#if (USBD_DEFERRED_EVENTS == 1)
+/**
+  * @brief  Event task: runs the USB Device Library for the events queued by
+  *         the USB interrupt, in order, then for the events it held while
+  *         the queue was full, and unmasks the interrupt again.
+  * @param  pvParameters: PCD handle
+  * @retval None
+  */
+static void USBD_LL_EventTask(void *pvParameters)
+{
+  PCD_HandleTypeDef *hpcd = (PCD_HandleTypeDef*)pvParameters;
+  USBD_LL_EventTypeDef event;
+  uint8_t i;
+
+  for (;;)
+  {
+    /* Events are only held while the queue is full, so that a held event
+    always finds the queue to receive from first */
+    if (xQueueReceive(USBD_LL_EventQueue, &event, (USBD_LL_EventsHeld != 0) ? 0 : portMAX_DELAY) == pdTRUE)
+    {
+      USBD_LL_HandleEvent(hpcd, &event);
+    }
+    else if (USBD_LL_EventsHeld != 0)
+    {
+      /* The interrupt is masked, nothing is added meanwhile */
+      for (i = 0; i < USBD_LL_EventsHeld; i++)
+      {
+        USBD_LL_HandleEvent(hpcd, &USBD_LL_EventHeld[i]);
+      }
+      USBD_LL_EventsHeld = 0;
+      hpcd->Instance->GAHBCFG |= USB_OTG_GAHBCFG_GINT;
+    }
+  }
+}
+#endif
+
+/**
+  * @brief  Returns the number of times the event queue was full and the USB
+  *         interrupt was held off until the event task caught up. No event
+  *         is dropped. Always 0 when USBD_DEFERRED_EVENTS is disabled.
+  * @retval Queue overflows
+  */
+uint32_t USBD_LLEx_GetEventsLost(void)
+{
+#if (USBD_DEFERRED_EVENTS == 1)
+  return USBD_LL_EventsLost;
+#else
+  return 0;
+#endif
+}
+
+/**
+  * @brief  Unmasks or masks the SOF interrupt. It is left masked at init,
+  *         the composite layer unmasks it while a class has an SOF timer
+  *         running.
+  * @param  pdev: Device handle
+  * @param  enable: 1 to unmask, 0 to mask
+  * @retval None
+  */
+void USBD_LLEx_EnableSOF(USBD_HandleTypeDef *pdev, uint8_t enable)
+{
+  PCD_HandleTypeDef *hpcd = pdev->pData;
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (enable != 0)
+  {
+    /* A frame started while masked is not reported late */
+    hpcd->Instance->GINTSTS = USB_OTG_GINTSTS_SOF;
+    hpcd->Instance->GINTMSK |= USB_OTG_GINTMSK_SOFM;
+  }
+  else
+  {
+    hpcd->Instance->GINTMSK &= ~USB_OTG_GINTMSK_SOFM;
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Returns the number of the current frame, counted by the core
+  *         from the SOF packets whether the SOF interrupt is masked or not.
+  * @param  pdev: Device handle
+  * @retval Frame number, 14 bits (11 bits at full speed)
+  */
+uint16_t USBD_LLEx_GetFrameNumber(USBD_HandleTypeDef *pdev)
+{
+  PCD_HandleTypeDef *hpcd = pdev->pData;
+
+  return (uint16_t)((USBD_LL_DEVICE(hpcd)->DSTS & USB_OTG_DSTS_FNSOF) >> USB_OTG_DSTS_FNSOF_Pos);
+}
+
 /**
   * @brief  Setup stage callback
   * @param  hpcd: PCD handle
@@ -145,7 +561,13 @@ void HAL_PCD_MspDeInit(PCD_HandleTypeDef* pcdHandle)
   */
 void HAL_PCD_SetupStageCallback(PCD_HandleTypeDef *hpcd)
 {
-  USBD_LL_SetupStage((USBD_HandleTypeDef*)hpcd->pData, (uint8_t *)hpcd->Setup);
+  USBD_LL_EventTypeDef event;
+
+  event.type = USBD_LL_EVENT_SETUP;
+  event.epnum = 0;
+  event.param = 0;
+  USBD_memcpy(event.setup, hpcd->Setup, sizeof(event.setup));
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /**
@@ -156,7 +578,12 @@ void HAL_PCD_SetupStageCallback(PCD_HandleTypeDef *hpcd)
   */
 void HAL_PCD_DataOutStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
 {
-  USBD_LL_DataOutStage((USBD_HandleTypeDef*)hpcd->pData, epnum, hpcd->OUT_ep[epnum].xfer_buff);
+  USBD_LL_EventTypeDef event;
+
+  event.type = USBD_LL_EVENT_DATA_OUT;
+  event.epnum = epnum;
+  event.param = hpcd->OUT_ep[epnum].xfer_count;
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /**
@@ -167,7 +594,12 @@ void HAL_PCD_DataOutStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
   */
 void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
 {
-  USBD_LL_DataInStage((USBD_HandleTypeDef*)hpcd->pData, epnum, hpcd->IN_ep[epnum].xfer_buff);
+  USBD_LL_EventTypeDef event;
+
+  event.type = USBD_LL_EVENT_DATA_IN;
+  event.epnum = epnum;
+  event.param = hpcd->IN_ep[epnum].xfer_count;
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /**
@@ -177,7 +609,12 @@ void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
   */
 void HAL_PCD_SOFCallback(PCD_HandleTypeDef *hpcd)
 {
-  USBD_LL_SOF((USBD_HandleTypeDef*)hpcd->pData);
+  USBD_LL_EventTypeDef event;
+
+  event.type = USBD_LL_EVENT_SOF;
+  event.epnum = 0;
+  event.param = 0;
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /**
@@ -187,6 +624,7 @@ void HAL_PCD_SOFCallback(PCD_HandleTypeDef *hpcd)
   */
 void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd)
 { 
+  USBD_LL_EventTypeDef event;
   USBD_SpeedTypeDef speed = USBD_SPEED_FULL;
 
   /*Set USB Current Speed*/
@@ -203,10 +641,11 @@ void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd)
     speed = USBD_SPEED_FULL;    
     break;    
   }
-  USBD_LL_SetSpeed((USBD_HandleTypeDef*)hpcd->pData, speed);  
-  
-  /*Reset Device*/
-  USBD_LL_Reset((USBD_HandleTypeDef*)hpcd->pData);
+
+  event.type = USBD_LL_EVENT_RESET;
+  event.epnum = 0;
+  event.param = speed;
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /**
@@ -217,8 +656,13 @@ void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd)
   */
 void HAL_PCD_SuspendCallback(PCD_HandleTypeDef *hpcd)
 {  
+  USBD_LL_EventTypeDef event;
+
    /* Inform USB library that core enters in suspend Mode */
-  USBD_LL_Suspend((USBD_HandleTypeDef*)hpcd->pData);
+  event.type = USBD_LL_EVENT_SUSPEND;
+  event.epnum = 0;
+  event.param = 0;
+  USBD_LL_PostEvent(hpcd, &event);
   __HAL_PCD_GATE_PHYCLOCK(hpcd);
   /*Enter in STOP mode */
   /* USER CODE BEGIN 2 */
@@ -238,9 +682,14 @@ void HAL_PCD_SuspendCallback(PCD_HandleTypeDef *hpcd)
   */
 void HAL_PCD_ResumeCallback(PCD_HandleTypeDef *hpcd)
 {
+  USBD_LL_EventTypeDef event;
+
   /* USER CODE BEGIN 3 */
   /* USER CODE END 3 */
-  USBD_LL_Resume((USBD_HandleTypeDef*)hpcd->pData);
+  event.type = USBD_LL_EVENT_RESUME;
+  event.epnum = 0;
+  event.param = 0;
+  USBD_LL_PostEvent(hpcd, &event);
   
 }
 
@@ -252,7 +701,12 @@ void HAL_PCD_ResumeCallback(PCD_HandleTypeDef *hpcd)
   */
 void HAL_PCD_ISOOUTIncompleteCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
 {
-  USBD_LL_IsoOUTIncomplete((USBD_HandleTypeDef*)hpcd->pData, epnum);
+  USBD_LL_EventTypeDef event;
+
+  event.type = USBD_LL_EVENT_ISO_OUT_INCOMPLETE;
+  event.epnum = epnum;
+  event.param = 0;
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /**
@@ -263,7 +717,12 @@ void HAL_PCD_ISOOUTIncompleteCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
   */
 void HAL_PCD_ISOINIncompleteCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
 {
-  USBD_LL_IsoINIncomplete((USBD_HandleTypeDef*)hpcd->pData, epnum);
+  USBD_LL_EventTypeDef event;
+
+  event.type = USBD_LL_EVENT_ISO_IN_INCOMPLETE;
+  event.epnum = epnum;
+  event.param = 0;
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /**
@@ -273,7 +732,12 @@ void HAL_PCD_ISOINIncompleteCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
   */
 void HAL_PCD_ConnectCallback(PCD_HandleTypeDef *hpcd)
 {
-  USBD_LL_DevConnected((USBD_HandleTypeDef*)hpcd->pData);
+  USBD_LL_EventTypeDef event;
+
+  event.type = USBD_LL_EVENT_CONNECT;
+  event.epnum = 0;
+  event.param = 0;
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /**
@@ -283,7 +747,12 @@ void HAL_PCD_ConnectCallback(PCD_HandleTypeDef *hpcd)
   */
 void HAL_PCD_DisconnectCallback(PCD_HandleTypeDef *hpcd)
 {
-  USBD_LL_DevDisconnected((USBD_HandleTypeDef*)hpcd->pData);
+  USBD_LL_EventTypeDef event;
+
+  event.type = USBD_LL_EVENT_DISCONNECT;
+  event.epnum = 0;
+  event.param = 0;
+  USBD_LL_PostEvent(hpcd, &event);
 }
 
 /*******************************************************************************
@@ -296,6 +765,32 @@ void HAL_PCD_DisconnectCallback(PCD_HandleTypeDef *hpcd)
   */
 USBD_StatusTypeDef  USBD_LL_Init (USBD_HandleTypeDef *pdev)
 { 
+#if (USBD_DEFERRED_EVENTS == 1)
+  /* The USB interrupt only queues events, this task runs the stack */
+  if (USBD_LL_EventQueue == NULL)
+  {
+    USBD_LL_EventQueue = xQueueCreate(USBD_EVENT_QUEUE_LENGTH, sizeof(USBD_LL_EventTypeDef));
+    if ((USBD_LL_EventQueue == NULL) ||
+        (xTaskCreate(USBD_LL_EventTask, "USBD", configUSBD_EVENT_TASK_STACK_SIZE, &hpcd_USB_OTG_FS,
+                     configUSBD_EVENT_TASK_PRIORITY, NULL) != pdPASS))
+    {
+      _Error_Handler(__FILE__, __LINE__);
+    }
+  }
+#endif
+
+#if (USBD_PROFILING == 1)
+  USBD_Prof_Init();
+#endif
+
+#if (USBD_TRACE == 1)
+  USBD_Trace_Init();
+#endif
+
+#if (USBD_DEBUG_LEVEL > 0) && (USBD_LOG_DEFERRED == 1)
+  USBD_Log_Init();
+#endif
+
   /* Init USB_IP */
   if (pdev->id == DEVICE_FS) {
   /* Link The driver to the stack */	
@@ -308,6 +803,7 @@ USBD_StatusTypeDef  USBD_LL_Init (USBD_HandleTypeDef *pdev)
   hpcd_USB_OTG_FS.Init.dma_enable = DISABLE;
   hpcd_USB_OTG_FS.Init.ep0_mps = DEP0CTL_MPS_64;
   hpcd_USB_OTG_FS.Init.phy_itface = PCD_PHY_EMBEDDED;
+  /* Unmasked on demand, see USBD_COMPOSITE_StartSOFTimer */
   hpcd_USB_OTG_FS.Init.Sof_enable = DISABLE;
   hpcd_USB_OTG_FS.Init.low_power_enable = DISABLE;
   hpcd_USB_OTG_FS.Init.lpm_enable = DISABLE;
@@ -318,11 +814,95 @@ USBD_StatusTypeDef  USBD_LL_Init (USBD_HandleTypeDef *pdev)
     _Error_Handler(__FILE__, __LINE__);
   }
 
-  HAL_PCDEx_SetRxFiFo(&hpcd_USB_OTG_FS, 0x80);
-  HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 0, 0x40);
-  HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 1, 0x40);
-  HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 2, 0x40);
-  HAL_PCDEx_SetTxFiFo(&hpcd_USB_OTG_FS, 3, 0x40);
+  /* FIFOs are partitioned in USBD_LL_Start, once the classes are registered */
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  Partitions the core FIFO RAM using the endpoint table built by the
+  *         composite layer. Bulk and isochronous IN endpoints get room for two
+  *         packets, interrupt IN endpoints for one, and the words left over
+  *         extend the RX FIFO shared by all OUT endpoints. If the budget is
+  *         exceeded the partition falls back to single packet buffering.
+  * @param  hpcd: PCD handle
+  * @retval USBD_OK, USBD_FAIL when even single packet buffering does not
+  *         fit: nothing is programmed, overlapping TX FIFOs would corrupt
+  *         each other's data
+  */
+static USBD_StatusTypeDef USBD_LL_ConfigureFifo(PCD_HandleTypeDef *hpcd)
+{
+  uint16_t tx_words[16];
+  uint16_t fifo_words;
+  uint16_t rx_words;
+  uint16_t used_words;
+  uint16_t max_out_mps;
+  uint16_t ep_mps;
+  uint8_t  ep_type;
+  uint8_t  out_eps;
+  uint8_t  packets = 2;
+  uint8_t  ep;
+
+  fifo_words = (hpcd->Instance == USB_OTG_FS) ? USBD_FS_FIFO_WORDS : USBD_HS_FIFO_WORDS;
+
+  do
+  {
+    max_out_mps = USB_MAX_EP0_SIZE;
+    out_eps = 1;
+    tx_words[0] = USB_MAX_EP0_SIZE / 4;
+    used_words = tx_words[0];
+
+    for (ep = 1; ep < hpcd->Init.dev_endpoints; ep++)
+    {
+      tx_words[ep] = 0;
+      if (USBD_COMPOSITE_GetEPInfo(ep | 0x80, &ep_type, &ep_mps) == USBD_OK)
+      {
+        if ((hpcd->Init.speed == PCD_SPEED_HIGH) && (ep_type == USBD_EP_TYPE_BULK))
+        {
+          ep_mps = 512;
+        }
+        tx_words[ep] = (ep_mps + 3) / 4;
+        if (ep_type != USBD_EP_TYPE_INTR)
+        {
+          tx_words[ep] *= packets;
+        }
+        if (tx_words[ep] < USBD_TX_FIFO_MIN_WORDS)
+        {
+          tx_words[ep] = USBD_TX_FIFO_MIN_WORDS;
+        }
+        used_words += tx_words[ep];
+      }
+      if (USBD_COMPOSITE_GetEPInfo(ep, &ep_type, &ep_mps) == USBD_OK)
+      {
+        if ((hpcd->Init.speed == PCD_SPEED_HIGH) && (ep_type == USBD_EP_TYPE_BULK))
+        {
+          ep_mps = 512;
+        }
+        if (ep_mps > max_out_mps)
+        {
+          max_out_mps = ep_mps;
+        }
+        out_eps++;
+      }
+    }
+
+    /* 13 words for SETUP packets, one status word per received packet, two
+    words per OUT endpoint for transfer complete status and one for global NAK */
+    rx_words = 13 + packets * ((max_out_mps + 3) / 4 + 1) + 2 * out_eps + 1;
+    used_words += rx_words;
+  } while ((used_words > fifo_words) && (--packets > 0));
+
+  if (used_words > fifo_words)
+  {
+    USBD_ErrLog("FIFO budget exceeded: %d/%d words", used_words, fifo_words);
+    return USBD_FAIL;
+  }
+  rx_words += fifo_words - used_words;
+
+  HAL_PCDEx_SetRxFiFo(hpcd, rx_words);
+  for (ep = 0; ep < hpcd->Init.dev_endpoints; ep++)
+  {
+    HAL_PCDEx_SetTxFiFo(hpcd, ep, tx_words[ep]);
   }
   return USBD_OK;
 }
@@ -368,6 +948,12 @@ USBD_StatusTypeDef  USBD_LL_Start(USBD_HandleTypeDef *pdev)
 {
   HAL_StatusTypeDef hal_status = HAL_OK;
   USBD_StatusTypeDef usb_status = USBD_OK;
+
+  /* The device does not connect with endpoints its FIFOs cannot hold */
+  if (USBD_LL_ConfigureFifo(pdev->pData) != USBD_OK)
+  {
+    return USBD_FAIL;
+  }
  
   hal_status = HAL_PCD_Start(pdev->pData);
      
@@ -480,6 +1066,8 @@ USBD_StatusTypeDef  USBD_LL_CloseEP (USBD_HandleTypeDef *pdev, uint8_t ep_addr)
   
   ep_addr=USBD_COMPOSITE_LL_EP_Conversion(pdev, ep_addr);
 
+  USBD_LLEx_Flush(pdev, ep_addr);
+
   hal_status = HAL_PCD_EP_Close(pdev->pData, ep_addr);
       
   switch (hal_status) {
@@ -692,6 +1280,17 @@ USBD_StatusTypeDef  USBD_LL_Transmit (USBD_HandleTypeDef *pdev,
       usb_status = USBD_FAIL;
     break;
   }
+
+#if (USBD_TRACE == 1)
+  if (usb_status == USBD_OK)
+  {
+    USBD_TRACE_EVENT(USBD_TRACE_EP_SUBMIT, ep_addr, size, 0);
+  }
+  else
+  {
+    USBD_TRACE_EVENT(USBD_TRACE_EP_BUSY, ep_addr, usb_status, size);
+  }
+#endif
   return usb_status;    
 }
 
@@ -732,6 +1331,17 @@ USBD_StatusTypeDef  USBD_LL_PrepareReceive(USBD_HandleTypeDef *pdev,
       usb_status = USBD_FAIL;
     break;
   }
+
+#if (USBD_TRACE == 1)
+  if (usb_status == USBD_OK)
+  {
+    USBD_TRACE_EVENT(USBD_TRACE_EP_SUBMIT, ep_addr, size, 0);
+  }
+  else
+  {
+    USBD_TRACE_EVENT(USBD_TRACE_EP_BUSY, ep_addr, usb_status, size);
+  }
+#endif
   return usb_status; 
 }
 
@@ -747,43 +1357,831 @@ uint32_t USBD_LL_GetRxDataSize  (USBD_HandleTypeDef *pdev, uint8_t  ep_addr)
   return HAL_PCD_EP_GetRxCount((PCD_HandleTypeDef*) pdev->pData, ep_addr);
 }
 
-#if (USBD_LPM_ENABLED == 1)
+/*******************************************************************************
+                       LL Driver Extended Interface (queued transfers)
+*******************************************************************************/
 /**
-  * @brief  HAL_PCDEx_LPM_Callback : Send LPM message to user layer
+  * @brief  Returns the transfer queue of a device endpoint.
+  * @param  hw_addr: Device endpoint address (after composite conversion)
+  * @retval Queue, NULL for EP0 or endpoints beyond USBD_LLEX_MAX_EP
+  */
+static USBD_LLEx_QueueTypeDef *USBD_LLEx_GetQueue(uint8_t hw_addr)
+{
+  uint8_t epnum = hw_addr & 0x7F;
+
+  if ((epnum == 0) || (epnum >= USBD_LLEX_MAX_EP))
+  {
+    return NULL;
+  }
+  return (hw_addr & 0x80) ? &USBD_LLEx_InQueue[epnum] : &USBD_LLEx_OutQueue[epnum];
+}
+
+/**
+  * @brief  Starts the transfer at the head of a queue.
   * @param  hpcd: PCD handle
-  * @param  msg: LPM message
-  * @retval HAL status
+  * @param  queue: Endpoint queue, must not be empty
+  * @retval None
   */
-void HAL_PCDEx_LPM_Callback(PCD_HandleTypeDef *hpcd, PCD_LPM_MsgTypeDef msg)
+static void USBD_LLEx_StartHead(PCD_HandleTypeDef *hpcd, USBD_LLEx_QueueTypeDef *queue)
 {
-  switch ( msg)
+  USBD_LLEx_XferTypeDef *xfer = &queue->xfer[queue->head];
+
+  if (queue->hw_addr & 0x80)
   {
-  case PCD_LPM_L0_ACTIVE:
-    if (hpcd->Init.low_power_enable)
-    {
-      SystemClock_Config();
-      
-      /* Reset SLEEPDEEP bit of Cortex System Control Register */
-      SCB->SCR &= (uint32_t)~((uint32_t)(SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk));
-    }
-    __HAL_PCD_UNGATE_PHYCLOCK(hpcd);
-    USBD_LL_Resume(hpcd->pData);    
-    break;
-    
-  case PCD_LPM_L1_ACTIVE:
-    __HAL_PCD_GATE_PHYCLOCK(hpcd);
-    USBD_LL_Suspend(hpcd->pData);
-    
-    /*Enter in STOP mode */
-    if (hpcd->Init.low_power_enable)
-    {   
-      /* Set SLEEPDEEP bit and SleepOnExit of Cortex System Control Register */
-      SCB->SCR |= (uint32_t)((uint32_t)(SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk));
-    }     
-    break;   
+    HAL_PCD_EP_Transmit(hpcd, queue->hw_addr, xfer->pbuf, xfer->length);
+  }
+  else
+  {
+    HAL_PCD_EP_Receive(hpcd, queue->hw_addr, xfer->pbuf, xfer->length);
   }
 }
-#endif
+
+/**
+  * @brief  Queues a transfer and starts it if the endpoint is idle.
+  *         The class context (pClassData/pUserData) current at submission is
+  *         restored around the completion callback.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint address, as seen by the class
+  * @param  pbuf: Data buffer, must stay valid until completion
+  * @param  size: Data size
+  * @param  pSegment: Gather list replacing pbuf/size, NULL for a contiguous
+  *         buffer
+  * @param  nsegment: Number of segments in pSegment
+  * @param  pCplt: Completion callback
+  * @param  pContext: User context passed back to pCplt
+  * @retval USBD_OK, USBD_BUSY when the queue is full, USBD_FAIL on EP0, an
+  *         endpoint without queue or a gather list that cannot be served
+  */
+static USBD_StatusTypeDef USBD_LLEx_Submit(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint32_t size,
+                                           const USBD_LLEx_SegmentTypeDef *pSegment, uint8_t nsegment,
+                                           USBD_LLEx_CpltCallbackTypeDef pCplt, void *pContext)
+{
+  PCD_HandleTypeDef *hpcd = pdev->pData;
+  USBD_LLEx_QueueTypeDef *queue;
+  USBD_LLEx_XferTypeDef *xfer;
+  uint8_t hw_addr;
+  uint8_t i;
+  uint32_t primask;
+
+  hw_addr = USBD_COMPOSITE_LL_EP_Conversion(pdev, ep_addr);
+  queue = USBD_LLEx_GetQueue(hw_addr);
+  if (queue == NULL)
+  {
+    return USBD_FAIL;
+  }
+
+  if (pSegment != NULL)
+  {
+    if ((nsegment == 0) || (nsegment > USBD_LLEX_MAX_SEGMENTS) || (USBD_LLEx_GatherReady == 0) ||
+        (hpcd->Init.dma_enable != DISABLE) || (hpcd->IN_ep[hw_addr & 0x7F].type == EP_TYPE_ISOC))
+    {
+      return USBD_FAIL;
+    }
+    pbuf = pSegment[0].pbuf;
+    size = 0;
+    for (i = 0; i < nsegment; i++)
+    {
+      size += pSegment[i].length;
+    }
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (queue->count >= USBD_LLEX_QUEUE_DEPTH)
+  {
+    queue->busy++;
+    __set_PRIMASK(primask);
+    USBD_TRACE_EVENT(USBD_TRACE_EP_BUSY, hw_addr, USBD_BUSY, size);
+    return USBD_BUSY;
+  }
+
+  xfer = &queue->xfer[(queue->head + queue->count) % USBD_LLEX_QUEUE_DEPTH];
+  xfer->ep_addr = ep_addr;
+  xfer->status = USBD_OK;
+  xfer->pbuf = pbuf;
+  xfer->length = size;
+  xfer->actual = 0;
+  xfer->pCplt = pCplt;
+  xfer->pContext = pContext;
+  xfer->pClassData = pdev->pClassData;
+  xfer->pUserData = pdev->pUserData;
+  xfer->nsegment = (pSegment != NULL) ? nsegment : 0;
+  xfer->seg_index = 0;
+  xfer->seg_offset = 0;
+  for (i = 0; i < xfer->nsegment; i++)
+  {
+    xfer->segment[i] = pSegment[i];
+  }
+  queue->hw_addr = hw_addr;
+
+  if (queue->count++ == 0)
+  {
+    USBD_LLEx_StartHead(hpcd, queue);
+  }
+  if (queue->count > queue->high_water)
+  {
+    queue->high_water = queue->count;
+  }
+  queue->submitted++;
+  USBD_TRACE_EVENT(USBD_TRACE_EP_SUBMIT, hw_addr, size, queue->count);
+
+  __set_PRIMASK(primask);
+  return USBD_OK;
+}
+
+/**
+  * @brief  Calls the completion callback of a transfer in its class context.
+  * @param  pdev: Device handle
+  * @param  xfer: Finished transfer
+  * @retval None
+  */
+static void USBD_LLEx_Notify(USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+  void *pClassData = pdev->pClassData;
+  void *pUserData = pdev->pUserData;
+
+  if (xfer->pCplt != NULL)
+  {
+    pdev->pClassData = xfer->pClassData;
+    pdev->pUserData = xfer->pUserData;
+    xfer->pCplt(pdev, xfer);
+    pdev->pClassData = pClassData;
+    pdev->pUserData = pUserData;
+  }
+}
+
+/**
+  * @brief  Completes the transfer at the head of an endpoint queue and starts
+  *         the next one.
+  * @param  hpcd: PCD handle
+  * @param  hw_addr: Device endpoint address
+  * @param  actual: Transferred length
+  * @retval USBD_OK if a queued transfer was completed, USBD_FAIL if the
+  *         endpoint has none and the event belongs to the class callbacks
+  */
+static uint8_t USBD_LLEx_Complete(PCD_HandleTypeDef *hpcd, uint8_t hw_addr, uint32_t actual)
+{
+  USBD_LLEx_QueueTypeDef *queue = USBD_LLEx_GetQueue(hw_addr);
+  USBD_LLEx_XferTypeDef xfer;
+  uint32_t primask;
+
+  if ((queue == NULL) || (queue->count == 0))
+  {
+    return USBD_FAIL;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  xfer = queue->xfer[queue->head];
+  queue->head = (queue->head + 1) % USBD_LLEX_QUEUE_DEPTH;
+  if (--queue->count != 0)
+  {
+    USBD_LLEx_StartHead(hpcd, queue);
+  }
+  __set_PRIMASK(primask);
+
+  xfer.actual = actual;
+  USBD_LLEx_Notify((USBD_HandleTypeDef*)hpcd->pData, &xfer);
+  return USBD_OK;
+}
+
+/**
+  * @brief  Drops all the transfers queued on an endpoint, completing them
+  *         with USBD_FAIL.
+  * @param  pdev: Device handle
+  * @param  hw_addr: Device endpoint address
+  * @retval None
+  */
+static void USBD_LLEx_Flush(USBD_HandleTypeDef *pdev, uint8_t hw_addr)
+{
+  USBD_LLEx_QueueTypeDef *queue = USBD_LLEx_GetQueue(hw_addr);
+  USBD_LLEx_XferTypeDef xfer;
+  uint32_t primask;
+
+  if (queue == NULL)
+  {
+    return;
+  }
+
+  for (;;)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (queue->count == 0)
+    {
+      __set_PRIMASK(primask);
+      break;
+    }
+    xfer = queue->xfer[queue->head];
+    queue->head = (queue->head + 1) % USBD_LLEX_QUEUE_DEPTH;
+    queue->count--;
+    __set_PRIMASK(primask);
+
+    xfer.status = USBD_FAIL;
+    USBD_LLEx_Notify(pdev, &xfer);
+  }
+}
+
+/**
+  * @brief  Queues a transmission on an endpoint. pCplt is called from the USB
+  *         interrupt once the data is sent, in submission order.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint Number
+  * @param  pbuf: Pointer to data to be sent, valid until completion
+  * @param  size: Data size
+  * @param  pCplt: Completion callback
+  * @param  pContext: User context
+  * @retval USBD Status, USBD_BUSY when USBD_LLEX_QUEUE_DEPTH transfers are pending
+  */
+USBD_StatusTypeDef  USBD_LLEx_Transmit (USBD_HandleTypeDef *pdev,
+                                        uint8_t  ep_addr,
+                                        uint8_t  *pbuf,
+                                        uint32_t size,
+                                        USBD_LLEx_CpltCallbackTypeDef pCplt,
+                                        void *pContext)
+{
+  return USBD_LLEx_Submit(pdev, ep_addr | 0x80, pbuf, size, NULL, 0, pCplt, pContext);
+}
+
+/**
+  * @brief  Queues a transmission gathered from a list of segments, sent as a
+  *         single transfer without copying them to a contiguous buffer. The
+  *         list is copied, the segment data must stay valid until completion.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint Number
+  * @param  pSegment: Segments, in transmission order
+  * @param  nsegment: Number of segments, up to USBD_LLEX_MAX_SEGMENTS
+  * @param  pCplt: Completion callback
+  * @param  pContext: User context
+  * @retval USBD Status, USBD_FAIL when gather is not available on the endpoint
+  */
+USBD_StatusTypeDef  USBD_LLEx_TransmitGather (USBD_HandleTypeDef *pdev,
+                                              uint8_t  ep_addr,
+                                              const USBD_LLEx_SegmentTypeDef *pSegment,
+                                              uint8_t  nsegment,
+                                              USBD_LLEx_CpltCallbackTypeDef pCplt,
+                                              void *pContext)
+{
+  return USBD_LLEx_Submit(pdev, ep_addr | 0x80, NULL, 0, pSegment, nsegment, pCplt, pContext);
+}
+
+/**
+  * @brief  Queues a reception on an endpoint. pCplt is called from the USB
+  *         interrupt with xfer->actual set to the received length.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint Number
+  * @param  pbuf: Pointer to data to be received, valid until completion
+  * @param  size: Data size
+  * @param  pCplt: Completion callback
+  * @param  pContext: User context
+  * @retval USBD Status, USBD_BUSY when USBD_LLEX_QUEUE_DEPTH transfers are pending
+  */
+USBD_StatusTypeDef  USBD_LLEx_PrepareReceive (USBD_HandleTypeDef *pdev,
+                                              uint8_t  ep_addr,
+                                              uint8_t  *pbuf,
+                                              uint32_t size,
+                                              USBD_LLEx_CpltCallbackTypeDef pCplt,
+                                              void *pContext)
+{
+  return USBD_LLEx_Submit(pdev, ep_addr & 0x7F, pbuf, size, NULL, 0, pCplt, pContext);
+}
+
+/**
+  * @brief  Pops one entry of the shared RX FIFO the way the PCD interrupt
+  *         does, but discards the data received on drop_epnum.
+  * @param  hpcd: PCD handle
+  * @param  drop_epnum: OUT endpoint whose packets are dropped
+  * @retval None
+  */
+static void USBD_LL_PopRxFifo(PCD_HandleTypeDef *hpcd, uint8_t drop_epnum)
+{
+  PCD_EPTypeDef *ep;
+  uint32_t status;
+  uint32_t bcnt;
+  uint32_t i;
+
+  status = hpcd->Instance->GRXSTSP;
+  ep = &hpcd->OUT_ep[status & USB_OTG_GRXSTSP_EPNUM];
+  bcnt = (status & USB_OTG_GRXSTSP_BCNT) >> 4;
+
+  switch ((status & USB_OTG_GRXSTSP_PKTSTS) >> 17)
+  {
+  case STS_DATA_UPDT:
+    if (ep->num == drop_epnum)
+    {
+      for (i = 0; i < (bcnt + 3) / 4; i++)
+      {
+        (void)USBD_LL_DFIFO(hpcd, 0);
+      }
+    }
+    else if (bcnt != 0)
+    {
+      USB_ReadPacket(hpcd->Instance, ep->xfer_buff, bcnt);
+      ep->xfer_buff += bcnt;
+      ep->xfer_count += bcnt;
+    }
+    break;
+
+  case STS_SETUP_UPDT:
+    USB_ReadPacket(hpcd->Instance, (uint8_t *)hpcd->Setup, 8);
+    ep->xfer_count += bcnt;
+    break;
+
+  default:
+    break;
+  }
+}
+
+/**
+  * @brief  Stops an IN endpoint in the core: NAKs the host, disables the
+  *         endpoint and flushes its TX FIFO. Called with the USB interrupt
+  *         masked.
+  * @param  hpcd: PCD handle
+  * @param  epnum: Endpoint number
+  * @retval USBD_OK, USBD_FAIL when the core did not acknowledge in time
+  */
+static USBD_StatusTypeDef USBD_LL_DisableInEP(PCD_HandleTypeDef *hpcd, uint8_t epnum)
+{
+  USB_OTG_INEndpointTypeDef *inep = USBD_LL_INEP(hpcd, epnum);
+  USBD_StatusTypeDef usb_status = USBD_OK;
+  uint32_t count;
+
+  if (inep->DIEPCTL & USB_OTG_DIEPCTL_EPENA)
+  {
+    /* The core must stop fetching the FIFO before the endpoint is disabled */
+    inep->DIEPCTL |= USB_OTG_DIEPCTL_SNAK;
+    for (count = 0; (inep->DIEPINT & USB_OTG_DIEPINT_INEPNE) == 0; count++)
+    {
+      if (count == USBD_LL_EP_DISABLE_POLLS)
+      {
+        usb_status = USBD_FAIL;
+        break;
+      }
+    }
+
+    inep->DIEPCTL |= USB_OTG_DIEPCTL_EPDIS | USB_OTG_DIEPCTL_SNAK;
+    for (count = 0; (inep->DIEPINT & USB_OTG_DIEPINT_EPDISD) == 0; count++)
+    {
+      if (count == USBD_LL_EP_DISABLE_POLLS)
+      {
+        usb_status = USBD_FAIL;
+        break;
+      }
+    }
+  }
+
+  /* Drop the events the interrupt has not served yet, a completion latched
+  before the disable belongs to the aborted transfer */
+  inep->DIEPINT = USB_OTG_DIEPINT_XFRC | USB_OTG_DIEPINT_EPDISD | USB_OTG_DIEPINT_TOC |
+                  USB_OTG_DIEPINT_ITTXFE | USB_OTG_DIEPINT_INEPNE;
+  USBD_LL_DEVICE(hpcd)->DIEPEMPMSK &= ~(1U << epnum);
+  USB_FlushTxFifo(hpcd->Instance, epnum);
+  return usb_status;
+}
+
+/**
+  * @brief  Stops an OUT endpoint in the core. The RX FIFO is shared, so all
+  *         the OUT endpoints are NAKed while the packets already received are
+  *         popped, the ones of this endpoint being dropped, then the
+  *         endpoint is disabled. Called with the USB interrupt masked.
+  * @param  hpcd: PCD handle
+  * @param  epnum: Endpoint number
+  * @retval USBD_OK, USBD_FAIL when the core did not acknowledge in time
+  */
+static USBD_StatusTypeDef USBD_LL_DisableOutEP(PCD_HandleTypeDef *hpcd, uint8_t epnum)
+{
+  USB_OTG_OUTEndpointTypeDef *outep = USBD_LL_OUTEP(hpcd, epnum);
+  USBD_StatusTypeDef usb_status = USBD_OK;
+  uint32_t count;
+
+  USBD_LL_DEVICE(hpcd)->DCTL |= USB_OTG_DCTL_SGONAK;
+  for (count = 0; (hpcd->Instance->GINTSTS & USB_OTG_GINTSTS_BOUTNAKEFF) == 0; count++)
+  {
+    if (count == USBD_LL_EP_DISABLE_POLLS)
+    {
+      usb_status = USBD_FAIL;
+      break;
+    }
+    if (hpcd->Instance->GINTSTS & USB_OTG_GINTSTS_RXFLVL)
+    {
+      USBD_LL_PopRxFifo(hpcd, epnum);
+    }
+  }
+
+  if (outep->DOEPCTL & USB_OTG_DOEPCTL_EPENA)
+  {
+    outep->DOEPCTL |= USB_OTG_DOEPCTL_EPDIS | USB_OTG_DOEPCTL_SNAK;
+    for (count = 0; (outep->DOEPINT & USB_OTG_DOEPINT_EPDISD) == 0; count++)
+    {
+      if (count == USBD_LL_EP_DISABLE_POLLS)
+      {
+        usb_status = USBD_FAIL;
+        break;
+      }
+    }
+  }
+  outep->DOEPINT = USB_OTG_DOEPINT_XFRC | USB_OTG_DOEPINT_EPDISD;
+
+  USBD_LL_DEVICE(hpcd)->DCTL |= USB_OTG_DCTL_CGONAK;
+  return usb_status;
+}
+
+/**
+  * @brief  Aborts the transfers queued on an endpoint. The endpoint is first
+  *         disabled in the core, its FIFO flushed and its transfer state
+  *         cleared, then each queued transfer is completed with USBD_FAIL
+  *         status. The endpoint is idle when the function returns: the core
+  *         no longer accesses the aborted buffers, they can be reused and a
+  *         new transfer can be queued at once, even from a completion
+  *         callback of the aborted ones.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint Number
+  * @retval USBD Status, USBD_FAIL on EP0, an endpoint without queue or when
+  *         the core did not acknowledge the disable within
+  *         USBD_LL_EP_DISABLE_TIMEOUT_US (transfers are completed anyway,
+  *         the bus is gone in that case)
+  */
+USBD_StatusTypeDef  USBD_LLEx_Abort (USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+  PCD_HandleTypeDef *hpcd = pdev->pData;
+  USBD_StatusTypeDef usb_status;
+  PCD_EPTypeDef *ep;
+  uint8_t epnum;
+  uint32_t irq_enabled;
+
+  ep_addr = USBD_COMPOSITE_LL_EP_Conversion(pdev, ep_addr);
+  epnum = ep_addr & 0x7F;
+  if (USBD_LLEx_GetQueue(ep_addr) == NULL)
+  {
+    return USBD_FAIL;
+  }
+
+  /* Only the USB interrupt is held off while the core acknowledges, the
+  others keep their latency. Also called from the USB interrupt itself. */
+  irq_enabled = NVIC_GetEnableIRQ(USBD_LL_IRQn(hpcd));
+  HAL_NVIC_DisableIRQ(USBD_LL_IRQn(hpcd));
+  __DSB();
+  __ISB();
+  if (ep_addr & 0x80)
+  {
+    usb_status = USBD_LL_DisableInEP(hpcd, epnum);
+    ep = &hpcd->IN_ep[epnum];
+  }
+  else
+  {
+    usb_status = USBD_LL_DisableOutEP(hpcd, epnum);
+    ep = &hpcd->OUT_ep[epnum];
+  }
+  ep->xfer_len = 0;
+  ep->xfer_count = 0;
+  if (irq_enabled != 0)
+  {
+    HAL_NVIC_EnableIRQ(USBD_LL_IRQn(hpcd));
+  }
+
+  if (usb_status != USBD_OK)
+  {
+    USBD_ErrLog("USBD_LLEx_Abort: endpoint 0x%02X not disabled", ep_addr);
+  }
+
+  USBD_LLEx_Flush(pdev, ep_addr);
+  return usb_status;
+}
+
+/**
+  * @brief  Carries the isochronous IN transfer armed on an endpoint over to
+  *         the next frame, when the host did not read it in this one. The
+  *         data stays in the TX FIFO, only the even/odd frame the core sends
+  *         it in is flipped. Call from the IsoINIncomplete callback, raised
+  *         at the end of the periodic frame.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint Number
+  * @retval USBD_OK, USBD_FAIL when no transfer is armed in the core: the
+  *         endpoint has to be aborted and armed again
+  */
+USBD_StatusTypeDef  USBD_LLEx_IsoInNextFrame (USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+  PCD_HandleTypeDef *hpcd = pdev->pData;
+  USBD_LLEx_QueueTypeDef *queue;
+  USB_OTG_INEndpointTypeDef *inep;
+  uint8_t epnum;
+  uint32_t primask;
+  USBD_StatusTypeDef usb_status = USBD_FAIL;
+
+  ep_addr = USBD_COMPOSITE_LL_EP_Conversion(pdev, ep_addr | 0x80);
+  epnum = ep_addr & 0x7F;
+  queue = USBD_LLEx_GetQueue(ep_addr);
+  if (queue == NULL)
+  {
+    return USBD_FAIL;
+  }
+  inep = USBD_LL_INEP(hpcd, epnum);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if ((queue->count != 0) && (inep->DIEPCTL & USB_OTG_DIEPCTL_EPENA))
+  {
+    /* Parity of the frame about to start, as USB_EPStartXfer sets it */
+    if ((USBD_LL_DEVICE(hpcd)->DSTS & (1U << USB_OTG_DSTS_FNSOF_Pos)) == 0)
+    {
+      inep->DIEPCTL |= USB_OTG_DIEPCTL_SODDFRM;
+    }
+    else
+    {
+      inep->DIEPCTL |= USB_OTG_DIEPCTL_SD0PID_SEVNFRM;
+    }
+    usb_status = USBD_OK;
+  }
+  __set_PRIMASK(primask);
+
+  return usb_status;
+}
+
+/**
+  * @brief  Returns the number of transfers pending on an endpoint.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint Number
+  * @retval Pending transfers, including the one in progress
+  */
+uint8_t USBD_LLEx_GetQueued (USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+  USBD_LLEx_QueueTypeDef *queue;
+
+  queue = USBD_LLEx_GetQueue(USBD_COMPOSITE_LL_EP_Conversion(pdev, ep_addr));
+  return (queue != NULL) ? queue->count : 0;
+}
+
+/**
+  * @brief  Returns the queue statistics of an endpoint.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint Number
+  * @param  stats: Statistics, zeroed for endpoints without queue
+  * @retval None
+  */
+void USBD_LLEx_GetStats (USBD_HandleTypeDef *pdev, uint8_t ep_addr, USBD_LLEx_StatsTypeDef *stats)
+{
+  USBD_LLEx_QueueTypeDef *queue;
+
+  queue = USBD_LLEx_GetQueue(USBD_COMPOSITE_LL_EP_Conversion(pdev, ep_addr));
+  if (queue == NULL)
+  {
+    USBD_memset(stats, 0, sizeof(*stats));
+    return;
+  }
+  stats->queued = queue->count;
+  stats->high_water = queue->high_water;
+  stats->submitted = queue->submitted;
+  stats->busy = queue->busy;
+}
+
+/**
+  * @brief  Writes the next packets of a gather transfer to the endpoint FIFO,
+  *         as long as they fit. Words straddling two segments are assembled
+  *         byte by byte, the rest is copied a word at a time.
+  * @param  hpcd: PCD handle
+  * @param  epnum: Device IN endpoint number
+  * @param  xfer: Gather transfer in progress on the endpoint
+  * @retval 1 once the whole transfer is in the FIFO, 0 otherwise
+  */
+static uint8_t USBD_LLEx_WriteGather(PCD_HandleTypeDef *hpcd, uint8_t epnum, USBD_LLEx_XferTypeDef *xfer)
+{
+  PCD_EPTypeDef *ep = &hpcd->IN_ep[epnum];
+  USBD_LLEx_SegmentTypeDef *seg;
+  uint32_t len;
+  uint32_t avail;
+  uint32_t word;
+  uint8_t shift;
+
+  while (ep->xfer_count < ep->xfer_len)
+  {
+    len = ep->xfer_len - ep->xfer_count;
+    if (len > ep->maxpacket)
+    {
+      len = ep->maxpacket;
+    }
+    if ((USBD_LL_INEP(hpcd, epnum)->DTXFSTS & USB_OTG_DTXFSTS_INEPTFSAV) < ((len + 3) / 4))
+    {
+      return 0;
+    }
+    ep->xfer_count += len;
+
+    while (len > 0)
+    {
+      seg = &xfer->segment[xfer->seg_index];
+      avail = seg->length - xfer->seg_offset;
+      if (avail == 0)
+      {
+        xfer->seg_index++;
+        xfer->seg_offset = 0;
+      }
+      else if ((avail >= 4) && (len >= 4))
+      {
+        avail = ((avail < len) ? avail : len) & ~3U;
+        len -= avail;
+        for (; avail != 0; avail -= 4)
+        {
+          USBD_memcpy(&word, seg->pbuf + xfer->seg_offset, 4);
+          USBD_LL_DFIFO(hpcd, epnum) = word;
+          xfer->seg_offset += 4;
+        }
+      }
+      else
+      {
+        word = 0;
+        for (shift = 0; (shift < 32) && (len > 0); shift += 8, len--)
+        {
+          while (xfer->seg_offset == xfer->segment[xfer->seg_index].length)
+          {
+            xfer->seg_index++;
+            xfer->seg_offset = 0;
+          }
+          word |= (uint32_t)xfer->segment[xfer->seg_index].pbuf[xfer->seg_offset++] << shift;
+        }
+        USBD_LL_DFIFO(hpcd, epnum) = word;
+      }
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  USB interrupt handler. Serves the TX FIFO empty events of gather
+  *         transfers before handing the interrupt to HAL_PCD_IRQHandler; their
+  *         empty interrupt stays masked while the HAL handler runs so it never
+  *         writes the FIFO from ep->xfer_buff.
+  * @param  hpcd: PCD handle
+  * @retval None
+  */
+void USBD_LLEx_IRQHandler(PCD_HandleTypeDef *hpcd)
+{
+  USBD_LLEx_QueueTypeDef *queue;
+  uint32_t empty_msk = 0;
+  uint8_t epnum;
+  USBD_PROF_START(cycles);
+
+  USBD_LLEx_GatherReady = 1;
+
+  for (epnum = 1; epnum < USBD_LLEX_MAX_EP; epnum++)
+  {
+    queue = &USBD_LLEx_InQueue[epnum];
+    if ((queue->count != 0) && (queue->xfer[queue->head].nsegment != 0) &&
+        (USBD_LL_DEVICE(hpcd)->DIEPEMPMSK & (1U << epnum)))
+    {
+      USBD_LL_DEVICE(hpcd)->DIEPEMPMSK &= ~(1U << epnum);
+      if (((USBD_LL_INEP(hpcd, epnum)->DIEPINT & USB_OTG_DIEPINT_TXFE) == 0) ||
+          (USBD_LLEx_WriteGather(hpcd, epnum, &queue->xfer[queue->head]) == 0))
+      {
+        empty_msk |= 1U << epnum;
+      }
+    }
+  }
+
+  HAL_PCD_IRQHandler(hpcd);
+
+  USBD_LL_DEVICE(hpcd)->DIEPEMPMSK |= empty_msk;
+
+  USBD_PROF_STOP(USBD_PROF_IRQ, cycles);
+}
+
+#if (USBD_LPM_ENABLED == 1)
+/**
+  * @brief  HAL_PCDEx_LPM_Callback : Send LPM message to user layer
+  * @param  hpcd: PCD handle
+  * @param  msg: LPM message
+  * @retval HAL status
+  */
+void HAL_PCDEx_LPM_Callback(PCD_HandleTypeDef *hpcd, PCD_LPM_MsgTypeDef msg)
+{
+  USBD_LL_EventTypeDef event;
+
+  event.epnum = 0;
+  event.param = 0;
+  switch ( msg)
+  {
+  case PCD_LPM_L0_ACTIVE:
+    if (hpcd->Init.low_power_enable)
+    {
+      SystemClock_Config();
+      
+      /* Reset SLEEPDEEP bit of Cortex System Control Register */
+      SCB->SCR &= (uint32_t)~((uint32_t)(SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk));
+    }
+    __HAL_PCD_UNGATE_PHYCLOCK(hpcd);
+    event.type = USBD_LL_EVENT_RESUME;
+    USBD_LL_PostEvent(hpcd, &event);
+    break;
+    
+  case PCD_LPM_L1_ACTIVE:
+    __HAL_PCD_GATE_PHYCLOCK(hpcd);
+    event.type = USBD_LL_EVENT_SUSPEND;
+    USBD_LL_PostEvent(hpcd, &event);
+    
+    /*Enter in STOP mode */
+    if (hpcd->Init.low_power_enable)
+    {   
+      /* Set SLEEPDEEP bit and SleepOnExit of Cortex System Control Register */
+      SCB->SCR |= (uint32_t)((uint32_t)(SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk));
+    }     
+    break;   
+  }
+}
+#endif
+/**
+  * @brief  Allocates a class handle from the static pool. Constant time and
+  *         safe from interrupts, the C heap is never used.
+  * @param  size: Size of the handle
+  * @retval Block, NULL if size exceeds the block size or the pool is empty
+  */
+void *USBD_static_malloc(uint32_t size)
+{
+  void *p = NULL;
+  uint32_t primask;
+  uint8_t i;
+
+  if (size > sizeof(USBD_StaticPool[0]))
+  {
+    USBD_ErrLog("USBD_static_malloc: %d bytes exceed the block size", size);
+    return NULL;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (USBD_StaticInit == 0)
+  {
+    for (i = 0; i < USBD_STATIC_POOL_BLOCKS; i++)
+    {
+      USBD_StaticFree[i] = USBD_STATIC_POOL_BLOCKS - 1 - i;
+    }
+    USBD_StaticFreeCount = USBD_STATIC_POOL_BLOCKS;
+    USBD_StaticInit = 1;
+  }
+  if (USBD_StaticFreeCount != 0)
+  {
+    i = USBD_StaticFree[--USBD_StaticFreeCount];
+    p = USBD_StaticPool[i];
+#if (USBD_DEBUG_LEVEL > 0)
+    USBD_StaticInUse[i] = 1;
+#endif
+    if ((USBD_STATIC_POOL_BLOCKS - USBD_StaticFreeCount) > USBD_StaticHighWater)
+    {
+      USBD_StaticHighWater = USBD_STATIC_POOL_BLOCKS - USBD_StaticFreeCount;
+    }
+  }
+  __set_PRIMASK(primask);
+
+  return p;
+}
+
+/**
+  * @brief  Returns a class handle to the static pool. With USBD_DEBUG_LEVEL
+  *         above 0, pointers outside the pool and double frees are logged.
+  * @param  p: Block returned by USBD_static_malloc, NULL is ignored
+  * @retval None
+  */
+void USBD_static_free(void *p)
+{
+  uint32_t offset = (uint32_t)((uint8_t *)p - (uint8_t *)USBD_StaticPool);
+  uint32_t block = offset / sizeof(USBD_StaticPool[0]);
+  uint32_t primask;
+
+  if (p == NULL)
+  {
+    return;
+  }
+  if ((offset >= sizeof(USBD_StaticPool)) || ((offset % sizeof(USBD_StaticPool[0])) != 0))
+  {
+    USBD_ErrLog("USBD_static_free: %p is not a pool block", p);
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+#if (USBD_DEBUG_LEVEL > 0)
+  if (USBD_StaticInUse[block] == 0)
+  {
+    __set_PRIMASK(primask);
+    USBD_ErrLog("USBD_static_free: block %d freed twice", block);
+    return;
+  }
+  USBD_StaticInUse[block] = 0;
+#endif
+  if (USBD_StaticFreeCount < USBD_STATIC_POOL_BLOCKS)
+  {
+    USBD_StaticFree[USBD_StaticFreeCount++] = block;
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Returns the largest number of class handles allocated at once.
+  * @retval Blocks, out of USBD_STATIC_POOL_BLOCKS
+  */
+uint32_t USBD_static_highwater(void)
+{
+  return USBD_StaticHighWater;
+}
+
 /**
   * @brief  Delays routine for the USB Device Library.
   * @param  Delay: Delay in ms
@@ -803,7 +2201,7 @@ void  USBD_LL_Delay (uint32_t Delay)
 //  /* USER CODE BEGIN OTG_FS_IRQn 0 */
 //
 //  /* USER CODE END OTG_FS_IRQn 0 */
-//  HAL_PCD_IRQHandler(&hpcd_USB_OTG_FS);
+//  USBD_LLEx_IRQHandler(&hpcd_USB_OTG_FS);
 //  /* USER CODE BEGIN OTG_FS_IRQn 1 */
 //
 //  /* USER CODE END OTG_FS_IRQn 1 */
@@ -137,10 +137,12 @@ __ALIGN_BEGIN uint8_t USBD_FS_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END =
   {
     0x12,                       /*bLength */
     USB_DESC_TYPE_DEVICE,       /*bDescriptorType*/
-#if (USBD_LPM_ENABLED == 1)
+#if (USBD_LPM_ENABLED == 1) || (USBD_VENDOR_FUNCTION == 1)
     0x01,                       /*bcdUSB */ /* changed to USB version 2.01 
                                                in order to support LPM L1 suspend
-                                               resume test of USBCV3.0*/
+                                               resume test of USBCV3.0, and for
+                                               the host to read the BOS of the
+                                               vendor function */
 #else  
     0x00,                       /* bcdUSB */
 #endif
@@ -0,0 +1,229 @@
+/**
+  ******************************************************************************
+  * @file    usbd_log.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Deferred binary logging backend of USBD_UsrLog, USBD_ErrLog and
+  *          USBD_DbgLog.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_log.h"
+#if (USBD_LOG_FLUSH_TASK == 1)
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_LOG
+  * @brief Deferred binary logging
+  * @{
+  */
+
+#if (USBD_DEBUG_LEVEL > 0) && (USBD_LOG_DEFERRED == 1)
+
+#if ((USBD_LOG_DEPTH & (USBD_LOG_DEPTH - 1)) != 0)
+#error "USBD_LOG_DEPTH must be a power of two"
+#endif
+
+/** @defgroup USBD_LOG_Private_Defines
+  * @{
+  */
+#ifndef configUSBD_LOG_TASK_STACK_SIZE
+#define configUSBD_LOG_TASK_STACK_SIZE  ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#ifndef configUSBD_LOG_TASK_PRIORITY
+#define configUSBD_LOG_TASK_PRIORITY    ( tskIDLE_PRIORITY )
+#endif
+
+#ifndef configUSBD_LOG_TASK_PERIOD_MS
+#define configUSBD_LOG_TASK_PERIOD_MS   100
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_LOG_Private_Variables
+  * @{
+  */
+/* Statically initialized so that messages logged before USBD_Log_Init are
+kept, their timestamps are 0 if the cycle counter is not running yet */
+USBD_Log_RingTypeDef USBD_Log =
+{
+  .magic = USBD_LOG_MAGIC,
+  .version = USBD_LOG_VERSION,
+  .entry_size = sizeof(USBD_Log_EntryTypeDef),
+  .depth = USBD_LOG_DEPTH,
+};
+
+static const char * const USBD_Log_Prefix[] = { "", "ERROR: ", "DEBUG : " };
+static uint32_t USBD_Log_Last = 0;
+/**
+  * @}
+  */
+
+/** @defgroup USBD_LOG_Private_Functions
+  * @{
+  */
+#if (USBD_LOG_FLUSH_TASK == 1)
+/**
+  * @brief  Log task: formats the pending messages periodically.
+  * @param  pvParameters: Not used
+  * @retval None
+  */
+static void USBD_Log_Task(void *pvParameters)
+{
+  (void)pvParameters;
+
+  for (;;)
+  {
+    USBD_Log_Flush();
+    vTaskDelay(pdMS_TO_TICKS(configUSBD_LOG_TASK_PERIOD_MS));
+  }
+}
+#endif
+
+/**
+  * @brief  Starts the DWT cycle counter used for timestamps and the log task.
+  * @retval None
+  */
+void USBD_Log_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  USBD_Log.clock = SystemCoreClock;
+
+#if (USBD_LOG_FLUSH_TASK == 1)
+  xTaskCreate(USBD_Log_Task, "USBDLog", configUSBD_LOG_TASK_STACK_SIZE, NULL,
+              configUSBD_LOG_TASK_PRIORITY, NULL);
+#endif
+}
+
+/**
+  * @brief  Stores a message in the ring. Callable from any context, use the
+  *         USBD_LOG macro.
+  * @param  level: USBD_LOG_LEVEL_xxx
+  * @param  fmt: printf format string, must stay valid
+  * @param  argc: Number of meaningful arguments
+  * @param  a0: First argument
+  * @param  a1: Second argument
+  * @param  a2: Third argument
+  * @param  a3: Fourth argument
+  * @retval None
+  */
+void USBD_Log_Write(uint8_t level, const char *fmt, uint8_t argc,
+                    uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+  USBD_Log_EntryTypeDef *entry;
+  uint32_t seq;
+
+  /* Reserve the slot, an interrupting writer takes the next one */
+  do
+  {
+    seq = __LDREXW(&USBD_Log.seq);
+  } while (__STREXW(seq + 1, &USBD_Log.seq) != 0);
+
+  entry = &USBD_Log.entry[seq & (USBD_LOG_DEPTH - 1)];
+  entry->seq = 0;
+  __DMB();
+  entry->timestamp = DWT->CYCCNT;
+  entry->fmt = fmt;
+  entry->level = level;
+  entry->argc = argc;
+  entry->arg[0] = a0;
+  entry->arg[1] = a1;
+  entry->arg[2] = a2;
+  entry->arg[3] = a3;
+  __DMB();
+  entry->seq = seq + 1;
+}
+
+/**
+  * @brief  Formats the pending messages with printf, oldest first. Must not
+  *         be called from several contexts at once.
+  * @retval Number of messages printed
+  */
+uint32_t USBD_Log_Flush(void)
+{
+  USBD_Log_EntryTypeDef copy;
+  USBD_Log_EntryTypeDef *entry;
+  uint32_t rd = USBD_Log.rd;
+  uint32_t seq = USBD_Log.seq;
+  uint32_t lost = 0;
+  uint32_t printed = 0;
+  uint32_t clock = (USBD_Log.clock != 0) ? USBD_Log.clock : 1000000;
+
+  if (seq - rd > USBD_LOG_DEPTH)
+  {
+    lost += seq - rd - USBD_LOG_DEPTH;
+    rd = seq - USBD_LOG_DEPTH;
+  }
+
+  while (rd != seq)
+  {
+    entry = &USBD_Log.entry[rd & (USBD_LOG_DEPTH - 1)];
+    copy.seq = entry->seq;
+    if (copy.seq == 0)
+    {
+      /* Still being written, resume from here next time */
+      break;
+    }
+
+    __DMB();
+    copy.timestamp = entry->timestamp;
+    copy.fmt = entry->fmt;
+    copy.level = entry->level;
+    copy.arg[0] = entry->arg[0];
+    copy.arg[1] = entry->arg[1];
+    copy.arg[2] = entry->arg[2];
+    copy.arg[3] = entry->arg[3];
+    __DMB();
+
+    if ((copy.seq != rd + 1) || (entry->seq != copy.seq))
+    {
+      /* Overwritten by a newer message */
+      lost++;
+      rd++;
+      continue;
+    }
+
+    /* Time since the previous message, the cycle counter wraps too fast
+    for absolute times */
+    printf("[+%9lu us] %s", (unsigned long)((uint64_t)(copy.timestamp - USBD_Log_Last) * 1000000 / clock),
+           USBD_Log_Prefix[(copy.level <= USBD_LOG_LEVEL_DBG) ? copy.level : 0]);
+    USBD_Log_Last = copy.timestamp;
+    printf(copy.fmt, copy.arg[0], copy.arg[1], copy.arg[2], copy.arg[3]);
+    printf("\n");
+    printed++;
+    rd++;
+  }
+
+  if (lost != 0)
+  {
+    USBD_Log.lost += lost;
+    printf("USBD log: %lu messages lost\n", (unsigned long)lost);
+  }
+  USBD_Log.rd = rd;
+  return printed;
+}
+/**
+  * @}
+  */
+
+#endif /* USBD_LOG_DEFERRED */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,600 @@
+/**
+  ******************************************************************************
+  * @file    usbd_msc_cache.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Block cache between the mass storage function and its storage.
+  *          The cache is made of lines of one erase unit each:
+  *           - Small reads, the FAT and directory blocks hosts read again
+  *             and again, fill a whole line with one storage access and are
+  *             then served from RAM.
+  *           - Sequential reads are detected and the next line read ahead
+  *             while the data goes out on the bus.
+  *           - Small writes are kept and written back one whole line per
+  *             storage access, on replacement, when idle or on sync.
+  *           - Whole lines go straight between the host and the storage.
+  *          Free of FreeRTOS and HAL dependencies so that
+  *          Tools/msc_cache_bench builds on the host. Not reentrant: every
+  *          call is made from the media task of usbd_msc_if.c.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_msc_cache.h"
+#include <string.h>
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_MSC_CACHE
+  * @brief Read-ahead and write-back block cache of the mass storage
+  * @{
+  */
+
+/** @defgroup USBD_MSC_CACHE_Private_FunctionPrototypes
+  * @{
+  */
+static uint32_t USBD_MSC_Cache_Mask    (uint16_t first, uint16_t count);
+static uint16_t USBD_MSC_Cache_Count   (uint32_t mask);
+static uint8_t *USBD_MSC_Cache_Data    (USBD_MSC_CacheTypeDef *pCache, uint16_t idx, uint16_t blk);
+static uint16_t USBD_MSC_Cache_Find    (USBD_MSC_CacheTypeDef *pCache, uint8_t lun, uint32_t blk_addr);
+static uint16_t USBD_MSC_Cache_Alloc   (USBD_MSC_CacheTypeDef *pCache, uint8_t lun, uint32_t blk_addr);
+static int8_t   USBD_MSC_Cache_Fill    (USBD_MSC_CacheTypeDef *pCache, uint16_t idx, uint32_t mask);
+static int8_t   USBD_MSC_Cache_Runs    (USBD_MSC_CacheTypeDef *pCache, uint16_t idx, uint32_t mask, uint8_t write);
+static void     USBD_MSC_Cache_Clean   (USBD_MSC_CacheTypeDef *pCache, uint16_t idx);
+/**
+  * @}
+  */
+
+/** @defgroup USBD_MSC_CACHE_Private_Functions
+  * @{
+  */
+/**
+  * @brief  Mask of count blocks from first
+  * @param  first: first block in the line
+  * @param  count: number of blocks, up to USBD_MSC_CACHE_MAX_LINE_BLOCKS
+  * @retval mask
+  */
+static uint32_t USBD_MSC_Cache_Mask(uint16_t first, uint16_t count)
+{
+  if (count >= 32)
+  {
+    return 0xFFFFFFFFU;
+  }
+  return ((1U << count) - 1U) << first;
+}
+
+/**
+  * @brief  Number of blocks in a mask
+  * @param  mask: block mask
+  * @retval count
+  */
+static uint16_t USBD_MSC_Cache_Count(uint32_t mask)
+{
+  uint16_t count = 0;
+
+  while (mask != 0)
+  {
+    mask &= mask - 1U;
+    count++;
+  }
+  return count;
+}
+
+/**
+  * @brief  Data of a block held in a line
+  * @param  pCache: cache
+  * @param  idx: line
+  * @param  blk: block in the line
+  * @retval block data
+  */
+static uint8_t *USBD_MSC_Cache_Data(USBD_MSC_CacheTypeDef *pCache, uint16_t idx, uint16_t blk)
+{
+  return pCache->pData + ((uint32_t)idx * pCache->line_blocks + blk) * pCache->blk_size;
+}
+
+/**
+  * @brief  Line holding a block
+  * @param  pCache: cache
+  * @param  lun: Logical unit number
+  * @param  blk_addr: first block of the line
+  * @retval line, pCache->lines if none
+  */
+static uint16_t USBD_MSC_Cache_Find(USBD_MSC_CacheTypeDef *pCache, uint8_t lun, uint32_t blk_addr)
+{
+  uint16_t idx;
+
+  for (idx = 0; idx < pCache->lines; idx++)
+  {
+    if ((pCache->pLine[idx].used != 0) &&
+        (pCache->pLine[idx].blk_addr == blk_addr) &&
+        (pCache->pLine[idx].lun == lun))
+    {
+      break;
+    }
+  }
+  return idx;
+}
+
+/**
+  * @brief  Take a line for blk_addr: a free one, or the least recently used
+  *         one once written back
+  * @param  pCache: cache
+  * @param  lun: Logical unit number
+  * @param  blk_addr: first block of the line
+  * @retval line, empty
+  */
+static uint16_t USBD_MSC_Cache_Alloc(USBD_MSC_CacheTypeDef *pCache, uint8_t lun, uint32_t blk_addr)
+{
+  USBD_MSC_CacheLineTypeDef *pLine;
+  uint16_t victim = 0;
+  uint16_t idx;
+
+  for (idx = 0; idx < pCache->lines; idx++)
+  {
+    if (pCache->pLine[idx].used == 0)
+    {
+      victim = idx;
+      break;
+    }
+    if (pCache->pLine[idx].stamp < pCache->pLine[victim].stamp)
+    {
+      victim = idx;
+    }
+  }
+
+  USBD_MSC_Cache_Clean(pCache, victim);
+
+  pLine = &pCache->pLine[victim];
+  pLine->blk_addr = blk_addr;
+  pLine->lun = lun;
+  pLine->valid = 0;
+  pLine->dirty = 0;
+  pLine->stamp = ++pCache->clock;
+  pLine->used = 1;
+  return victim;
+}
+
+/**
+  * @brief  Read or write the blocks of a mask, one storage access per run
+  *         of consecutive blocks
+  * @param  pCache: cache
+  * @param  idx: line
+  * @param  mask: blocks
+  * @param  write: 0 reads them into the line, 1 writes them from it
+  * @retval 0, or -1 if an access failed
+  */
+static int8_t USBD_MSC_Cache_Runs(USBD_MSC_CacheTypeDef *pCache, uint16_t idx, uint32_t mask, uint8_t write)
+{
+  USBD_MSC_CacheLineTypeDef *pLine = &pCache->pLine[idx];
+  uint16_t first = 0;
+  uint16_t last;
+  int8_t ret;
+
+  while (first < pCache->line_blocks)
+  {
+    if ((mask & (1U << first)) == 0)
+    {
+      first++;
+      continue;
+    }
+    last = first;
+    while ((last < pCache->line_blocks) && ((mask & (1U << last)) != 0))
+    {
+      last++;
+    }
+
+    if (write != 0)
+    {
+      ret = pCache->Write(pLine->lun, USBD_MSC_Cache_Data(pCache, idx, first),
+                          pLine->blk_addr + first, last - first);
+    }
+    else
+    {
+      ret = pCache->Read(pLine->lun, USBD_MSC_Cache_Data(pCache, idx, first),
+                         pLine->blk_addr + first, last - first);
+      if (ret == 0)
+      {
+        pLine->valid |= USBD_MSC_Cache_Mask(first, last - first);
+      }
+    }
+    if (ret != 0)
+    {
+      return -1;
+    }
+    first = last;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Read the blocks of a mask the line does not hold yet. Blocks
+  *         not written back are never read over.
+  * @param  pCache: cache
+  * @param  idx: line
+  * @param  mask: blocks needed
+  * @retval 0, or -1 if a read failed
+  */
+static int8_t USBD_MSC_Cache_Fill(USBD_MSC_CacheTypeDef *pCache, uint16_t idx, uint32_t mask)
+{
+  return USBD_MSC_Cache_Runs(pCache, idx, mask & ~pCache->pLine[idx].valid, 0);
+}
+
+/**
+  * @brief  Write back a line. The blocks it misses are read first so that
+  *         the storage gets the whole erase unit in one access; when they
+  *         cannot be read only the dirty blocks are written.
+  * @param  pCache: cache
+  * @param  idx: line
+  * @retval None, a failure is kept for USBD_MSC_Cache_Sync
+  */
+static void USBD_MSC_Cache_Clean(USBD_MSC_CacheTypeDef *pCache, uint16_t idx)
+{
+  USBD_MSC_CacheLineTypeDef *pLine = &pCache->pLine[idx];
+  uint32_t full = USBD_MSC_Cache_Mask(0, pCache->line_blocks);
+  int8_t ret;
+
+  if ((pLine->used == 0) || (pLine->dirty == 0))
+  {
+    return;
+  }
+
+  if (USBD_MSC_Cache_Fill(pCache, idx, full) == 0)
+  {
+    ret = pCache->Write(pLine->lun, USBD_MSC_Cache_Data(pCache, idx, 0),
+                        pLine->blk_addr, pCache->line_blocks);
+  }
+  else
+  {
+    ret = USBD_MSC_Cache_Runs(pCache, idx, pLine->dirty, 1);
+  }
+
+  if (ret != 0)
+  {
+    pCache->error = -1;
+    pCache->stats.errors++;
+  }
+  else
+  {
+    pCache->stats.write_backs++;
+  }
+  pLine->dirty = 0;
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_MSC_CACHE_Exported_Functions
+  * @{
+  */
+/**
+  * @brief  Initialize a cache, empty
+  * @param  pCache: cache
+  * @param  Read: storage read
+  * @param  Write: storage write
+  * @param  pLine: lines array
+  * @param  lines: number of lines
+  * @param  line_blocks: blocks per line, the erase unit of the storage, up
+  *         to USBD_MSC_CACHE_MAX_LINE_BLOCKS
+  * @param  pData: line data, lines * line_blocks * blk_size bytes
+  * @param  blk_size: block size of the storage
+  * @retval None
+  */
+void USBD_MSC_Cache_Init(USBD_MSC_CacheTypeDef *pCache,
+                         USBD_MSC_CacheIoTypeDef Read,
+                         USBD_MSC_CacheIoTypeDef Write,
+                         USBD_MSC_CacheLineTypeDef *pLine,
+                         uint16_t lines,
+                         uint16_t line_blocks,
+                         uint8_t *pData,
+                         uint16_t blk_size)
+{
+  memset(pCache, 0, sizeof(*pCache));
+  memset(pLine, 0, lines * sizeof(*pLine));
+  pCache->Read = Read;
+  pCache->Write = Write;
+  pCache->pLine = pLine;
+  pCache->lines = lines;
+  pCache->line_blocks = line_blocks;
+  pCache->pData = pData;
+  pCache->blk_size = blk_size;
+}
+
+/**
+  * @brief  Read blocks. A line missing a block is filled whole, whole
+  *         lines not held are read directly into buf in one access. A read following the
+  *         previous one up to the end of a line sets up the read ahead of
+  *         the next line.
+  * @param  pCache: cache
+  * @param  lun: Logical unit number
+  * @param  buf: destination
+  * @param  blk_addr: first block
+  * @param  blk_len: number of blocks
+  * @retval 0, or -1 if the storage failed
+  */
+int8_t USBD_MSC_Cache_Read(USBD_MSC_CacheTypeDef *pCache, uint8_t lun,
+                           uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+{
+  USBD_MSC_CacheLineTypeDef *pLine;
+  uint8_t sequential = (lun == pCache->seq_lun) && (blk_addr == pCache->seq_next);
+  uint8_t line_end = (blk_addr % pCache->line_blocks) + blk_len >= pCache->line_blocks;
+  uint32_t full = USBD_MSC_Cache_Mask(0, pCache->line_blocks);
+  uint32_t missing;
+  uint16_t offset;
+  uint16_t count;
+  uint16_t idx;
+
+  pCache->seq_lun = lun;
+  pCache->seq_next = blk_addr + blk_len;
+
+  while (blk_len != 0)
+  {
+    offset = blk_addr % pCache->line_blocks;
+    count = pCache->line_blocks - offset;
+    if (count > blk_len)
+    {
+      count = blk_len;
+    }
+    idx = USBD_MSC_Cache_Find(pCache, lun, blk_addr - offset);
+
+    if ((idx == pCache->lines) && (count == pCache->line_blocks))
+    {
+      /* Every following whole line not held in the same access */
+      while ((count + pCache->line_blocks <= blk_len) &&
+             (USBD_MSC_Cache_Find(pCache, lun, blk_addr + count) == pCache->lines))
+      {
+        count += pCache->line_blocks;
+      }
+      if (pCache->Read(lun, buf, blk_addr, count) != 0)
+      {
+        return -1;
+      }
+      pCache->stats.read_misses += count;
+      pCache->stats.bypassed += count;
+    }
+    else
+    {
+      if (idx == pCache->lines)
+      {
+        idx = USBD_MSC_Cache_Alloc(pCache, lun, blk_addr - offset);
+      }
+      pLine = &pCache->pLine[idx];
+
+      missing = USBD_MSC_Cache_Mask(offset, count) & ~pLine->valid;
+      if (missing != 0)
+      {
+        /* The whole line in one access, or at least the blocks asked
+        for when the line runs past the end of the storage */
+        if ((USBD_MSC_Cache_Fill(pCache, idx, full) != 0) &&
+            (USBD_MSC_Cache_Fill(pCache, idx, missing) != 0))
+        {
+          return -1;
+        }
+        pCache->stats.read_misses += USBD_MSC_Cache_Count(missing);
+      }
+      pCache->stats.read_hits += count - USBD_MSC_Cache_Count(missing);
+
+      memcpy(buf, USBD_MSC_Cache_Data(pCache, idx, offset), (uint32_t)count * pCache->blk_size);
+
+      /* A line streamed through is the first to go */
+      pLine->stamp = (sequential && (offset + count == pCache->line_blocks)) ? 0 : ++pCache->clock;
+    }
+
+    buf += (uint32_t)count * pCache->blk_size;
+    blk_addr += count;
+    blk_len -= count;
+  }
+
+  /* Only once the stream leaves a line, small reads next to each other
+  in the FAT are not a stream */
+  if (sequential && line_end)
+  {
+    pCache->ahead = 1;
+    pCache->ahead_lun = lun;
+    pCache->ahead_addr = pCache->seq_next - (pCache->seq_next % pCache->line_blocks);
+  }
+  return 0;
+}
+
+/**
+  * @brief  Write blocks. Whole lines are written through, consecutive
+  *         ones in one access, the other blocks are kept until written back.
+  * @param  pCache: cache
+  * @param  lun: Logical unit number
+  * @param  buf: source
+  * @param  blk_addr: first block
+  * @param  blk_len: number of blocks
+  * @retval 0, or -1 if the storage failed
+  */
+int8_t USBD_MSC_Cache_Write(USBD_MSC_CacheTypeDef *pCache, uint8_t lun,
+                            uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+{
+  USBD_MSC_CacheLineTypeDef *pLine;
+  uint32_t mask;
+  uint16_t offset;
+  uint16_t count;
+  uint16_t line;
+  uint16_t idx;
+  int8_t ret;
+
+  pCache->stats.write_blocks += blk_len;
+
+  while (blk_len != 0)
+  {
+    offset = blk_addr % pCache->line_blocks;
+    count = pCache->line_blocks - offset;
+    if (count > blk_len)
+    {
+      count = blk_len;
+    }
+
+    if (count == pCache->line_blocks)
+    {
+      /* Every following whole line in the same access */
+      while (count + pCache->line_blocks <= blk_len)
+      {
+        count += pCache->line_blocks;
+      }
+      ret = pCache->Write(lun, buf, blk_addr, count);
+
+      /* The lines held get the new data, or are dropped on failure since
+      every block of them was to be replaced */
+      for (line = 0; line < count; line += pCache->line_blocks)
+      {
+        idx = USBD_MSC_Cache_Find(pCache, lun, blk_addr + line);
+        if (idx == pCache->lines)
+        {
+          continue;
+        }
+        pLine = &pCache->pLine[idx];
+        if (ret != 0)
+        {
+          pLine->used = 0;
+        }
+        else
+        {
+          memcpy(USBD_MSC_Cache_Data(pCache, idx, 0), buf + (uint32_t)line * pCache->blk_size,
+                 (uint32_t)pCache->line_blocks * pCache->blk_size);
+          pLine->valid = USBD_MSC_Cache_Mask(0, pCache->line_blocks);
+        }
+        pLine->dirty = 0;
+      }
+      if (ret != 0)
+      {
+        return -1;
+      }
+      pCache->stats.bypassed += count;
+    }
+    else
+    {
+      idx = USBD_MSC_Cache_Find(pCache, lun, blk_addr - offset);
+      if (idx == pCache->lines)
+      {
+        idx = USBD_MSC_Cache_Alloc(pCache, lun, blk_addr - offset);
+      }
+      pLine = &pCache->pLine[idx];
+      mask = USBD_MSC_Cache_Mask(offset, count);
+
+      memcpy(USBD_MSC_Cache_Data(pCache, idx, offset), buf, (uint32_t)count * pCache->blk_size);
+      pLine->valid |= mask;
+      pLine->dirty |= mask;
+      pLine->stamp = ++pCache->clock;
+    }
+
+    buf += (uint32_t)count * pCache->blk_size;
+    blk_addr += count;
+    blk_len -= count;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Read ahead the line following a sequential read, or the one
+  *         after when held already, once the read is done and nothing else
+  *         is waiting. A failure, past the
+  *         end of the storage for instance, is ignored.
+  * @param  pCache: cache
+  * @retval 1 if the storage was accessed, 0 if there was nothing to do
+  */
+uint8_t USBD_MSC_Cache_ReadAhead(USBD_MSC_CacheTypeDef *pCache)
+{
+  USBD_MSC_CacheLineTypeDef *pLine;
+  uint32_t full = USBD_MSC_Cache_Mask(0, pCache->line_blocks);
+  uint16_t held;
+  uint16_t idx;
+
+  if (pCache->ahead == 0)
+  {
+    return 0;
+  }
+  pCache->ahead = 0;
+
+  /* An unaligned stream has filled the line it stopped in already */
+  idx = USBD_MSC_Cache_Find(pCache, pCache->ahead_lun, pCache->ahead_addr);
+  if ((idx != pCache->lines) && (pCache->pLine[idx].valid == full))
+  {
+    pCache->ahead_addr += pCache->line_blocks;
+    idx = USBD_MSC_Cache_Find(pCache, pCache->ahead_lun, pCache->ahead_addr);
+  }
+  if (idx == pCache->lines)
+  {
+    idx = USBD_MSC_Cache_Alloc(pCache, pCache->ahead_lun, pCache->ahead_addr);
+  }
+  else if (pCache->pLine[idx].valid == full)
+  {
+    return 0;
+  }
+  pLine = &pCache->pLine[idx];
+
+  held = USBD_MSC_Cache_Count(pLine->valid);
+  USBD_MSC_Cache_Fill(pCache, idx, full);
+  pCache->stats.read_ahead += USBD_MSC_Cache_Count(pLine->valid) - held;
+  pLine->stamp = ++pCache->clock;
+  return 1;
+}
+
+/**
+  * @brief  Write back every line, when idle
+  * @param  pCache: cache
+  * @retval None
+  */
+void USBD_MSC_Cache_WriteBack(USBD_MSC_CacheTypeDef *pCache)
+{
+  uint16_t idx;
+
+  for (idx = 0; idx < pCache->lines; idx++)
+  {
+    USBD_MSC_Cache_Clean(pCache, idx);
+  }
+}
+
+/**
+  * @brief  Write back every line for SYNCHRONIZE CACHE
+  * @param  pCache: cache
+  * @retval 0, or -1 if a write-back failed since the previous sync
+  */
+int8_t USBD_MSC_Cache_Sync(USBD_MSC_CacheTypeDef *pCache)
+{
+  int8_t ret;
+
+  USBD_MSC_Cache_WriteBack(pCache);
+  ret = pCache->error;
+  pCache->error = 0;
+  return ret;
+}
+
+/**
+  * @brief  Whether a line is waiting to be written back
+  * @param  pCache: cache
+  * @retval 1 if so
+  */
+uint8_t USBD_MSC_Cache_IsDirty(USBD_MSC_CacheTypeDef *pCache)
+{
+  uint16_t idx;
+
+  for (idx = 0; idx < pCache->lines; idx++)
+  {
+    if ((pCache->pLine[idx].used != 0) && (pCache->pLine[idx].dirty != 0))
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
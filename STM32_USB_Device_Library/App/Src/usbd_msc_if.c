@@ -0,0 +1,289 @@
+/**
+ ******************************************************************************
+ * @file    usbd_msc_if.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   Storage accesses of the mass storage function. The class hands
+ *          each READ(10)/WRITE(10) chunk to Submit from the USB interrupt;
+ *          a task runs it on the storage of usbd_storage_if.c, or the RAM
+ *          disk of usbd_ramdisk_if.c, and reports it back, so the bus keeps
+ *          moving the other media buffer meanwhile. With MSC_CACHE_BLOCKS
+ *          the accesses go through the block cache of usbd_msc_cache.c,
+ *          which the task reads ahead into and writes back when idle.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_msc_if.h"
+#include "../inc/usbd_storage_if.h"
+#include "../inc/usbd_ramdisk_if.h"
+#include "../inc/usbd_msc_cache.h"
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if (USBD_MSC_FUNCTION == 1)
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup USBD_MSC_IF
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_MSC_IF_Private_Defines
+ * @{
+ */
+/* The storage driver polls the card from this task, it runs below the
+deferred interrupt tasks so that the network keeps going during long
+transfers - but allow both to be overridden in FreeRTOSConfig.h. */
+#ifndef configMSC_TASK_STACK_SIZE
+#define configMSC_TASK_STACK_SIZE ( 2 * configMINIMAL_STACK_SIZE )
+#endif
+
+#ifndef configMSC_TASK_PRIORITY
+#define configMSC_TASK_PRIORITY ( configMAX_PRIORITIES - 2 )
+#endif
+
+/* Quiet time after which the cache writes its lines back, the host may
+write the same FAT and directory blocks again meanwhile. */
+#ifndef configMSC_CACHE_WRITEBACK_MS
+#define configMSC_CACHE_WRITEBACK_MS 250
+#endif
+
+#if (MSC_RAMDISK_BLOCKS > 0)
+#define MSC_STORAGE_FOPS		USBD_RamDisk_fops_FS
+#else
+#define MSC_STORAGE_FOPS		USBD_Storage_Interface_fops_FS
+#endif
+
+/* The storage must have 512 byte blocks, as SD cards do */
+#define MSC_CACHE_BLK_SIZE		512
+#define MSC_CACHE_LINES			(MSC_CACHE_BLOCKS / MSC_CACHE_LINE_BLOCKS)
+
+#if (MSC_CACHE_BLOCKS > 0)
+#if (MSC_CACHE_LINE_BLOCKS > USBD_MSC_CACHE_MAX_LINE_BLOCKS) || ((MSC_CACHE_BLOCKS % MSC_CACHE_LINE_BLOCKS) != 0)
+#error "MSC_CACHE_BLOCKS must be whole lines of up to USBD_MSC_CACHE_MAX_LINE_BLOCKS blocks"
+#endif
+#endif
+/**
+ * @}
+ */
+
+/** @defgroup USBD_MSC_IF_Private_Variables
+ * @{
+ */
+static TaskHandle_t xMSCTaskHandle = NULL;
+
+/* The access being run, the class submits one at a time */
+static USBD_MSC_MediaReqTypeDef * volatile pxMediaReq = NULL;
+
+#if (MSC_CACHE_BLOCKS > 0)
+static USBD_MSC_CacheTypeDef xCache;
+static USBD_MSC_CacheLineTypeDef xCacheLine[MSC_CACHE_LINES];
+static uint32_t ulCacheData[MSC_CACHE_BLOCKS * MSC_CACHE_BLK_SIZE / 4];
+#endif
+/**
+ * @}
+ */
+
+/** @defgroup USBD_MSC_IF_Exported_Variables
+ * @{
+ */
+extern USBD_HandleTypeDef hUsbDeviceFS;
+/**
+ * @}
+ */
+
+/** @defgroup USBD_MSC_IF_Private_FunctionPrototypes
+ * @{
+ */
+static int8_t MSC_Init_FS     (void);
+static int8_t MSC_DeInit_FS   (void);
+static int8_t MSC_Submit_FS   (USBD_MSC_MediaReqTypeDef *req);
+static int8_t prvMSCMediaAccess(USBD_MSC_MediaReqTypeDef *req);
+static TickType_t prvMSCMediaIdle(TickType_t xWaited);
+static void prvMSCMediaTask(void *pvParameters);
+/**
+ * @}
+ */
+
+USBD_MSC_ItfTypeDef USBD_MSC_Interface_fops_FS =
+{
+	MSC_Init_FS,
+	MSC_DeInit_FS,
+	MSC_Submit_FS,
+	&MSC_STORAGE_FOPS,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  MSC_Init_FS
+ *         Configured
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t MSC_Init_FS(void)
+{
+	return (USBD_OK);
+}
+
+/**
+ * @brief  MSC_DeInit_FS
+ *         Unconfigured, an access being run still completes and is dropped
+ *         by the class
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t MSC_DeInit_FS(void)
+{
+	return (USBD_OK);
+}
+
+/**
+ * @brief  MSC_Submit_FS
+ *         Hand an access to the task. Called from the USB interrupt, or
+ *         from the task itself when USBD_MSC_MediaCplt starts the next one.
+ * @param  req: the access, untouched by the class until completed
+ * @retval USBD_OK, USBD_FAIL without the task or with an access running
+ */
+static int8_t MSC_Submit_FS(USBD_MSC_MediaReqTypeDef *req)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	if((xMSCTaskHandle == NULL) || (pxMediaReq != NULL)){
+		return (USBD_FAIL);
+	}
+	pxMediaReq = req;
+
+	if(__get_IPSR() != 0){
+		vTaskNotifyGiveFromISR(xMSCTaskHandle, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	} else {
+		xTaskNotifyGive(xMSCTaskHandle);
+	}
+	return (USBD_OK);
+}
+
+/**
+ * @brief  prvMSCMediaAccess
+ *         Run an access on the storage, through the cache if any
+ * @param  req: the access
+ * @retval 0, or -1 if the storage failed
+ */
+static int8_t prvMSCMediaAccess(USBD_MSC_MediaReqTypeDef *req)
+{
+	switch(req->op){
+#if (MSC_CACHE_BLOCKS > 0)
+	case USBD_MSC_MEDIA_READ:
+		return USBD_MSC_Cache_Read(&xCache, req->lun, req->pbuf, req->blk_addr, req->blk_len);
+
+	case USBD_MSC_MEDIA_WRITE:
+		return USBD_MSC_Cache_Write(&xCache, req->lun, req->pbuf, req->blk_addr, req->blk_len);
+
+	case USBD_MSC_MEDIA_SYNC:
+		return USBD_MSC_Cache_Sync(&xCache);
+#else
+	case USBD_MSC_MEDIA_READ:
+		return MSC_STORAGE_FOPS.Read(req->lun, req->pbuf, req->blk_addr, req->blk_len);
+
+	case USBD_MSC_MEDIA_WRITE:
+		return MSC_STORAGE_FOPS.Write(req->lun, req->pbuf, req->blk_addr, req->blk_len);
+
+	case USBD_MSC_MEDIA_SYNC:
+		return 0;
+#endif
+	default:
+		return -1;
+	}
+}
+
+/**
+ * @brief  prvMSCMediaIdle
+ *         Nothing submitted: read ahead of a stream at once, write back once
+ *         the host stayed quiet for configMSC_CACHE_WRITEBACK_MS
+ * @param  xWaited: ticks waited for a submission, 0 right after one
+ * @retval ticks to wait next
+ */
+static TickType_t prvMSCMediaIdle(TickType_t xWaited)
+{
+#if (MSC_CACHE_BLOCKS > 0)
+	if(USBD_MSC_Cache_ReadAhead(&xCache)){
+		return 0;
+	}
+	if(xWaited == 0){
+		return USBD_MSC_Cache_IsDirty(&xCache) ? pdMS_TO_TICKS( configMSC_CACHE_WRITEBACK_MS ) : portMAX_DELAY;
+	}
+	USBD_MSC_Cache_WriteBack(&xCache);
+#endif
+	return portMAX_DELAY;
+}
+
+/**
+ * @brief  prvMSCMediaTask
+ *         Run the submitted accesses on the storage, and the cache work in
+ *         between
+ * @param  pvParameters: unused
+ * @retval None
+ */
+static void prvMSCMediaTask(void *pvParameters)
+{
+	USBD_MSC_MediaReqTypeDef *req;
+	TickType_t xWait = portMAX_DELAY;
+
+	for(;;){
+		if(ulTaskNotifyTake(pdTRUE, xWait) == 0){
+			xWait = prvMSCMediaIdle(xWait);
+			continue;
+		}
+
+		req = pxMediaReq;
+		if(req == NULL){
+			continue;
+		}
+		req->status = prvMSCMediaAccess(req);
+
+		/* Released first, the completion submits the next access */
+		pxMediaReq = NULL;
+		USBD_MSC_MediaCplt(&hUsbDeviceFS, req);
+		xWait = 0;
+	}
+}
+
+/**
+ * @brief  MSC_Start_FS
+ *         Initialize the storage and create the task, before USBD_Start
+ * @param  None
+ * @retval None
+ */
+void MSC_Start_FS(void)
+{
+	uint8_t lun;
+
+	for(lun = 0; lun <= (uint8_t)MSC_STORAGE_FOPS.GetMaxLun(); lun++){
+		MSC_STORAGE_FOPS.Init(lun);
+	}
+#if (MSC_CACHE_BLOCKS > 0)
+	USBD_MSC_Cache_Init(&xCache, MSC_STORAGE_FOPS.Read, MSC_STORAGE_FOPS.Write,
+			xCacheLine, MSC_CACHE_LINES, MSC_CACHE_LINE_BLOCKS,
+			(uint8_t *)ulCacheData, MSC_CACHE_BLK_SIZE);
+#endif
+	if(xMSCTaskHandle == NULL){
+		xTaskCreate( prvMSCMediaTask, "MSC", configMSC_TASK_STACK_SIZE, NULL, configMSC_TASK_PRIORITY, &xMSCTaskHandle );
+	}
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif /* USBD_MSC_FUNCTION */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,598 @@
+/**
+ ******************************************************************************
+ * @file    usbd_ncm_if.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   FreeRTOS+TCP network interface over the USB NCM class, built in
+ *          place of usbd_rndis_if.c when USBD_NET_CLASS is
+ *          USBD_NET_CLASS_NCM.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_ncm_if.h"
+#include "usbd_netops.h"
+#include "FreeRTOS.h"
+#include "list.h"
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "NetworkBufferManagement.h"
+#include "FreeRTOS_IP_Private.h"
+
+#if (USBD_NET_CLASS == USBD_NET_CLASS_NCM) && (USBD_CDC_FUNCTION == 0)
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup USBD_NCM_IF
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_NCM_IF_Private_Defines
+ * @{
+ */
+#define NCM_RX_NTBS			2	/* NTB buffers armed for reception in turn */
+#define DeviceID_8 ((uint8_t*)0x1FFF7A10)
+
+/* Received datagrams are copied out of the NTB, the network buffers need no
+headroom beyond ipBUFFER_PADDING */
+#define emacBUFFER_SIZE		( ( ipBUFFER_PADDING + ipTOTAL_ETHERNET_FRAME_SIZE + 31 ) & ~31UL )
+
+/* Events notified to the EMAC task */
+#define NCM_EVENT_RX			0x01UL	/* NTBs are in the receive buffers */
+/**
+ * @}
+ */
+
+/** @defgroup USBD_NCM_IF_Private_Variables
+ * @{
+ */
+/* Received NTBs, NCM_EVENT_RX tells the EMAC task about them.  An NTB is in
+ulRxNtb[n % NCM_RX_NTBS] while n is between ulRxTail and ulRxHead.  Reception
+is held, NAKing the host, while both buffers hold NTBs. */
+static uint32_t ulRxNtb[NCM_RX_NTBS][NCM_NTB_MAX_SIZE / 4];
+static uint16_t usRxSize[NCM_RX_NTBS];
+static volatile uint32_t ulRxHead=0;
+static volatile uint32_t ulRxTail=0;
+static volatile uint8_t ucRxStalled=0;
+static volatile uint8_t ucRxArmed=0;
+/* Set while the EMAC task waits for network buffers, the NTB it is on stays
+in its slot meanwhile */
+static volatile uint8_t ucRxFlowStalled=0;
+
+/* Frames are gathered into one NTB while the other is sent */
+static uint32_t ulTxNtb[2][NCM_NTB_MAX_SIZE / 4];
+
+static enum{
+	NCM_STATE_CONNECTED,
+	NCM_STATE_DISCONNECTED
+} ncm_state=NCM_STATE_DISCONNECTED;
+
+static NCM_StatsTypeDef ncm_stats;
+/**
+ * @}
+ */
+
+/** @defgroup USBD_NCM_IF_Exported_Variables
+ * @{
+ */
+extern USBD_HandleTypeDef hUsbDeviceFS;
+/**
+ * @}
+ */
+
+/** @defgroup USBD_NCM_IF_Private_FunctionPrototypes
+ * @{
+ */
+static int8_t NCM_Init_FS     (void);
+static int8_t NCM_DeInit_FS   (void);
+static int8_t NCM_Link_FS     (uint8_t up);
+static int8_t NCM_Receive_FS  (uint8_t* pbuf, uint32_t *Len);
+static int8_t NCM_TransmitCplt_FS  (uint8_t* pbuf, uint32_t *Len);
+static int8_t NCM_GetMacAddress_FS  (uint8_t* pbuf);
+/**
+ * @}
+ */
+
+static void prvEMACHandlerTask( void *pvParameters );
+static void prvRxProcess( void );
+static void prvRxDeliver( NetworkBufferDescriptor_t *pxFirst, UBaseType_t uxCount );
+static void prvRxRelease( void );
+static void prvRxArm( void );
+
+/* The default stack size, as in usbd_rndis_if.c */
+#ifndef configEMAC_TASK_STACK_SIZE
+#define configEMAC_TASK_STACK_SIZE ( 2 * configMINIMAL_STACK_SIZE )
+#endif
+
+/* Datagrams are only copied out of an NTB while more than
+configEMAC_RX_MIN_FREE_BUFFERS network buffers are free.  Below it the NTB
+stays in its slot, and once both are held the host is NAKed, so a burst is
+held back by USB instead of being dropped and retransmitted by TCP.  The EMAC
+task checks again every configEMAC_RX_POLL_PERIOD_MS meanwhile. */
+#ifndef configEMAC_RX_MIN_FREE_BUFFERS
+#define configEMAC_RX_MIN_FREE_BUFFERS 2
+#endif
+
+#ifndef configEMAC_RX_POLL_PERIOD_MS
+#define configEMAC_RX_POLL_PERIOD_MS 1
+#endif
+
+#define emacRX_POLL_TICKS ( pdMS_TO_TICKS( configEMAC_RX_POLL_PERIOD_MS ) > 0 ? pdMS_TO_TICKS( configEMAC_RX_POLL_PERIOD_MS ) : 1 )
+
+/* Holds the handle of the task used as a deferred interrupt processor.  The
+handle is used so direct notifications can be sent to the task for all USB
+related interrupts. */
+static TaskHandle_t xEMACTaskHandle = NULL;
+
+
+USBD_NCM_ItfTypeDef USBD_NCM_Interface_fops_FS =
+{
+		NCM_Init_FS,
+		NCM_DeInit_FS,
+		NCM_Link_FS,
+		NCM_Receive_FS,
+		NCM_TransmitCplt_FS,
+		NCM_GetMacAddress_FS
+};
+
+
+/* Private functions ---------------------------------------------------------*/
+
+static void NCM_Disconnect(void){
+	ncm_state=NCM_STATE_DISCONNECTED;
+	/* Reached from DeInit and Link(0), after the class aborted the OUT
+	endpoint, the NTB buffer armed is released */
+	ucRxArmed=0;
+	FreeRTOS_NetworkDownFromISR();
+}
+
+/**
+ * @brief  NCM_Init_FS
+ *         Initializes the NCM media low layer over the FS USB IP
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t NCM_Init_FS(void)
+{
+	USBD_NCM_SetTxBuffers(&hUsbDeviceFS, (uint8_t*)ulTxNtb[0], (uint8_t*)ulTxNtb[1]);
+	NCM_Disconnect();
+	return (USBD_OK);
+}
+
+/**
+ * @brief  NCM_DeInit_FS
+ *         DeInitializes the NCM media low layer
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t NCM_DeInit_FS(void)
+{
+	NCM_Disconnect();
+	return (USBD_OK);
+}
+
+/**
+ * @brief  NCM_Link_FS
+ *         Called from the USB interrupt when the host selects the data
+ *         interface, or leaves it
+ * @param  up: 1 for alternate setting 1, 0 for alternate setting 0
+ * @retval Result of the operation: USBD_OK
+ */
+static int8_t NCM_Link_FS(uint8_t up)
+{
+	/* The class aborted the NTB being received, its buffer is free again */
+	ucRxArmed=0;
+	if(up){
+		ncm_state=NCM_STATE_CONNECTED;
+		prvRxArm();
+	} else if(ncm_state==NCM_STATE_CONNECTED){
+		NCM_Disconnect();
+	}
+	return (USBD_OK);
+}
+
+/**
+ * @brief  NCM_Receive_FS
+ *         Called from the USB interrupt when an NTB has been received, the
+ *         EMAC task takes its datagrams.
+ * @param  Buf: Buffer of data received
+ * @param  Len: Number of data received (in bytes)
+ * @retval Result of the operation: USBD_OK
+ */
+static int8_t NCM_Receive_FS (uint8_t* Buf, uint32_t *Len)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	ucRxArmed=0;
+	if(xEMACTaskHandle==NULL){
+		/* The IP stack is not up yet, the buffer is armed again */
+		ncm_stats.RxDropNoTask++;
+		prvRxArm();
+	} else if(*Len==0){
+		prvRxArm();
+	} else {
+		usRxSize[ulRxHead % NCM_RX_NTBS]=*Len;
+		ulRxHead++;
+		ncm_stats.RxNtbs++;
+		prvRxArm();
+		xTaskNotifyFromISR(xEMACTaskHandle, NCM_EVENT_RX, eSetBits, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	}
+	return (USBD_OK);
+}
+
+/**
+ * @brief  NCM_Transmit_FS
+ *         Copies an Ethernet frame into the NTB sent next
+ * @param  Buf: Buffer of data to be send
+ * @param  Len: Number of data to be send (in bytes)
+ * @retval Result of the operation: USBD_OK, USBD_BUSY while both NTBs are
+ *         full, or USBD_FAIL
+ */
+uint8_t NCM_Transmit_FS(uint8_t* Buf, uint16_t Len)
+{
+	if(ncm_state!=NCM_STATE_CONNECTED){
+		return USBD_FAIL;
+	}
+	return USBD_NCM_TransmitFrame(&hUsbDeviceFS, Buf, Len);
+}
+
+/**
+ * @brief  NCM_TransmitCplt_FS
+ *         Called from the USB interrupt when an NTB has been sent or aborted
+ * @param  Buf: Buffer of data sent
+ * @param  Len: Number of data sent (in bytes)
+ * @retval Result of the operation: USBD_OK
+ */
+static int8_t NCM_TransmitCplt_FS (uint8_t* Buf, uint32_t *Len)
+{
+	ncm_stats.TxNtbs++;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  NCM_GetMacAddress_FS
+ *         Address of the host side of the link, from the device ID as the
+ *         RNDIS permanent address
+ * @param  Buf: 6 bytes
+ * @retval Result of the operation: USBD_OK
+ */
+static int8_t NCM_GetMacAddress_FS (uint8_t* Buf)
+{
+	Buf[0]=0x40;
+	Buf[1]=0x78;
+	Buf[2]=0x75;
+	Buf[3]=DeviceID_8[0];
+	Buf[4]=DeviceID_8[1];
+	Buf[5]=DeviceID_8[2];
+	return (USBD_OK);
+}
+
+/**
+ * @brief  NCM_GetStats
+ *         Copies the driver counters
+ * @param  pStats: Destination
+ * @retval None
+ */
+void NCM_GetStats(NCM_StatsTypeDef *pStats)
+{
+	taskENTER_CRITICAL();
+	*pStats=ncm_stats;
+	taskEXIT_CRITICAL();
+}
+
+BaseType_t xNetworkInterfaceInitialise( void ){
+	/* When returning non-zero, the stack will become active and
+    start DHCP (if configured) */
+	BaseType_t ret=0;
+
+	/* The deferred interrupt handler task is created at the highest
+	possible priority to ensure the interrupt handler can return directly
+	to it. */
+	if(ncm_state==NCM_STATE_CONNECTED){
+		ret=1;
+		if(xEMACTaskHandle==0){
+			xTaskCreate( prvEMACHandlerTask, "EMAC", configEMAC_TASK_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &xEMACTaskHandle );
+		}
+	}
+
+	return ret;
+}
+
+
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescriptor, BaseType_t xReleaseAfterSend  ){
+	uint8_t retries=0;
+	uint8_t result;
+
+	/* The frame is copied into the NTB being filled, which goes out as soon
+	as the IN endpoint is free.  Both are full only while the host is not
+	reading. */
+	while((result=NCM_Transmit_FS( pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength))==USBD_BUSY){
+		ncm_stats.TxBusy++;
+		vTaskDelay(1);
+		retries++;
+		if(retries>=10){
+			break;
+		}
+	}
+	if(result==USBD_OK){
+		ncm_stats.TxFrames++;
+	} else {
+		ncm_stats.TxDrop++;
+	}
+
+	/* Call the standard trace macro to log the send event. */
+	iptraceNETWORK_INTERFACE_TRANSMIT();
+
+	if( xReleaseAfterSend != pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+	}
+
+	return pdTRUE;
+}
+
+/**
+ * @brief  vNetworkInterfaceAllocateRAMToBuffers
+ *         Gives BufferAllocation_1 its statically allocated network buffers
+ * @param  pxNetworkBuffers: Descriptors to attach the buffers to
+ * @retval None
+ */
+void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ] ){
+	static uint8_t ucNetworkPackets[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ][ emacBUFFER_SIZE ] __attribute__ ( ( aligned( 32 ) ) );
+	BaseType_t x;
+
+	for( x = 0; x < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; x++ )
+	{
+		/* pucEthernetBuffer is preceded by a pointer back to its descriptor */
+		pxNetworkBuffers[ x ].pucEthernetBuffer = &( ucNetworkPackets[ x ][ ipBUFFER_PADDING ] );
+		*( ( NetworkBufferDescriptor_t ** ) &( ucNetworkPackets[ x ][ 0 ] ) ) = &( pxNetworkBuffers[ x ] );
+	}
+}
+
+BaseType_t xGetPhyLinkStatus( void ){
+		BaseType_t xReturn;
+
+		if( ncm_state == NCM_STATE_CONNECTED )
+		{
+			xReturn = pdPASS;
+		}
+		else
+		{
+			xReturn = pdFAIL;
+		}
+
+		return xReturn;
+}
+
+/**
+ * @brief  prvRxDeliver
+ *         Sends received frames to the IP task in a single event. Runs in
+ *         the EMAC task.
+ * @param  pxFirst: First network buffer, the next ones are linked through
+ *         pxNextBuffer when ipconfigUSE_LINKED_RX_MESSAGES is set
+ * @param  uxCount: Number of frames
+ * @retval None
+ */
+static void prvRxDeliver( NetworkBufferDescriptor_t *pxFirst, UBaseType_t uxCount )
+{
+	IPStackEvent_t xRxEvent;
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	NetworkBufferDescriptor_t *pxNext;
+#endif
+
+	xRxEvent.eEventType = eNetworkRxEvent;
+	xRxEvent.pvData = ( void * ) pxFirst;
+
+	if( xSendEventStructToIPTask( &xRxEvent, 0 ) == pdFALSE )
+	{
+		/* The buffers could not be sent to the IP task so they must be
+		released. */
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+		while( pxFirst != NULL )
+		{
+			pxNext = pxFirst->pxNextBuffer;
+			vReleaseNetworkBufferAndDescriptor( pxFirst );
+			pxFirst = pxNext;
+		}
+#else
+		vReleaseNetworkBufferAndDescriptor( pxFirst );
+#endif
+		ncm_stats.RxDropIpQueue+=uxCount;
+		iptraceETHERNET_RX_EVENT_LOST();
+	}
+	else
+	{
+		ncm_stats.RxFrames+=uxCount;
+		ncm_stats.RxBatches++;
+		iptraceNETWORK_INTERFACE_RECEIVE();
+	}
+}
+
+/**
+ * @brief  prvRxRelease
+ *         Gives the oldest NTB buffer back to the USB interrupt, and resumes
+ *         reception if it was held because both buffers were full.
+ * @retval None
+ */
+static void prvRxRelease( void )
+{
+	taskENTER_CRITICAL();
+	ulRxTail++;
+	if(ucRxStalled){
+		prvRxArm();
+	}
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief  prvRxArm
+ *         Prepares the reception of the next NTB, into the next free buffer.
+ *         Called from the USB interrupt, or with it masked.
+ * @retval None
+ */
+static void prvRxArm( void )
+{
+	if((ncm_state!=NCM_STATE_CONNECTED) || ucRxArmed){
+		return;
+	}
+	if(ulRxHead-ulRxTail >= NCM_RX_NTBS){
+		/* Both buffers hold NTBs, the EMAC task resumes reception */
+		ucRxStalled=1;
+		return;
+	}
+	ucRxStalled=0;
+	ucRxArmed=1;
+	USBD_NCM_ReceiveNtb(&hUsbDeviceFS, (uint8_t*)ulRxNtb[ulRxHead % NCM_RX_NTBS], NCM_NTB_MAX_SIZE);
+}
+
+/**
+ * @brief  prvRxProcess
+ *         Copies the datagrams of every NTB received so far into network
+ *         buffers and hands them to the IP task, releasing each NTB once
+ *         done with it.  Stops short, keeping its position, when network
+ *         buffers run low.  Runs in the EMAC task.
+ * @retval None
+ */
+static void prvRxProcess( void )
+{
+	/* Datagrams of the NTB at ulRxTail, usNext is the first one left */
+	static USBD_NCM_DatagramTypeDef xDatagrams[NCM_NTB_MAX_DATAGRAMS];
+	static uint16_t usCount=0, usNext=0;
+	static BaseType_t xParsed=pdFALSE;
+	NetworkBufferDescriptor_t *pxDescriptor;
+	NetworkBufferDescriptor_t *pxFirst=NULL;
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	NetworkBufferDescriptor_t *pxLast=NULL;
+#endif
+	UBaseType_t uxBatch=0;
+	uint8_t *pucNtb;
+	uint16_t usLength;
+
+	while( ulRxTail != ulRxHead )
+	{
+		pucNtb=( uint8_t * ) ulRxNtb[ ulRxTail % NCM_RX_NTBS ];
+		if( xParsed == pdFALSE )
+		{
+			usCount=NCM_NTB_MAX_DATAGRAMS;
+			switch( USBD_NCM_ParseNtb( pucNtb, usRxSize[ ulRxTail % NCM_RX_NTBS ], xDatagrams, &usCount ) )
+			{
+			case USBD_FAIL:
+				ncm_stats.RxDropMalformed++;
+				break;
+			case USBD_BUSY:
+				ncm_stats.RxDropOverflow++;
+				break;
+			default:
+				break;
+			}
+			usNext=0;
+			xParsed=pdTRUE;
+		}
+
+		for( ; usNext < usCount; usNext++ )
+		{
+			usLength=xDatagrams[ usNext ].Length;
+			if( ( usLength < ipSIZE_OF_ETH_HEADER ) || ( usLength > ipTOTAL_ETHERNET_FRAME_SIZE ) )
+			{
+				ncm_stats.RxDropMalformed++;
+				continue;
+			}
+
+			pxDescriptor=NULL;
+			if( uxGetNumberOfFreeNetworkBuffers() > configEMAC_RX_MIN_FREE_BUFFERS )
+			{
+				pxDescriptor=pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, 0 );
+			}
+			if( pxDescriptor == NULL )
+			{
+				/* Picked up again from here on the next poll */
+				if( !ucRxFlowStalled )
+				{
+					ucRxFlowStalled=1;
+					ncm_stats.RxFlowStalls++;
+				}
+				break;
+			}
+			ucRxFlowStalled=0;
+
+			USBD_NetOps_Copy( pxDescriptor->pucEthernetBuffer, pucNtb + xDatagrams[ usNext ].Offset, usLength );
+			pxDescriptor->xDataLength=usLength;
+
+			/* See if the data contained in the received Ethernet frame needs
+			to be processed. */
+			if( eConsiderFrameForProcessing( pxDescriptor->pucEthernetBuffer ) != eProcessBuffer )
+			{
+				vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+				ncm_stats.RxFiltered++;
+				continue;
+			}
+
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+			/* Chained, and handed to the IP task in one event */
+			pxDescriptor->pxNextBuffer=NULL;
+			if( pxFirst == NULL )
+			{
+				pxFirst=pxDescriptor;
+			}
+			else
+			{
+				pxLast->pxNextBuffer=pxDescriptor;
+			}
+			pxLast=pxDescriptor;
+			uxBatch++;
+#else
+			prvRxDeliver( pxDescriptor, 1 );
+#endif
+		}
+		if( usNext < usCount )
+		{
+			break;
+		}
+
+		/* Done with the NTB, reception continues into its buffer */
+		xParsed=pdFALSE;
+		prvRxRelease();
+	}
+
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	if( pxFirst != NULL )
+	{
+		prvRxDeliver( pxFirst, uxBatch );
+	}
+#else
+	( void ) pxFirst;
+	( void ) uxBatch;
+#endif
+}
+
+static void prvEMACHandlerTask( void *pvParameters ){
+	uint32_t ulEvents;
+
+	for( ;; )
+	{
+		/* Wait for the USB interrupt to indicate that NTBs have been
+		received.  While datagrams wait for network buffers the task wakes
+		every poll period instead. */
+		xTaskNotifyWait( 0, 0xFFFFFFFFUL, &ulEvents, ucRxFlowStalled ? emacRX_POLL_TICKS : portMAX_DELAY );
+		ncm_stats.EmacWakeups++;
+
+		prvRxProcess();
+	}
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif /* USBD_NET_CLASS == USBD_NET_CLASS_NCM && USBD_CDC_FUNCTION == 0 */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
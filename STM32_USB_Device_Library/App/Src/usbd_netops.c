@@ -0,0 +1,211 @@
+/**
+  ******************************************************************************
+  * @file    usbd_netops.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Frame copy and Internet checksum kernels of the RNDIS interface.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_netops.h"
+#include <string.h>
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_NETOPS
+  * @brief Frame copy and Internet checksum kernels
+  * @{
+  */
+
+/** @defgroup USBD_NETOPS_Private_Types
+  * @{
+  */
+/* Word access to byte buffers */
+#if defined(__GNUC__)
+typedef uint32_t __attribute__((__may_alias__)) USBD_NetOps_Word;
+typedef uint16_t __attribute__((__may_alias__)) USBD_NetOps_Half;
+#else
+typedef uint32_t USBD_NetOps_Word;
+typedef uint16_t USBD_NetOps_Half;
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_NETOPS_Private_Functions
+  * @{
+  */
+/**
+  * @brief  Copies a buffer, memcpy semantics. The buffers may also overlap
+  *         when dst is below src, as for a frame moved towards the start of
+  *         its buffer.
+  * @param  dst: Destination, any alignment
+  * @param  src: Source, any alignment
+  * @param  len: Number of bytes
+  * @retval None
+  */
+void USBD_NetOps_Copy(void *dst, const void *src, uint32_t len)
+{
+  uint8_t *d = dst;
+  const uint8_t *s = src;
+  uint32_t word;
+
+  /* Align the destination, a misaligned source is read with unaligned
+  loads below */
+  while ((len != 0) && (((uintptr_t)d & 3) != 0))
+  {
+    *d++ = *s++;
+    len--;
+  }
+
+  if (((uintptr_t)s & 3) == 0)
+  {
+#if (USBD_NETOPS_ASM == 1)
+    while (len >= 16)
+    {
+      __asm volatile ("ldmia %0!, {r3, r4, r5, r12}\n\t"
+                      "stmia %1!, {r3, r4, r5, r12}"
+                      : "+r" (s), "+r" (d)
+                      :
+                      : "r3", "r4", "r5", "r12", "memory");
+      len -= 16;
+    }
+#else
+    while (len >= 16)
+    {
+      ((USBD_NetOps_Word *)d)[0] = ((const USBD_NetOps_Word *)s)[0];
+      ((USBD_NetOps_Word *)d)[1] = ((const USBD_NetOps_Word *)s)[1];
+      ((USBD_NetOps_Word *)d)[2] = ((const USBD_NetOps_Word *)s)[2];
+      ((USBD_NetOps_Word *)d)[3] = ((const USBD_NetOps_Word *)s)[3];
+      d += 16;
+      s += 16;
+      len -= 16;
+    }
+#endif
+  }
+
+  /* A single LDR on Cortex-M3/M4, which allow unaligned word loads */
+  while (len >= 4)
+  {
+    memcpy(&word, s, 4);
+    *(USBD_NetOps_Word *)d = word;
+    d += 4;
+    s += 4;
+    len -= 4;
+  }
+  while (len != 0)
+  {
+    *d++ = *s++;
+    len--;
+  }
+}
+
+/**
+  * @brief  Ones' complement sum of a buffer, as FreeRTOS+TCP
+  *         usGenerateChecksum: the result is not inverted, and is
+  *         ipCORRECT_CRC over data holding a valid checksum.
+  * @param  sum: Sum of the preceding data, 0 to start
+  * @param  data: Buffer, any alignment
+  * @param  len: Number of bytes
+  * @retval Folded 16 bit sum, in memory byte order
+  */
+uint16_t USBD_NetOps_Checksum(uint32_t sum, const void *data, uint32_t len)
+{
+  const uint8_t *p = data;
+  uint32_t odd = (uintptr_t)p & 1;
+  uint64_t acc = 0;
+
+  /* From an odd address, every byte is summed in the other half of its
+  halfword, the result is swapped back at the end */
+  if ((odd != 0) && (len != 0))
+  {
+    acc += (uint32_t)*p++ << 8;
+    len--;
+  }
+  if ((((uintptr_t)p & 2) != 0) && (len >= 2))
+  {
+    acc += *(const USBD_NetOps_Half *)p;
+    p += 2;
+    len -= 2;
+  }
+
+#if (USBD_NETOPS_ASM == 1)
+  {
+    uint32_t part = 0;
+
+    while (len >= 16)
+    {
+      __asm volatile ("ldmia %[p]!, {r3, r4, r5, r12}\n\t"
+                      "adds  %[part], %[part], r3\n\t"
+                      "adcs  %[part], %[part], r4\n\t"
+                      "adcs  %[part], %[part], r5\n\t"
+                      "adcs  %[part], %[part], r12\n\t"
+                      "adc   %[part], %[part], #0"
+                      : [p] "+r" (p), [part] "+r" (part)
+                      :
+                      : "r3", "r4", "r5", "r12", "cc", "memory");
+      len -= 16;
+    }
+    acc += part;
+  }
+#else
+  while (len >= 16)
+  {
+    acc += ((const USBD_NetOps_Word *)p)[0];
+    acc += ((const USBD_NetOps_Word *)p)[1];
+    acc += ((const USBD_NetOps_Word *)p)[2];
+    acc += ((const USBD_NetOps_Word *)p)[3];
+    p += 16;
+    len -= 16;
+  }
+#endif
+
+  while (len >= 4)
+  {
+    acc += *(const USBD_NetOps_Word *)p;
+    p += 4;
+    len -= 4;
+  }
+  if (len >= 2)
+  {
+    acc += *(const USBD_NetOps_Half *)p;
+    p += 2;
+    len -= 2;
+  }
+  if (len != 0)
+  {
+    acc += *p;
+  }
+
+  while ((acc >> 16) != 0)
+  {
+    acc = (acc & 0xFFFF) + (acc >> 16);
+  }
+  if (odd != 0)
+  {
+    acc = ((acc & 0xFF) << 8) | (acc >> 8);
+  }
+  acc += sum;
+  while ((acc >> 16) != 0)
+  {
+    acc = (acc & 0xFFFF) + (acc >> 16);
+  }
+  return (uint16_t)acc;
+}
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,188 @@
+/**
+  ******************************************************************************
+  * @file    usbd_prof.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Cycle counter profiling of the USB interrupt, LL callbacks and
+  *          class dispatch.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_def.h"
+#include "usbd_prof.h"
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_PROF
+  * @brief Cycle counter profiling
+  * @{
+  */
+
+/** @defgroup USBD_PROF_Private_Variables
+  * @{
+  */
+#if (USBD_PROFILING == 1)
+USBD_Prof_StatTypeDef USBD_Prof_Stats[USBD_PROF_COUNT];
+#endif
+
+static const char * const USBD_Prof_Names[USBD_PROF_COUNT] =
+{
+  "IRQ",
+  "LL Setup",
+  "LL DataOut",
+  "LL DataIn",
+  "LL SOF",
+  "LL Reset",
+  "LL Suspend",
+  "LL Resume",
+  "LL IsoOutIncomplete",
+  "LL IsoInIncomplete",
+  "LL Connect",
+  "LL Disconnect",
+  "Class Setup",
+  "Class DataIn",
+  "Class DataOut",
+  "Class EP0_RxReady",
+  "Class EP0_TxSent",
+  "Class SOF",
+  "Class IsoINIncomplete",
+  "Class IsoOUTIncomplete",
+  "RNDIS Control",
+  "RNDIS Receive",
+  "RNDIS RX wake",
+  "RNDIS RX refill",
+  "RNDIS RX handoff",
+  "RNDIS RX total",
+  "RNDIS TX submit",
+  "RNDIS TX USB",
+  "RNDIS TX total",
+};
+/**
+  * @}
+  */
+
+/** @defgroup USBD_PROF_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Starts the DWT cycle counter and clears the statistics.
+  * @retval None
+  */
+void USBD_Prof_Init(void)
+{
+#if (USBD_PROFILING == 1)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  USBD_Prof_Reset();
+#endif
+}
+
+/**
+  * @brief  Accounts one execution of a profiled section.
+  * @param  id: Section
+  * @param  cycles: Duration in CPU cycles
+  * @retval None
+  */
+void USBD_Prof_Record(USBD_Prof_IdTypeDef id, uint32_t cycles)
+{
+#if (USBD_PROFILING == 1)
+  USBD_Prof_StatTypeDef *stat = &USBD_Prof_Stats[id];
+  uint32_t bin;
+  uint32_t primask;
+
+  bin = (cycles != 0) ? 31 - __CLZ(cycles) : 0;
+  if (bin >= USBD_PROF_HIST_BINS)
+  {
+    bin = USBD_PROF_HIST_BINS - 1;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if ((stat->count == 0) || (cycles < stat->min))
+  {
+    stat->min = cycles;
+  }
+  if (cycles > stat->max)
+  {
+    stat->max = cycles;
+  }
+  stat->count++;
+  stat->total += cycles;
+  stat->hist[bin]++;
+  __set_PRIMASK(primask);
+#else
+  (void)id;
+  (void)cycles;
+#endif
+}
+
+/**
+  * @brief  Copies the statistics of a section, consistently.
+  * @param  id: Section
+  * @param  stat: Destination
+  * @retval USBD_OK, USBD_FAIL when profiling is compiled out
+  */
+uint8_t USBD_Prof_Get(USBD_Prof_IdTypeDef id, USBD_Prof_StatTypeDef *stat)
+{
+#if (USBD_PROFILING == 1)
+  uint32_t primask;
+
+  if (id >= USBD_PROF_COUNT)
+  {
+    return USBD_FAIL;
+  }
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *stat = USBD_Prof_Stats[id];
+  __set_PRIMASK(primask);
+  return USBD_OK;
+#else
+  (void)id;
+  USBD_memset(stat, 0, sizeof(*stat));
+  return USBD_FAIL;
+#endif
+}
+
+/**
+  * @brief  Clears the statistics of all sections.
+  * @retval None
+  */
+void USBD_Prof_Reset(void)
+{
+#if (USBD_PROFILING == 1)
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  USBD_memset(USBD_Prof_Stats, 0, sizeof(USBD_Prof_Stats));
+  __set_PRIMASK(primask);
+#endif
+}
+
+/**
+  * @brief  Returns the printable name of a section.
+  * @param  id: Section
+  * @retval Name
+  */
+const char *USBD_Prof_Name(USBD_Prof_IdTypeDef id)
+{
+  return (id < USBD_PROF_COUNT) ? USBD_Prof_Names[id] : "?";
+}
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,179 @@
+/**
+ ******************************************************************************
+ * @file    usbd_ramdisk_if.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   RAM disk storage of the mass storage function, MSC_RAMDISK_BLOCKS
+ *          blocks, lost on reset. The host formats it on first use.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_ramdisk_if.h"
+#include "../../Class/MSC/inc/usbd_msc_scsi.h"
+
+#if (USBD_MSC_FUNCTION == 1) && (MSC_RAMDISK_BLOCKS > 0)
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup USBD_RAMDISK
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_RAMDISK_Private_Variables
+ * @{
+ */
+static uint32_t ulRamDisk[MSC_RAMDISK_BLOCKS * RAMDISK_BLK_SIZ / 4];
+
+/* USB Mass storage Standard Inquiry Data */
+static const int8_t RAMDISK_Inquirydata_FS[] = {/* 36 */
+
+	/* LUN 0 */
+	0x00,
+	0x80,
+	0x02,
+	0x02,
+	(STANDARD_INQUIRY_DATA_LEN - 5),
+	0x00,
+	0x00,
+	0x00,
+	'S', 'T', 'M', ' ', ' ', ' ', ' ', ' ', /* Manufacturer : 8 bytes */
+	'R', 'A', 'M', ' ', 'D', 'i', 's', 'k', /* Product      : 16 Bytes */
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
+	'0', '.', '0' ,'1',                     /* Version      : 4 Bytes */
+};
+/**
+ * @}
+ */
+
+/** @defgroup USBD_RAMDISK_Private_FunctionPrototypes
+ * @{
+ */
+static int8_t RAMDISK_Init_FS (uint8_t lun);
+static int8_t RAMDISK_GetCapacity_FS (uint8_t lun, uint32_t *block_num, uint16_t *block_size);
+static int8_t RAMDISK_IsReady_FS (uint8_t lun);
+static int8_t RAMDISK_IsWriteProtected_FS (uint8_t lun);
+static int8_t RAMDISK_Read_FS (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t RAMDISK_Write_FS (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t RAMDISK_GetMaxLun_FS (void);
+/**
+ * @}
+ */
+
+USBD_StorageTypeDef USBD_RamDisk_fops_FS =
+{
+	RAMDISK_Init_FS,
+	RAMDISK_GetCapacity_FS,
+	RAMDISK_IsReady_FS,
+	RAMDISK_IsWriteProtected_FS,
+	RAMDISK_Read_FS,
+	RAMDISK_Write_FS,
+	RAMDISK_GetMaxLun_FS,
+	(int8_t *)RAMDISK_Inquirydata_FS,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  RAMDISK_Init_FS
+ * @param  lun: Logical unit number
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t RAMDISK_Init_FS (uint8_t lun)
+{
+	return (USBD_OK);
+}
+
+/**
+ * @brief  RAMDISK_GetCapacity_FS
+ * @param  lun: Logical unit number
+ * @param  block_num: Number of blocks
+ * @param  block_size: Block size in bytes
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t RAMDISK_GetCapacity_FS (uint8_t lun, uint32_t *block_num, uint16_t *block_size)
+{
+	*block_num  = MSC_RAMDISK_BLOCKS;
+	*block_size = RAMDISK_BLK_SIZ;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  RAMDISK_IsReady_FS
+ * @param  lun: Logical unit number
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t RAMDISK_IsReady_FS (uint8_t lun)
+{
+	return (USBD_OK);
+}
+
+/**
+ * @brief  RAMDISK_IsWriteProtected_FS
+ * @param  lun: Logical unit number
+ * @retval 0 when writable
+ */
+static int8_t RAMDISK_IsWriteProtected_FS (uint8_t lun)
+{
+	return 0;
+}
+
+/**
+ * @brief  RAMDISK_Read_FS
+ *         Read blocks, the read ahead of the cache may ask past the end
+ * @param  lun: Logical unit number
+ * @param  buf: destination, blk_len blocks
+ * @param  blk_addr: first block
+ * @param  blk_len: number of blocks
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t RAMDISK_Read_FS (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+{
+	if((blk_addr > MSC_RAMDISK_BLOCKS) || (blk_len > MSC_RAMDISK_BLOCKS - blk_addr)){
+		return (USBD_FAIL);
+	}
+	USBD_memcpy(buf, (uint8_t *)ulRamDisk + blk_addr * RAMDISK_BLK_SIZ, (uint32_t)blk_len * RAMDISK_BLK_SIZ);
+	return (USBD_OK);
+}
+
+/**
+ * @brief  RAMDISK_Write_FS
+ * @param  lun: Logical unit number
+ * @param  buf: source, blk_len blocks
+ * @param  blk_addr: first block
+ * @param  blk_len: number of blocks
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t RAMDISK_Write_FS (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+{
+	if((blk_addr > MSC_RAMDISK_BLOCKS) || (blk_len > MSC_RAMDISK_BLOCKS - blk_addr)){
+		return (USBD_FAIL);
+	}
+	USBD_memcpy((uint8_t *)ulRamDisk + blk_addr * RAMDISK_BLK_SIZ, buf, (uint32_t)blk_len * RAMDISK_BLK_SIZ);
+	return (USBD_OK);
+}
+
+/**
+ * @brief  RAMDISK_GetMaxLun_FS
+ * @param  None
+ * @retval Highest logical unit number
+ */
+static int8_t RAMDISK_GetMaxLun_FS (void)
+{
+	return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif /* USBD_MSC_FUNCTION && MSC_RAMDISK_BLOCKS */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,254 @@
+/**
+  ******************************************************************************
+  * @file    usbd_ring.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Byte ring shared by one producer and one consumer without a
+  *          lock, for instance a task and the USB interrupt:
+  *           - The producer reserves contiguous free space, fills it in
+  *             place and commits what it wrote.
+  *           - The consumer peeks at contiguous data, uses it in place and
+  *             releases it.
+  *          A reservation that does not fit before the end of the buffer
+  *          wraps to its start, so that an endpoint can be given a whole
+  *          packet of space. Free of FreeRTOS and HAL dependencies so that
+  *          Tools/ring_bench builds on the host.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_ring.h"
+#include <stddef.h>
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_RING
+  * @brief Single producer, single consumer byte ring
+  * @{
+  */
+
+/** @defgroup USBD_RING_Private_Defines
+  * @{
+  */
+/* Orders the data accesses and the index updates between the two sides,
+a DMB on the Cortex-M4 */
+#ifndef USBD_RING_BARRIER
+#define USBD_RING_BARRIER()   __sync_synchronize()
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_RING_Exported_Functions
+  * @{
+  */
+/**
+  * @brief  Initialize a ring, empty. Neither side may use it meanwhile.
+  * @param  pRing: ring
+  * @param  pBuffer: storage, size bytes
+  * @param  size: ring size, one byte less can be held
+  * @retval None
+  */
+void USBD_Ring_Init(USBD_RingTypeDef *pRing, uint8_t *pBuffer, uint32_t size)
+{
+  pRing->pBuffer = pBuffer;
+  pRing->size = size;
+  pRing->head = 0;
+  pRing->tail = 0;
+  pRing->limit = size;
+  pRing->reserved = 0;
+}
+
+/**
+  * @brief  Reserve contiguous free space, producer side. A new reservation
+  *         replaces the previous one.
+  * @param  pRing: ring
+  * @param  min: space needed, from the end of the data or else from the
+  *         start of the buffer
+  * @param  len: space reserved, at least min
+  * @retval space, NULL if min bytes are not free in one piece
+  */
+uint8_t *USBD_Ring_Reserve(USBD_RingTypeDef *pRing, uint32_t min, uint32_t *len)
+{
+  uint32_t h = pRing->head;
+  uint32_t t = pRing->tail;
+  uint32_t space;
+
+  if (min == 0)
+  {
+    min = 1;
+  }
+
+  if (h >= t)
+  {
+    /* Up to the end, head may not reach a tail at the start */
+    space = pRing->size - h - ((t == 0) ? 1 : 0);
+    if (space >= min)
+    {
+      pRing->reserved = h;
+      *len = space;
+      return pRing->pBuffer + h;
+    }
+    /* From the start, the end of the buffer is skipped */
+    if ((t != 0) && (t - 1 >= min))
+    {
+      pRing->reserved = 0;
+      *len = t - 1;
+      return pRing->pBuffer;
+    }
+  }
+  else if (t - h - 1 >= min)
+  {
+    pRing->reserved = h;
+    *len = t - h - 1;
+    return pRing->pBuffer + h;
+  }
+
+  *len = 0;
+  return NULL;
+}
+
+/**
+  * @brief  Hand the start of the reservation to the consumer, producer
+  *         side. The rest of the reservation stays reserved.
+  * @param  pRing: ring
+  * @param  len: bytes written, up to the space left in the reservation
+  * @retval None
+  */
+void USBD_Ring_Commit(USBD_RingTypeDef *pRing, uint32_t len)
+{
+  uint32_t h = pRing->head;
+
+  if (len == 0)
+  {
+    return;
+  }
+
+  if (pRing->reserved != h)
+  {
+    /* Wrapped, the data ends at the old head */
+    pRing->limit = h;
+    h = len;
+  }
+  else
+  {
+    h += len;
+    if (h == pRing->size)
+    {
+      pRing->limit = h;
+      h = 0;
+    }
+  }
+  pRing->reserved = h;
+
+  /* The data and limit before the head that publishes them */
+  USBD_RING_BARRIER();
+  pRing->head = h;
+}
+
+/**
+  * @brief  Contiguous data, consumer side
+  * @param  pRing: ring
+  * @param  offset: bytes to skip from the oldest one, those already in use
+  * @param  len: bytes available from there in one piece
+  * @retval data, NULL if there is none past offset
+  */
+uint8_t *USBD_Ring_Peek(USBD_RingTypeDef *pRing, uint32_t offset, uint32_t *len)
+{
+  uint32_t h = pRing->head;
+  uint32_t t;
+  uint32_t first;
+  uint32_t second;
+
+  /* limit and the data are valid once head is seen */
+  USBD_RING_BARRIER();
+  t = pRing->tail;
+
+  if (h >= t)
+  {
+    first = h - t;
+    second = 0;
+  }
+  else
+  {
+    first = pRing->limit - t;
+    second = h;
+  }
+
+  if (offset < first)
+  {
+    *len = first - offset;
+    return pRing->pBuffer + t + offset;
+  }
+  offset -= first;
+  if (offset < second)
+  {
+    *len = second - offset;
+    return pRing->pBuffer + offset;
+  }
+
+  *len = 0;
+  return NULL;
+}
+
+/**
+  * @brief  Give the oldest data back to the producer, consumer side
+  * @param  pRing: ring
+  * @param  len: bytes, up to those available
+  * @retval None
+  */
+void USBD_Ring_Release(USBD_RingTypeDef *pRing, uint32_t len)
+{
+  uint32_t h = pRing->head;
+  uint32_t t = pRing->tail;
+
+  USBD_RING_BARRIER();
+  if (h < t)
+  {
+    t += len;
+    if (t >= pRing->limit)
+    {
+      t -= pRing->limit;
+    }
+  }
+  else
+  {
+    t += len;
+  }
+
+  /* Done with the data before the producer may write over it */
+  USBD_RING_BARRIER();
+  pRing->tail = t;
+}
+
+/**
+  * @brief  Bytes held, either side
+  * @param  pRing: ring
+  * @retval count
+  */
+uint32_t USBD_Ring_Count(USBD_RingTypeDef *pRing)
+{
+  uint32_t h = pRing->head;
+  uint32_t t;
+
+  USBD_RING_BARRIER();
+  t = pRing->tail;
+  return (h >= t) ? h - t : pRing->limit - t + h;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -48,13 +48,18 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "../inc/usbd_rndis_if.h"
+#include "usbd_prof.h"
+#include "usbd_trace.h"
+#include "usbd_ll_ex.h"
+#include "usbd_netops.h"
 #include "FreeRTOS.h"
 #include "list.h"
 #include "task.h"
 #include "FreeRTOS_IP.h"
 #include "NetworkBufferManagement.h"
 #include "FreeRTOS_IP_Private.h"
-//#include "hr_gettime.h"
+
+#if (USBD_NET_CLASS == USBD_NET_CLASS_RNDIS) && (USBD_CDC_FUNCTION == 0)
 
 /* USER CODE BEGIN INCLUDE */
 /* USER CODE END INCLUDE */
@@ -83,10 +88,25 @@
 /* USER CODE BEGIN PRIVATE_DEFINES */
 /* Define size for the receive and transmit buffer over RNDIS */
 /* It's up to user to redefine and/or remove those define */
-#define APP_RX_DATA_SIZE  2048
 #define APP_TX_DATA_SIZE  2048
+#define RNDIS_RX_FRAMES   3	/* Network buffers armed for reception */
+#define RNDIS_MAX_TRANSFER_SIZE	1580	/* Longest message the host may send */
 #define DeviceID_8 ((uint8_t*)0x1FFF7A10)
 
+/* Network buffers, see vNetworkInterfaceAllocateRAMToBuffers. A received
+REMOTE_NDIS_PACKET_MSG lands with its header in the headroom in front of
+pucEthernetBuffer, so the frame is not copied. Reception is armed for whole
+packets, more than any message the host may send so that the short packet
+closing the message always ends the transfer. */
+#define emacRX_ARM_SIZE		( ( ( RNDIS_MAX_TRANSFER_SIZE / RNDIS_DATA_FS_MAX_PACKET_SIZE ) + 1 ) * RNDIS_DATA_FS_MAX_PACKET_SIZE )
+#define emacHEADROOM		( ( ( RNDIS_PACKET_MSG_HEADER_SIZE - ipBUFFER_PADDING + 7 ) & ~7UL ) + ipBUFFER_PADDING )
+#define emacBUFFER_SIZE		( ( emacHEADROOM - RNDIS_PACKET_MSG_HEADER_SIZE + emacRX_ARM_SIZE + 31 ) & ~31UL )
+
+/* Events notified to the EMAC task */
+#define RNDIS_EVENT_RX			0x01UL	/* Frames are in the receive buffers */
+#define RNDIS_EVENT_TX_DONE		0x02UL	/* A zero copy frame has been sent */
+#define RNDIS_EVENT_STATS		0x04UL	/* A vendor OID query waits for its answer */
+
 /* USER CODE END PRIVATE_DEFINES */
 /**
  * @}
@@ -105,15 +125,31 @@
 /** @defgroup USBD_RNDIS_Private_Variables
  * @{
  */
-/* Create buffer for reception and transmission           */
-/* It's up to user to redefine and/or remove those define */
-/* Received Data over USB are stored in this buffer       */
-static uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
-static uint8_t UserRxBufferFS_Temp[64];
+/* Received Data over USB are stored in network buffers, armed for reception
+by the EMAC task. Messages arriving before the EMAC task runs are discarded
+into UserRxBufferFS_Temp packet by packet. */
+static NetworkBufferDescriptor_t * volatile pxRxBuffers[RNDIS_RX_FRAMES];
+static uint8_t UserRxBufferFS_Temp[RNDIS_DATA_FS_MAX_PACKET_SIZE];
 static uint64_t rndis_oid_gen_xmit_ok=0;
 static uint64_t rndis_oid_gen_rcv_ok=0;
 
-uint16_t UserRxSize=0;
+static uint16_t UserRxSize[RNDIS_RX_FRAMES];
+
+/* Frames completed by the USB interrupt and consumed by the EMAC task, the
+frame in pxRxBuffers[n % RNDIS_RX_FRAMES] is ready while n is between them.
+Reception is held, NAKing the host, while all buffers hold frames or the
+next one is not armed yet. */
+static volatile uint32_t ulRxHead=0;
+static volatile uint32_t ulRxTail=0;
+static volatile uint8_t ucRxStalled=0;
+/* Held because the next buffer is not armed, see prvRxRefill */
+static volatile uint8_t ucRxFlowStalled=0;
+
+/* Received frames are not notified, the EMAC task polls for them */
+static volatile uint8_t ucRxPolling=0;
+
+/* Set once the network buffers come from vNetworkInterfaceAllocateRAMToBuffers */
+static BaseType_t xStaticBuffers=pdFALSE;
 static enum{
 	RNDIS_STATE_NORMAL,
 	RNDIS_STATE_HALTED
@@ -123,6 +159,35 @@ static enum{
 /* Send Data over USB RNDIS are stored in this buffer       */
 uint8_t UserTxBufferFS[APP_TX_DATA_SIZE+44];
 
+/* Network buffer being sent without copy, and the last one sent, waiting to
+be released out of the interrupt context */
+static NetworkBufferDescriptor_t * volatile pxTxDescriptor = NULL;
+static NetworkBufferDescriptor_t * volatile pxTxDone = NULL;
+
+#if (USBD_PROFILING == 1)
+/* Latency stamps of the frame in flight in each direction */
+static uint32_t ulRxDoneStamp[RNDIS_RX_FRAMES];
+static uint32_t ulRxWakeStamp;
+/* First frame of the batch being delivered */
+static uint32_t ulRxBatchFirstStamp;
+static uint32_t ulTxEntryStamp;
+static uint32_t ulTxSubmitStamp;
+#endif
+
+/* Driver counters of RNDIS_OID_VENDOR_DRIVER_STATS, kept across reconnections */
+static RNDIS_VendorStatsTypeDef rndis_stats;
+
+/* Answer to the last vendor OID query, built by the EMAC task as the task
+API cannot be used from the USB interrupt. ulVendorSize is 0 when the OID is
+not supported. */
+static union{
+	RNDIS_VendorStatsTypeDef Driver;
+	RNDIS_VendorTasksTypeDef Tasks;
+} xVendorResponse;
+static uint32_t ulVendorOid=0;
+static uint32_t ulVendorSize=0;
+static volatile uint8_t ucVendorPending=0;
+
 /* USER CODE BEGIN PRIVATE_VARIABLES */
 /* USER CODE END PRIVATE_VARIABLES */
 
@@ -148,6 +213,7 @@ static int8_t RNDIS_Init_FS     (void);
 static int8_t RNDIS_DeInit_FS   (void);
 static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static int8_t RNDIS_Receive_FS  (uint8_t* pbuf, uint32_t *Len);
+static int8_t RNDIS_TransmitCplt_FS  (uint8_t* pbuf, uint32_t *Len);
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_DECLARATION */
 /* USER CODE END PRIVATE_FUNCTIONS_DECLARATION */
@@ -157,6 +223,19 @@ static int8_t RNDIS_Receive_FS  (uint8_t* pbuf, uint32_t *Len);
  */
 
 static void prvEMACHandlerTask( void *pvParameters );
+static void prvReleaseTxDone( void );
+static void prvVendorQuery( void );
+static NetworkBufferDescriptor_t *prvRxFrame( UBaseType_t uxSlot );
+#if ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 )
+static BaseType_t prvRxChecksumSpotCheck( const NetworkBufferDescriptor_t *pxDescriptor );
+#endif
+static void prvRxDeliver( NetworkBufferDescriptor_t *pxFirst, UBaseType_t uxCount );
+static void prvRxRelease( void );
+static void prvRxArm( void );
+static void prvRxRefill( void );
+#if ( configEMAC_RX_POLLING == 1 )
+static void prvRxModeration( UBaseType_t uxFrames );
+#endif
 
 /* Default the size of the stack used by the EMAC deferred handler task to twice
 the size of the stack used by the idle task - but allow this to be overridden in
@@ -165,6 +244,49 @@ FreeRTOSConfig.h as configMINIMAL_STACK_SIZE is a user definable constant. */
 #define configEMAC_TASK_STACK_SIZE ( 2 * configMINIMAL_STACK_SIZE )
 #endif
 
+/* Received frame moderation.  When at least configEMAC_RX_POLL_THRESHOLD
+frames arrive within configEMAC_RX_POLL_WINDOW_MS the USB interrupt stops
+notifying each frame and the EMAC task polls every configEMAC_RX_POLL_PERIOD_MS
+instead, until the rate drops below the threshold again.  Set
+configEMAC_RX_POLLING to 0 to always notify. */
+#ifndef configEMAC_RX_POLLING
+#define configEMAC_RX_POLLING 1
+#endif
+
+#ifndef configEMAC_RX_POLL_THRESHOLD
+#define configEMAC_RX_POLL_THRESHOLD 8
+#endif
+
+#ifndef configEMAC_RX_POLL_WINDOW_MS
+#define configEMAC_RX_POLL_WINDOW_MS 10
+#endif
+
+#ifndef configEMAC_RX_POLL_PERIOD_MS
+#define configEMAC_RX_POLL_PERIOD_MS 1
+#endif
+
+/* Network buffers left to the IP stack and to transmission: receive buffers
+are only armed while more than configEMAC_RX_MIN_FREE_BUFFERS are free.
+Below it the host is NAKed until buffers are released, so a burst is held
+back by USB instead of being dropped and retransmitted by TCP.  The EMAC
+task checks again every configEMAC_RX_POLL_PERIOD_MS meanwhile. */
+#ifndef configEMAC_RX_MIN_FREE_BUFFERS
+#define configEMAC_RX_MIN_FREE_BUFFERS 2
+#endif
+
+/* Frames come over USB bulk transfers, protected by their own CRC, so the IP
+and protocol checksums can be left unchecked by setting
+ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM to 1 in FreeRTOSIPConfig.h.  The
+driver then still verifies one IPv4 frame out of every
+configEMAC_RX_CHECKSUM_SPOT_CHECK, dropping it on error, as a guard against
+host or firmware bugs; 0 checks none. */
+#ifndef configEMAC_RX_CHECKSUM_SPOT_CHECK
+#define configEMAC_RX_CHECKSUM_SPOT_CHECK 64
+#endif
+
+#define emacRX_POLL_TICKS ( pdMS_TO_TICKS( configEMAC_RX_POLL_PERIOD_MS ) > 0 ? pdMS_TO_TICKS( configEMAC_RX_POLL_PERIOD_MS ) : 1 )
+#define emacRX_POLL_WINDOW_TICKS ( pdMS_TO_TICKS( configEMAC_RX_POLL_WINDOW_MS ) > 0 ? pdMS_TO_TICKS( configEMAC_RX_POLL_WINDOW_MS ) : 1 )
+
 /* Holds the handle of the task used as a deferred interrupt processor.  The
 handle is used so direct notifications can be sent to the task for all EMAC/DMA
 related interrupts. */
@@ -176,7 +298,8 @@ USBD_RNDIS_ItfTypeDef USBD_RNDIS_Interface_fops_FS =
 		RNDIS_Init_FS,
 		RNDIS_DeInit_FS,
 		RNDIS_Control_FS,
-		RNDIS_Receive_FS
+		RNDIS_Receive_FS,
+		RNDIS_TransmitCplt_FS
 };
 
 const uint32_t OID_GEN_SUPPORTED[]={
@@ -208,6 +331,8 @@ const uint32_t OID_GEN_SUPPORTED[]={
 		RNDIS_OID_802_3_RCV_ERROR_ALIGNMENT,
 		RNDIS_OID_802_3_XMIT_ONE_COLLISION,
 		RNDIS_OID_802_3_XMIT_MORE_COLLISIONS,
+		RNDIS_OID_VENDOR_DRIVER_STATS,
+		RNDIS_OID_VENDOR_TASK_STATS,
 };
 
 const uint32_t response[]={
@@ -227,6 +352,7 @@ const uint32_t response[]={
 void RNDIS_Disconnect(){
 	rndis_oid_gen_xmit_ok=0;
 	rndis_oid_gen_rcv_ok=0;
+	ucVendorPending=0;
 	rndis_state=RNDIS_STATE_HALTED;
 	FreeRTOS_NetworkDownFromISR();
 }
@@ -276,15 +402,18 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
 	static const char nome[]="IMBEL TPP-1400";
 	static RNDIS_DATA rndis_data;
 	uint32_t *buf32=(uint32_t *)pbuf;
-	uint8_t len;
+	uint16_t len=0;
 	int pos=0;
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	USBD_RNDIS_HandleTypeDef *hrndis = (USBD_RNDIS_HandleTypeDef*)hUsbDeviceFS.pClassData;
+	USBD_PROF_START(cycles);
 
 	switch (cmd)
 	{
 	case SEND_ENCAPSULATED_COMMAND:
 		rndis_data.MessageType=buf32[0];
 		rndis_data.RequestId=buf32[2];
+		USBD_TRACE_EVENT(USBD_TRACE_RNDIS_MSG, 0, buf32[0], buf32[2]);
 		if(buf32[0]==RNDIS_MSG_INIT){
 			//SEC RNDIS_MSG_INIT
 			RNDIS_Disconnect();
@@ -305,7 +434,15 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
 			rndis_data.InformationBufferLength=buf32[4];
 			rndis_data.InformationBufferOffset=buf32[5];
 			rndis_data.DeviceVcHandle=buf32[6];
-			USBD_RNDIS_TransmitControl(&hUsbDeviceFS, (uint8_t*)response, 8);
+			if((rndis_data.Oid==RNDIS_OID_VENDOR_DRIVER_STATS || rndis_data.Oid==RNDIS_OID_VENDOR_TASK_STATS) && xEMACTaskHandle!=0){
+				/* The EMAC task builds the answer and signals it */
+				ulVendorOid=rndis_data.Oid;
+				ucVendorPending=1;
+				xTaskNotifyFromISR(xEMACTaskHandle, RNDIS_EVENT_STATS, eSetBits, &xHigherPriorityTaskWoken);
+				portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+			} else {
+				USBD_RNDIS_TransmitControl(&hUsbDeviceFS, (uint8_t*)response, 8);
+			}
 		} else if(buf32[0]==RNDIS_MSG_SET){
 			//SEC RNDIS_MSG_SET
 			USBD_RNDIS_TransmitControl(&hUsbDeviceFS, (uint8_t*)response, 8);
@@ -320,7 +457,11 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
 		}
 		break;
 	case GET_ENCAPSULATED_RESPONSE:
-		if(rndis_data.MessageType==RNDIS_MSG_INIT){
+		if(ucVendorPending){
+			//GER Not ready, a single zero byte means no response available
+			pbuf[0]=0;
+			len=1;
+		} else if(rndis_data.MessageType==RNDIS_MSG_INIT){
 			//GER RNDIS_MSG_INIT
 			buf32[pos++]=RNDIS_MSG_INIT_C;							//MessageType			Specifies the type of message being sent. Set to 0x80000002.
 			pos++;
@@ -333,7 +474,7 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
 																	//						RNDIS_DF_CONNECTION_ORIENTED 0x00000002
 			buf32[pos++]=RNDIS_MEDIUM_802_3;						//Medium				Specifies the medium supported by the device. Set to RNDIS_MEDIUM_802_3 (0x00000000)
 			buf32[pos++]=1;											//MaxPacketsPerMessage	Specifies the maximum number of Remote NDIS data messages that the device can handle in a single transfer to it. This value should be at least one.
-			buf32[pos++]=1580;										//MaxTransferSize		Specifies the maximum size in bytes of any single bus data transfer that the device expects to receive from the host.
+			buf32[pos++]=RNDIS_MAX_TRANSFER_SIZE;					//MaxTransferSize		Specifies the maximum size in bytes of any single bus data transfer that the device expects to receive from the host.
 			buf32[pos++]=0;											//PacketAlignmentFactor	Specifies the byte alignment that the device expects for each Remote NDIS message that is part of a multimessage transfer to it. This value is specified in powers of 2. For example, this value is set to three to indicate 8-byte alignment. This value has a maximum setting of seven, which specifies 128-byte alignment.
 			buf32[pos++]=0;											//AFListOffset			Reserved for connection-oriented devices. Set value to zero.
 			buf32[pos++]=0;											//AFListSize			Reserved for connection-oriented devices. Set value to zero.
@@ -352,7 +493,7 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
 				buf32[pos++]=temp;
 				buf32[pos++]=16;
 				USBD_memcpy(buf32+pos, OID_GEN_SUPPORTED, temp);
-				pos+=temp;
+				pos+=temp/4;
 				break;
 			case RNDIS_OID_GEN_PHYSICAL_MEDIUM:
 				buf32[pos++]=4;
@@ -435,6 +576,19 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
 				USBD_memcpy((char*)&buf32[pos++], nome, sizeof(nome));
 				len=buf32[1]=pos*4+sizeof(nome);
 				break;
+			case RNDIS_OID_VENDOR_DRIVER_STATS:
+			case RNDIS_OID_VENDOR_TASK_STATS:
+				if(ulVendorOid!=rndis_data.Oid || ulVendorSize==0){
+					buf32[3]=RNDIS_STATUS_NOT_SUPPORTED;
+					buf32[pos++]=0;
+					buf32[pos++]=0;
+					break;
+				}
+				buf32[pos++]=ulVendorSize;
+				buf32[pos++]=16;
+				USBD_memcpy(buf32+pos, &xVendorResponse, ulVendorSize);
+				pos+=ulVendorSize/4;
+				break;
 			default:
 				buf32[pos++]=0;
 				buf32[pos++]=20;
@@ -474,11 +628,13 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
 			//GER OTHER
 		}
 		if(!len) len=buf32[1]=pos*4;
+		if(len>length) len=length;
 		USBD_CtlSendData(&hUsbDeviceFS, pbuf, len);
 		break;
 	default:
 		break;
 	}
+	USBD_PROF_STOP(USBD_PROF_RNDIS_CONTROL, cycles);
 	return (USBD_OK);
 	/* USER CODE END 5 */
 }
@@ -489,40 +645,45 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
  *         through this function.
  *
  *         @note
- *         This function will block any OUT packet reception on USB endpoint
- *         untill exiting this function. If you exit this function before transfer
- *         is complete on RNDIS interface (ie. using DMA controller) it will result
- *         in receiving more data while previous ones are still not sent.
+ *         Called once per message received into a network buffer, and once
+ *         per packet of the messages discarded into UserRxBufferFS_Temp.
  *
  * @param  Buf: Buffer of data to be received
  * @param  Len: Number of data received (in bytes)
  * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
  */
-//uint64_t timestamp;
 static int8_t RNDIS_Receive_FS (uint8_t* Buf, uint32_t *Len)
 {
-	BaseType_t xHigherPriorityTaskWoken;
-	static uint16_t len=0;
-
-	if(*Len>64){
-		*Len=64;
-	}
-	if((len+*Len) < sizeof(UserRxBufferFS)){
-		memcpy(UserRxBufferFS+len, UserRxBufferFS_Temp, *Len);
-		len+=(*Len);
-	}
-
-	if(*Len!=64 && xEMACTaskHandle!=0){
-		UserRxSize=len;
-//		timestamp=ullGetHighResolutionTime();
-		len=0;
-		vTaskNotifyGiveFromISR(xEMACTaskHandle, &xHigherPriorityTaskWoken);
-		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
-		rndis_oid_gen_rcv_ok++;
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t slot=ulRxHead % RNDIS_RX_FRAMES;
+	USBD_PROF_START(cycles);
+
+	if(Buf==UserRxBufferFS_Temp){
+		if(*Len==RNDIS_DATA_FS_MAX_PACKET_SIZE){
+			/* More of the discarded message to come */
+			USBD_RNDIS_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS_Temp);
+			USBD_RNDIS_ReceivePacket(&hUsbDeviceFS);
+		} else {
+			rndis_stats.RxDropNoBuffer++;
+			prvRxArm();
+		}
+	} else if(*Len>=emacRX_ARM_SIZE){
+		/* Longer than any message the host may send, dropped. The rest of it
+		is received as a message of its own and rejected as malformed. */
+		rndis_stats.RxDropOversize++;
+		prvRxArm();
 	} else {
-		USBD_RNDIS_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS_Temp);
-		USBD_RNDIS_ReceivePacket(&hUsbDeviceFS);
+		UserRxSize[slot]=*Len;
+		USBD_PROF_STAMP(ulRxDoneStamp[slot]);
+		ulRxHead++;
+		rndis_oid_gen_rcv_ok++;
+		prvRxArm();
+		if(!ucRxPolling){
+			xTaskNotifyFromISR(xEMACTaskHandle, RNDIS_EVENT_RX, eSetBits, &xHigherPriorityTaskWoken);
+			portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+		}
 	}
+	USBD_PROF_STOP(USBD_PROF_RNDIS_RECEIVE, cycles);
 	return (USBD_OK);
 	/* USER CODE END 6 */
 }
@@ -565,16 +726,170 @@ uint8_t RNDIS_Transmit_FS(uint8_t* Buf, uint16_t Len)
 	buffer[10]=0;			//Reserved
 
 	if((Len+44)<sizeof(UserTxBufferFS)){
-		memcpy(UserTxBufferFS+44, Buf, Len);
+		USBD_NetOps_Copy(UserTxBufferFS+44, Buf, Len);
 	}
 
 	USBD_RNDIS_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, Len+44);
+	USBD_PROF_STAMP(ulTxSubmitStamp);
 	result = USBD_RNDIS_TransmitPacket(&hUsbDeviceFS);
+	if(result==USBD_OK){
+		rndis_stats.TxFrames++;
+	}
 	rndis_oid_gen_xmit_ok++;
 	/* USER CODE END 7 */
 	return result;
 }
 
+/**
+ * @brief  RNDIS_TransmitCplt_FS
+ *         Called from the USB interrupt when a data packet has been sent or
+ *         aborted. A network buffer sent without copy is handed to the EMAC
+ *         task for release.
+ * @param  Buf: Buffer of data sent
+ * @param  Len: Number of data sent (in bytes)
+ * @retval Result of the operation: USBD_OK
+ */
+static int8_t RNDIS_TransmitCplt_FS (uint8_t* Buf, uint32_t *Len)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+#if (USBD_PROFILING == 1)
+	uint32_t ulStamp;
+
+	USBD_PROF_STAMP(ulStamp);
+	USBD_PROF_SPAN(USBD_PROF_RNDIS_TX_USB, ulTxSubmitStamp, ulStamp);
+	USBD_PROF_SPAN(USBD_PROF_RNDIS_TX_TOTAL, ulTxEntryStamp, ulStamp);
+#endif
+
+	if(pxTxDescriptor != NULL){
+		pxTxDone=pxTxDescriptor;
+		pxTxDescriptor=NULL;
+		if(xEMACTaskHandle!=0){
+			xTaskNotifyFromISR(xEMACTaskHandle, RNDIS_EVENT_TX_DONE, eSetBits, &xHigherPriorityTaskWoken);
+			portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+		}
+	}
+	return (USBD_OK);
+}
+
+/**
+ * @brief  RNDIS_TransmitDescriptor_FS
+ *         Sends a network buffer without copying it. The buffer is owned by
+ *         the driver until RNDIS_TransmitCplt_FS.
+ * @param  pxDescriptor: Network buffer to be sent
+ * @retval USBD_OK, USBD_BUSY, or USBD_FAIL when the frame must be copied
+ */
+static uint8_t RNDIS_TransmitDescriptor_FS(NetworkBufferDescriptor_t *pxDescriptor)
+{
+	USBD_RNDIS_HandleTypeDef *hrndis = (USBD_RNDIS_HandleTypeDef*)hUsbDeviceFS.pClassData;
+	uint8_t result;
+
+	if (hrndis->TxState != 0 || rndis_state!=RNDIS_STATE_NORMAL){
+		return USBD_BUSY;
+	}
+	if(pxDescriptor->xDataLength>APP_TX_DATA_SIZE){
+		return USBD_FAIL;
+	}
+
+	pxTxDescriptor=pxDescriptor;
+	USBD_PROF_STAMP(ulTxSubmitStamp);
+	result = USBD_RNDIS_TransmitFrame(&hUsbDeviceFS, pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength);
+	if(result==USBD_OK){
+		rndis_oid_gen_xmit_ok++;
+		rndis_stats.TxFrames++;
+		rndis_stats.TxZeroCopy++;
+	} else {
+		pxTxDescriptor=NULL;
+	}
+	return result;
+}
+
+/**
+ * @brief  prvReleaseTxDone
+ *         Releases the network buffer of the last zero copy transmission.
+ * @retval None
+ */
+static void prvReleaseTxDone( void )
+{
+	NetworkBufferDescriptor_t *pxDescriptor;
+
+	taskENTER_CRITICAL();
+	pxDescriptor=pxTxDone;
+	pxTxDone=NULL;
+	taskEXIT_CRITICAL();
+
+	if(pxDescriptor!=NULL){
+		vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+	}
+}
+
+/**
+ * @brief  prvVendorQuery
+ *         Builds the answer to the pending vendor OID query and tells the host
+ *         it is available. Runs in the EMAC task.
+ * @retval None
+ */
+static void prvVendorQuery( void )
+{
+	if(ulVendorOid==RNDIS_OID_VENDOR_DRIVER_STATS){
+		RNDIS_VendorStatsTypeDef *pxStats=&xVendorResponse.Driver;
+		USBD_LLEx_StatsTypeDef xQueueStats;
+		USBD_Prof_StatTypeDef xIsrStats;
+
+		taskENTER_CRITICAL();
+		*pxStats=rndis_stats;
+		taskEXIT_CRITICAL();
+
+		pxStats->Version=RNDIS_VENDOR_STATS_VERSION;
+		pxStats->Size=sizeof(RNDIS_VendorStatsTypeDef);
+		pxStats->Uptime=xTaskGetTickCount()*portTICK_PERIOD_MS;
+		USBD_LLEx_GetStats(&hUsbDeviceFS, RNDIS_IN_EP, &xQueueStats);
+		pxStats->TxQueued=xQueueStats.queued;
+		pxStats->TxQueueHighWater=xQueueStats.high_water;
+		pxStats->TxQueueBusy=xQueueStats.busy;
+		pxStats->RxPending=ulRxHead-ulRxTail;
+		pxStats->RxPolling=ucRxPolling;
+		pxStats->RxFlowStalled=ucRxFlowStalled;
+		pxStats->NetBuffersFree=uxGetNumberOfFreeNetworkBuffers();
+		pxStats->NetBuffersMinFree=uxGetMinimumFreeNetworkBuffers();
+		pxStats->UsbEventsLost=USBD_LLEx_GetEventsLost();
+		if(USBD_Prof_Get(USBD_PROF_IRQ, &xIsrStats)==USBD_OK && xIsrStats.count!=0){
+			pxStats->IsrCount=xIsrStats.count;
+			pxStats->IsrCyclesMin=xIsrStats.min;
+			pxStats->IsrCyclesAvg=(uint32_t)(xIsrStats.total/xIsrStats.count);
+			pxStats->IsrCyclesMax=xIsrStats.max;
+		}
+		pxStats->EmacStackHighWater=uxTaskGetStackHighWaterMark(NULL);
+		pxStats->StaticPoolHighWater=USBD_static_highwater();
+		ulVendorSize=sizeof(RNDIS_VendorStatsTypeDef);
+	} else {
+#if ( configUSE_TRACE_FACILITY == 1 )
+		static TaskStatus_t xTaskStatus[RNDIS_VENDOR_MAX_TASKS];
+		RNDIS_VendorTasksTypeDef *pxTasks=&xVendorResponse.Tasks;
+		uint32_t ulTotalRunTime=0;
+		UBaseType_t uxCount, i;
+
+		/* Nothing is reported when there are more tasks than fit */
+		uxCount=uxTaskGetSystemState(xTaskStatus, RNDIS_VENDOR_MAX_TASKS, &ulTotalRunTime);
+		pxTasks->Version=RNDIS_VENDOR_STATS_VERSION;
+		pxTasks->Count=uxCount;
+		pxTasks->TotalRunTime=ulTotalRunTime;
+		for(i=0;i<uxCount;i++){
+			strncpy(pxTasks->Task[i].Name, xTaskStatus[i].pcTaskName, RNDIS_VENDOR_TASK_NAME_LEN);
+			pxTasks->Task[i].RunTime=xTaskStatus[i].ulRunTimeCounter;
+			pxTasks->Task[i].StackHighWater=xTaskStatus[i].usStackHighWaterMark;
+			pxTasks->Task[i].Priority=xTaskStatus[i].uxCurrentPriority;
+			pxTasks->Task[i].State=xTaskStatus[i].eCurrentState;
+		}
+		ulVendorSize=sizeof(RNDIS_VendorTasksTypeDef)-(RNDIS_VENDOR_MAX_TASKS-uxCount)*sizeof(RNDIS_VendorTaskTypeDef);
+#else
+		ulVendorSize=0;
+#endif
+	}
+
+	ucVendorPending=0;
+	USBD_RNDIS_TransmitControl(&hUsbDeviceFS, (uint8_t*)response, 8);
+}
+
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
@@ -609,13 +924,44 @@ BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescript
 	    by pxDescriptor->xDataLength. */
 
 	uint8_t retries=0;
-	while(RNDIS_Transmit_FS( pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength) ){
+	uint8_t result;
+
+	USBD_PROF_STAMP(ulTxEntryStamp);
+	prvReleaseTxDone();
+
+	if( xReleaseAfterSend != pdFALSE )
+	{
+		/* The buffer is ours: send it in place, behind the RNDIS header, and
+		release it once the transfer completes. */
+		while((result=RNDIS_TransmitDescriptor_FS(pxDescriptor))==USBD_BUSY){
+			rndis_stats.TxBusy++;
+			vTaskDelay(5);
+			retries++;
+			if(retries>=5){
+				break;
+			}
+		}
+		if(result==USBD_OK){
+			USBD_PROF_SPAN(USBD_PROF_RNDIS_TX_SUBMIT, ulTxEntryStamp, ulTxSubmitStamp);
+			iptraceNETWORK_INTERFACE_TRANSMIT();
+			return pdTRUE;
+		}
+		retries=0;
+	}
+
+	while((result=RNDIS_Transmit_FS( pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength))!=USBD_OK){
+		rndis_stats.TxBusy++;
 		vTaskDelay(5);
 		retries++;
 		if(retries>=5){
 			break;
 		}
 	}
+	if(result==USBD_OK){
+		USBD_PROF_SPAN(USBD_PROF_RNDIS_TX_SUBMIT, ulTxEntryStamp, ulTxSubmitStamp);
+	} else {
+		rndis_stats.TxDrop++;
+	}
 
 	iptraceNETWORK_INTERFACE_TRANSMIT();
 
@@ -633,8 +979,27 @@ BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescript
 
 }
 
-//void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ] ){
-//}
+/**
+ * @brief  vNetworkInterfaceAllocateRAMToBuffers
+ *         Gives BufferAllocation_1 its statically allocated network buffers,
+ *         aligned and with room for the RNDIS header in front of the frame.
+ *         The RNDIS receive path depends on it, BufferAllocation_2 is not
+ *         supported.
+ * @param  pxNetworkBuffers: Descriptors to attach the buffers to
+ * @retval None
+ */
+void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ] ){
+	static uint8_t ucNetworkPackets[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ][ emacBUFFER_SIZE ] __attribute__ ( ( aligned( 32 ) ) );
+	BaseType_t x;
+
+	for( x = 0; x < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; x++ )
+	{
+		/* pucEthernetBuffer is preceded by a pointer back to its descriptor */
+		pxNetworkBuffers[ x ].pucEthernetBuffer = &( ucNetworkPackets[ x ][ emacHEADROOM ] );
+		*( ( NetworkBufferDescriptor_t ** ) &( ucNetworkPackets[ x ][ emacHEADROOM - ipBUFFER_PADDING ] ) ) = &( pxNetworkBuffers[ x ] );
+	}
+	xStaticBuffers = pdTRUE;
+}
 
 BaseType_t xGetPhyLinkStatus( void ){
 		BaseType_t xReturn;
@@ -651,100 +1016,449 @@ BaseType_t xGetPhyLinkStatus( void ){
 		return xReturn;
 }
 
-static void prvEMACHandlerTask( void *pvParameters ){
-	NetworkBufferDescriptor_t *pxBufferDescriptor;
-	size_t xBytesReceived;
+/**
+ * @brief  prvRxFrame
+ *         Checks a received message and prepares its network buffer for the
+ *         IP task. Runs in the EMAC task.
+ * @param  uxSlot: Receive buffer holding the frame
+ * @retval Network buffer to hand to the IP task, NULL if the frame is dropped
+ *         and the buffer stays in the slot
+ */
+static NetworkBufferDescriptor_t *prvRxFrame( UBaseType_t uxSlot )
+{
+	NetworkBufferDescriptor_t *pxDescriptor=pxRxBuffers[uxSlot];
+	uint8_t *pucMessage=pxDescriptor->pucEthernetBuffer-RNDIS_PACKET_MSG_HEADER_SIZE;
+	uint32_t ulLength=UserRxSize[uxSlot];
+	uint32_t ulHeader[4];
+	uint32_t ulDataOffset, ulDataLength;
+
+	USBD_PROF_SPAN(USBD_PROF_RNDIS_RX_WAKE, ulRxDoneStamp[uxSlot], ulRxWakeStamp);
+
+	/* REMOTE_NDIS_PACKET_MSG: MessageType, MessageLength, DataOffset from the
+	DataOffset field and DataLength. The message is not word aligned. */
+	if( ulLength < RNDIS_PACKET_MSG_HEADER_SIZE )
+	{
+		rndis_stats.RxDropRunt++;
+		return NULL;
+	}
+	memcpy(ulHeader, pucMessage, sizeof(ulHeader));
+	ulDataOffset=ulHeader[2]+8;
+	ulDataLength=ulHeader[3];
+	if( ( ulHeader[0] != RNDIS_MSG_PACKET ) || ( ulHeader[2] > ulLength ) ||
+			( ulDataOffset < RNDIS_PACKET_MSG_HEADER_SIZE ) || ( ulDataOffset > ulLength ) ||
+			( ulDataLength > ulLength - ulDataOffset ) || ( ulDataLength < ipSIZE_OF_ETH_HEADER ) )
+	{
+		/* Malformed, or no frame behind the header */
+		rndis_stats.RxDropRunt++;
+		return NULL;
+	}
+	if( ulDataOffset != RNDIS_PACKET_MSG_HEADER_SIZE )
+	{
+		/* Per packet information between the header and the frame */
+		USBD_NetOps_Copy(pxDescriptor->pucEthernetBuffer, pucMessage+ulDataOffset, ulDataLength);
+	}
+
+	/* The header overwrote the pointer from the buffer to its descriptor */
+	*( ( NetworkBufferDescriptor_t ** ) ( pxDescriptor->pucEthernetBuffer - ipBUFFER_PADDING ) ) = pxDescriptor;
+	pxDescriptor->xDataLength = ulDataLength;
+
+	/* See if the data contained in the received Ethernet frame needs
+	to be processed. */
+	if( eConsiderFrameForProcessing( pxDescriptor->pucEthernetBuffer )
+			!= eProcessBuffer )
+	{
+		/* The Ethernet frame can be dropped, the buffer is armed again. */
+		rndis_stats.RxFiltered++;
+		return NULL;
+	}
+
+#if ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 )
+	if( prvRxChecksumSpotCheck( pxDescriptor ) == pdFALSE )
+	{
+		rndis_stats.RxChecksumErrors++;
+		return NULL;
+	}
+#endif
+
+	/* The IP task owns the buffer now, prvRxRefill replaces it */
+	pxRxBuffers[uxSlot]=NULL;
+	return pxDescriptor;
+}
+
+#if ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 )
+/**
+ * @brief  prvRxChecksumSpotCheck
+ *         Verifies the checksums the IP task skips, on one IPv4 frame out of
+ *         every configEMAC_RX_CHECKSUM_SPOT_CHECK. Runs in the EMAC task.
+ * @param  pxDescriptor: Received frame
+ * @retval pdFALSE if the frame is checked and found corrupt
+ */
+static BaseType_t prvRxChecksumSpotCheck( const NetworkBufferDescriptor_t *pxDescriptor )
+{
+	static UBaseType_t uxCountdown=0;
+	const IPPacket_t *pxIPPacket=( const IPPacket_t * ) pxDescriptor->pucEthernetBuffer;
+	const uint8_t *pucSegment;
+	uint8_t ucPseudoHeader[12];
+	size_t uxHeaderLength;
+	size_t uxTotalLength;
+	size_t uxSegmentLength;
+	uint32_t ulSum;
+
+	if( ( configEMAC_RX_CHECKSUM_SPOT_CHECK == 0 ) ||
+			( pxDescriptor->xDataLength < sizeof( IPPacket_t ) ) ||
+			( pxIPPacket->xEthernetHeader.usFrameType != ipIPv4_FRAME_TYPE ) )
+	{
+		return pdTRUE;
+	}
+	if( uxCountdown > 0 )
+	{
+		uxCountdown--;
+		return pdTRUE;
+	}
+	uxCountdown=configEMAC_RX_CHECKSUM_SPOT_CHECK - 1;
+	rndis_stats.RxChecksumChecked++;
+
+	uxHeaderLength=( size_t ) ( ( pxIPPacket->xIPHeader.ucVersionHeaderLength & 0x0FU ) << 2 );
+	uxTotalLength=( size_t ) FreeRTOS_ntohs( pxIPPacket->xIPHeader.usLength );
+	if( ( uxHeaderLength < ipSIZEOF_IPv4_HEADER ) ||
+			( uxTotalLength < uxHeaderLength ) ||
+			( uxTotalLength > pxDescriptor->xDataLength - ipSIZE_OF_ETH_HEADER ) ||
+			( USBD_NetOps_Checksum( 0, &( pxIPPacket->xIPHeader ), uxHeaderLength ) != ipCORRECT_CRC ) )
+	{
+		return pdFALSE;
+	}
+
+	/* A fragment does not hold the whole segment its checksum covers */
+	if( ( FreeRTOS_ntohs( pxIPPacket->xIPHeader.usFragmentOffset ) & 0x3FFFU ) != 0 )
+	{
+		return pdTRUE;
+	}
+
+	pucSegment=pxDescriptor->pucEthernetBuffer + ipSIZE_OF_ETH_HEADER + uxHeaderLength;
+	uxSegmentLength=uxTotalLength - uxHeaderLength;
+	switch( pxIPPacket->xIPHeader.ucProtocol )
+	{
+	case ipPROTOCOL_ICMP:
+		/* No pseudo header */
+		return ( USBD_NetOps_Checksum( 0, pucSegment, uxSegmentLength ) == ipCORRECT_CRC ) ? pdTRUE : pdFALSE;
+
+	case ipPROTOCOL_UDP:
+		if( uxSegmentLength < ipSIZE_OF_UDP_HEADER )
+		{
+			return pdFALSE;
+		}
+		/* A zero UDP checksum was not computed by the sender */
+		if( ( pucSegment[6] == 0 ) && ( pucSegment[7] == 0 ) )
+		{
+			return pdTRUE;
+		}
+		break;
+
+	case ipPROTOCOL_TCP:
+		if( uxSegmentLength < ipSIZE_OF_TCP_HEADER )
+		{
+			return pdFALSE;
+		}
+		break;
+
+	default:
+		/* Protocols the stack does not checksum are let through */
+		return pdTRUE;
+	}
+
+	/* Source and destination address, zero, protocol and segment length,
+	 * laid out in network order so the sum stays in memory byte order */
+	memcpy( ucPseudoHeader, &( pxIPPacket->xIPHeader.ulSourceIPAddress ), 8 );
+	ucPseudoHeader[8]=0;
+	ucPseudoHeader[9]=pxIPPacket->xIPHeader.ucProtocol;
+	ucPseudoHeader[10]=( uint8_t ) ( uxSegmentLength >> 8 );
+	ucPseudoHeader[11]=( uint8_t ) uxSegmentLength;
+	ulSum=USBD_NetOps_Checksum( 0, ucPseudoHeader, sizeof( ucPseudoHeader ) );
+	return ( USBD_NetOps_Checksum( ulSum, pucSegment, uxSegmentLength ) == ipCORRECT_CRC ) ? pdTRUE : pdFALSE;
+}
+#endif
+
+/**
+ * @brief  prvRxDeliver
+ *         Sends received frames to the IP task in a single event. Runs in
+ *         the EMAC task.
+ * @param  pxFirst: First network buffer, the next ones are linked through
+ *         pxNextBuffer when ipconfigUSE_LINKED_RX_MESSAGES is set
+ * @param  uxCount: Number of frames
+ * @retval None
+ */
+static void prvRxDeliver( NetworkBufferDescriptor_t *pxFirst, UBaseType_t uxCount )
+{
 	/* Used to indicate that xSendEventStructToIPTask() is being called because
 	of an Ethernet receive event. */
 	IPStackEvent_t xRxEvent;
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	NetworkBufferDescriptor_t *pxNext;
+#endif
+#if (USBD_PROFILING == 1)
+	uint32_t ulStamp;
+#endif
 
-	for( ;; )
+	/* The event about to be sent to the TCP/IP is an Rx event. */
+	xRxEvent.eEventType = eNetworkRxEvent;
+
+	/* pvData is used to point to the network buffer descriptor that
+	now references the received data. */
+	xRxEvent.pvData = ( void * ) pxFirst;
+
+	/* Send the data to the TCP/IP stack. */
+	if( xSendEventStructToIPTask( &xRxEvent, 0 ) == pdFALSE )
+	{
+		/* The buffers could not be sent to the IP task so they must be
+		released. */
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+		while( pxFirst != NULL )
+		{
+			pxNext = pxFirst->pxNextBuffer;
+			vReleaseNetworkBufferAndDescriptor( pxFirst );
+			pxFirst = pxNext;
+		}
+#else
+		vReleaseNetworkBufferAndDescriptor( pxFirst );
+#endif
+		rndis_stats.RxDropIpQueue+=uxCount;
+
+		/* Make a call to the standard trace macro to log the
+		occurrence. */
+		iptraceETHERNET_RX_EVENT_LOST();
+	}
+	else
+	{
+		/* The message was successfully sent to the TCP/IP stack.
+		Call the standard trace macro to log the occurrence. */
+		USBD_PROF_STAMP(ulStamp);
+		USBD_PROF_SPAN(USBD_PROF_RNDIS_RX_HANDOFF, ulRxWakeStamp, ulStamp);
+		USBD_PROF_SPAN(USBD_PROF_RNDIS_RX_TOTAL, ulRxBatchFirstStamp, ulStamp);
+		rndis_stats.RxFrames+=uxCount;
+		rndis_stats.RxBatches++;
+		iptraceNETWORK_INTERFACE_RECEIVE();
+	}
+}
+
+/**
+ * @brief  prvRxRelease
+ *         Gives the oldest receive buffer back to the USB interrupt, and
+ *         resumes reception if it was held because all buffers were full.
+ * @retval None
+ */
+static void prvRxRelease( void )
+{
+	taskENTER_CRITICAL();
+	ulRxTail++;
+	if(ucRxStalled){
+		prvRxArm();
+	}
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief  prvRxArm
+ *         Prepares the reception of the next message, into the next receive
+ *         buffer. Called from the USB interrupt, or with it masked.
+ * @retval None
+ */
+static void prvRxArm( void )
+{
+	NetworkBufferDescriptor_t *pxDescriptor;
+
+	if(ulRxHead-ulRxTail >= RNDIS_RX_FRAMES){
+		/* All buffers hold frames, the EMAC task resumes reception */
+		ucRxStalled=1;
+		return;
+	}
+	ucRxStalled=0;
+
+	pxDescriptor=pxRxBuffers[ulRxHead % RNDIS_RX_FRAMES];
+	if(pxDescriptor!=NULL){
+		ucRxFlowStalled=0;
+		USBD_RNDIS_ReceiveFrame(&hUsbDeviceFS, pxDescriptor->pucEthernetBuffer-RNDIS_PACKET_MSG_HEADER_SIZE, emacRX_ARM_SIZE);
+	} else if(xEMACTaskHandle!=0){
+		/* Out of buffers, held until prvRxRefill arms one */
+		if(!ucRxFlowStalled){
+			ucRxFlowStalled=1;
+			rndis_stats.RxFlowStalls++;
+		}
+		ucRxStalled=1;
+	} else {
+		/* Nothing would ever arm a buffer */
+		USBD_RNDIS_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS_Temp);
+		USBD_RNDIS_ReceivePacket(&hUsbDeviceFS);
+	}
+}
+
+/**
+ * @brief  prvRxRefill
+ *         Gives a network buffer to every receive slot whose buffer went to
+ *         the IP task, as long as enough are left free, and resumes reception
+ *         if it was held for lack of them. Runs in the EMAC task.
+ * @retval None
+ */
+static void prvRxRefill( void )
+{
+	NetworkBufferDescriptor_t *pxDescriptor;
+	UBaseType_t uxSlot;
+
+	/* Reception needs the headroom of the driver's own buffers */
+	configASSERT( xStaticBuffers != pdFALSE );
+
+	for( uxSlot = 0; uxSlot < RNDIS_RX_FRAMES; uxSlot++ )
+	{
+		if( pxRxBuffers[ uxSlot ] != NULL )
+		{
+			continue;
+		}
+		if( uxGetNumberOfFreeNetworkBuffers() <= configEMAC_RX_MIN_FREE_BUFFERS )
+		{
+			break;
+		}
+		USBD_PROF_START(cycles);
+		pxDescriptor = pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, 0 );
+		USBD_PROF_STOP(USBD_PROF_RNDIS_RX_REFILL, cycles);
+		if( pxDescriptor == NULL )
+		{
+			USBD_TRACE_EVENT(USBD_TRACE_NETBUF_FAIL, 0, ipTOTAL_ETHERNET_FRAME_SIZE, 0);
+			break;
+		}
+		pxRxBuffers[ uxSlot ] = pxDescriptor;
+	}
+
+	taskENTER_CRITICAL();
+	if( ucRxFlowStalled )
+	{
+		prvRxArm();
+	}
+	taskEXIT_CRITICAL();
+}
+
+#if ( configEMAC_RX_POLLING == 1 )
+/**
+ * @brief  prvRxModeration
+ *         Switches between one notification per received frame and polling,
+ *         from the number of frames received over the last window.
+ * @param  uxFrames: Frames processed since the last call
+ * @retval None
+ */
+static void prvRxModeration( UBaseType_t uxFrames )
+{
+	static TickType_t xWindowStart=0;
+	static UBaseType_t uxWindowFrames=0;
+	TickType_t xNow=xTaskGetTickCount();
+
+	uxWindowFrames+=uxFrames;
+	if( ( xNow - xWindowStart ) < emacRX_POLL_WINDOW_TICKS )
+	{
+		return;
+	}
+
+	if( uxWindowFrames >= configEMAC_RX_POLL_THRESHOLD )
 	{
-		/* Wait for the Ethernet MAC interrupt to indicate that another packet
-	        has been received.  The task notification is used in a similar way to a
-	        counting semaphore to count Rx events, but is a lot more efficient than
-	        a semaphore. */
-		ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+		/* Under load: the interrupt stops notifying, frames are collected every
+		poll period instead of costing a context switch each */
+		ucRxPolling=1;
+	}
+	else if( ucRxPolling )
+	{
+		/* Back to one notification per frame, for latency. A frame completed
+		after the last drain was not notified. */
+		ucRxPolling=0;
+		if( ulRxHead != ulRxTail )
+		{
+			xTaskNotify( xEMACTaskHandle, RNDIS_EVENT_RX, eSetBits );
+		}
+	}
+	xWindowStart=xNow;
+	uxWindowFrames=0;
+}
+#endif
+
+static void prvEMACHandlerTask( void *pvParameters ){
+	uint32_t ulEvents;
+	UBaseType_t uxFrames, uxBatch;
+	NetworkBufferDescriptor_t *pxDescriptor;
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	NetworkBufferDescriptor_t *pxFirst=NULL, *pxLast=NULL;
+#endif
 
-		/* See how much data was received.  Here it is assumed ReceiveSize() is
-	        a peripheral driver function that returns the number of bytes in the
-	        received Ethernet frame. */
+	prvRxRefill();
 
-		xBytesReceived = UserRxSize;
-//		timestamp=ullGetHighResolutionTime()-timestamp;
+	for( ;; )
+	{
+		/* Wait for the USB interrupt to indicate that packets have been
+	        received or that a zero copy transmission is done.  The task
+	        notification value is used as a set of event bits.  While polling,
+	        the interrupt does not notify received frames and the task wakes
+	        every poll period instead, as it does to retry the refill while
+	        reception is held for lack of buffers. */
+		xTaskNotifyWait( 0, 0xFFFFFFFFUL, &ulEvents, ( ucRxPolling || ucRxFlowStalled ) ? emacRX_POLL_TICKS : portMAX_DELAY );
+		USBD_TRACE_EVENT(USBD_TRACE_EMAC_NOTIFY, 0, ulEvents, ulRxHead - ulRxTail);
+		rndis_stats.EmacWakeups++;
+
+		if( ( ulEvents & RNDIS_EVENT_TX_DONE ) != 0 )
+		{
+			prvReleaseTxDone();
+		}
+		if( ( ulEvents & RNDIS_EVENT_STATS ) != 0 )
+		{
+			prvVendorQuery();
+		}
 
-		if( xBytesReceived > 44 )
+		/* Drain every frame received so far, reception continues into the
+		free buffers meanwhile.  With ipconfigUSE_LINKED_RX_MESSAGES the frames
+		are chained and handed to the IP task in one event. */
+		USBD_PROF_STAMP(ulRxWakeStamp);
+		uxFrames=0;
+		uxBatch=0;
+		while( ulRxTail != ulRxHead )
 		{
-			xBytesReceived-=44;
-			/* Allocate a network buffer descriptor that points to a buffer
-	            large enough to hold the received frame.  As this is the simple
-	            rather than efficient example the received data will just be copied
-	            into this buffer. */
-			pxBufferDescriptor = pxGetNetworkBufferWithDescriptor( xBytesReceived, 0 );
-
-			if( pxBufferDescriptor != NULL )
+			pxDescriptor=prvRxFrame( ulRxTail % RNDIS_RX_FRAMES );
+#if ( USBD_PROFILING == 1 )
+			if( uxBatch == 0 )
 			{
-				/* pxBufferDescriptor->pucEthernetBuffer now points to an Ethernet
-	                buffer large enough to hold the received data.  Copy the
-	                received data into pcNetworkBuffer->pucEthernetBuffer.  Here it
-	                is assumed ReceiveData() is a peripheral driver function that
-	                copies the received data into a buffer passed in as the function's
-	                parameter.  Remember! While is is a simple robust technique -
-	                it is not efficient.  An example that uses a zero copy technique
-	                is provided further down this page. */
-				memcpy(pxBufferDescriptor->pucEthernetBuffer, UserRxBufferFS+44, xBytesReceived);
-				UserRxSize=0;
-				pxBufferDescriptor->xDataLength = xBytesReceived;
-
-				/* See if the data contained in the received Ethernet frame needs
-	                to be processed.  NOTE! It is preferable to do this in
-	                the interrupt service routine itself, which would remove the need
-	                to unblock this task for packets that don't need processing. */
-				if( eConsiderFrameForProcessing( pxBufferDescriptor->pucEthernetBuffer )
-						== eProcessBuffer )
-				{
-					/* The event about to be sent to the TCP/IP is an Rx event. */
-					xRxEvent.eEventType = eNetworkRxEvent;
-
-					/* pvData is used to point to the network buffer descriptor that
-	                    now references the received data. */
-					xRxEvent.pvData = ( void * ) pxBufferDescriptor;
-
-					/* Send the data to the TCP/IP stack. */
-					if( xSendEventStructToIPTask( &xRxEvent, 0 ) == pdFALSE )
-					{
-						/* The buffer could not be sent to the IP task so the buffer
-	                        must be released. */
-						vReleaseNetworkBufferAndDescriptor( pxBufferDescriptor );
-
-						/* Make a call to the standard trace macro to log the
-	                        occurrence. */
-						iptraceETHERNET_RX_EVENT_LOST();
-					}
-					else
-					{
-						/* The message was successfully sent to the TCP/IP stack.
-	                        Call the standard trace macro to log the occurrence. */
-						iptraceNETWORK_INTERFACE_RECEIVE();
-					}
-				}
-				else
-				{
-					/* The Ethernet frame can be dropped, but the Ethernet buffer
-	                    must be released. */
-					vReleaseNetworkBufferAndDescriptor( pxBufferDescriptor );
-				}
+				ulRxBatchFirstStamp=ulRxDoneStamp[ulRxTail % RNDIS_RX_FRAMES];
+			}
+#endif
+			prvRxRelease();
+			uxFrames++;
+			if( pxDescriptor == NULL )
+			{
+				continue;
+			}
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+			pxDescriptor->pxNextBuffer=NULL;
+			if( pxFirst == NULL )
+			{
+				pxFirst=pxDescriptor;
 			}
 			else
 			{
-				/* The event was lost because a network buffer was not available.
-	                Call the standard trace macro to log the occurrence. */
-				iptraceETHERNET_RX_EVENT_LOST();
+				pxLast->pxNextBuffer=pxDescriptor;
 			}
+			pxLast=pxDescriptor;
+			uxBatch++;
+#else
+			prvRxDeliver( pxDescriptor, 1 );
+#endif
 		}
-		USBD_RNDIS_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS_Temp);
-		USBD_RNDIS_ReceivePacket(&hUsbDeviceFS);
-
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+		if( pxFirst != NULL )
+		{
+			prvRxDeliver( pxFirst, uxBatch );
+			pxFirst=NULL;
+		}
+#else
+		( void ) uxBatch;
+#endif
+		prvRxRefill();
+#if ( configEMAC_RX_POLLING == 1 )
+		prvRxModeration( uxFrames );
+#else
+		( void ) uxFrames;
+#endif
 	}
 }
 
@@ -758,5 +1472,7 @@ static void prvEMACHandlerTask( void *pvParameters ){
  * @}
  */
 
+#endif /* USBD_NET_CLASS == USBD_NET_CLASS_RNDIS && USBD_CDC_FUNCTION == 0 */
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
 
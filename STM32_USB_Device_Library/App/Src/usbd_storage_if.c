@@ -0,0 +1,235 @@
+/**
+ ******************************************************************************
+ * @file    usbd_storage_if.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   Storage of the mass storage function: the SD card of the board
+ *          through the HAL SD driver. Without HAL_SD_MODULE_ENABLED the unit
+ *          reports no medium.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_storage_if.h"
+#include "../../Class/MSC/inc/usbd_msc_scsi.h"
+#include "stm32f4xx_hal.h"
+
+#if (USBD_MSC_FUNCTION == 1)
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup USBD_STORAGE
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_STORAGE_Private_Variables
+ * @{
+ */
+/* USB Mass storage Standard Inquiry Data */
+static const int8_t STORAGE_Inquirydata_FS[] = {/* 36 */
+
+	/* LUN 0 */
+	0x00,
+	0x80,
+	0x02,
+	0x02,
+	(STANDARD_INQUIRY_DATA_LEN - 5),
+	0x00,
+	0x00,
+	0x00,
+	'S', 'T', 'M', ' ', ' ', ' ', ' ', ' ', /* Manufacturer : 8 bytes */
+	'S', 'D', ' ', 'C', 'a', 'r', 'd', ' ', /* Product      : 16 Bytes */
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
+	'0', '.', '0' ,'1',                     /* Version      : 4 Bytes */
+};
+/**
+ * @}
+ */
+
+/** @defgroup USBD_STORAGE_Exported_Variables
+ * @{
+ */
+#ifdef HAL_SD_MODULE_ENABLED
+extern SD_HandleTypeDef hsd;
+#endif
+/**
+ * @}
+ */
+
+/** @defgroup USBD_STORAGE_Private_FunctionPrototypes
+ * @{
+ */
+static int8_t STORAGE_Init_FS (uint8_t lun);
+static int8_t STORAGE_GetCapacity_FS (uint8_t lun, uint32_t *block_num, uint16_t *block_size);
+static int8_t STORAGE_IsReady_FS (uint8_t lun);
+static int8_t STORAGE_IsWriteProtected_FS (uint8_t lun);
+static int8_t STORAGE_Read_FS (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t STORAGE_Write_FS (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t STORAGE_GetMaxLun_FS (void);
+/**
+ * @}
+ */
+
+USBD_StorageTypeDef USBD_Storage_Interface_fops_FS =
+{
+	STORAGE_Init_FS,
+	STORAGE_GetCapacity_FS,
+	STORAGE_IsReady_FS,
+	STORAGE_IsWriteProtected_FS,
+	STORAGE_Read_FS,
+	STORAGE_Write_FS,
+	STORAGE_GetMaxLun_FS,
+	(int8_t *)STORAGE_Inquirydata_FS,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  STORAGE_Init_FS
+ *         The card is initialized by the application, with MX_SDIO_SD_Init
+ * @param  lun: Logical unit number
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t STORAGE_Init_FS (uint8_t lun)
+{
+	return (USBD_OK);
+}
+
+/**
+ * @brief  STORAGE_GetCapacity_FS
+ *         Number and size of the logical blocks of the card
+ * @param  lun: Logical unit number
+ * @param  block_num: Number of blocks
+ * @param  block_size: Block size in bytes
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t STORAGE_GetCapacity_FS (uint8_t lun, uint32_t *block_num, uint16_t *block_size)
+{
+#ifdef HAL_SD_MODULE_ENABLED
+	HAL_SD_CardInfoTypeDef info;
+
+	if(HAL_SD_GetCardInfo(&hsd, &info) != HAL_OK){
+		return (USBD_FAIL);
+	}
+	*block_num  = info.LogBlockNbr;
+	*block_size = info.LogBlockSize;
+	return (USBD_OK);
+#else
+	return (USBD_FAIL);
+#endif
+}
+
+/**
+ * @brief  STORAGE_IsReady_FS
+ *         The card answers and is not busy with a previous access
+ * @param  lun: Logical unit number
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t STORAGE_IsReady_FS (uint8_t lun)
+{
+#ifdef HAL_SD_MODULE_ENABLED
+	if(hsd.State == HAL_SD_STATE_RESET){
+		return (USBD_FAIL);
+	}
+	return (USBD_OK);
+#else
+	return (USBD_FAIL);
+#endif
+}
+
+/**
+ * @brief  STORAGE_IsWriteProtected_FS
+ * @param  lun: Logical unit number
+ * @retval 0 when writable
+ */
+static int8_t STORAGE_IsWriteProtected_FS (uint8_t lun)
+{
+	return 0;
+}
+
+#ifdef HAL_SD_MODULE_ENABLED
+/**
+ * @brief  STORAGE_WaitTransfer
+ *         Wait for the card to be back in the transfer state
+ * @param  None
+ * @retval USBD_OK, USBD_FAIL on timeout
+ */
+static int8_t STORAGE_WaitTransfer(void)
+{
+	uint32_t tickstart = HAL_GetTick();
+
+	while(HAL_SD_GetCardState(&hsd) != HAL_SD_CARD_TRANSFER){
+		if((HAL_GetTick() - tickstart) >= STORAGE_TIMEOUT){
+			return (USBD_FAIL);
+		}
+	}
+	return (USBD_OK);
+}
+#endif
+
+/**
+ * @brief  STORAGE_Read_FS
+ *         Read blocks, called from the task of usbd_msc_if.c
+ * @param  lun: Logical unit number
+ * @param  buf: destination, blk_len blocks
+ * @param  blk_addr: first block
+ * @param  blk_len: number of blocks
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t STORAGE_Read_FS (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+{
+#ifdef HAL_SD_MODULE_ENABLED
+	if(HAL_SD_ReadBlocks(&hsd, buf, blk_addr, blk_len, STORAGE_TIMEOUT) != HAL_OK){
+		return (USBD_FAIL);
+	}
+	return STORAGE_WaitTransfer();
+#else
+	return (USBD_FAIL);
+#endif
+}
+
+/**
+ * @brief  STORAGE_Write_FS
+ *         Write blocks, called from the task of usbd_msc_if.c
+ * @param  lun: Logical unit number
+ * @param  buf: source, blk_len blocks
+ * @param  blk_addr: first block
+ * @param  blk_len: number of blocks
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t STORAGE_Write_FS (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+{
+#ifdef HAL_SD_MODULE_ENABLED
+	if(HAL_SD_WriteBlocks(&hsd, buf, blk_addr, blk_len, STORAGE_TIMEOUT) != HAL_OK){
+		return (USBD_FAIL);
+	}
+	return STORAGE_WaitTransfer();
+#else
+	return (USBD_FAIL);
+#endif
+}
+
+/**
+ * @brief  STORAGE_GetMaxLun_FS
+ * @param  None
+ * @retval Highest logical unit number
+ */
+static int8_t STORAGE_GetMaxLun_FS (void)
+{
+	return (STORAGE_LUN_NBR - 1);
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif /* USBD_MSC_FUNCTION */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,141 @@
+/**
+  ******************************************************************************
+  * @file    usbd_trace.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Binary event trace of the USB device and RNDIS interface.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_trace.h"
+
+/** @addtogroup USBD_OTG_DRIVER
+  * @{
+  */
+
+/** @defgroup USBD_TRACE
+  * @brief Binary event trace
+  * @{
+  */
+
+#if ((USBD_TRACE_DEPTH & (USBD_TRACE_DEPTH - 1)) != 0)
+#error "USBD_TRACE_DEPTH must be a power of two"
+#endif
+
+/** @defgroup USBD_TRACE_Private_Variables
+  * @{
+  */
+#if (USBD_TRACE == 1)
+USBD_Trace_RingTypeDef USBD_Trace;
+#endif
+/**
+  * @}
+  */
+
+/** @defgroup USBD_TRACE_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Starts the DWT cycle counter, clears and enables the trace.
+  * @retval None
+  */
+void USBD_Trace_Init(void)
+{
+#if (USBD_TRACE == 1)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  USBD_Trace.enabled = 0;
+  /* Sequence numbers of unwritten slots never match the decoder's */
+  USBD_memset(USBD_Trace.entry, 0xFF, sizeof(USBD_Trace.entry));
+  USBD_Trace.magic = USBD_TRACE_MAGIC;
+  USBD_Trace.version = USBD_TRACE_VERSION;
+  USBD_Trace.entry_size = sizeof(USBD_Trace_EntryTypeDef);
+  USBD_Trace.depth = USBD_TRACE_DEPTH;
+  USBD_Trace.clock = SystemCoreClock;
+  USBD_Trace.seq = 0;
+  USBD_Trace.enabled = 1;
+#endif
+}
+
+/**
+  * @brief  Appends an event to the trace. Callable from any context.
+  * @param  type: Event type
+  * @param  ep: Endpoint address, 0 when not relevant
+  * @param  arg0: First event argument
+  * @param  arg1: Second event argument
+  * @retval None
+  */
+void USBD_Trace_Record(USBD_Trace_TypeTypeDef type, uint8_t ep, uint32_t arg0, uint32_t arg1)
+{
+#if (USBD_TRACE == 1)
+  USBD_Trace_EntryTypeDef *entry;
+  uint32_t seq;
+
+  if (USBD_Trace.enabled == 0)
+  {
+    return;
+  }
+
+  /* Reserve the slot, an interrupting writer takes the next one */
+  do
+  {
+    seq = __LDREXW(&USBD_Trace.seq);
+  } while (__STREXW(seq + 1, &USBD_Trace.seq) != 0);
+
+  entry = &USBD_Trace.entry[seq & (USBD_TRACE_DEPTH - 1)];
+  entry->timestamp = DWT->CYCCNT;
+  entry->type = type;
+  entry->ep = ep;
+  entry->arg0 = arg0;
+  entry->arg1 = arg1;
+  __DMB();
+  entry->seq = (uint16_t)seq;
+#else
+  (void)type;
+  (void)ep;
+  (void)arg0;
+  (void)arg1;
+#endif
+}
+
+/**
+  * @brief  Stops recording, the ring keeps the events leading here.
+  * @retval None
+  */
+void USBD_Trace_Freeze(void)
+{
+#if (USBD_TRACE == 1)
+  USBD_Trace.enabled = 0;
+#endif
+}
+
+/**
+  * @brief  Resumes recording after USBD_Trace_Freeze.
+  * @retval None
+  */
+void USBD_Trace_Resume(void)
+{
+#if (USBD_TRACE == 1)
+  if (USBD_Trace.magic == USBD_TRACE_MAGIC)
+  {
+    USBD_Trace.enabled = 1;
+  }
+#endif
+}
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
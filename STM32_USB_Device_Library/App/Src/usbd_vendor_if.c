@@ -0,0 +1,236 @@
+/**
+ ******************************************************************************
+ * @file    usbd_vendor_if.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   Stream endpoints of the vendor bulk function: OUT data is
+ *          received into buffers queued in turn, IN data is either given
+ *          by the application with VENDOR_Transmit_FS or the test pattern
+ *          of VENDOR_REQ_SET_SOURCE.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_vendor_if.h"
+
+#if (USBD_VENDOR_FUNCTION == 1)
+
+/** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup USBD_VENDOR_IF
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_VENDOR_IF_Private_Defines
+ * @{
+ */
+/* Transfers kept queued per direction, up to USBD_LLEX_QUEUE_DEPTH: one on
+the bus while the others wait, so that the endpoint never idles between
+two of them */
+#define VENDOR_BUFFERS			3
+#define VENDOR_BUFFER_SIZE		(VENDOR_PATTERN_WORDS * 4)
+/**
+ * @}
+ */
+
+/** @defgroup USBD_VENDOR_IF_Private_Variables
+ * @{
+ */
+static uint32_t ulRxBuffer[VENDOR_BUFFERS][VENDOR_BUFFER_SIZE / 4];
+
+/* The test pattern, read only while it is sent, so one buffer is queued
+VENDOR_BUFFERS times */
+static uint32_t ulPattern[VENDOR_PATTERN_WORDS];
+static volatile uint8_t ucSource=0;
+
+static VENDOR_StatsTypeDef vendor_stats;
+/**
+ * @}
+ */
+
+/** @defgroup USBD_VENDOR_IF_Exported_Variables
+ * @{
+ */
+extern USBD_HandleTypeDef hUsbDeviceFS;
+/**
+ * @}
+ */
+
+/** @defgroup USBD_VENDOR_IF_Private_FunctionPrototypes
+ * @{
+ */
+static int8_t VENDOR_Init_FS     (void);
+static int8_t VENDOR_DeInit_FS   (void);
+static int8_t VENDOR_Control_FS  (USBD_SetupReqTypedef *req, uint8_t* pbuf);
+static int8_t VENDOR_Receive_FS  (uint8_t* pbuf, uint32_t *Len);
+static int8_t VENDOR_TransmitCplt_FS  (uint8_t* pbuf, uint32_t *Len);
+/**
+ * @}
+ */
+
+USBD_VENDOR_ItfTypeDef USBD_VENDOR_Interface_fops_FS =
+{
+	VENDOR_Init_FS,
+	VENDOR_DeInit_FS,
+	VENDOR_Control_FS,
+	VENDOR_Receive_FS,
+	VENDOR_TransmitCplt_FS,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  VENDOR_Init_FS
+ *         Configured: every receive buffer is queued
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t VENDOR_Init_FS(void)
+{
+	uint32_t i;
+
+	ucSource=0;
+	for(i=0; i<VENDOR_PATTERN_WORDS; i++){
+		ulPattern[i]=i;
+	}
+	for(i=0; i<VENDOR_BUFFERS; i++){
+		USBD_VENDOR_Receive(&hUsbDeviceFS, (uint8_t*)ulRxBuffer[i], VENDOR_BUFFER_SIZE);
+	}
+	return (USBD_OK);
+}
+
+/**
+ * @brief  VENDOR_DeInit_FS
+ *         Unconfigured, the queued buffers were given back
+ * @param  None
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t VENDOR_DeInit_FS(void)
+{
+	ucSource=0;
+	return (USBD_OK);
+}
+
+/**
+ * @brief  VENDOR_Control_FS
+ *         Vendor requests to the interface
+ * @param  req: request
+ * @param  pbuf: its data, wLength bytes to fill in for a request to the host
+ * @retval Result of the operation: USBD_OK, USBD_FAIL stalls the request
+ */
+static int8_t VENDOR_Control_FS(USBD_SetupReqTypedef *req, uint8_t* pbuf)
+{
+	uint32_t i;
+
+	switch(req->bRequest){
+	case VENDOR_REQ_SET_SOURCE:
+		ucSource=(req->wValue!=0);
+		if(ucSource){
+			/* Up to the queue depth, with those still queued from before */
+			for(i=0; i<VENDOR_BUFFERS; i++){
+				USBD_VENDOR_Transmit(&hUsbDeviceFS, (uint8_t*)ulPattern, VENDOR_BUFFER_SIZE);
+			}
+		}
+		return (USBD_OK);
+
+	case VENDOR_REQ_GET_STATS:
+		if(((req->bmRequest & 0x80)==0) || (req->wLength>sizeof(vendor_stats))){
+			return (USBD_FAIL);
+		}
+		USBD_memcpy(pbuf, &vendor_stats, req->wLength);
+		return (USBD_OK);
+
+	case VENDOR_REQ_RESET_STATS:
+		USBD_memset(&vendor_stats, 0, sizeof(vendor_stats));
+		return (USBD_OK);
+
+	default:
+		return (USBD_FAIL);
+	}
+}
+
+/**
+ * @brief  VENDOR_Receive_FS
+ *         OUT buffer filled, it is queued again at once. Called from the
+ *         USB interrupt.
+ * @param  pbuf: Buffer of data received
+ * @param  Len: Number of data received (in bytes), 0 when aborted
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t VENDOR_Receive_FS(uint8_t* pbuf, uint32_t *Len)
+{
+	if(*Len==0){
+		vendor_stats.Aborted++;
+		return (USBD_OK);
+	}
+	vendor_stats.RxBytes+=*Len;
+	vendor_stats.RxTransfers++;
+
+	return USBD_VENDOR_Receive(&hUsbDeviceFS, pbuf, VENDOR_BUFFER_SIZE);
+}
+
+/**
+ * @brief  VENDOR_TransmitCplt_FS
+ *         IN buffer sent, the test pattern is queued again while the source
+ *         runs. Called from the USB interrupt.
+ * @param  pbuf: Buffer sent
+ * @param  Len: Number of data sent (in bytes), 0 when aborted
+ * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+ */
+static int8_t VENDOR_TransmitCplt_FS(uint8_t* pbuf, uint32_t *Len)
+{
+	if(*Len==0){
+		vendor_stats.Aborted++;
+		return (USBD_OK);
+	}
+	vendor_stats.TxBytes+=*Len;
+	vendor_stats.TxTransfers++;
+
+	if(ucSource && (pbuf==(uint8_t*)ulPattern)){
+		return USBD_VENDOR_Transmit(&hUsbDeviceFS, pbuf, VENDOR_BUFFER_SIZE);
+	}
+	return (USBD_OK);
+}
+
+/**
+ * @brief  VENDOR_Transmit_FS
+ *         Queue data on the IN endpoint, without copy
+ * @param  Buf: Buffer of data to be sent, untouched until sent
+ * @param  Len: Number of data to be sent (in bytes)
+ * @retval USBD_OK, USBD_BUSY while the queue is full, USBD_FAIL if not configured
+ */
+uint8_t VENDOR_Transmit_FS(uint8_t* Buf, uint32_t Len)
+{
+	uint8_t ret=USBD_VENDOR_Transmit(&hUsbDeviceFS, Buf, Len);
+
+	if(ret==USBD_BUSY){
+		vendor_stats.TxBusy++;
+	}
+	return ret;
+}
+
+/**
+ * @brief  VENDOR_GetStats
+ *         Copy the stream counters
+ * @param  pStats: destination
+ * @retval None
+ */
+void VENDOR_GetStats(VENDOR_StatsTypeDef *pStats)
+{
+	*pStats=vendor_stats;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#endif /* USBD_VENDOR_FUNCTION */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,158 @@
+/**
+  ******************************************************************************
+  * @file    usbd_audio.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   header file for the usbd_audio.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_AUDIO_H
+#define __USB_AUDIO_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+#include  "usbd_ring.h"
+#include  "usbd_audio_fb.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_audio
+  * @brief This file is the Header file for usbd_audio.c
+  * @{
+  */
+
+
+/** @defgroup usbd_audio_Exported_Defines
+  * @{
+  */
+#define AUDIO_OUT_EP                                  0x01  /* Isochronous samples, renumbered by the composite layer */
+#define AUDIO_FB_EP                                   0x81  /* Isochronous feedback, renumbered by the composite layer */
+
+#define AUDIO_CHANNELS                                2
+#define AUDIO_SAMPLE_BYTES                            (AUDIO_CHANNELS * 2)  /* 16 bit PCM */
+/* One sample more than nominal, for the host to follow the feedback */
+#define AUDIO_OUT_PACKET_MAX                          ((USBD_AUDIO_FREQ / 1000 + 1) * AUDIO_SAMPLE_BYTES)
+#define AUDIO_OUT_BUFFERS                             2     /* Packets queued, one received while the other is handled */
+#define AUDIO_FB_PACKET_SIZE                          3     /* 10.14 samples per frame */
+
+/* Samples the feedback keeps buffered, the delay from the host to the
+speaker, see AUDIO_LATENCY_MS in usbd_conf.h */
+#define AUDIO_LATENCY_SAMPLES                         (AUDIO_LATENCY_MS * USBD_AUDIO_FREQ / 1000)
+
+#define AUDIO_FB_REFRESH                              5     /* The host reads the feedback every 2^5 frames */
+#define AUDIO_FB_WINDOW_LOG2                          6     /* Frames per feedback update, log2, more than 2^AUDIO_FB_REFRESH */
+
+#define USB_AUDIO_CONFIG_DESC_SIZ                     119
+#define AUDIO_AC_DESC_SIZ                             40    /* Class-specific AudioControl descriptors */
+
+#define AUDIO_IT_ID                                   0x01  /* USB streaming input terminal */
+#define AUDIO_FU_ID                                   0x02  /* Feature unit, mute */
+#define AUDIO_OT_ID                                   0x03  /* Speaker output terminal */
+
+/*---------------------------------------------------------------------*/
+/*  AUDIO definitions                                                  */
+/*---------------------------------------------------------------------*/
+#define AUDIO_REQ_SET_CUR                             0x01
+#define AUDIO_REQ_GET_CUR                             0x81
+#define AUDIO_REQ_GET_MIN                             0x82
+#define AUDIO_REQ_GET_MAX                             0x83
+#define AUDIO_REQ_GET_RES                             0x84
+
+#define AUDIO_CONTROL_MUTE                            0x01
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/* The samples go to a ring owned by the interface: the class produces
+into it from the USB interrupt, the playback consumes it and counts what it
+played. */
+typedef struct _USBD_AUDIO_Itf
+{
+  int8_t   (* Init)         (uint32_t AudioFreq);                      /* Configured */
+  int8_t   (* DeInit)       (void);                                    /* Unconfigured */
+  int8_t   (* Streaming)    (uint8_t Active);                          /* Streaming interface alternate setting */
+  int8_t   (* MuteCtl)      (uint8_t Mute);
+  uint32_t (* GetClock)     (void);                                    /* Samples played so far, silence included */
+  USBD_RingTypeDef *pRing;                                             /* PCM from the host */
+
+}USBD_AUDIO_ItfTypeDef;
+
+
+typedef struct
+{
+  uint32_t RxBuffer[AUDIO_OUT_BUFFERS][(AUDIO_OUT_PACKET_MAX + 3) / 4];  /* Packets being received */
+  uint8_t  FbBuffer[4];                      /* Feedback being sent */
+  uint32_t data[1];                          /* EP0 requests, force 32bits alignment */
+  uint8_t  CmdOpCode;                        /* Waiting for its data stage */
+  uint8_t  CmdControl;
+  uint8_t  AltSetting;                       /* Of the streaming interface */
+  uint8_t  Mute;
+  uint8_t  FbArmed;                          /* Feedback transfer queued */
+  uint32_t Overruns;                         /* Packets the ring had no room for */
+  uint32_t Incomplete;                       /* Isochronous transfers missed */
+  USBD_AUDIO_FbTypeDef Fb;
+}
+USBD_AUDIO_HandleTypeDef;
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_AUDIO;
+#define USBD_AUDIO_CLASS    &USBD_AUDIO
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_AUDIO_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+                                        USBD_AUDIO_ItfTypeDef *fops);
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_AUDIO_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
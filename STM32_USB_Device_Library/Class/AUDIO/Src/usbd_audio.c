@@ -0,0 +1,822 @@
+/**
+ ******************************************************************************
+ * @file    usbd_audio.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB Audio function:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as a stereo speaker
+ *           - Isochronous OUT stream into a byte ring
+ *           - Explicit feedback of the sink clock to the host
+ *           - Mute control
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                                AUDIO Class Driver Description
+ *          ===================================================================
+ *           This driver implements the following aspects of the
+ *           "Universal Serial Bus Device Class Definition for Audio Devices"
+ *           Release 1.0:
+ *             - AudioControl interface with an input terminal, a feature
+ *               unit with the master mute and a speaker output terminal
+ *             - AudioStreaming interface, alternate setting 1 with a 16 bit
+ *               stereo PCM isochronous OUT endpoint at USBD_AUDIO_FREQ
+ *             - Asynchronous synchronization type, with an isochronous
+ *               feedback IN endpoint
+ *             - SET_CUR and GET_CUR of the mute control
+ *
+ *           The speaker plays at its own clock, which the host does not
+ *           follow by itself. The host sends as many samples per frame as
+ *           the feedback endpoint tells it, and the feedback is computed at
+ *           every SOF from the samples the interface played and the samples
+ *           still buffered, see usbd_audio_fb.c: the buffer stays at
+ *           AUDIO_LATENCY_SAMPLES whatever the drift between the two clocks.
+ *
+ *           Two OUT transfers of one packet are queued, one is received
+ *           while the previous one is copied into the ring of the
+ *           interface, each is queued again once copied. A packet the ring
+ *           has no room for is dropped whole.
+ *
+ *           The SOF timer of the composite layer runs every frame while
+ *           the host streams, the SOF interrupt is masked otherwise.
+ *
+ *           The feedback endpoint is armed with the latest value. The host
+ *           only reads it every 2^AUDIO_FB_REFRESH frames, in the others the
+ *           transfer is incomplete at the end of the frame and carried over
+ *           to the next one: only its even/odd frame changes, the value
+ *           stays in the FIFO. The value read is thus up to one refresh
+ *           period old, well within the averaging window of the rate. The
+ *           endpoint is aborted and armed again only if the core dropped
+ *           the transfer.
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_audio.h"
+#include "../../Composite/inc/usbd_composite.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+#include "usbd_ll_ex.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+
+/** @defgroup USBD_AUDIO
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_AUDIO_Private_TypesDefinitions
+ * @{
+ */
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_AUDIO_Private_Defines
+ * @{
+ */
+#define AUDIO_SAMPLE_FREQ(frq)      (uint8_t)(frq), (uint8_t)((frq >> 8)), (uint8_t)((frq >> 16))
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_AUDIO_Private_Macros
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_AUDIO_Private_FunctionPrototypes
+ * @{
+ */
+
+
+static uint8_t  USBD_AUDIO_Init (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_AUDIO_DeInit (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_AUDIO_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_AUDIO_EP0_RxReady (USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_AUDIO_SOF (USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_AUDIO_IsoINIncomplete (USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  USBD_AUDIO_IsoOutIncomplete (USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static void  USBD_AUDIO_SetStreaming (USBD_HandleTypeDef *pdev, uint8_t alt);
+
+static void  USBD_AUDIO_RxStart (USBD_HandleTypeDef *pdev);
+
+static void  USBD_AUDIO_FbStart (USBD_HandleTypeDef *pdev);
+
+static void  USBD_AUDIO_RxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static void  USBD_AUDIO_FbCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static uint8_t  *USBD_AUDIO_GetFSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_AUDIO_GetHSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_AUDIO_GetOtherSpeedCfgDesc (uint16_t *length);
+
+uint8_t  *USBD_AUDIO_GetDeviceQualifierDescriptor (uint16_t *length);
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_AUDIO_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+		USB_LEN_DEV_QUALIFIER_DESC,
+		USB_DESC_TYPE_DEVICE_QUALIFIER,
+		0x00,
+		0x02,
+		0x00,
+		0x00,
+		0x00,
+		0x40,
+		0x01,
+		0x00,
+};
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_AUDIO_Private_Variables
+ * @{
+ */
+
+
+/* AUDIO interface class callbacks structure */
+USBD_ClassTypeDef  USBD_AUDIO =
+{
+		USBD_AUDIO_Init,
+		USBD_AUDIO_DeInit,
+		USBD_AUDIO_Setup,
+		NULL,                 /* EP0_TxSent, */
+		USBD_AUDIO_EP0_RxReady,
+		NULL,                 /* DataIn, every transfer is queued */
+		NULL,                 /* DataOut, every transfer is queued */
+		USBD_AUDIO_SOF,
+		USBD_AUDIO_IsoINIncomplete,
+		USBD_AUDIO_IsoOutIncomplete,
+		USBD_AUDIO_GetHSCfgDesc,
+		USBD_AUDIO_GetFSCfgDesc,
+		USBD_AUDIO_GetOtherSpeedCfgDesc,
+		USBD_AUDIO_GetDeviceQualifierDescriptor,
+#if (USBD_SUPPORT_USER_STRING == 1)
+		NULL,
+#endif
+};
+
+/* USB AUDIO device Configuration Descriptor */
+__ALIGN_BEGIN uint8_t USBD_AUDIO_CfgFSDesc[USB_AUDIO_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+		//SIZE: 9+9+9+12+10+9+9+9+7+11+9+7+9=119
+		/*Configuration Descriptor*/
+		0x09,   /* bLength: Configuration Descriptor size */
+		USB_DESC_TYPE_CONFIGURATION,      /* bDescriptorType: Configuration */
+		USB_AUDIO_CONFIG_DESC_SIZ,                /* wTotalLength:no of returned bytes */
+		0x00,
+		0x02,   /* bNumInterfaces: 2 interface */
+		0x01,   /* bConfigurationValue: Configuration value */
+		0x00,   /* iConfiguration: Index of string descriptor describing the configuration */
+		0xC0,   /* bmAttributes: self powered */
+		0xFA,   /* MaxPower 0 mA */
+
+		///INTERFACE DESCRIPTOR(0)
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x00,    ///bInterfaceNumber: Interface Number
+		0x00,    ///bAlternateSetting: Alternate setting for this interface
+		0x00,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x01,    ///iInterfaceClass: Class Code: Audio
+		0x01,    ///iInterfaceSubClass: AudioControl
+		0x00,    ///bInterfaceProtocol: Protocol Code
+		0x00,    ///iInterface: String index
+
+		///AUDIOCONTROL HEADER DESCRIPTOR
+		0x09,    ///bLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x01,    ///bDescriptorSubtype: Header
+		0x00,    ///bcdADC: 1.00
+		0x01,
+		AUDIO_AC_DESC_SIZ,    ///wTotalLength
+		0x00,
+		0x01,    ///bInCollection: 1 streaming interface
+		0x01,    ///baInterfaceNr(1), renumbered by the composite layer
+
+		///INPUT TERMINAL DESCRIPTOR
+		0x0C,    ///bLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x02,    ///bDescriptorSubtype: Input Terminal
+		AUDIO_IT_ID,    ///bTerminalID
+		0x01,    ///wTerminalType: USB streaming
+		0x01,
+		0x00,    ///bAssocTerminal
+		AUDIO_CHANNELS,    ///bNrChannels
+		0x03,    ///wChannelConfig: left front, right front
+		0x00,
+		0x00,    ///iChannelNames
+		0x00,    ///iTerminal
+
+		///FEATURE UNIT DESCRIPTOR
+		0x0A,    ///bLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x06,    ///bDescriptorSubtype: Feature Unit
+		AUDIO_FU_ID,    ///bUnitID
+		AUDIO_IT_ID,    ///bSourceID
+		0x01,    ///bControlSize
+		AUDIO_CONTROL_MUTE,    ///bmaControls(0): master mute
+		0x00,    ///bmaControls(1)
+		0x00,    ///bmaControls(2)
+		0x00,    ///iFeature
+
+		///OUTPUT TERMINAL DESCRIPTOR
+		0x09,    ///bLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x03,    ///bDescriptorSubtype: Output Terminal
+		AUDIO_OT_ID,    ///bTerminalID
+		0x01,    ///wTerminalType: Speaker
+		0x03,
+		0x00,    ///bAssocTerminal
+		AUDIO_FU_ID,    ///bSourceID
+		0x00,    ///iTerminal
+
+		///INTERFACE DESCRIPTOR(1), zero bandwidth
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x01,    ///bInterfaceNumber: Interface Number
+		0x00,    ///bAlternateSetting: Alternate setting for this interface
+		0x00,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x01,    ///iInterfaceClass: Class Code: Audio
+		0x02,    ///iInterfaceSubClass: AudioStreaming
+		0x00,    ///bInterfaceProtocol: Protocol Code
+		0x00,    ///iInterface: String index
+
+		///INTERFACE DESCRIPTOR(1), streaming
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x01,    ///bInterfaceNumber: Interface Number
+		0x01,    ///bAlternateSetting: Alternate setting for this interface
+		0x02,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x01,    ///iInterfaceClass: Class Code: Audio
+		0x02,    ///iInterfaceSubClass: AudioStreaming
+		0x00,    ///bInterfaceProtocol: Protocol Code
+		0x00,    ///iInterface: String index
+
+		///AUDIOSTREAMING GENERAL DESCRIPTOR
+		0x07,    ///bLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x01,    ///bDescriptorSubtype: AS_GENERAL
+		AUDIO_IT_ID,    ///bTerminalLink
+		AUDIO_LATENCY_MS,    ///bDelay: frames, kept by the feedback
+		0x01,    ///wFormatTag: PCM
+		0x00,
+
+		///TYPE I FORMAT DESCRIPTOR
+		0x0B,    ///bLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x02,    ///bDescriptorSubtype: FORMAT_TYPE
+		0x01,    ///bFormatType: Type I
+		AUDIO_CHANNELS,    ///bNrChannels
+		0x02,    ///bSubFrameSize: 2 bytes
+		0x10,    ///bBitResolution: 16 bits
+		0x01,    ///bSamFreqType: 1 frequency
+		AUDIO_SAMPLE_FREQ(USBD_AUDIO_FREQ),    ///tSamFreq
+
+		///ENDPOINT DESCRIPTOR(0)
+		0x09,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		AUDIO_OUT_EP,    ///bEndpointAddress: Endpoint address (OUT,EP1)
+		0x05,    ///bmAttributes: Transfer Type: ISOCHRONOUS, asynchronous
+		LOBYTE(AUDIO_OUT_PACKET_MAX),    ///wMaxPacketSize: Endpoint Size
+		HIBYTE(AUDIO_OUT_PACKET_MAX),    ///wMaxPacketSize: Endpoint Size
+		0x01,    ///bInterval: every frame
+		0x00,    ///bRefresh
+		AUDIO_FB_EP,    ///bSynchAddress, renumbered by the composite layer
+
+		///AUDIO ENDPOINT DESCRIPTOR
+		0x07,    ///bLength
+		0x25,    ///bDescriptorType: CS_ENDPOINT
+		0x01,    ///bDescriptor: EP_GENERAL
+		0x00,    ///bmAttributes: no sampling frequency control
+		0x00,    ///bLockDelayUnits
+		0x00,    ///wLockDelay
+		0x00,
+
+		///ENDPOINT DESCRIPTOR(1)
+		0x09,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		AUDIO_FB_EP,    ///bEndpointAddress: Endpoint address (IN,EP1)
+		0x11,    ///bmAttributes: Transfer Type: ISOCHRONOUS, feedback
+		AUDIO_FB_PACKET_SIZE,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x01,    ///bInterval: every frame
+		AUDIO_FB_REFRESH,    ///bRefresh: read every 2^AUDIO_FB_REFRESH frames
+		0x00,    ///bSynchAddress
+		/*---------------------------------------------------------------------------*/
+} ;
+
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_AUDIO_Private_Functions
+ * @{
+ */
+
+/**
+ * @brief  USBD_AUDIO_Init
+ *         Initialize the AUDIO interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_AUDIO_Init (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+	USBD_AUDIO_HandleTypeDef   *haudio;
+
+	/* Open EP OUT */
+	USBD_LL_OpenEP(pdev,
+			AUDIO_OUT_EP,
+			USBD_EP_TYPE_ISOC,
+			AUDIO_OUT_PACKET_MAX);
+
+	/* Open Feedback IN EP */
+	USBD_LL_OpenEP(pdev,
+			AUDIO_FB_EP,
+			USBD_EP_TYPE_ISOC,
+			AUDIO_FB_PACKET_SIZE);
+
+
+	pdev->pClassData = USBD_malloc(sizeof (USBD_AUDIO_HandleTypeDef));
+
+	if(pdev->pClassData == NULL)
+	{
+		ret = 1;
+	}
+	else
+	{
+		haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+		USBD_memset(haudio, 0, sizeof (USBD_AUDIO_HandleTypeDef));
+		haudio->CmdOpCode = 0xFF;
+
+		/* Init  physical Interface components */
+		((USBD_AUDIO_ItfTypeDef *)pdev->pUserData)->Init(USBD_AUDIO_FREQ);
+	}
+	return ret;
+}
+
+/**
+ * @brief  USBD_AUDIO_DeInit
+ *         DeInitialize the AUDIO layer
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_AUDIO_DeInit (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+
+	/* Close EP OUT */
+	USBD_LL_CloseEP(pdev,
+			AUDIO_OUT_EP);
+
+	/* Close Feedback IN EP */
+	USBD_LL_CloseEP(pdev,
+			AUDIO_FB_EP);
+
+
+	/* DeInit  physical Interface components */
+	if(pdev->pClassData != NULL)
+	{
+		((USBD_AUDIO_ItfTypeDef *)pdev->pUserData)->DeInit();
+		USBD_free(pdev->pClassData);
+		pdev->pClassData = NULL;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_AUDIO_Setup
+ *         Handle the AUDIO specific requests: the mute control of the
+ *         feature unit, and the alternate setting of the streaming interface
+ * @param  pdev: instance
+ * @param  req: usb requests
+ * @retval status
+ */
+static uint8_t  USBD_AUDIO_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+	uint8_t streaming = USBD_COMPOSITE_GetFirstInterface(&USBD_AUDIO) + 1;
+
+	if(haudio == NULL)
+	{
+		USBD_CtlError (pdev, req);
+		return USBD_FAIL;
+	}
+
+	switch (req->bmRequest & USB_REQ_TYPE_MASK)
+	{
+	case USB_REQ_TYPE_CLASS :
+		if((HIBYTE(req->wIndex) != AUDIO_FU_ID) || (HIBYTE(req->wValue) != AUDIO_CONTROL_MUTE) ||
+				(req->wLength != 1))
+		{
+			USBD_CtlError (pdev, req);
+			return USBD_FAIL;
+		}
+		switch (req->bRequest)
+		{
+		case AUDIO_REQ_SET_CUR:
+			haudio->CmdOpCode = req->bRequest;
+			haudio->CmdControl = HIBYTE(req->wValue);
+			USBD_CtlPrepareRx (pdev, (uint8_t *)haudio->data, 1);
+			break;
+
+		case AUDIO_REQ_GET_CUR:
+			haudio->data[0] = haudio->Mute;
+			USBD_CtlSendData (pdev, (uint8_t *)haudio->data, 1);
+			break;
+
+		default:
+			USBD_CtlError (pdev, req);
+			return USBD_FAIL;
+		}
+		break;
+
+	case USB_REQ_TYPE_STANDARD:
+		switch (req->bRequest)
+		{
+		case USB_REQ_GET_INTERFACE :
+			haudio->data[0] = (LOBYTE(req->wIndex) == streaming) ? haudio->AltSetting : 0;
+			USBD_CtlSendData (pdev, (uint8_t *)haudio->data, 1);
+			break;
+
+		case USB_REQ_SET_INTERFACE :
+			if((LOBYTE(req->wIndex) == streaming) && (LOBYTE(req->wValue) <= 1))
+			{
+				USBD_AUDIO_SetStreaming(pdev, LOBYTE(req->wValue));
+			}
+			else if(LOBYTE(req->wValue) != 0)
+			{
+				USBD_CtlError (pdev, req);
+				return USBD_FAIL;
+			}
+			break;
+		}
+		break;
+
+	default:
+		break;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_AUDIO_EP0_RxReady
+ *         Data stage of a class request received
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t  USBD_AUDIO_EP0_RxReady (USBD_HandleTypeDef *pdev)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+
+	if((haudio != NULL) && (haudio->CmdOpCode != 0xFF))
+	{
+		if(haudio->CmdControl == AUDIO_CONTROL_MUTE)
+		{
+			haudio->Mute = (uint8_t)haudio->data[0];
+			((USBD_AUDIO_ItfTypeDef *)pdev->pUserData)->MuteCtl(haudio->Mute);
+		}
+		haudio->CmdOpCode = 0xFF;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_AUDIO_SOF
+ *         A frame started while streaming: the feedback follows the sink
+ *         clock and the buffered samples, and goes to the endpoint if it is
+ *         not armed
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t  USBD_AUDIO_SOF (USBD_HandleTypeDef *pdev)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+	USBD_AUDIO_ItfTypeDef *itf = (USBD_AUDIO_ItfTypeDef *)pdev->pUserData;
+
+	if((haudio == NULL) || (haudio->AltSetting == 0))
+	{
+		return USBD_OK;
+	}
+
+	USBD_AUDIO_Fb_Frame(&haudio->Fb, itf->GetClock(), USBD_Ring_Count(itf->pRing) / AUDIO_SAMPLE_BYTES);
+	USBD_AUDIO_FbStart(pdev);
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_AUDIO_IsoINIncomplete
+ *         The host did not read the feedback in this frame, the value armed
+ *         is offered again in the next one. Most frames end this way.
+ * @param  pdev: device instance
+ * @param  epnum: endpoint index
+ * @retval status
+ */
+static uint8_t  USBD_AUDIO_IsoINIncomplete (USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+
+	if((haudio != NULL) && (haudio->AltSetting != 0) && ((epnum & 0x7F) == (AUDIO_FB_EP & 0x7F)))
+	{
+		if(USBD_LLEx_IsoInNextFrame(pdev, AUDIO_FB_EP) != USBD_OK)
+		{
+			/* Nothing left armed in the core, the feedback is stuck */
+			USBD_LLEx_Abort(pdev, AUDIO_FB_EP);
+			USBD_AUDIO_FbStart(pdev);
+		}
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_AUDIO_IsoOutIncomplete
+ *         A packet was missed and the transfers armed wait for the wrong
+ *         frame: they are stopped in the core and queued again. Rare, the
+ *         host sends a packet every frame.
+ * @param  pdev: device instance
+ * @param  epnum: endpoint index
+ * @retval status
+ */
+static uint8_t  USBD_AUDIO_IsoOutIncomplete (USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+
+	if((haudio != NULL) && (haudio->AltSetting != 0) && ((epnum & 0x7F) == (AUDIO_OUT_EP & 0x7F)))
+	{
+		haudio->Incomplete++;
+		USBD_LLEx_Abort(pdev, AUDIO_OUT_EP);
+		USBD_AUDIO_RxStart(pdev);
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_AUDIO_SetStreaming
+ *         Alternate setting of the streaming interface. The feedback starts
+ *         from the nominal rate every time the host starts streaming.
+ * @param  pdev: device instance
+ * @param  alt: 0 for zero bandwidth, 1 for streaming
+ * @retval None
+ */
+static void  USBD_AUDIO_SetStreaming (USBD_HandleTypeDef *pdev, uint8_t alt)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+	USBD_AUDIO_ItfTypeDef *itf = (USBD_AUDIO_ItfTypeDef *)pdev->pUserData;
+
+	if(alt == haudio->AltSetting)
+	{
+		return;
+	}
+	haudio->AltSetting = alt;
+
+	if(alt != 0)
+	{
+		USBD_AUDIO_Fb_Init(&haudio->Fb, USBD_AUDIO_FREQ, AUDIO_LATENCY_SAMPLES, AUDIO_FB_WINDOW_LOG2);
+		USBD_AUDIO_RxStart(pdev);
+		USBD_AUDIO_FbStart(pdev);
+		USBD_COMPOSITE_StartSOFTimer(pdev, &USBD_AUDIO, 1);
+	}
+	else
+	{
+		/* Both endpoints are stopped in the core on return, the packet
+		buffers are not written any more once the interface is told */
+		USBD_COMPOSITE_StopSOFTimer(pdev, &USBD_AUDIO);
+		USBD_LLEx_Abort(pdev, AUDIO_OUT_EP);
+		USBD_LLEx_Abort(pdev, AUDIO_FB_EP);
+	}
+	itf->Streaming(alt);
+}
+
+/**
+ * @brief  USBD_AUDIO_RxStart
+ *         Queue an OUT transfer into each packet buffer, none is queued
+ * @param  pdev: device instance, in the context of the class
+ * @retval None
+ */
+static void  USBD_AUDIO_RxStart (USBD_HandleTypeDef *pdev)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+	uint8_t i;
+
+	for(i = 0; i < AUDIO_OUT_BUFFERS; i++)
+	{
+		USBD_LLEx_PrepareReceive(pdev, AUDIO_OUT_EP, (uint8_t *)haudio->RxBuffer[i], AUDIO_OUT_PACKET_MAX,
+				USBD_AUDIO_RxCplt, NULL);
+	}
+}
+
+/**
+ * @brief  USBD_AUDIO_FbStart
+ *         Arm the feedback endpoint with the latest value, unless it is
+ *         armed already
+ * @param  pdev: device instance, in the context of the class
+ * @retval None
+ */
+static void  USBD_AUDIO_FbStart (USBD_HandleTypeDef *pdev)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+	uint32_t value;
+
+	if((haudio->AltSetting == 0) || (haudio->FbArmed != 0))
+	{
+		return;
+	}
+
+	/* 10.14 format, least significant byte first */
+	value = haudio->Fb.value;
+	haudio->FbBuffer[0] = (uint8_t)value;
+	haudio->FbBuffer[1] = (uint8_t)(value >> 8);
+	haudio->FbBuffer[2] = (uint8_t)(value >> 16);
+	if(USBD_LLEx_Transmit(pdev, AUDIO_FB_EP, haudio->FbBuffer, AUDIO_FB_PACKET_SIZE, USBD_AUDIO_FbCplt, NULL) == USBD_OK)
+	{
+		haudio->FbArmed = 1;
+	}
+}
+
+/**
+ * @brief  USBD_AUDIO_RxCplt
+ *         OUT packet received: its samples go to the ring and the buffer is
+ *         queued again. An aborted one is queued again by whoever aborted it.
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  USBD_AUDIO_RxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+	USBD_RingTypeDef *pRing = ((USBD_AUDIO_ItfTypeDef *)pdev->pUserData)->pRing;
+	uint8_t *psrc = xfer->pbuf;
+	uint32_t length = xfer->actual - (xfer->actual % AUDIO_SAMPLE_BYTES);
+	uint8_t *pdst;
+	uint32_t space;
+
+	if((haudio == NULL) || (xfer->status != USBD_OK))
+	{
+		return;
+	}
+
+	/* A whole packet or nothing, the ring holds whole samples */
+	if(pRing->size - 1 - USBD_Ring_Count(pRing) < length)
+	{
+		haudio->Overruns++;
+		length = 0;
+	}
+	while(length != 0)
+	{
+		pdst = USBD_Ring_Reserve(pRing, 1, &space);
+		if(pdst == NULL)
+		{
+			break;
+		}
+		if(space > length)
+		{
+			space = length;
+		}
+		USBD_memcpy(pdst, psrc, space);
+		USBD_Ring_Commit(pRing, space);
+		psrc += space;
+		length -= space;
+	}
+
+	USBD_LLEx_PrepareReceive(pdev, AUDIO_OUT_EP, xfer->pbuf, AUDIO_OUT_PACKET_MAX, USBD_AUDIO_RxCplt, NULL);
+}
+
+/**
+ * @brief  USBD_AUDIO_FbCplt
+ *         Feedback read by the host, armed again with the latest value
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  USBD_AUDIO_FbCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_AUDIO_HandleTypeDef   *haudio = (USBD_AUDIO_HandleTypeDef*) pdev->pClassData;
+
+	if(haudio == NULL)
+	{
+		return;
+	}
+	haudio->FbArmed = 0;
+
+	if(xfer->status == USBD_OK)
+	{
+		USBD_AUDIO_FbStart(pdev);
+	}
+}
+
+/**
+ * @brief  USBD_AUDIO_GetFSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_AUDIO_GetFSCfgDesc (uint16_t *length)
+{
+	*length = sizeof (USBD_AUDIO_CfgFSDesc);
+	return USBD_AUDIO_CfgFSDesc;
+}
+
+/**
+ * @brief  USBD_AUDIO_GetHSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_AUDIO_GetHSCfgDesc (uint16_t *length)
+{
+	return USBD_AUDIO_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  USBD_AUDIO_GetOtherSpeedCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_AUDIO_GetOtherSpeedCfgDesc (uint16_t *length)
+{
+	return USBD_AUDIO_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  DeviceQualifierDescriptor
+ *         return Device Qualifier descriptor
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+uint8_t  *USBD_AUDIO_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+	*length = sizeof (USBD_AUDIO_DeviceQualifierDesc);
+	return USBD_AUDIO_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  USBD_AUDIO_RegisterInterface
+ * @param  pdev: device instance
+ * @param  fops: AUDIO Interface callback
+ * @retval status
+ */
+uint8_t  USBD_AUDIO_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+		USBD_AUDIO_ItfTypeDef *fops)
+{
+	uint8_t  ret = USBD_FAIL;
+
+	if((fops != NULL) && (fops->pRing != NULL) && (fops->GetClock != NULL))
+	{
+		pdev->pUserData= fops;
+		ret = USBD_OK;
+	}
+
+	return ret;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,161 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   header file for the usbd_cdc.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_CDC_H
+#define __USB_CDC_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+#include  "usbd_ring.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_cdc
+  * @brief This file is the Header file for usbd_cdc.c
+  * @{
+  */
+
+
+/** @defgroup usbd_cdc_Exported_Defines
+  * @{
+  */
+#define CDC_IN_EP                                     0x81  /* EP1 for data IN, renumbered by the composite layer */
+#define CDC_OUT_EP                                    0x01  /* EP1 for data OUT, renumbered by the composite layer */
+#define CDC_CMD_EP                                    0x82  /* EP2 for CDC notifications, renumbered by the composite layer */
+
+#define CDC_DATA_FS_MAX_PACKET_SIZE                   64  /* Endpoint IN & OUT Packet size */
+#define CDC_CMD_PACKET_SIZE                           8   /* Control Endpoint Packet size */
+#define CDC_CMD_MAX_SIZE                              8   /* Longest data stage of a class request */
+
+#define USB_CDC_CONFIG_DESC_SIZ                       67
+
+/* IN transfers queued from the transmit ring, up to USBD_LLEX_QUEUE_DEPTH:
+the next one is on the endpoint as soon as one completes */
+#define CDC_TX_XFERS                                  2
+#define CDC_TX_XFER_MAX_SIZE                          512   /* Bytes per IN transfer, released to the ring when sent */
+
+/*---------------------------------------------------------------------*/
+/*  CDC definitions                                                    */
+/*---------------------------------------------------------------------*/
+#define CDC_SEND_ENCAPSULATED_COMMAND                 0x00
+#define CDC_GET_ENCAPSULATED_RESPONSE                 0x01
+#define CDC_SET_COMM_FEATURE                          0x02
+#define CDC_GET_COMM_FEATURE                          0x03
+#define CDC_CLEAR_COMM_FEATURE                        0x04
+#define CDC_SET_LINE_CODING                           0x20
+#define CDC_GET_LINE_CODING                           0x21
+#define CDC_SET_CONTROL_LINE_STATE                    0x22
+#define CDC_SEND_BREAK                                0x23
+
+/* SET_CONTROL_LINE_STATE wValue */
+#define CDC_CONTROL_LINE_DTR                          0x01
+#define CDC_CONTROL_LINE_RTS                          0x02
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/**
+  * @}
+  */
+typedef struct
+{
+  uint32_t bitrate;
+  uint8_t  format;
+  uint8_t  paritytype;
+  uint8_t  datatype;
+}USBD_CDC_LineCodingTypeDef;
+
+/* The data streams through two rings owned by the interface: the class
+consumes the transmit ring and produces into the receive ring, from the
+USB interrupt. */
+typedef struct _USBD_CDC_Itf
+{
+  int8_t (* Init)          (void);                                      /* Configured */
+  int8_t (* DeInit)        (void);                                      /* Unconfigured, the rings keep their data */
+  int8_t (* Control)       (uint8_t, uint8_t * , uint16_t);             /* Class request and its data */
+  int8_t (* Receive)       (uint32_t);                                  /* Bytes committed to the receive ring */
+  USBD_RingTypeDef *pTxRing;                                            /* Data to the host */
+  USBD_RingTypeDef *pRxRing;                                            /* Data from the host, at least 2 packets + 1 */
+
+}USBD_CDC_ItfTypeDef;
+
+
+typedef struct
+{
+  uint32_t data[CDC_CMD_MAX_SIZE/4];         /* EP0 requests, force 32bits alignment */
+  uint8_t  CmdOpCode;                        /* Waiting for its data stage */
+  uint8_t  CmdLength;
+  uint8_t  TxXfers;                          /* IN transfers queued */
+  uint8_t  TxZlp;                            /* The last one queued ended on a full packet */
+  uint32_t TxQueued;                         /* Transmit ring bytes in them */
+  uint8_t  RxArmed;                          /* OUT transfer queued */
+}
+USBD_CDC_HandleTypeDef;
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_CDC;
+#define USBD_CDC_CLASS    &USBD_CDC
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_CDC_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+                                      USBD_CDC_ItfTypeDef *fops);
+
+uint8_t  USBD_CDC_TransmitPacket     (USBD_HandleTypeDef *pdev);
+
+uint8_t  USBD_CDC_ReceivePacket      (USBD_HandleTypeDef *pdev);
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_CDC_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
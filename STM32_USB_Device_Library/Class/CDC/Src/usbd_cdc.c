@@ -0,0 +1,713 @@
+/**
+ ******************************************************************************
+ * @file    usbd_cdc.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB CDC-ACM function:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as an Abstract Control Model serial port
+ *           - Bulk IN and OUT streams kept moving from and into byte rings
+ *           - Line coding and control line state requests
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                                CDC-ACM Class Driver Description
+ *          ===================================================================
+ *           This driver implements the following aspects of the
+ *           "Universal Serial Bus Class Definitions for Communications
+ *           Devices" and its "PSTN Devices" subclass:
+ *             - Communication interface with the Header, Call Management,
+ *               Abstract Control Management and Union functional
+ *               descriptors, and a notification endpoint
+ *             - Data interface with a bulk IN and a bulk OUT endpoint
+ *             - SET_LINE_CODING, GET_LINE_CODING, SET_CONTROL_LINE_STATE
+ *               and SEND_BREAK, passed to the interface
+ *
+ *           The data is never copied by the class. IN transfers are queued
+ *           straight from the transmit ring of the interface, up to
+ *           CDC_TX_XFERS of them so that the endpoint never idles between
+ *           two, and the data is released once sent. A transfer ending on a
+ *           full packet is followed by a zero length packet when nothing
+ *           else is left to send. OUT transfers of one packet are queued
+ *           straight into the receive ring and committed once received,
+ *           the next one is queued from the completion. When the receive
+ *           ring is full the OUT endpoint is left unarmed, so the host is
+ *           NAKed rather than data dropped, until the interface releases
+ *           data and calls USBD_CDC_ReceivePacket.
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_cdc.h"
+#include "../../Composite/inc/usbd_composite.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+#include "usbd_ll_ex.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+
+/** @defgroup USBD_CDC
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_CDC_Private_TypesDefinitions
+ * @{
+ */
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_CDC_Private_Defines
+ * @{
+ */
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_CDC_Private_Macros
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_CDC_Private_FunctionPrototypes
+ * @{
+ */
+
+
+static uint8_t  USBD_CDC_Init (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_CDC_DeInit (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_CDC_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_CDC_EP0_RxReady (USBD_HandleTypeDef *pdev);
+
+static void  USBD_CDC_TxStart (USBD_HandleTypeDef *pdev);
+
+static void  USBD_CDC_RxStart (USBD_HandleTypeDef *pdev);
+
+static void  USBD_CDC_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static void  USBD_CDC_RxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static uint8_t  *USBD_CDC_GetFSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_CDC_GetHSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_CDC_GetOtherSpeedCfgDesc (uint16_t *length);
+
+uint8_t  *USBD_CDC_GetDeviceQualifierDescriptor (uint16_t *length);
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_CDC_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+		USB_LEN_DEV_QUALIFIER_DESC,
+		USB_DESC_TYPE_DEVICE_QUALIFIER,
+		0x00,
+		0x02,
+		0x00,
+		0x00,
+		0x00,
+		0x40,
+		0x01,
+		0x00,
+};
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CDC_Private_Variables
+ * @{
+ */
+
+
+/* CDC interface class callbacks structure */
+USBD_ClassTypeDef  USBD_CDC =
+{
+		USBD_CDC_Init,
+		USBD_CDC_DeInit,
+		USBD_CDC_Setup,
+		NULL,                 /* EP0_TxSent, */
+		USBD_CDC_EP0_RxReady,
+		NULL,                 /* DataIn, every transfer is queued */
+		NULL,                 /* DataOut, every transfer is queued */
+		NULL,
+		NULL,
+		NULL,
+		USBD_CDC_GetHSCfgDesc,
+		USBD_CDC_GetFSCfgDesc,
+		USBD_CDC_GetOtherSpeedCfgDesc,
+		USBD_CDC_GetDeviceQualifierDescriptor,
+#if (USBD_SUPPORT_USER_STRING == 1)
+		NULL,
+#endif
+};
+
+/* USB CDC device Configuration Descriptor */
+__ALIGN_BEGIN uint8_t USBD_CDC_CfgFSDesc[USB_CDC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+		//SIZE: 9+9+5+5+4+5+7+9+7+7=67
+		/*Configuration Descriptor*/
+		0x09,   /* bLength: Configuration Descriptor size */
+		USB_DESC_TYPE_CONFIGURATION,      /* bDescriptorType: Configuration */
+		USB_CDC_CONFIG_DESC_SIZ,                /* wTotalLength:no of returned bytes */
+		0x00,
+		0x02,   /* bNumInterfaces: 2 interface */
+		0x01,   /* bConfigurationValue: Configuration value */
+		0x00,   /* iConfiguration: Index of string descriptor describing the configuration */
+		0xC0,   /* bmAttributes: self powered */
+		0xFA,   /* MaxPower 0 mA */
+
+		///INTERFACE DESCRIPTOR(0)
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x00,    ///bInterfaceNumber: Interface Number
+		0x00,    ///bAlternateSetting: Alternate setting for this interface
+		0x01,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x02,    ///iInterfaceClass: Class Code: Communications
+		0x02,    ///iInterfaceSubClass: Abstract Control Model
+		0x01,    ///bInterfaceProtocol: Common AT commands
+		0x00,    ///iInterface: String index
+
+		///HEADER FUNCTIONAL DESCRIPTOR
+		0x05,    ///bFunctionLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x00,    ///bDescriptorSubtype: Header
+		0x10,    ///bcdCDC: 1.10
+		0x01,
+
+		///CALL MANAGEMENT FUNCTIONAL DESCRIPTOR
+		0x05,    ///bFunctionLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x01,    ///bDescriptorSubtype: Call Management
+		0x00,    ///bmCapabilities: no call management
+		0x01,    ///bDataInterface, renumbered by the composite layer
+
+		///ABSTRACT CONTROL MANAGEMENT FUNCTIONAL DESCRIPTOR
+		0x04,    ///bFunctionLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x02,    ///bDescriptorSubtype: Abstract Control Management
+		0x02,    ///bmCapabilities: line coding and control line state requests
+
+		///UNION FUNCTIONAL DESCRIPTOR
+		0x05,    ///bFunctionLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x06,    ///bDescriptorSubtype: Union
+		0x00,    ///bControlInterface, renumbered by the composite layer
+		0x01,    ///bSubordinateInterface0, renumbered by the composite layer
+
+		///ENDPOINT DESCRIPTOR(0)
+		0x07,    					//bLength: Length of this descriptor
+		0x05,    					//bDescriptorType: Endpoint Descriptor Type
+		CDC_CMD_EP,    				//bEndpointAddress: Endpoint address (IN,EP2)
+		0x03,    					//bmAttributes: Transfer Type: INTERRUPT_TRANSFER
+		CDC_CMD_PACKET_SIZE,    	//wMaxPacketSize: Endpoint Size
+		0x00,    					//wMaxPacketSize: Endpoint Size
+		0x10,    					//bIntervall: Polling Intervall
+
+		///INTERFACE DESCRIPTOR(1)
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x01,    ///bInterfaceNumber: Interface Number
+		0x00,    ///bAlternateSetting: Alternate setting for this interface
+		0x02,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x0A,    ///iInterfaceClass: Class Code: CDC_DATA
+		0x00,    ///iInterfaceSubClass: SubClass Code
+		0x00,    ///bInterfaceProtocol: Protocol Code
+		0x00,    ///iInterface: String index
+
+		///ENDPOINT DESCRIPTOR(1)
+		0x07,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		CDC_OUT_EP,    ///bEndpointAddress: Endpoint address (OUT,EP1)
+		0x02,    ///bmAttributes: Transfer Type: BULK_TRANSFER
+		CDC_DATA_FS_MAX_PACKET_SIZE,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///bIntervall: Polling Intervall
+
+		///ENDPOINT DESCRIPTOR(2)
+		0x07,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		CDC_IN_EP,    ///bEndpointAddress: Endpoint address (IN,EP1)
+		0x02,    ///bmAttributes: Transfer Type: BULK_TRANSFER
+		CDC_DATA_FS_MAX_PACKET_SIZE,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///bIntervall: Polling Intervall
+		/*---------------------------------------------------------------------------*/
+} ;
+
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CDC_Private_Functions
+ * @{
+ */
+
+/**
+ * @brief  USBD_CDC_Init
+ *         Initialize the CDC interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_CDC_Init (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+	USBD_CDC_HandleTypeDef   *hcdc;
+
+	/* Open EP IN */
+	USBD_LL_OpenEP(pdev,
+			CDC_IN_EP,
+			USBD_EP_TYPE_BULK,
+			CDC_DATA_FS_MAX_PACKET_SIZE);
+
+	/* Open EP OUT */
+	USBD_LL_OpenEP(pdev,
+			CDC_OUT_EP,
+			USBD_EP_TYPE_BULK,
+			CDC_DATA_FS_MAX_PACKET_SIZE);
+
+	/* Open Command IN EP */
+	USBD_LL_OpenEP(pdev,
+			CDC_CMD_EP,
+			USBD_EP_TYPE_INTR,
+			CDC_CMD_PACKET_SIZE);
+
+
+	pdev->pClassData = USBD_malloc(sizeof (USBD_CDC_HandleTypeDef));
+
+	if(pdev->pClassData == NULL)
+	{
+		ret = 1;
+	}
+	else
+	{
+		hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
+		USBD_memset(hcdc, 0, sizeof (USBD_CDC_HandleTypeDef));
+		hcdc->CmdOpCode = 0xFF;
+
+		/* Init  physical Interface components */
+		((USBD_CDC_ItfTypeDef *)pdev->pUserData)->Init();
+
+		/* Whatever was written before the host configured the device goes
+		out first */
+		USBD_CDC_TxStart(pdev);
+		USBD_CDC_RxStart(pdev);
+	}
+	return ret;
+}
+
+/**
+ * @brief  USBD_CDC_DeInit
+ *         DeInitialize the CDC layer. Closing the endpoints gives the
+ *         queued transfers back, their data stays in the rings.
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_CDC_DeInit (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+
+	/* Close EP IN */
+	USBD_LL_CloseEP(pdev,
+			CDC_IN_EP);
+
+	/* Close EP OUT */
+	USBD_LL_CloseEP(pdev,
+			CDC_OUT_EP);
+
+	/* Close Command IN EP */
+	USBD_LL_CloseEP(pdev,
+			CDC_CMD_EP);
+
+
+	/* DeInit  physical Interface components */
+	if(pdev->pClassData != NULL)
+	{
+		((USBD_CDC_ItfTypeDef *)pdev->pUserData)->DeInit();
+		USBD_free(pdev->pClassData);
+		pdev->pClassData = NULL;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_CDC_Setup
+ *         Handle the CDC specific requests. A request without a data stage
+ *         is passed to the interface with the request itself as data, for
+ *         the wValue of SET_CONTROL_LINE_STATE and SEND_BREAK.
+ * @param  pdev: instance
+ * @param  req: usb requests
+ * @retval status
+ */
+static uint8_t  USBD_CDC_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+	USBD_CDC_HandleTypeDef   *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
+
+	if(hcdc == NULL)
+	{
+		USBD_CtlError (pdev, req);
+		return USBD_FAIL;
+	}
+
+	switch (req->bmRequest & USB_REQ_TYPE_MASK)
+	{
+	case USB_REQ_TYPE_CLASS :
+		if(req->wLength > CDC_CMD_MAX_SIZE)
+		{
+			USBD_CtlError (pdev, req);
+			return USBD_FAIL;
+		}
+		if(req->wLength != 0)
+		{
+			if(req->bmRequest & 0x80)
+			{
+				((USBD_CDC_ItfTypeDef *)pdev->pUserData)->Control(req->bRequest, (uint8_t *)hcdc->data, req->wLength);
+				USBD_CtlSendData (pdev, (uint8_t *)hcdc->data, req->wLength);
+			}
+			else
+			{
+				hcdc->CmdOpCode = req->bRequest;
+				hcdc->CmdLength = req->wLength;
+				USBD_CtlPrepareRx (pdev, (uint8_t *)hcdc->data, req->wLength);
+			}
+		}
+		else
+		{
+			((USBD_CDC_ItfTypeDef *)pdev->pUserData)->Control(req->bRequest, (uint8_t *)req, 0);
+		}
+		break;
+
+	case USB_REQ_TYPE_STANDARD:
+		switch (req->bRequest)
+		{
+		case USB_REQ_GET_INTERFACE :
+			hcdc->data[0] = 0;
+			USBD_CtlSendData (pdev, (uint8_t *)hcdc->data, 1);
+			break;
+
+		case USB_REQ_SET_INTERFACE :
+			if(LOBYTE(req->wValue) != 0)
+			{
+				USBD_CtlError (pdev, req);
+				return USBD_FAIL;
+			}
+			break;
+		}
+		break;
+
+	default:
+		break;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_CDC_EP0_RxReady
+ *         Data stage of a class request received
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t  USBD_CDC_EP0_RxReady (USBD_HandleTypeDef *pdev)
+{
+	USBD_CDC_HandleTypeDef   *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
+
+	if((hcdc != NULL) && (hcdc->CmdOpCode != 0xFF))
+	{
+		((USBD_CDC_ItfTypeDef *)pdev->pUserData)->Control(hcdc->CmdOpCode, (uint8_t *)hcdc->data, hcdc->CmdLength);
+		hcdc->CmdOpCode = 0xFF;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_CDC_TxStart
+ *         Queue IN transfers of the transmit ring data not queued yet, and
+ *         the zero length packet ending the stream once it is all sent
+ * @param  pdev: device instance, in the context of the class
+ * @retval None
+ */
+static void  USBD_CDC_TxStart (USBD_HandleTypeDef *pdev)
+{
+	USBD_CDC_HandleTypeDef   *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
+	USBD_RingTypeDef *pRing = ((USBD_CDC_ItfTypeDef *)pdev->pUserData)->pTxRing;
+	uint8_t *pbuf;
+	uint32_t length;
+
+	while(hcdc->TxXfers < CDC_TX_XFERS)
+	{
+		pbuf = USBD_Ring_Peek(pRing, hcdc->TxQueued, &length);
+		if(pbuf == NULL)
+		{
+			/* The host only sees the end of a transfer of full packets
+			with a short one */
+			if((hcdc->TxXfers != 0) || (hcdc->TxZlp == 0))
+			{
+				break;
+			}
+			pbuf = pRing->pBuffer;
+			length = 0;
+		}
+		if(length > CDC_TX_XFER_MAX_SIZE)
+		{
+			length = CDC_TX_XFER_MAX_SIZE;
+		}
+
+		if(USBD_LLEx_Transmit(pdev, CDC_IN_EP, pbuf, length, USBD_CDC_TxCplt, NULL) != USBD_OK)
+		{
+			break;
+		}
+		hcdc->TxXfers++;
+		hcdc->TxQueued += length;
+		hcdc->TxZlp = (length != 0) && ((length % CDC_DATA_FS_MAX_PACKET_SIZE) == 0);
+	}
+}
+
+/**
+ * @brief  USBD_CDC_RxStart
+ *         Queue an OUT transfer of one packet into the receive ring, unless
+ *         one is queued or the ring is full
+ * @param  pdev: device instance, in the context of the class
+ * @retval None
+ */
+static void  USBD_CDC_RxStart (USBD_HandleTypeDef *pdev)
+{
+	USBD_CDC_HandleTypeDef   *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
+	USBD_RingTypeDef *pRing = ((USBD_CDC_ItfTypeDef *)pdev->pUserData)->pRxRing;
+	uint8_t *pbuf;
+	uint32_t length;
+
+	if(hcdc->RxArmed != 0)
+	{
+		return;
+	}
+
+	/* One packet per transfer, as the host does not end a write of full
+	packets with a zero length packet */
+	pbuf = USBD_Ring_Reserve(pRing, CDC_DATA_FS_MAX_PACKET_SIZE, &length);
+	if(pbuf == NULL)
+	{
+		return;
+	}
+	if(USBD_LLEx_PrepareReceive(pdev, CDC_OUT_EP, pbuf, CDC_DATA_FS_MAX_PACKET_SIZE, USBD_CDC_RxCplt, NULL) == USBD_OK)
+	{
+		hcdc->RxArmed = 1;
+	}
+}
+
+/**
+ * @brief  USBD_CDC_TxCplt
+ *         IN transfer sent: its data goes back to the transmit ring and
+ *         the next one is queued. An aborted one is sent again once the
+ *         device is configured.
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  USBD_CDC_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_CDC_HandleTypeDef   *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
+
+	if(hcdc == NULL)
+	{
+		return;
+	}
+	hcdc->TxXfers--;
+	hcdc->TxQueued -= xfer->length;
+
+	if(xfer->status == USBD_OK)
+	{
+		USBD_Ring_Release(((USBD_CDC_ItfTypeDef *)pdev->pUserData)->pTxRing, xfer->length);
+		USBD_CDC_TxStart(pdev);
+	}
+}
+
+/**
+ * @brief  USBD_CDC_RxCplt
+ *         OUT packet received into the receive ring, the next one is queued
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  USBD_CDC_RxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_CDC_HandleTypeDef   *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
+	USBD_CDC_ItfTypeDef *itf = (USBD_CDC_ItfTypeDef *)pdev->pUserData;
+
+	if(hcdc == NULL)
+	{
+		return;
+	}
+	hcdc->RxArmed = 0;
+
+	if(xfer->status == USBD_OK)
+	{
+		USBD_Ring_Commit(itf->pRxRing, xfer->actual);
+		if(xfer->actual != 0)
+		{
+			itf->Receive(xfer->actual);
+		}
+		USBD_CDC_RxStart(pdev);
+	}
+}
+
+/**
+ * @brief  USBD_CDC_GetFSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_CDC_GetFSCfgDesc (uint16_t *length)
+{
+	*length = sizeof (USBD_CDC_CfgFSDesc);
+	return USBD_CDC_CfgFSDesc;
+}
+
+/**
+ * @brief  USBD_CDC_GetHSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_CDC_GetHSCfgDesc (uint16_t *length)
+{
+	return USBD_CDC_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  USBD_CDC_GetOtherSpeedCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_CDC_GetOtherSpeedCfgDesc (uint16_t *length)
+{
+	return USBD_CDC_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  DeviceQualifierDescriptor
+ *         return Device Qualifier descriptor
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+uint8_t  *USBD_CDC_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+	*length = sizeof (USBD_CDC_DeviceQualifierDesc);
+	return USBD_CDC_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  USBD_CDC_RegisterInterface
+ * @param  pdev: device instance
+ * @param  fops: CDC Interface callback
+ * @retval status
+ */
+uint8_t  USBD_CDC_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+		USBD_CDC_ItfTypeDef *fops)
+{
+	uint8_t  ret = USBD_FAIL;
+
+	if((fops != NULL) && (fops->pTxRing != NULL) && (fops->pRxRing != NULL))
+	{
+		pdev->pUserData= fops;
+		ret = USBD_OK;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_CDC_TransmitPacket
+ *         Queue what was committed to the transmit ring, if the endpoint
+ *         can take more. Callable from task context.
+ * @param  pdev: device instance
+ * @retval status, USBD_FAIL while not configured: the data waits in the ring
+ */
+uint8_t  USBD_CDC_TransmitPacket(USBD_HandleTypeDef *pdev)
+{
+	USBD_COMPOSITE_ContextTypeDef context;
+	uint32_t primask;
+	uint8_t ret = USBD_FAIL;
+
+	/* The device handle holds the context of the first class outside of
+	the USB interrupt */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if((USBD_COMPOSITE_SelectClass(pdev, &USBD_CDC, &context) == USBD_OK) && (pdev->pClassData != NULL))
+	{
+		USBD_CDC_TxStart(pdev);
+		ret = USBD_OK;
+	}
+	USBD_COMPOSITE_RestoreClass(pdev, &context);
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_CDC_ReceivePacket
+ *         Queue an OUT transfer if none is and the receive ring has room
+ *         again. Callable from task context, once data is released.
+ * @param  pdev: device instance
+ * @retval status, USBD_FAIL while not configured
+ */
+uint8_t  USBD_CDC_ReceivePacket(USBD_HandleTypeDef *pdev)
+{
+	USBD_COMPOSITE_ContextTypeDef context;
+	uint32_t primask;
+	uint8_t ret = USBD_FAIL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if((USBD_COMPOSITE_SelectClass(pdev, &USBD_CDC, &context) == USBD_OK) && (pdev->pClassData != NULL))
+	{
+		USBD_CDC_RxStart(pdev);
+		ret = USBD_OK;
+	}
+	USBD_COMPOSITE_RestoreClass(pdev, &context);
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
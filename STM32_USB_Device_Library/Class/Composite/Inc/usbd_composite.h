@@ -62,6 +62,7 @@
 #define USB_COMPOSITE_MAX_CLASSES				  		  5
 #define USB_COMPOSITE_IFC_ASSOC_DESC_SIZ				  8
 #define USB_COMPOSITE_CONFIG_DESC_SIZ                     9
+#define USB_COMPOSITE_FRAME_MASK                          0x7FF  /* Full speed frame number */
 #define COMPOSITE_DATA_HS_IN_PACKET_SIZE                  COMPOSITE_DATA_HS_MAX_PACKET_SIZE
 #define COMPOSITE_DATA_HS_OUT_PACKET_SIZE                 COMPOSITE_DATA_HS_MAX_PACKET_SIZE
 
@@ -138,6 +139,17 @@ typedef struct
 	uint8_t iFunction;
 } USBD_COMPOSITE_ItfAssocDescriptor;
 
+/* Device recipient request handler of a class, see
+USBD_COMPOSITE_RegisterDeviceRequest */
+typedef uint8_t (*USBD_COMPOSITE_DeviceRequestTypeDef)(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+/* Class context of the device handle, saved by USBD_COMPOSITE_SelectClass */
+typedef struct
+{
+	void *pClassData;
+	void *pUserData;
+} USBD_COMPOSITE_ContextTypeDef;
+
 typedef struct
 {
 	uint8_t bFunctionClass;
@@ -153,6 +165,13 @@ typedef struct
 	uint8_t outEPn[15];
 	uint8_t inEPa[15];
 	uint8_t outEPa[15];
+	uint8_t inEPtype[15];
+	uint8_t outEPtype[15];
+	uint16_t inEPmps[15];
+	uint16_t outEPmps[15];
+	USBD_COMPOSITE_DeviceRequestTypeDef DeviceRequest;
+	uint16_t sofPeriod;					/* Frames between SOF callbacks, 0 for none */
+	uint16_t sofRemaining;				/* Frames to the next one */
 } USBD_COMPOSITE_ClassData;
 
 /** @defgroup USBD_CORE_Exported_Macros
@@ -181,6 +200,22 @@ USBD_StatusTypeDef  USBD_COMPOSITE_RegisterClass(USBD_HandleTypeDef *pdev, uint8
 
 uint8_t  USBD_COMPOSITE_LL_EP_Conversion  (USBD_HandleTypeDef *pdev, uint8_t  ep_addr);
 
+uint8_t  USBD_COMPOSITE_GetEPInfo  (uint8_t  ep_addr, uint8_t *ep_type, uint16_t *ep_mps);
+
+USBD_StatusTypeDef  USBD_COMPOSITE_RegisterDeviceRequest(USBD_HandleTypeDef *pdev, USBD_COMPOSITE_DeviceRequestTypeDef pDeviceRequest);
+
+uint8_t  USBD_COMPOSITE_DeviceRequest  (USBD_HandleTypeDef *pdev, uint8_t *psetup);
+
+uint8_t  USBD_COMPOSITE_SelectClass  (USBD_HandleTypeDef *pdev, USBD_ClassTypeDef *pClass, USBD_COMPOSITE_ContextTypeDef *pSaved);
+
+void  USBD_COMPOSITE_RestoreClass  (USBD_HandleTypeDef *pdev, USBD_COMPOSITE_ContextTypeDef *pSaved);
+
+uint8_t  USBD_COMPOSITE_GetFirstInterface  (USBD_ClassTypeDef *pClass);
+
+uint8_t  USBD_COMPOSITE_StartSOFTimer  (USBD_HandleTypeDef *pdev, USBD_ClassTypeDef *pClass, uint16_t period);
+
+void  USBD_COMPOSITE_StopSOFTimer  (USBD_HandleTypeDef *pdev, USBD_ClassTypeDef *pClass);
+
 uint8_t  USBD_COMPOSITE_RegisterInterface  (USBD_HandleTypeDef   *pdev,
                                       USBD_COMPOSITE_ItfTypeDef *fops);
 
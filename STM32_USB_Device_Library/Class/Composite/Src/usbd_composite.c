@@ -62,6 +62,8 @@
 #include "../inc/usbd_composite.h"
 #include "usbd_desc.h"
 #include "usbd_ctlreq.h"
+#include "usbd_prof.h"
+#include "usbd_ll_ex.h"
 
 
 /** @addtogroup STM32_USB_DEVICE_LIBRARY
@@ -139,6 +141,10 @@ static uint8_t  *USBD_COMPOSITE_GetOtherSpeedCfgDesc (uint16_t *length);
 
 uint8_t  *USBD_COMPOSITE_GetDeviceQualifierDescriptor (uint16_t *length);
 
+#if (USBD_SUPPORT_USER_STRING == 1)
+static uint8_t  *USBD_COMPOSITE_GetUsrStrDescriptor (USBD_HandleTypeDef *pdev, uint8_t index, uint16_t *length);
+#endif
+
 
 USBD_COMPOSITE_ClassData usbd_composite_class_data[USB_COMPOSITE_MAX_CLASSES];
 static uint8_t usbd_composite_pClass_count=0;
@@ -147,6 +153,9 @@ static uint16_t descriptor_size=0;
 static uint8_t itf_num=0;
 static uint8_t inEP=1;
 static uint8_t outEP=1;
+/* SOF timers running, the SOF interrupt is unmasked while there is one */
+static uint8_t usbd_composite_sof_timers=0;
+static uint16_t usbd_composite_sof_frame=0;		/* Of the last SOF dispatched */
 
 
 
@@ -191,6 +200,9 @@ USBD_ClassTypeDef  USBD_COMPOSITE =
 		USBD_COMPOSITE_GetFSCfgDesc,
 		USBD_COMPOSITE_GetOtherSpeedCfgDesc,
 		USBD_COMPOSITE_GetDeviceQualifierDescriptor,
+#if (USBD_SUPPORT_USER_STRING == 1)
+		USBD_COMPOSITE_GetUsrStrDescriptor,
+#endif
 };
 
 /* USB COMPOSITE device Configuration Descriptor */
@@ -278,6 +290,10 @@ static uint8_t  USBD_COMPOSITE_Init (USBD_HandleTypeDef *pdev, uint8_t cfgidx)
 		usbd_composite_class_data[index].pClassData=pdev->pClassData;
 		usbd_composite_class_data[index].pUserData=pdev->pUserData;
 	}
+	/* Outside of the class callbacks the device handle keeps the context of
+	the first class, task-context code of that class reads it from there */
+	pdev->pClassData=usbd_composite_class_data[0].pClassData;
+	pdev->pUserData=usbd_composite_class_data[0].pUserData;
 	return ret;
 }
 
@@ -303,7 +319,10 @@ static uint8_t  USBD_COMPOSITE_DeInit (USBD_HandleTypeDef *pdev,
 
 		usbd_composite_class_data[index].pClassData=pdev->pClassData;
 		usbd_composite_class_data[index].pUserData=pdev->pUserData;
+		USBD_COMPOSITE_StopSOFTimer(pdev, usbd_composite_class_data[index].pClass);
 	}
+	pdev->pClassData=usbd_composite_class_data[0].pClassData;
+	pdev->pUserData=usbd_composite_class_data[0].pUserData;
 
 	return ret;
 }
@@ -320,8 +339,11 @@ static uint8_t  USBD_COMPOSITE_Setup (USBD_HandleTypeDef *pdev,
 {
 	uint8_t status=USBD_OK;
 	uint8_t itf=0;
-	uint8_t index=-1;
+	uint8_t index=usbd_composite_pClass_count;
 	uint8_t i=0;
+	uint8_t found=0;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
 
 	switch(req->bmRequest & 0x1F) {
 	case USB_REQ_RECIPIENT_INTERFACE:
@@ -332,38 +354,40 @@ static uint8_t  USBD_COMPOSITE_Setup (USBD_HandleTypeDef *pdev,
 		}
 		break;
 	case USB_REQ_RECIPIENT_ENDPOINT:
-		for(index=0;index<usbd_composite_pClass_count;index++){
+		/* The OUT endpoints of a class are checked against its own count,
+		so that a request to one is not routed to the class before it */
+		for(index=0;index<usbd_composite_pClass_count && !found;index++){
 			if(req->wIndex & 0x80){
-				for(i=0;i<usbd_composite_class_data[index].inEP;i++){
-					if(usbd_composite_class_data[index].inEPa[i]==(req->wIndex & 0x7F)){
-						break;
-					}
+				for(i=0;i<usbd_composite_class_data[index].inEP && !found;i++){
+					found=(usbd_composite_class_data[index].inEPa[i]==(req->wIndex & 0x7F));
 				}
 			} else {
-				for(i=0;i<usbd_composite_class_data[index].outEP;i++){
-					if(usbd_composite_class_data[index].outEPa[i]==LOBYTE(req->wIndex)){
-						break;
-					}
+				for(i=0;i<usbd_composite_class_data[index].outEP && !found;i++){
+					found=(usbd_composite_class_data[index].outEPa[i]==LOBYTE(req->wIndex));
 				}
 			}
-			if(i!=usbd_composite_class_data[index].inEP){
-				break;
-			}
+		}
+		if(found){
+			index--;
 		}
 		break;
 	}
-	if(index!=-1 && index!=usbd_composite_pClass_count){
+	if(index<usbd_composite_pClass_count){
 		pdev->pClassData=usbd_composite_class_data[index].pClassData;
 		pdev->pUserData=usbd_composite_class_data[index].pUserData;
 
 		if(usbd_composite_class_data[index].pClass->Setup){
+			USBD_PROF_START(cycles);
 			status=usbd_composite_class_data[index].pClass->Setup(pdev, req);
+			USBD_PROF_STOP(USBD_PROF_CLASS_SETUP, cycles);
 		}
 
 		usbd_composite_class_data[index].pClassData=pdev->pClassData;
 		usbd_composite_class_data[index].pUserData=pdev->pUserData;
 	}
 
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
 	return status;
 }
 
@@ -400,6 +424,8 @@ static uint8_t  USBD_COMPOSITE_DataIn (USBD_HandleTypeDef *pdev, uint8_t epnum)
 	uint8_t status=USBD_OK;
 	uint8_t index=0;
 	uint8_t i=0;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
 
 	for(index=0;index<usbd_composite_pClass_count;index++){
 		for(i=0;i<usbd_composite_class_data[index].inEP;i++){
@@ -407,16 +433,22 @@ static uint8_t  USBD_COMPOSITE_DataIn (USBD_HandleTypeDef *pdev, uint8_t epnum)
 				pdev->pClassData=usbd_composite_class_data[index].pClassData;
 				pdev->pUserData=usbd_composite_class_data[index].pUserData;
 
-				if(usbd_composite_class_data[index].pClass->DataOut){
+				if(usbd_composite_class_data[index].pClass->DataIn){
+					USBD_PROF_START(cycles);
 					status|=usbd_composite_class_data[index].pClass->DataIn(pdev, usbd_composite_class_data[index].inEPn[i]);
+					USBD_PROF_STOP(USBD_PROF_CLASS_DATA_IN, cycles);
 				}
 
 				usbd_composite_class_data[index].pClassData=pdev->pClassData;
 				usbd_composite_class_data[index].pUserData=pdev->pUserData;
+				pdev->pClassData=pClassData;
+				pdev->pUserData=pUserData;
 				return status;
 			}
 		}
 	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
 	return status;
 }
 
@@ -431,6 +463,8 @@ static uint8_t  USBD_COMPOSITE_DataOut (USBD_HandleTypeDef *pdev, uint8_t epnum)
 {      
 	uint8_t status=USBD_OK;
 	uint8_t index=0;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
 	for(index=0;index<usbd_composite_pClass_count;index++){
 		uint8_t i=0;
 		for(i=0;i<usbd_composite_class_data[index].outEP;i++){
@@ -439,15 +473,21 @@ static uint8_t  USBD_COMPOSITE_DataOut (USBD_HandleTypeDef *pdev, uint8_t epnum)
 				pdev->pUserData=usbd_composite_class_data[index].pUserData;
 
 				if(usbd_composite_class_data[index].pClass->DataOut){
+					USBD_PROF_START(cycles);
 					status|=usbd_composite_class_data[index].pClass->DataOut(pdev, usbd_composite_class_data[index].outEPn[i]);
+					USBD_PROF_STOP(USBD_PROF_CLASS_DATA_OUT, cycles);
 				}
 
 				usbd_composite_class_data[index].pClassData=pdev->pClassData;
 				usbd_composite_class_data[index].pUserData=pdev->pUserData;
+				pdev->pClassData=pClassData;
+				pdev->pUserData=pUserData;
 				return status;
 			}
 		}
 	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
 	return status;
 }
 
@@ -464,17 +504,23 @@ static uint8_t  USBD_COMPOSITE_EP0_RxReady (USBD_HandleTypeDef *pdev)
 { 
 	uint8_t status=USBD_OK;
 	uint8_t index;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
 	for(index=0;index<usbd_composite_pClass_count;index++){
 		pdev->pClassData=usbd_composite_class_data[index].pClassData;
 		pdev->pUserData=usbd_composite_class_data[index].pUserData;
 
 		if(usbd_composite_class_data[index].pClass->EP0_RxReady){
+			USBD_PROF_START(cycles);
 			status|=usbd_composite_class_data[index].pClass->EP0_RxReady(pdev);
+			USBD_PROF_STOP(USBD_PROF_CLASS_EP0_RX_READY, cycles);
 		}
 
 		usbd_composite_class_data[index].pClassData=pdev->pClassData;
 		usbd_composite_class_data[index].pUserData=pdev->pUserData;
 	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
 	return status;
 }
 
@@ -488,22 +534,31 @@ static uint8_t  USBD_COMPOSITE_EP0_TxReady (USBD_HandleTypeDef *pdev)
 {
 	uint8_t status=USBD_OK;
 	uint8_t index;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
 	for(index=0;index<usbd_composite_pClass_count;index++){
 		pdev->pClassData=usbd_composite_class_data[index].pClassData;
 		pdev->pUserData=usbd_composite_class_data[index].pUserData;
 
 		if(usbd_composite_class_data[index].pClass->EP0_TxSent){
+			USBD_PROF_START(cycles);
 			status|=usbd_composite_class_data[index].pClass->EP0_TxSent(pdev);
+			USBD_PROF_STOP(USBD_PROF_CLASS_EP0_TX_SENT, cycles);
 		}
 
 		usbd_composite_class_data[index].pClassData=pdev->pClassData;
 		usbd_composite_class_data[index].pUserData=pdev->pUserData;
 	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
 	return status;
 }
 /**
   * @brief  USBD_COMPOSITE_SOF
-  *         handle SOF event
+  *         handle SOF event, calls the SOF of the classes whose timer
+  *         expired. Frames whose SOF was not handled, with deferred events,
+  *         still count: a timer that expired several times in between is
+  *         called once.
   * @param  pdev: device instance
   * @retval status
   */
@@ -511,17 +566,43 @@ static uint8_t  USBD_COMPOSITE_SOF (USBD_HandleTypeDef *pdev)
 {
 	uint8_t status=USBD_OK;
 	uint8_t index;
+	uint16_t frame;
+	uint16_t elapsed;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
+
+	frame=USBD_LLEx_GetFrameNumber(pdev);
+	elapsed=(frame-usbd_composite_sof_frame) & USB_COMPOSITE_FRAME_MASK;
+	usbd_composite_sof_frame=frame;
+	if(elapsed==0){
+		return status;
+	}
+
 	for(index=0;index<usbd_composite_pClass_count;index++){
+		if(usbd_composite_class_data[index].sofPeriod==0){
+			continue;
+		}
+		if(usbd_composite_class_data[index].sofRemaining>elapsed){
+			usbd_composite_class_data[index].sofRemaining-=elapsed;
+			continue;
+		}
+		usbd_composite_class_data[index].sofRemaining=usbd_composite_class_data[index].sofPeriod-
+				(elapsed-usbd_composite_class_data[index].sofRemaining)%usbd_composite_class_data[index].sofPeriod;
+
 		pdev->pClassData=usbd_composite_class_data[index].pClassData;
 		pdev->pUserData=usbd_composite_class_data[index].pUserData;
 
 		if(usbd_composite_class_data[index].pClass->SOF){
+			USBD_PROF_START(cycles);
 			status|=usbd_composite_class_data[index].pClass->SOF(pdev);
+			USBD_PROF_STOP(USBD_PROF_CLASS_SOF, cycles);
 		}
 
 		usbd_composite_class_data[index].pClassData=pdev->pClassData;
 		usbd_composite_class_data[index].pUserData=pdev->pUserData;
 	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
 	return status;
 }
 
@@ -537,6 +618,8 @@ static uint8_t  USBD_COMPOSITE_IsoINIncomplete (USBD_HandleTypeDef *pdev, uint8_
 {
 	uint8_t status=USBD_OK;
 	uint8_t index=0;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
 	for(index=0;index<usbd_composite_pClass_count;index++){
 		uint8_t i=0;
 		for(i=0;i<usbd_composite_class_data[index].inEP;i++){
@@ -545,15 +628,21 @@ static uint8_t  USBD_COMPOSITE_IsoINIncomplete (USBD_HandleTypeDef *pdev, uint8_
 				pdev->pUserData=usbd_composite_class_data[index].pUserData;
 
 				if(usbd_composite_class_data[index].pClass->IsoINIncomplete){
+					USBD_PROF_START(cycles);
 					status|=usbd_composite_class_data[index].pClass->IsoINIncomplete(pdev, usbd_composite_class_data[index].inEPn[i]);
+					USBD_PROF_STOP(USBD_PROF_CLASS_ISO_IN_INCOMPLETE, cycles);
 				}
 
 				usbd_composite_class_data[index].pClassData=pdev->pClassData;
 				usbd_composite_class_data[index].pUserData=pdev->pUserData;
+				pdev->pClassData=pClassData;
+				pdev->pUserData=pUserData;
 				return status;
 			}
 		}
 	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
 	return status;
 }
 /**
@@ -568,6 +657,8 @@ static uint8_t  USBD_COMPOSITE_IsoOutIncomplete (USBD_HandleTypeDef *pdev, uint8
 
 	uint8_t status=USBD_OK;
 	uint8_t index=0;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
 	for(index=0;index<usbd_composite_pClass_count;index++){
 		uint8_t i=0;
 		for(i=0;i<usbd_composite_class_data[index].outEP;i++){
@@ -576,15 +667,21 @@ static uint8_t  USBD_COMPOSITE_IsoOutIncomplete (USBD_HandleTypeDef *pdev, uint8
 				pdev->pUserData=usbd_composite_class_data[index].pUserData;
 
 				if(usbd_composite_class_data[index].pClass->IsoOUTIncomplete){
+					USBD_PROF_START(cycles);
 					status|=usbd_composite_class_data[index].pClass->IsoOUTIncomplete(pdev, usbd_composite_class_data[index].outEPn[i]);
+					USBD_PROF_STOP(USBD_PROF_CLASS_ISO_OUT_INCOMPLETE, cycles);
 				}
 
 				usbd_composite_class_data[index].pClassData=pdev->pClassData;
 				usbd_composite_class_data[index].pUserData=pdev->pUserData;
+				pdev->pClassData=pClassData;
+				pdev->pUserData=pUserData;
 				return status;
 			}
 		}
 	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
 	return status;
 }
 
@@ -638,9 +735,57 @@ uint8_t  *USBD_COMPOSITE_GetDeviceQualifierDescriptor (uint16_t *length)
 	return USBD_COMPOSITE_DeviceQualifierDesc;
 }
 
+#if (USBD_SUPPORT_USER_STRING == 1)
+/**
+ * @brief  USBD_COMPOSITE_GetUsrStrDescriptor
+ *         Return the string descriptor of the first class knowing the index.
+ *         The core sends nothing for an unknown one, EP0 is stalled instead.
+ * @param  pdev: device instance
+ * @param  index: string index
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_COMPOSITE_GetUsrStrDescriptor (USBD_HandleTypeDef *pdev, uint8_t index, uint16_t *length)
+{
+	uint8_t *pbuf=NULL;
+	uint8_t index_class;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
+
+	*length=0;
+	for(index_class=0;index_class<usbd_composite_pClass_count;index_class++){
+		if(usbd_composite_class_data[index_class].pClass->GetUsrStrDescriptor==NULL){
+			continue;
+		}
+		pdev->pClassData=usbd_composite_class_data[index_class].pClassData;
+		pdev->pUserData=usbd_composite_class_data[index_class].pUserData;
+
+		pbuf=usbd_composite_class_data[index_class].pClass->GetUsrStrDescriptor(pdev, index, length);
+
+		usbd_composite_class_data[index_class].pClassData=pdev->pClassData;
+		usbd_composite_class_data[index_class].pUserData=pdev->pUserData;
+		if(*length!=0){
+			pdev->pClassData=pClassData;
+			pdev->pUserData=pUserData;
+			return pbuf;
+		}
+	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
+
+	USBD_LL_StallEP(pdev, 0x80);
+	USBD_LL_StallEP(pdev, 0);
+	return NULL;
+}
+#endif
+
 USBD_StatusTypeDef  USBD_COMPOSITE_RegisterClass(USBD_HandleTypeDef *pdev, uint8_t bFunctionClass, uint8_t bFunctionSubClass, uint8_t bFunctionProtocol){
 	USBD_StatusTypeDef   status = USBD_OK;
 	uint8_t lastIfc=-1;
+	uint8_t ifcClass=0;
+	uint8_t ifcSubClass=0;
+	uint8_t *descriptor_first;
+	uint8_t i;
 	if(descriptor_size==0){
 		USBD_memcpy(descriptor, USBD_COMPOSITE_CfgFSDesc, USB_COMPOSITE_CONFIG_DESC_SIZ);
 		descriptor_size+=USB_COMPOSITE_CONFIG_DESC_SIZ;
@@ -661,6 +806,7 @@ USBD_StatusTypeDef  USBD_COMPOSITE_RegisterClass(USBD_HandleTypeDef *pdev, uint8
 		uint8_t *descriptor_end=descriptor_temp+length_temp;
 		USBD_COMPOSITE_ItfAssocDescriptor *itfAssocDescriptor;
 
+		descriptor_first=descriptor+descriptor_size;
 		while(descriptor_temp<descriptor_end){
 			uint8_t *descriptor_current=descriptor+descriptor_size;
 			USBD_memcpy(descriptor_current, descriptor_temp, descriptor_temp[0]);
@@ -683,6 +829,8 @@ USBD_StatusTypeDef  USBD_COMPOSITE_RegisterClass(USBD_HandleTypeDef *pdev, uint8
 				itfAssocDescriptor->bFunctionProtocol=bFunctionProtocol;
 				break;
 			case 0x04: // Interface descriptor
+				ifcClass=descriptor_current[5];
+				ifcSubClass=descriptor_current[6];
 				if(descriptor_current[2]!=lastIfc){ // Check if same interface different configuration.
 					lastIfc=descriptor_current[2];
 					descriptor_current[2]=itf_num++;
@@ -694,12 +842,16 @@ USBD_StatusTypeDef  USBD_COMPOSITE_RegisterClass(USBD_HandleTypeDef *pdev, uint8
 			case 0x05: // Endpoint descriptor
 				if(descriptor_current[2] & 0x80) // Check if IN EP
 				{
+					usbd_composite_class_data[usbd_composite_pClass_count].inEPtype[usbd_composite_class_data[usbd_composite_pClass_count].inEP]=descriptor_current[3] & 0x03;
+					usbd_composite_class_data[usbd_composite_pClass_count].inEPmps[usbd_composite_class_data[usbd_composite_pClass_count].inEP]=(descriptor_current[4] | (descriptor_current[5]<<8)) & 0x7FF;
 					usbd_composite_class_data[usbd_composite_pClass_count].inEPn[usbd_composite_class_data[usbd_composite_pClass_count].inEP]=descriptor_current[2] & 0x7F;
 //					usbd_composite_class_data[usbd_composite_pClass_count].inEPa[usbd_composite_class_data[usbd_composite_pClass_count].inEP++]=descriptor_current[2] & 0x7F;
 //					inEP++;
 					usbd_composite_class_data[usbd_composite_pClass_count].inEPa[usbd_composite_class_data[usbd_composite_pClass_count].inEP++]=inEP;
 					descriptor_current[2]=inEP++ | 0x80;
 				} else {
+					usbd_composite_class_data[usbd_composite_pClass_count].outEPtype[usbd_composite_class_data[usbd_composite_pClass_count].outEP]=descriptor_current[3] & 0x03;
+					usbd_composite_class_data[usbd_composite_pClass_count].outEPmps[usbd_composite_class_data[usbd_composite_pClass_count].outEP]=(descriptor_current[4] | (descriptor_current[5]<<8)) & 0x7FF;
 					usbd_composite_class_data[usbd_composite_pClass_count].outEPn[usbd_composite_class_data[usbd_composite_pClass_count].outEP]=descriptor_current[2] & 0x7F;
 //					usbd_composite_class_data[usbd_composite_pClass_count].outEPa[usbd_composite_class_data[usbd_composite_pClass_count].outEP++]=descriptor_current[2] & 0x7F;
 //					outEP++;
@@ -708,8 +860,16 @@ USBD_StatusTypeDef  USBD_COMPOSITE_RegisterClass(USBD_HandleTypeDef *pdev, uint8
 				}
 				break;
 			case 0x24: // CS Interface
+				if(ifcClass==0x01){ // Audio
+					if(ifcSubClass==0x01 && descriptor_current[2]==0x01){ //Check if AudioControl Header, baInterfaceNr
+						for(i=0;i<descriptor_current[7];i++){
+							descriptor_current[8+i]=itf_num-1+descriptor_current[8+i];
+						}
+					}
+					break;
+				}
 				switch(descriptor_current[2]){
-				case 0x01: //Check if Union Functional Descriptor
+				case 0x01: //Check if Call Management Functional Descriptor
 					descriptor_current[4]=itf_num-1+descriptor_current[4];
 					break;
 				case 0x06: //Check if Union Functional Descriptor
@@ -723,6 +883,28 @@ USBD_StatusTypeDef  USBD_COMPOSITE_RegisterClass(USBD_HandleTypeDef *pdev, uint8
 			}
 		}
 
+		/* Second pass, an isochronous endpoint may name its feedback endpoint
+		declared after it */
+		for(descriptor_temp=descriptor_first;descriptor_temp<descriptor+descriptor_size;descriptor_temp+=descriptor_temp[0]){
+			if(descriptor_temp[1]==0x05 && descriptor_temp[0]>=9 && descriptor_temp[8]!=0){ // Audio endpoint, bSynchAddress
+				if(descriptor_temp[8] & 0x80){
+					for(i=0;i<usbd_composite_class_data[usbd_composite_pClass_count].inEP;i++){
+						if(usbd_composite_class_data[usbd_composite_pClass_count].inEPn[i]==(descriptor_temp[8] & 0x7F)){
+							descriptor_temp[8]=usbd_composite_class_data[usbd_composite_pClass_count].inEPa[i] | 0x80;
+							break;
+						}
+					}
+				} else {
+					for(i=0;i<usbd_composite_class_data[usbd_composite_pClass_count].outEP;i++){
+						if(usbd_composite_class_data[usbd_composite_pClass_count].outEPn[i]==descriptor_temp[8]){
+							descriptor_temp[8]=usbd_composite_class_data[usbd_composite_pClass_count].outEPa[i];
+							break;
+						}
+					}
+				}
+			}
+		}
+
 		descriptor[2]=LOBYTE(descriptor_size);		//Update Config Descritor Total Size
 		descriptor[3]=HIBYTE(descriptor_size);	//Update Config Descritor Total Size
 		descriptor[4]=itf_num;			//Update the total interface count
@@ -767,6 +949,248 @@ uint8_t  USBD_COMPOSITE_LL_EP_Conversion  (USBD_HandleTypeDef *pdev, uint8_t  ep
 	return ep_addr;
 }
 
+/**
+ * @brief  USBD_COMPOSITE_GetEPInfo
+ *         Return the transfer type and max packet size of a device endpoint
+ * @param  ep_addr: device (already converted) endpoint address
+ * @param  ep_type: pointer to the endpoint type (USBD_EP_TYPE_xxx)
+ * @param  ep_mps: pointer to the endpoint max packet size
+ * @retval USBD_OK if the endpoint belongs to a registered class, USBD_FAIL otherwise
+ */
+uint8_t  USBD_COMPOSITE_GetEPInfo  (uint8_t  ep_addr, uint8_t *ep_type, uint16_t *ep_mps){
+	uint8_t index=0;
+	uint8_t i=0;
+	for(index=0;index<usbd_composite_pClass_count;index++){
+		if(ep_addr & 0x80){
+			for(i=0;i<usbd_composite_class_data[index].inEP;i++){
+				if(usbd_composite_class_data[index].inEPa[i]==(ep_addr & 0x7f)){
+					*ep_type=usbd_composite_class_data[index].inEPtype[i];
+					*ep_mps=usbd_composite_class_data[index].inEPmps[i];
+					return USBD_OK;
+				}
+			}
+		} else {
+			for(i=0;i<usbd_composite_class_data[index].outEP;i++){
+				if(usbd_composite_class_data[index].outEPa[i]==ep_addr){
+					*ep_type=usbd_composite_class_data[index].outEPtype[i];
+					*ep_mps=usbd_composite_class_data[index].outEPmps[i];
+					return USBD_OK;
+				}
+			}
+		}
+	}
+	return USBD_FAIL;
+}
+
+/**
+ * @brief  USBD_COMPOSITE_RegisterDeviceRequest
+ *         Give the class registered last a handler of device recipient
+ *         requests: vendor requests and the BOS descriptor, which the core
+ *         never passes to the class. The handler returns USBD_OK when it
+ *         took the request, with its data stage started, or USBD_FAIL to
+ *         leave it to the other classes.
+ * @param  pdev: device instance
+ * @param  pDeviceRequest: request handler
+ * @retval status
+ */
+USBD_StatusTypeDef  USBD_COMPOSITE_RegisterDeviceRequest(USBD_HandleTypeDef *pdev, USBD_COMPOSITE_DeviceRequestTypeDef pDeviceRequest){
+	if(usbd_composite_pClass_count==0 || pDeviceRequest==NULL){
+		USBD_ErrLog("Invalid device request handler");
+		return USBD_FAIL;
+	}
+	usbd_composite_class_data[usbd_composite_pClass_count-1].DeviceRequest=pDeviceRequest;
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_COMPOSITE_DeviceRequest
+ *         Offer a SETUP packet to the device request handlers of the classes,
+ *         before USBD_LL_SetupStage. Vendor requests to the device and
+ *         GET_DESCRIPTOR(BOS) are taken when a class has a handler, any
+ *         other request is left to the core.
+ * @param  pdev: device instance
+ * @param  psetup: SETUP packet
+ * @retval USBD_OK if the request was handled (or stalled) here
+ */
+uint8_t  USBD_COMPOSITE_DeviceRequest  (USBD_HandleTypeDef *pdev, uint8_t *psetup){
+	uint8_t status=USBD_FAIL;
+	uint8_t index=0;
+	void *pClassData=pdev->pClassData;
+	void *pUserData=pdev->pUserData;
+
+	if((psetup[0] & 0x1F)!=USB_REQ_RECIPIENT_DEVICE){
+		return USBD_FAIL;
+	}
+	if((psetup[0] & USB_REQ_TYPE_MASK)!=USB_REQ_TYPE_VENDOR &&
+			!((psetup[0] & USB_REQ_TYPE_MASK)==USB_REQ_TYPE_STANDARD && psetup[1]==USB_REQ_GET_DESCRIPTOR && psetup[3]==USB_DESC_TYPE_BOS)){
+		return USBD_FAIL;
+	}
+	for(index=0;index<usbd_composite_pClass_count;index++){
+		if(usbd_composite_class_data[index].DeviceRequest){
+			break;
+		}
+	}
+	if(index==usbd_composite_pClass_count){
+		return USBD_FAIL;
+	}
+
+	/* As USBD_LL_SetupStage, for the EP0 data and status stages */
+	USBD_ParseSetupRequest(&pdev->request, psetup);
+	pdev->ep0_state=USBD_EP0_SETUP;
+	pdev->ep0_data_len=pdev->request.wLength;
+
+	for(index=0;index<usbd_composite_pClass_count && status!=USBD_OK;index++){
+		if(usbd_composite_class_data[index].DeviceRequest==NULL){
+			continue;
+		}
+		pdev->pClassData=usbd_composite_class_data[index].pClassData;
+		pdev->pUserData=usbd_composite_class_data[index].pUserData;
+
+		USBD_PROF_START(cycles);
+		status=usbd_composite_class_data[index].DeviceRequest(pdev, &pdev->request);
+		USBD_PROF_STOP(USBD_PROF_CLASS_SETUP, cycles);
+
+		usbd_composite_class_data[index].pClassData=pdev->pClassData;
+		usbd_composite_class_data[index].pUserData=pdev->pUserData;
+	}
+	pdev->pClassData=pClassData;
+	pdev->pUserData=pUserData;
+
+	if(status!=USBD_OK){
+		USBD_CtlError(pdev, &pdev->request);
+	} else if(pdev->request.wLength==0){
+		USBD_CtlSendStatus(pdev);
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_COMPOSITE_SelectClass
+ *         Make the context of a class current in the device handle, for a
+ *         call into the class from task context. The USB interrupt must stay
+ *         masked until USBD_COMPOSITE_RestoreClass. Within the callbacks of
+ *         the class its context is left as it is, Init has not stored its
+ *         class data yet.
+ * @param  pdev: device instance
+ * @param  pClass: registered class
+ * @param  pSaved: context to restore
+ * @retval USBD_OK, USBD_FAIL if the class is not registered
+ */
+uint8_t  USBD_COMPOSITE_SelectClass  (USBD_HandleTypeDef *pdev, USBD_ClassTypeDef *pClass, USBD_COMPOSITE_ContextTypeDef *pSaved){
+	uint8_t index=0;
+
+	pSaved->pClassData=pdev->pClassData;
+	pSaved->pUserData=pdev->pUserData;
+	for(index=0;index<usbd_composite_pClass_count;index++){
+		if(usbd_composite_class_data[index].pClass==pClass){
+			if(pdev->pUserData!=usbd_composite_class_data[index].pUserData){
+				pdev->pClassData=usbd_composite_class_data[index].pClassData;
+				pdev->pUserData=usbd_composite_class_data[index].pUserData;
+			}
+			return USBD_OK;
+		}
+	}
+	return USBD_FAIL;
+}
+
+/**
+ * @brief  USBD_COMPOSITE_RestoreClass
+ *         Restore the context saved by USBD_COMPOSITE_SelectClass
+ * @param  pdev: device instance
+ * @param  pSaved: saved context
+ * @retval None
+ */
+void  USBD_COMPOSITE_RestoreClass  (USBD_HandleTypeDef *pdev, USBD_COMPOSITE_ContextTypeDef *pSaved){
+	pdev->pClassData=pSaved->pClassData;
+	pdev->pUserData=pSaved->pUserData;
+}
+
+/**
+ * @brief  USBD_COMPOSITE_GetFirstInterface
+ *         Return the device interface number of the first interface of a class
+ * @param  pClass: registered class
+ * @retval interface number, 0xFF if the class is not registered
+ */
+uint8_t  USBD_COMPOSITE_GetFirstInterface  (USBD_ClassTypeDef *pClass){
+	uint8_t index=0;
+	uint8_t itf=0;
+
+	for(index=0;index<usbd_composite_pClass_count;index++){
+		if(usbd_composite_class_data[index].pClass==pClass){
+			return itf;
+		}
+		itf+=usbd_composite_class_data[index].bInterfaces;
+	}
+	return 0xFF;
+}
+
+/**
+ * @brief  USBD_COMPOSITE_StartSOFTimer
+ *         Call the SOF of a class every period frames, 1 ms each at full
+ *         speed, until stopped or the device is unconfigured. Starting a
+ *         running timer restarts it, as a timeout pushed back by activity.
+ *         The first call may come up to a frame early. Callable from the
+ *         class callbacks and from task context.
+ * @param  pdev: device instance
+ * @param  pClass: registered class
+ * @param  period: frames, 0 stops the timer
+ * @retval USBD_OK, USBD_FAIL if the class is not registered
+ */
+uint8_t  USBD_COMPOSITE_StartSOFTimer  (USBD_HandleTypeDef *pdev, USBD_ClassTypeDef *pClass, uint16_t period){
+	uint8_t index=0;
+	uint32_t primask;
+
+	if(period==0){
+		USBD_COMPOSITE_StopSOFTimer(pdev, pClass);
+		return USBD_OK;
+	}
+
+	for(index=0;index<usbd_composite_pClass_count;index++){
+		if(usbd_composite_class_data[index].pClass==pClass){
+			primask=__get_PRIMASK();
+			__disable_irq();
+			if(usbd_composite_class_data[index].sofPeriod==0 && usbd_composite_sof_timers++==0){
+				/* Frames count from now, not from the last SOF dispatched */
+				usbd_composite_sof_frame=USBD_LLEx_GetFrameNumber(pdev);
+				USBD_LLEx_EnableSOF(pdev, 1);
+			}
+			usbd_composite_class_data[index].sofPeriod=period;
+			usbd_composite_class_data[index].sofRemaining=period;
+			__set_PRIMASK(primask);
+			return USBD_OK;
+		}
+	}
+	return USBD_FAIL;
+}
+
+/**
+ * @brief  USBD_COMPOSITE_StopSOFTimer
+ *         Stop the SOF timer of a class, the SOF interrupt is masked once
+ *         no class has one running
+ * @param  pdev: device instance
+ * @param  pClass: registered class
+ * @retval None
+ */
+void  USBD_COMPOSITE_StopSOFTimer  (USBD_HandleTypeDef *pdev, USBD_ClassTypeDef *pClass){
+	uint8_t index=0;
+	uint32_t primask;
+
+	for(index=0;index<usbd_composite_pClass_count;index++){
+		if(usbd_composite_class_data[index].pClass==pClass){
+			primask=__get_PRIMASK();
+			__disable_irq();
+			if(usbd_composite_class_data[index].sofPeriod!=0){
+				usbd_composite_class_data[index].sofPeriod=0;
+				if(--usbd_composite_sof_timers==0){
+					USBD_LLEx_EnableSOF(pdev, 0);
+				}
+			}
+			__set_PRIMASK(primask);
+			return;
+		}
+	}
+}
+
 
 /**
  * @}
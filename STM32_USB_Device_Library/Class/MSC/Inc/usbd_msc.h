@@ -0,0 +1,265 @@
+/**
+  ******************************************************************************
+  * @file    usbd_msc.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   header file for the usbd_msc.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_MSC_H
+#define __USB_MSC_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_msc
+  * @brief This file is the Header file for usbd_msc.c
+  * @{
+  */
+
+
+/** @defgroup usbd_msc_Exported_Defines
+  * @{
+  */
+#define MSC_IN_EP                                     0x81  /* EP1 for data IN, renumbered by the composite layer */
+#define MSC_OUT_EP                                    0x01  /* EP1 for data OUT, renumbered by the composite layer */
+
+#define MSC_MAX_FS_PACKET                             64    /* Endpoint IN & OUT Packet size */
+
+#define USB_MSC_CONFIG_DESC_SIZ                       32
+
+/* Media buffers: one is on the bus while the storage fills or empties the
+other, MSC_MEDIA_PACKET bytes each (usbd_conf.h) */
+#define MSC_MEDIA_BUFFERS                             2
+
+/*---------------------------------------------------------------------*/
+/*  Bulk-Only Transport definitions                                    */
+/*---------------------------------------------------------------------*/
+#define BOT_GET_MAX_LUN                               0xFE
+#define BOT_RESET                                     0xFF
+
+#define USBD_BOT_CBW_SIGNATURE                        0x43425355
+#define USBD_BOT_CSW_SIGNATURE                        0x53425355
+#define USBD_BOT_CBW_LENGTH                           31
+#define USBD_BOT_CSW_LENGTH                           13
+#define USBD_BOT_MAX_DATA                             64    /* Data of the commands other than READ/WRITE */
+
+/* CSW Status Definitions */
+#define USBD_CSW_CMD_PASSED                           0x00
+#define USBD_CSW_CMD_FAILED                           0x01
+#define USBD_CSW_PHASE_ERROR                          0x02
+
+/* USBD_MSC_MediaReqTypeDef operations */
+#define USBD_MSC_MEDIA_READ                           0     /* Read blk_len blocks into pbuf */
+#define USBD_MSC_MEDIA_WRITE                          1     /* Write blk_len blocks from pbuf */
+#define USBD_MSC_MEDIA_SYNC                           2     /* Write back what the storage keeps, no data */
+
+#define MSC_MAX_LUN                                   1
+#define MSC_SENSE_DEPTH                               4     /* Sense data kept for REQUEST SENSE */
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/**
+  * @}
+  */
+/* Storage backend, as in the ST MSC class. Read and Write are only called
+from the task of the interface, the other functions from the USB interrupt. */
+typedef struct _USBD_STORAGE
+{
+  int8_t (* Init) (uint8_t lun);
+  int8_t (* GetCapacity) (uint8_t lun, uint32_t *block_num, uint16_t *block_size);
+  int8_t (* IsReady) (uint8_t lun);
+  int8_t (* IsWriteProtected) (uint8_t lun);
+  int8_t (* Read) (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+  int8_t (* Write)(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+  int8_t (* GetMaxLun)(void);
+  int8_t *pInquiry;
+
+}USBD_StorageTypeDef;
+
+/* One storage access of a READ(10) or WRITE(10), or the sync of a storage
+cache for SYNCHRONIZE CACHE(10) and STOP UNIT */
+typedef struct
+{
+  uint8_t  lun;
+  uint8_t  op;                               /* USBD_MSC_MEDIA_READ, _WRITE or _SYNC */
+  uint8_t  *pbuf;
+  uint32_t blk_addr;
+  uint16_t blk_len;
+  int8_t   status;                           /* Set by the interface: 0, or -1 on failure */
+}USBD_MSC_MediaReqTypeDef;
+
+typedef struct _USBD_MSC_Itf
+{
+  int8_t (* Init)          (void);                                      /* Configured */
+  int8_t (* DeInit)        (void);                                      /* Unconfigured, a pending access still completes */
+  int8_t (* Submit)        (USBD_MSC_MediaReqTypeDef *);                /* Start an access, USBD_MSC_MediaCplt once done */
+  USBD_StorageTypeDef *pStorage;                                        /* Every other storage call */
+
+}USBD_MSC_ItfTypeDef;
+
+typedef struct
+{
+  uint32_t dSignature;
+  uint32_t dTag;
+  uint32_t dDataLength;
+  uint8_t  bmFlags;
+  uint8_t  bLUN;
+  uint8_t  bCBLength;
+  uint8_t  CB[16];
+  uint8_t  ReservedForAlign;
+}
+USBD_MSC_BOT_CBWTypeDef;
+
+typedef struct
+{
+  uint32_t dSignature;
+  uint32_t dTag;
+  uint32_t dDataResidue;
+  uint8_t  bStatus;
+  uint8_t  ReservedForAlign[3];
+}
+USBD_MSC_BOT_CSWTypeDef;
+
+typedef struct
+{
+  uint8_t  Skey;
+  uint8_t  ASC;
+  uint8_t  ASCQ;
+}
+USBD_MSC_SenseTypeDef;
+
+/* BOT states */
+typedef enum
+{
+  USBD_BOT_IDLE = 0,                         /* Waiting for a CBW */
+  USBD_BOT_DATA_OUT,                         /* WRITE(10) data stage */
+  USBD_BOT_DATA_IN,                          /* READ(10) data stage */
+  USBD_BOT_SEND_DATA,                        /* Data of another command */
+  USBD_BOT_SYNC,                             /* Storage sync, no data stage */
+  USBD_BOT_STATUS,                           /* CSW queued, or waiting for the halt to be cleared */
+} USBD_MSC_BOT_StateTypeDef;
+
+typedef enum
+{
+  USBD_BOT_STATUS_NORMAL = 0,
+  USBD_BOT_STATUS_RECOVERY,                  /* Reset by the host */
+  USBD_BOT_STATUS_ERROR,                     /* Invalid CBW, waiting for a reset recovery */
+} USBD_MSC_BOT_StatusTypeDef;
+
+/* Media buffer states, each buffer goes through them in turn */
+typedef enum
+{
+  USBD_MSC_BUF_FREE = 0,
+  USBD_MSC_BUF_MEDIA,                        /* Storage access pending */
+  USBD_MSC_BUF_BUS,                          /* Queued on the endpoint */
+  USBD_MSC_BUF_FULL,                         /* Received, waiting for the storage */
+} USBD_MSC_BufStateTypeDef;
+
+typedef struct
+{
+  uint8_t  buf_state[MSC_MEDIA_BUFFERS];
+  uint16_t buf_blocks[MSC_MEDIA_BUFFERS];
+  uint8_t  media_idx;                        /* Next buffer for the storage */
+  uint8_t  bus_idx;                          /* Next buffer for the endpoint */
+  uint8_t  media_busy;
+  uint8_t  failed;                           /* Storage access failed, the data stage ends */
+  uint32_t media_addr;                       /* Next block for the storage */
+  uint32_t media_left;                       /* Blocks left for the storage */
+  uint32_t bus_left;                         /* Blocks left to queue on the endpoint */
+  uint32_t done_bytes;                       /* Data stage bytes moved */
+}
+USBD_MSC_PipeTypeDef;
+
+typedef struct
+{
+  uint32_t                  max_lun;
+  uint8_t                   bot_state;
+  uint8_t                   bot_status;
+  uint16_t                  bot_data_length;
+  uint32_t                  bot_data[USBD_BOT_MAX_DATA/4];      /* Data of the commands other than READ/WRITE */
+  uint32_t                  cbw_packet[MSC_MAX_FS_PACKET/4];    /* CBW receive buffer, a whole packet */
+  USBD_MSC_BOT_CBWTypeDef   cbw;
+  USBD_MSC_BOT_CSWTypeDef   csw;
+
+  USBD_MSC_SenseTypeDef     scsi_sense[MSC_SENSE_DEPTH];
+  uint8_t                   scsi_sense_head;
+  uint8_t                   scsi_sense_tail;
+
+  uint16_t                  scsi_blk_size;
+  uint32_t                  scsi_blk_nbr;
+
+  USBD_MSC_PipeTypeDef      pipe;
+}
+USBD_MSC_BOT_HandleTypeDef;
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_MSC;
+#define USBD_MSC_CLASS    &USBD_MSC
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_MSC_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+                                      USBD_MSC_ItfTypeDef *fops);
+
+uint8_t  USBD_MSC_MediaCplt          (USBD_HandleTypeDef *pdev,
+                                      USBD_MSC_MediaReqTypeDef *req);
+
+/* Shared by usbd_msc.c and usbd_msc_scsi.c */
+void     MSC_BOT_SendData            (USBD_HandleTypeDef *pdev, uint8_t *pbuf, uint16_t len);
+
+void     MSC_BOT_StartPipe           (USBD_HandleTypeDef *pdev, uint8_t op, uint32_t blk_addr, uint32_t blk_len);
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_MSC_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,1136 @@
+/**
+ ******************************************************************************
+ * @file    usbd_msc.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB Mass Storage Class:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as Mass Storage device, SCSI transparent command
+ *             set over Bulk-Only Transport
+ *           - READ(10) and WRITE(10) data stages pipelined with the storage
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                                MSC Class Driver Description
+ *          ===================================================================
+ *           This driver implements the following aspects of the
+ *           "Universal Serial Bus Mass Storage Class Bulk-Only Transport"
+ *           specification revision 1.0:
+ *             - Command Block Wrapper decoding and Command Status Wrapper
+ *             - Class requests: Bulk-Only Mass Storage Reset, Get Max LUN
+ *             - Error handling and reset recovery
+ *
+ *           The storage is accessed MSC_MEDIA_PACKET bytes at a time through
+ *           MSC_MEDIA_BUFFERS buffers, from the task of the interface
+ *           (USBD_MSC_ItfTypeDef.Submit): while the storage reads into or
+ *           writes from one buffer, the other is queued on the endpoint
+ *           (usbd_ll_ex.h). READ(10) keeps the storage one buffer ahead of
+ *           the bus, WRITE(10) keeps every free buffer armed for the host.
+ *           Only one storage access is pending at a time.
+ *           SYNCHRONIZE CACHE(10) and STOP UNIT are given to the task the
+ *           same way (USBD_MSC_MEDIA_SYNC), their CSW follows its end, for
+ *           an interface that keeps writes back.
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_msc.h"
+#include "../inc/usbd_msc_scsi.h"
+#include "../../Composite/inc/usbd_composite.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+#include "usbd_ll_ex.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+
+/** @defgroup USBD_MSC
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_MSC_Private_TypesDefinitions
+ * @{
+ */
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_MSC_Private_Defines
+ * @{
+ */
+#if (MSC_MEDIA_PACKET % MSC_MAX_FS_PACKET) != 0
+#error "MSC_MEDIA_PACKET must be a multiple of the packet size"
+#endif
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_MSC_Private_Macros
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_MSC_Private_FunctionPrototypes
+ * @{
+ */
+
+
+static uint8_t  USBD_MSC_Init (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_MSC_DeInit (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_MSC_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t  *USBD_MSC_GetFSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_MSC_GetHSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_MSC_GetOtherSpeedCfgDesc (uint16_t *length);
+
+uint8_t  *USBD_MSC_GetDeviceQualifierDescriptor (uint16_t *length);
+
+static void  MSC_BOT_Init (USBD_HandleTypeDef *pdev);
+
+static void  MSC_BOT_Reset (USBD_HandleTypeDef *pdev);
+
+static void  MSC_BOT_Abort (USBD_HandleTypeDef *pdev);
+
+static void  MSC_BOT_CplClrFeature (USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static void  MSC_BOT_ReceiveCBW (USBD_HandleTypeDef *pdev);
+
+static void  MSC_BOT_CBWCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static void  MSC_BOT_CBW_Decode (USBD_HandleTypeDef *pdev, uint32_t length);
+
+static void  MSC_BOT_DataCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static void  MSC_BOT_SendCSW (USBD_HandleTypeDef *pdev, uint8_t CSW_Status);
+
+static uint8_t  MSC_Pipe_Index (uint8_t *pbuf);
+
+static uint8_t  MSC_Pipe_BufferFree (USBD_MSC_BOT_HandleTypeDef *hmsc, uint8_t idx);
+
+static void  MSC_Pipe_Next (USBD_HandleTypeDef *pdev);
+
+static void  MSC_Pipe_Submit (USBD_HandleTypeDef *pdev, uint8_t idx);
+
+static void  MSC_Pipe_MediaDone (USBD_HandleTypeDef *pdev, int8_t status);
+
+static void  MSC_Pipe_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static void  MSC_Pipe_RxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static void  MSC_Pipe_End (USBD_HandleTypeDef *pdev);
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_MSC_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+		USB_LEN_DEV_QUALIFIER_DESC,
+		USB_DESC_TYPE_DEVICE_QUALIFIER,
+		0x00,
+		0x02,
+		0x00,
+		0x00,
+		0x00,
+		MSC_MAX_FS_PACKET,
+		0x01,
+		0x00,
+};
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_MSC_Private_Variables
+ * @{
+ */
+
+
+/* MSC interface class callbacks structure */
+USBD_ClassTypeDef  USBD_MSC =
+{
+		USBD_MSC_Init,
+		USBD_MSC_DeInit,
+		USBD_MSC_Setup,
+		NULL,                 /* EP0_TxSent, */
+		NULL,                 /* EP0_RxReady, */
+		NULL,                 /* DataIn, every transfer is queued */
+		NULL,                 /* DataOut, every transfer is queued */
+		NULL,
+		NULL,
+		NULL,
+		USBD_MSC_GetHSCfgDesc,
+		USBD_MSC_GetFSCfgDesc,
+		USBD_MSC_GetOtherSpeedCfgDesc,
+		USBD_MSC_GetDeviceQualifierDescriptor,
+#if (USBD_SUPPORT_USER_STRING == 1)
+		NULL,
+#endif
+};
+
+/* USB MSC device Configuration Descriptor */
+__ALIGN_BEGIN uint8_t USBD_MSC_CfgFSDesc[USB_MSC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+		//SIZE: 9+9+7+7=32
+		/*Configuration Descriptor*/
+		0x09,   /* bLength: Configuration Descriptor size */
+		USB_DESC_TYPE_CONFIGURATION,      /* bDescriptorType: Configuration */
+		USB_MSC_CONFIG_DESC_SIZ,                /* wTotalLength:no of returned bytes */
+		0x00,
+		0x01,   /* bNumInterfaces: 1 interface */
+		0x01,   /* bConfigurationValue: Configuration value */
+		0x00,   /* iConfiguration: Index of string descriptor describing the configuration */
+		0xC0,   /* bmAttributes: self powered */
+		0xFA,   /* MaxPower 0 mA */
+
+		///INTERFACE DESCRIPTOR(0)
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x00,    ///bInterfaceNumber: Interface Number
+		0x00,    ///bAlternateSetting: Alternate setting for this interface
+		0x02,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x08,    ///iInterfaceClass: Class Code: Mass Storage
+		0x06,    ///iInterfaceSubClass: SubClass Code: SCSI transparent command set
+		0x50,    ///bInterfaceProtocol: Protocol Code: Bulk-Only Transport
+		0x00,    ///iInterface: String index
+
+		///ENDPOINT DESCRIPTOR(1)
+		0x07,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		MSC_IN_EP,    ///bEndpointAddress: Endpoint address (IN,EP1)
+		0x02,    ///bmAttributes: Transfer Type: BULK_TRANSFER
+		MSC_MAX_FS_PACKET,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///bIntervall: Polling Intervall
+
+		///ENDPOINT DESCRIPTOR(2)
+		0x07,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		MSC_OUT_EP,    ///bEndpointAddress: Endpoint address (OUT,EP1)
+		0x02,    ///bmAttributes: Transfer Type: BULK_TRANSFER
+		MSC_MAX_FS_PACKET,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///bIntervall: Polling Intervall
+		/*---------------------------------------------------------------------------*/
+} ;
+
+/* Media buffers, outside of the class handle so that a storage access still
+pending when the device is reset or unconfigured keeps its buffer */
+static uint32_t MSC_MediaBuffer[MSC_MEDIA_BUFFERS][MSC_MEDIA_PACKET / 4];
+
+/* Storage access given to the interface, and its buffer while pending */
+static USBD_MSC_MediaReqTypeDef MSC_Media;
+static __IO uint8_t MSC_MediaPending = 0;
+
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_MSC_Private_Functions
+ * @{
+ */
+
+/**
+ * @brief  USBD_MSC_Init
+ *         Initialize the MSC interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_MSC_Init (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+
+	/* Open EP IN */
+	USBD_LL_OpenEP(pdev,
+			MSC_IN_EP,
+			USBD_EP_TYPE_BULK,
+			MSC_MAX_FS_PACKET);
+
+	/* Open EP OUT */
+	USBD_LL_OpenEP(pdev,
+			MSC_OUT_EP,
+			USBD_EP_TYPE_BULK,
+			MSC_MAX_FS_PACKET);
+
+
+	pdev->pClassData = USBD_malloc(sizeof (USBD_MSC_BOT_HandleTypeDef));
+
+	if(pdev->pClassData == NULL)
+	{
+		ret = 1;
+	}
+	else
+	{
+		USBD_memset(pdev->pClassData, 0, sizeof (USBD_MSC_BOT_HandleTypeDef));
+
+		/* Init  physical Interface components */
+		((USBD_MSC_ItfTypeDef *)pdev->pUserData)->Init();
+
+		/* Init the BOT layer */
+		MSC_BOT_Init(pdev);
+	}
+	return ret;
+}
+
+/**
+ * @brief  USBD_MSC_DeInit
+ *         DeInitialize the MSC layer. A storage access still pending
+ *         completes to nothing.
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_MSC_DeInit (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+
+	/* Close EP IN */
+	USBD_LL_CloseEP(pdev,
+			MSC_IN_EP);
+
+	/* Close EP OUT */
+	USBD_LL_CloseEP(pdev,
+			MSC_OUT_EP);
+
+
+	/* DeInit  physical Interface components */
+	if(pdev->pClassData != NULL)
+	{
+		((USBD_MSC_ItfTypeDef *)pdev->pUserData)->DeInit();
+		USBD_free(pdev->pClassData);
+		pdev->pClassData = NULL;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_MSC_Setup
+ *         Handle the MSC specific requests
+ * @param  pdev: instance
+ * @param  req: usb requests
+ * @retval status
+ */
+static uint8_t  USBD_MSC_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	if(hmsc == NULL)
+	{
+		USBD_CtlError (pdev, req);
+		return USBD_FAIL;
+	}
+
+	switch (req->bmRequest & USB_REQ_TYPE_MASK)
+	{
+	/* Class request */
+	case USB_REQ_TYPE_CLASS :
+		switch (req->bRequest)
+		{
+		case BOT_GET_MAX_LUN :
+			if((req->wValue  == 0) && (req->wLength == 1) && ((req->bmRequest & 0x80) == 0x80))
+			{
+				hmsc->max_lun = ((USBD_MSC_ItfTypeDef *)pdev->pUserData)->pStorage->GetMaxLun();
+				USBD_CtlSendData (pdev, (uint8_t *)&hmsc->max_lun, 1);
+			}
+			else
+			{
+				USBD_CtlError(pdev , req);
+				return USBD_FAIL;
+			}
+			break;
+
+		case BOT_RESET :
+			if((req->wValue  == 0) && (req->wLength == 0) && ((req->bmRequest & 0x80) != 0x80))
+			{
+				MSC_BOT_Reset(pdev);
+			}
+			else
+			{
+				USBD_CtlError(pdev , req);
+				return USBD_FAIL;
+			}
+			break;
+
+		default:
+			USBD_CtlError(pdev , req);
+			return USBD_FAIL;
+		}
+		break;
+
+	/* Interface & Endpoint request */
+	case USB_REQ_TYPE_STANDARD:
+		switch (req->bRequest)
+		{
+		case USB_REQ_GET_INTERFACE :
+			hmsc->bot_data[0] = 0;
+			USBD_CtlSendData (pdev, (uint8_t *)hmsc->bot_data, 1);
+			break;
+
+		case USB_REQ_SET_INTERFACE :
+			if(LOBYTE(req->wValue) != 0)
+			{
+				USBD_CtlError (pdev, req);
+				return USBD_FAIL;
+			}
+			break;
+
+		case USB_REQ_CLEAR_FEATURE:
+			/* The core cleared the halt, wIndex is the device endpoint
+			address */
+			MSC_BOT_CplClrFeature(pdev, (uint8_t)req->wIndex);
+			break;
+		}
+		break;
+
+	default:
+		break;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_MSC_GetFSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_MSC_GetFSCfgDesc (uint16_t *length)
+{
+	*length = sizeof (USBD_MSC_CfgFSDesc);
+	return USBD_MSC_CfgFSDesc;
+}
+
+/**
+ * @brief  USBD_MSC_GetHSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_MSC_GetHSCfgDesc (uint16_t *length)
+{
+	return USBD_MSC_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  USBD_MSC_GetOtherSpeedCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_MSC_GetOtherSpeedCfgDesc (uint16_t *length)
+{
+	return USBD_MSC_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  DeviceQualifierDescriptor
+ *         return Device Qualifier descriptor
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+uint8_t  *USBD_MSC_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+	*length = sizeof (USBD_MSC_DeviceQualifierDesc);
+	return USBD_MSC_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  MSC_BOT_Init
+ *         Initialize the BOT Process and wait for the first CBW
+ * @param  pdev: device instance
+ * @retval None
+ */
+static void  MSC_BOT_Init (USBD_HandleTypeDef *pdev)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	hmsc->bot_state = USBD_BOT_IDLE;
+	hmsc->bot_status = USBD_BOT_STATUS_NORMAL;
+	hmsc->scsi_sense_tail = 0;
+	hmsc->scsi_sense_head = 0;
+	hmsc->max_lun = ((USBD_MSC_ItfTypeDef *)pdev->pUserData)->pStorage->GetMaxLun();
+
+	MSC_BOT_ReceiveCBW(pdev);
+}
+
+/**
+ * @brief  MSC_BOT_Reset
+ *         Bulk-Only Mass Storage Reset: the command in progress is dropped,
+ *         the storage access it may have pending completes to nothing.
+ * @param  pdev: device instance
+ * @retval None
+ */
+static void  MSC_BOT_Reset (USBD_HandleTypeDef *pdev)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	hmsc->bot_state = USBD_BOT_IDLE;
+	hmsc->bot_status = USBD_BOT_STATUS_RECOVERY;
+	USBD_memset(&hmsc->pipe, 0, sizeof (hmsc->pipe));
+
+	/* Queued transfers complete as aborted, and are ignored. Both endpoints
+	are stopped in the core on return, the CBW reception is armed at once on
+	an OUT endpoint no longer writing into a media buffer */
+	USBD_LLEx_Abort(pdev, MSC_IN_EP);
+	USBD_LLEx_Abort(pdev, MSC_OUT_EP);
+
+	MSC_BOT_ReceiveCBW(pdev);
+}
+
+/**
+ * @brief  MSC_BOT_Abort
+ *         Stall the endpoints of a failed command, its CSW is sent once the
+ *         host clears the IN halt. After an invalid CBW both stay halted
+ *         until a Bulk-Only Mass Storage Reset.
+ * @param  pdev: device instance
+ * @retval None
+ */
+static void  MSC_BOT_Abort (USBD_HandleTypeDef *pdev)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	if ((hmsc->bot_status == USBD_BOT_STATUS_ERROR) ||
+			((hmsc->cbw.bmFlags == 0) && (hmsc->cbw.dDataLength != 0)))
+	{
+		USBD_LL_StallEP(pdev, USBD_COMPOSITE_LL_EP_Conversion(pdev, MSC_OUT_EP));
+	}
+	USBD_LL_StallEP(pdev, USBD_COMPOSITE_LL_EP_Conversion(pdev, MSC_IN_EP));
+
+	hmsc->bot_state = USBD_BOT_STATUS;
+}
+
+/**
+ * @brief  MSC_BOT_CplClrFeature
+ *         Complete the clear feature request
+ * @param  pdev: device instance
+ * @param  epnum: endpoint index
+ * @retval None
+ */
+static void  MSC_BOT_CplClrFeature (USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	if(hmsc->bot_status == USBD_BOT_STATUS_ERROR)/* Bad CBW, halted until reset */
+	{
+		USBD_LL_StallEP(pdev, epnum);
+	}
+	else if(((epnum & 0x80) == 0x80) && (hmsc->bot_state == USBD_BOT_STATUS))
+	{
+		MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_FAILED);
+	}
+}
+
+/**
+ * @brief  MSC_BOT_ReceiveCBW
+ *         Wait for the next CBW
+ * @param  pdev: device instance
+ * @retval None
+ */
+static void  MSC_BOT_ReceiveCBW (USBD_HandleTypeDef *pdev)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	/* A whole packet, a host sending more than a CBW cannot overrun it */
+	USBD_LLEx_PrepareReceive(pdev, MSC_OUT_EP, (uint8_t *)hmsc->cbw_packet, MSC_MAX_FS_PACKET,
+			MSC_BOT_CBWCplt, NULL);
+}
+
+/**
+ * @brief  MSC_BOT_CBWCplt
+ *         CBW received
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  MSC_BOT_CBWCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	if((hmsc == NULL) || (xfer->status != USBD_OK))
+	{
+		return;
+	}
+	USBD_memcpy(&hmsc->cbw, hmsc->cbw_packet, sizeof (hmsc->cbw));
+	MSC_BOT_CBW_Decode(pdev, xfer->actual);
+}
+
+/**
+ * @brief  MSC_BOT_CBW_Decode
+ *         Decode the CBW command and set the BOT state machine accordingly
+ * @param  pdev: device instance
+ * @param  length: CBW length received
+ * @retval None
+ */
+static void  MSC_BOT_CBW_Decode (USBD_HandleTypeDef *pdev, uint32_t length)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	hmsc->csw.dTag = hmsc->cbw.dTag;
+	hmsc->csw.dDataResidue = hmsc->cbw.dDataLength;
+	hmsc->bot_data_length = 0;
+
+	if ((length != USBD_BOT_CBW_LENGTH) ||
+			(hmsc->cbw.dSignature != USBD_BOT_CBW_SIGNATURE)||
+			(hmsc->cbw.bLUN > hmsc->max_lun) ||
+			(hmsc->cbw.bCBLength < 1) ||
+			(hmsc->cbw.bCBLength > 16))
+	{
+		SCSI_SenseCode(pdev,
+				hmsc->cbw.bLUN,
+				ILLEGAL_REQUEST,
+				INVALID_CDB);
+		hmsc->bot_status = USBD_BOT_STATUS_ERROR;
+		MSC_BOT_Abort(pdev);
+		return;
+	}
+
+	hmsc->bot_status = USBD_BOT_STATUS_NORMAL;
+
+	/* The sense data is that of the last command that failed */
+	if(hmsc->cbw.CB[0] != SCSI_REQUEST_SENSE)
+	{
+		hmsc->scsi_sense_head = hmsc->scsi_sense_tail;
+	}
+	if(SCSI_ProcessCmd(pdev, hmsc->cbw.bLUN, &hmsc->cbw.CB[0]) < 0)
+	{
+		if(hmsc->cbw.dDataLength == 0)
+		{
+			MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_FAILED);
+		}
+		else
+		{
+			MSC_BOT_Abort(pdev);
+		}
+	}
+	/* READ(10) and WRITE(10) data stages and syncs run in the pipeline */
+	else if((hmsc->bot_state != USBD_BOT_DATA_IN) &&
+			(hmsc->bot_state != USBD_BOT_DATA_OUT) &&
+			(hmsc->bot_state != USBD_BOT_SYNC))
+	{
+		if (hmsc->bot_data_length > 0)
+		{
+			MSC_BOT_SendData(pdev, (uint8_t *)hmsc->bot_data, hmsc->bot_data_length);
+		}
+		else
+		{
+			MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_PASSED);
+		}
+	}
+}
+
+/**
+ * @brief  MSC_BOT_SendData
+ *         Send the data of a command other than READ(10), at most the
+ *         length the host asked for
+ * @param  pdev: device instance
+ * @param  pbuf: data, valid until sent
+ * @param  len: data length
+ * @retval None
+ */
+void  MSC_BOT_SendData(USBD_HandleTypeDef *pdev, uint8_t *pbuf, uint16_t len)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	len = MIN (hmsc->cbw.dDataLength, len);
+	hmsc->csw.dDataResidue -= len;
+	hmsc->csw.bStatus = USBD_CSW_CMD_PASSED;
+	hmsc->bot_state = USBD_BOT_SEND_DATA;
+
+	USBD_LLEx_Transmit(pdev, MSC_IN_EP, pbuf, len, MSC_BOT_DataCplt, NULL);
+}
+
+/**
+ * @brief  MSC_BOT_DataCplt
+ *         Data of a command sent, its CSW follows
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  MSC_BOT_DataCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	if((hmsc != NULL) && (xfer->status == USBD_OK) && (hmsc->bot_state == USBD_BOT_SEND_DATA))
+	{
+		MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_PASSED);
+	}
+}
+
+/**
+ * @brief  MSC_BOT_SendCSW
+ *         Send the Command Status Wrapper and wait for the next CBW
+ * @param  pdev: device instance
+ * @param  status : CSW status
+ * @retval None
+ */
+static void  MSC_BOT_SendCSW (USBD_HandleTypeDef *pdev,
+		uint8_t CSW_Status)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	hmsc->csw.dSignature = USBD_BOT_CSW_SIGNATURE;
+	hmsc->csw.bStatus = CSW_Status;
+	hmsc->bot_state = USBD_BOT_IDLE;
+
+	USBD_LLEx_Transmit(pdev, MSC_IN_EP, (uint8_t *)&hmsc->csw, USBD_BOT_CSW_LENGTH, NULL, NULL);
+
+	/* Prepare EP to Receive next Cmd */
+	MSC_BOT_ReceiveCBW(pdev);
+}
+
+/**
+ * @brief  MSC_BOT_StartPipe
+ *         Start the data stage of READ(10) or WRITE(10), checked by the
+ *         SCSI layer against the CBW and the storage capacity, or the
+ *         storage sync the CSW of SYNCHRONIZE CACHE(10) waits for
+ * @param  pdev: device instance
+ * @param  op: USBD_MSC_MEDIA_READ, USBD_MSC_MEDIA_WRITE or USBD_MSC_MEDIA_SYNC
+ * @param  blk_addr: first block
+ * @param  blk_len: number of blocks, not 0, unused by a sync
+ * @retval None
+ */
+void  MSC_BOT_StartPipe(USBD_HandleTypeDef *pdev, uint8_t op, uint32_t blk_addr, uint32_t blk_len)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+
+	USBD_memset(&hmsc->pipe, 0, sizeof (hmsc->pipe));
+	hmsc->pipe.media_addr = blk_addr;
+	hmsc->pipe.media_left = blk_len;
+	hmsc->pipe.bus_left = blk_len;
+	if(op == USBD_MSC_MEDIA_SYNC)
+	{
+		/* One storage access, no block on the bus */
+		hmsc->pipe.media_left = 1;
+		hmsc->pipe.bus_left = 0;
+		hmsc->bot_state = USBD_BOT_SYNC;
+	}
+	else
+	{
+		hmsc->bot_state = (op == USBD_MSC_MEDIA_WRITE) ? USBD_BOT_DATA_OUT : USBD_BOT_DATA_IN;
+	}
+
+	MSC_Pipe_Next(pdev);
+}
+
+/**
+ * @brief  MSC_Pipe_Index
+ *         Media buffer of a transfer
+ * @param  pbuf: transfer buffer
+ * @retval buffer index
+ */
+static uint8_t  MSC_Pipe_Index (uint8_t *pbuf)
+{
+	return (uint8_t)(((uint32_t *)pbuf - MSC_MediaBuffer[0]) / (MSC_MEDIA_PACKET / 4));
+}
+
+/**
+ * @brief  MSC_Pipe_BufferFree
+ *         Whether a media buffer may be used: a storage access left over
+ *         from a reset may still hold it
+ * @param  hmsc: class handle
+ * @param  idx: buffer index
+ * @retval 1 if free, 0 otherwise
+ */
+static uint8_t  MSC_Pipe_BufferFree (USBD_MSC_BOT_HandleTypeDef *hmsc, uint8_t idx)
+{
+	if(hmsc->pipe.buf_state[idx] != USBD_MSC_BUF_FREE)
+	{
+		return 0;
+	}
+	return ((MSC_MediaPending == 0) || (MSC_Media.pbuf != (uint8_t *)MSC_MediaBuffer[idx])) ? 1 : 0;
+}
+
+/**
+ * @brief  MSC_Pipe_Next
+ *         Start what the buffers allow: the next storage read and the
+ *         transmission of each buffer read, or the reception into every
+ *         free buffer and the next storage write. Ends the data stage once
+ *         nothing is left.
+ * @param  pdev: device instance
+ * @retval None
+ */
+static void  MSC_Pipe_Next (USBD_HandleTypeDef *pdev)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+	USBD_MSC_PipeTypeDef *pipe = &hmsc->pipe;
+	uint32_t per_buffer = MSC_MEDIA_PACKET / hmsc->scsi_blk_size;
+	uint8_t idx;
+
+	if(hmsc->bot_state == USBD_BOT_DATA_IN)
+	{
+		idx = pipe->media_idx;
+		if((pipe->failed == 0) && (pipe->media_left != 0) && (MSC_MediaPending == 0) &&
+				MSC_Pipe_BufferFree(hmsc, idx))
+		{
+			pipe->buf_blocks[idx] = MIN(pipe->media_left, per_buffer);
+			MSC_Pipe_Submit(pdev, idx);
+		}
+	}
+	else if(hmsc->bot_state == USBD_BOT_DATA_OUT)
+	{
+		/* The host may send ahead into every free buffer */
+		while((pipe->failed == 0) && (pipe->bus_left != 0) && MSC_Pipe_BufferFree(hmsc, pipe->bus_idx))
+		{
+			idx = pipe->bus_idx;
+			pipe->buf_blocks[idx] = MIN(pipe->bus_left, per_buffer);
+			if(USBD_LLEx_PrepareReceive(pdev, MSC_OUT_EP, (uint8_t *)MSC_MediaBuffer[idx],
+					pipe->buf_blocks[idx] * hmsc->scsi_blk_size, MSC_Pipe_RxCplt, NULL) != USBD_OK)
+			{
+				break;
+			}
+			pipe->buf_state[idx] = USBD_MSC_BUF_BUS;
+			pipe->bus_left -= pipe->buf_blocks[idx];
+			pipe->bus_idx = (idx + 1) % MSC_MEDIA_BUFFERS;
+		}
+
+		idx = pipe->media_idx;
+		if((pipe->failed == 0) && (MSC_MediaPending == 0) && (pipe->buf_state[idx] == USBD_MSC_BUF_FULL))
+		{
+			MSC_Pipe_Submit(pdev, idx);
+		}
+	}
+	else if(hmsc->bot_state == USBD_BOT_SYNC)
+	{
+		idx = pipe->media_idx;
+		if((pipe->failed == 0) && (pipe->media_left != 0) && (MSC_MediaPending == 0))
+		{
+			pipe->buf_blocks[idx] = 1;
+			MSC_Pipe_Submit(pdev, idx);
+		}
+	}
+	else
+	{
+		return;
+	}
+
+	MSC_Pipe_End(pdev);
+}
+
+/**
+ * @brief  MSC_Pipe_Submit
+ *         Give the storage access of a buffer to the interface task
+ * @param  pdev: device instance
+ * @param  idx: buffer index, buf_blocks set
+ * @retval None
+ */
+static void  MSC_Pipe_Submit (USBD_HandleTypeDef *pdev, uint8_t idx)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+	USBD_MSC_PipeTypeDef *pipe = &hmsc->pipe;
+
+	MSC_Media.lun = hmsc->cbw.bLUN;
+	MSC_Media.pbuf = (uint8_t *)MSC_MediaBuffer[idx];
+	MSC_Media.blk_addr = pipe->media_addr;
+	MSC_Media.blk_len = pipe->buf_blocks[idx];
+	switch(hmsc->bot_state)
+	{
+	case USBD_BOT_DATA_IN:
+		MSC_Media.op = USBD_MSC_MEDIA_READ;
+		break;
+
+	case USBD_BOT_DATA_OUT:
+		MSC_Media.op = USBD_MSC_MEDIA_WRITE;
+		break;
+
+	default:
+		MSC_Media.op = USBD_MSC_MEDIA_SYNC;
+		MSC_Media.blk_len = 0;
+		break;
+	}
+	MSC_Media.status = 0;
+
+	pipe->buf_state[idx] = USBD_MSC_BUF_MEDIA;
+	pipe->media_busy = 1;
+	MSC_MediaPending = 1;
+
+	if(((USBD_MSC_ItfTypeDef *)pdev->pUserData)->Submit(&MSC_Media) != 0)
+	{
+		MSC_MediaPending = 0;
+		pipe->media_busy = 0;
+		MSC_Pipe_MediaDone(pdev, -1);
+	}
+}
+
+/**
+ * @brief  MSC_Pipe_MediaDone
+ *         Storage access of the current command finished: a buffer read is
+ *         queued on the IN endpoint, a buffer written is free again
+ * @param  pdev: device instance
+ * @param  status: 0, or -1 if the access failed
+ * @retval None
+ */
+static void  MSC_Pipe_MediaDone (USBD_HandleTypeDef *pdev, int8_t status)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+	USBD_MSC_PipeTypeDef *pipe = &hmsc->pipe;
+	uint8_t idx = pipe->media_idx;
+
+	if(status != 0)
+	{
+		pipe->buf_state[idx] = USBD_MSC_BUF_FREE;
+		pipe->failed = 1;
+		SCSI_SenseCode(pdev,
+				hmsc->cbw.bLUN,
+				(hmsc->bot_state == USBD_BOT_DATA_IN) ? MEDIUM_ERROR : HARDWARE_ERROR,
+				(hmsc->bot_state == USBD_BOT_DATA_IN) ? UNRECOVERED_READ_ERROR : WRITE_FAULT);
+		MSC_Pipe_End(pdev);
+		return;
+	}
+
+	pipe->media_addr += pipe->buf_blocks[idx];
+	pipe->media_left -= pipe->buf_blocks[idx];
+	pipe->media_idx = (idx + 1) % MSC_MEDIA_BUFFERS;
+
+	if(hmsc->bot_state == USBD_BOT_DATA_IN)
+	{
+		/* Reads complete in buffer order, the endpoint sends them in turn */
+		pipe->buf_state[idx] = USBD_MSC_BUF_BUS;
+		pipe->bus_left -= pipe->buf_blocks[idx];
+		USBD_LLEx_Transmit(pdev, MSC_IN_EP, (uint8_t *)MSC_MediaBuffer[idx],
+				pipe->buf_blocks[idx] * hmsc->scsi_blk_size, MSC_Pipe_TxCplt, NULL);
+	}
+	else
+	{
+		pipe->buf_state[idx] = USBD_MSC_BUF_FREE;
+	}
+
+	MSC_Pipe_Next(pdev);
+}
+
+/**
+ * @brief  MSC_Pipe_TxCplt
+ *         READ(10) buffer sent, or aborted
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  MSC_Pipe_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+	uint8_t idx = MSC_Pipe_Index(xfer->pbuf);
+
+	if((hmsc == NULL) || (xfer->status != USBD_OK) || (hmsc->bot_state != USBD_BOT_DATA_IN))
+	{
+		return;
+	}
+	hmsc->pipe.buf_state[idx] = USBD_MSC_BUF_FREE;
+	hmsc->pipe.done_bytes += xfer->actual;
+
+	MSC_Pipe_Next(pdev);
+}
+
+/**
+ * @brief  MSC_Pipe_RxCplt
+ *         WRITE(10) buffer received, or aborted
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  MSC_Pipe_RxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+	uint8_t idx = MSC_Pipe_Index(xfer->pbuf);
+
+	if((hmsc == NULL) || (xfer->status != USBD_OK) || (hmsc->bot_state != USBD_BOT_DATA_OUT))
+	{
+		return;
+	}
+	hmsc->pipe.done_bytes += xfer->actual;
+
+	if(xfer->actual != xfer->length)
+	{
+		/* The host ended the data stage early */
+		hmsc->pipe.buf_state[idx] = USBD_MSC_BUF_FREE;
+		hmsc->pipe.failed = 1;
+		SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, INVALID_CDB);
+	}
+	else
+	{
+		hmsc->pipe.buf_state[idx] = USBD_MSC_BUF_FULL;
+	}
+
+	MSC_Pipe_Next(pdev);
+}
+
+/**
+ * @brief  MSC_Pipe_End
+ *         End the data stage once every block went through, or once the
+ *         buffers in use are back after a failure
+ * @param  pdev: device instance
+ * @retval None
+ */
+static void  MSC_Pipe_End (USBD_HandleTypeDef *pdev)
+{
+	USBD_MSC_BOT_HandleTypeDef   *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+	USBD_MSC_PipeTypeDef *pipe = &hmsc->pipe;
+	uint8_t idx;
+
+	if(pipe->failed == 0)
+	{
+		if(hmsc->bot_state == USBD_BOT_DATA_IN)
+		{
+			for(idx = 0; idx < MSC_MEDIA_BUFFERS; idx++)
+			{
+				if(pipe->buf_state[idx] != USBD_MSC_BUF_FREE)
+				{
+					return;
+				}
+			}
+			if(pipe->media_left != 0)
+			{
+				return;
+			}
+		}
+		else if(pipe->media_left != 0)
+		{
+			return;
+		}
+		hmsc->csw.dDataResidue = hmsc->cbw.dDataLength - pipe->done_bytes;
+		MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_PASSED);
+		return;
+	}
+
+	if(pipe->media_busy != 0)
+	{
+		return;
+	}
+
+	if(hmsc->bot_state == USBD_BOT_DATA_IN)
+	{
+		/* The data already queued goes out first */
+		for(idx = 0; idx < MSC_MEDIA_BUFFERS; idx++)
+		{
+			if(pipe->buf_state[idx] == USBD_MSC_BUF_BUS)
+			{
+				return;
+			}
+		}
+		hmsc->csw.dDataResidue = hmsc->cbw.dDataLength - pipe->done_bytes;
+		if(hmsc->csw.dDataResidue != 0)
+		{
+			/* The CSW follows once the host clears the halt */
+			USBD_LL_StallEP(pdev, USBD_COMPOSITE_LL_EP_Conversion(pdev, MSC_IN_EP));
+			hmsc->bot_state = USBD_BOT_STATUS;
+		}
+		else
+		{
+			MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_FAILED);
+		}
+	}
+	else if(hmsc->bot_state == USBD_BOT_SYNC)
+	{
+		MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_FAILED);
+	}
+	else
+	{
+		/* Receptions still armed are dropped, the core is done with their
+		buffers before they are freed. The host is told to stop sending with
+		a halt and reads the CSW */
+		USBD_LLEx_Abort(pdev, MSC_OUT_EP);
+		USBD_memset(pipe->buf_state, USBD_MSC_BUF_FREE, sizeof (pipe->buf_state));
+		hmsc->csw.dDataResidue = hmsc->cbw.dDataLength - pipe->done_bytes;
+		if(hmsc->csw.dDataResidue != 0)
+		{
+			USBD_LL_StallEP(pdev, USBD_COMPOSITE_LL_EP_Conversion(pdev, MSC_OUT_EP));
+		}
+		MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_FAILED);
+	}
+}
+
+/**
+ * @brief  USBD_MSC_RegisterInterface
+ * @param  pdev: device instance
+ * @param  fops: MSC Interface callback, with its storage
+ * @retval status
+ */
+uint8_t  USBD_MSC_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+		USBD_MSC_ItfTypeDef *fops)
+{
+	uint8_t  ret = USBD_FAIL;
+
+	if((fops != NULL) && (fops->pStorage != NULL))
+	{
+		pdev->pUserData= fops;
+		ret = USBD_OK;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_MSC_MediaCplt
+ *         Storage access finished, called by the interface task: the
+ *         pipeline moves on. An access of a command dropped by a reset
+ *         only frees its buffer.
+ * @param  pdev: device instance
+ * @param  req: the access given to Submit, status set
+ * @retval status
+ */
+uint8_t  USBD_MSC_MediaCplt(USBD_HandleTypeDef *pdev, USBD_MSC_MediaReqTypeDef *req)
+{
+	USBD_COMPOSITE_ContextTypeDef context;
+	USBD_MSC_BOT_HandleTypeDef *hmsc;
+	uint32_t primask;
+	uint8_t ret = USBD_FAIL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	MSC_MediaPending = 0;
+	if((USBD_COMPOSITE_SelectClass(pdev, &USBD_MSC, &context) == USBD_OK) && (pdev->pClassData != NULL))
+	{
+		hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData;
+		if(hmsc->pipe.media_busy != 0)
+		{
+			hmsc->pipe.media_busy = 0;
+			MSC_Pipe_MediaDone(pdev, req->status);
+		}
+		else
+		{
+			MSC_Pipe_Next(pdev);
+		}
+		ret = USBD_OK;
+	}
+	USBD_COMPOSITE_RestoreClass(pdev, &context);
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
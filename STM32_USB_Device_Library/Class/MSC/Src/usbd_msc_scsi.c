@@ -0,0 +1,585 @@
+/**
+ ******************************************************************************
+ * @file    usbd_msc_scsi.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   SCSI transparent command set of the MSC class: the commands
+ *          Windows, Linux and macOS issue to a direct access block device.
+ *          READ(10) and WRITE(10) are checked here and their data stage
+ *          handed to the pipeline of usbd_msc.c; every other answer fits in
+ *          USBD_BOT_MAX_DATA bytes.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_msc.h"
+#include "../inc/usbd_msc_scsi.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+
+/** @defgroup MSC_SCSI
+ * @brief Mass storage SCSI layer module
+ * @{
+ */
+
+/** @defgroup MSC_SCSI_Private_Macros
+ * @{
+ */
+#define SCSI_STORAGE(pdev)		(((USBD_MSC_ItfTypeDef *)(pdev)->pUserData)->pStorage)
+/**
+ * @}
+ */
+
+
+/** @defgroup MSC_SCSI_Private_FunctionPrototypes
+ * @{
+ */
+static int8_t SCSI_TestUnitReady(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_Inquiry(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_ReadFormatCapacity(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_ReadCapacity10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_RequestSense (USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_ModeSense6 (USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_ModeSense10 (USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_Read10(USBD_HandleTypeDef *pdev, uint8_t lun , uint8_t *params);
+static int8_t SCSI_Write10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_Verify10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_StartStopUnit(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_SynchronizeCache10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_UpdateCapacity(USBD_HandleTypeDef *pdev, uint8_t lun);
+static int8_t SCSI_CheckAddressRange (USBD_HandleTypeDef *pdev, uint8_t lun, uint32_t blk_offset, uint32_t blk_nbr);
+/**
+ * @}
+ */
+
+
+/** @defgroup MSC_SCSI_Private_Functions
+ * @{
+ */
+
+
+/**
+ * @brief  SCSI_ProcessCmd
+ *         Process SCSI commands
+ * @param  pdev: device instance
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status: 0, or -1 with the sense data set
+ */
+int8_t SCSI_ProcessCmd(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+	switch (params[0])
+	{
+	case SCSI_TEST_UNIT_READY:
+		return SCSI_TestUnitReady(pdev, lun, params);
+
+	case SCSI_REQUEST_SENSE:
+		return SCSI_RequestSense (pdev, lun, params);
+
+	case SCSI_INQUIRY:
+		return SCSI_Inquiry(pdev, lun, params);
+
+	case SCSI_START_STOP_UNIT:
+		return SCSI_StartStopUnit(pdev, lun, params);
+
+	case SCSI_ALLOW_MEDIUM_REMOVAL:
+		return 0;
+
+	case SCSI_SYNCHRONIZE_CACHE10:
+		return SCSI_SynchronizeCache10(pdev, lun, params);
+
+	case SCSI_MODE_SENSE6:
+		return SCSI_ModeSense6 (pdev, lun, params);
+
+	case SCSI_MODE_SENSE10:
+		return SCSI_ModeSense10 (pdev, lun, params);
+
+	case SCSI_READ_FORMAT_CAPACITIES:
+		return SCSI_ReadFormatCapacity(pdev, lun, params);
+
+	case SCSI_READ_CAPACITY10:
+		return SCSI_ReadCapacity10(pdev, lun, params);
+
+	case SCSI_READ10:
+		return SCSI_Read10(pdev, lun, params);
+
+	case SCSI_WRITE10:
+		return SCSI_Write10(pdev, lun, params);
+
+	case SCSI_VERIFY10:
+		return SCSI_Verify10(pdev, lun, params);
+
+	default:
+		SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, INVALID_CDB);
+		return -1;
+	}
+}
+
+
+/**
+ * @brief  SCSI_TestUnitReady
+ *         Process SCSI Test Unit Ready Command
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_TestUnitReady(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+
+	/* case 9 : Hi > D0 */
+	if (hmsc->cbw.dDataLength != 0)
+	{
+		SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, INVALID_CDB);
+		return -1;
+	}
+
+	if(SCSI_STORAGE(pdev)->IsReady(lun) != 0)
+	{
+		SCSI_SenseCode(pdev, lun, NOT_READY, MEDIUM_NOT_PRESENT);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief  SCSI_Inquiry
+ *         Process Inquiry command: the standard data of the storage, or the
+ *         list of the vital product data pages, of which there is no other
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t  SCSI_Inquiry(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint8_t *pPage;
+	uint16_t len;
+
+	if (params[1] & 0x01)/*Evpd is set*/
+	{
+		if(params[2] != 0x00)
+		{
+			SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, INVALID_FIELED_IN_COMMAND);
+			return -1;
+		}
+		pPage = (uint8_t *)hmsc->bot_data;
+		USBD_memset(pPage, 0, 5);
+		pPage[3] = 1;    /* Page length: supported pages, page 00h only */
+		len = 5;
+	}
+	else
+	{
+		pPage = (uint8_t *)&SCSI_STORAGE(pdev)->pInquiry[lun * STANDARD_INQUIRY_DATA_LEN];
+		len = MIN(pPage[4] + 5, USBD_BOT_MAX_DATA);
+		USBD_memcpy(hmsc->bot_data, pPage, len);
+	}
+
+	hmsc->bot_data_length = MIN(len, (params[3] << 8) | params[4]);
+	return 0;
+}
+
+/**
+ * @brief  SCSI_UpdateCapacity
+ *         Read the capacity of the storage, its block size must divide the
+ *         media buffers
+ * @param  lun: Logical unit number
+ * @retval status
+ */
+static int8_t SCSI_UpdateCapacity(USBD_HandleTypeDef *pdev, uint8_t lun)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint32_t blk_nbr;
+	uint16_t blk_size;
+
+	if((SCSI_STORAGE(pdev)->GetCapacity(lun, &blk_nbr, &blk_size) != 0) ||
+			(blk_size == 0) || ((MSC_MEDIA_PACKET % blk_size) != 0))
+	{
+		SCSI_SenseCode(pdev, lun, NOT_READY, MEDIUM_NOT_PRESENT);
+		return -1;
+	}
+	hmsc->scsi_blk_nbr = blk_nbr;
+	hmsc->scsi_blk_size = blk_size;
+	return 0;
+}
+
+/**
+ * @brief  SCSI_ReadCapacity10
+ *         Process Read Capacity 10 command
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_ReadCapacity10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint8_t *pData = (uint8_t *)hmsc->bot_data;
+	uint32_t last;
+
+	if(SCSI_UpdateCapacity(pdev, lun) != 0)
+	{
+		return -1;
+	}
+
+	last = hmsc->scsi_blk_nbr - 1;
+	pData[0] = (uint8_t)(last >> 24);
+	pData[1] = (uint8_t)(last >> 16);
+	pData[2] = (uint8_t)(last >>  8);
+	pData[3] = (uint8_t)(last);
+
+	pData[4] = 0;
+	pData[5] = 0;
+	pData[6] = (uint8_t)(hmsc->scsi_blk_size >>  8);
+	pData[7] = (uint8_t)(hmsc->scsi_blk_size);
+
+	hmsc->bot_data_length = READ_CAPACITY10_DATA_LEN;
+	return 0;
+}
+
+/**
+ * @brief  SCSI_ReadFormatCapacity
+ *         Process Read Format Capacity command
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_ReadFormatCapacity(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint8_t *pData = (uint8_t *)hmsc->bot_data;
+
+	if(SCSI_UpdateCapacity(pdev, lun) != 0)
+	{
+		return -1;
+	}
+
+	USBD_memset(pData, 0, READ_FORMAT_CAPACITY_DATA_LEN);
+	pData[3] = 0x08;    /* Capacity list length */
+	pData[4] = (uint8_t)(hmsc->scsi_blk_nbr >> 24);
+	pData[5] = (uint8_t)(hmsc->scsi_blk_nbr >> 16);
+	pData[6] = (uint8_t)(hmsc->scsi_blk_nbr >>  8);
+	pData[7] = (uint8_t)(hmsc->scsi_blk_nbr);
+	pData[8] = 0x02;    /* Formatted media */
+	pData[10] = (uint8_t)(hmsc->scsi_blk_size >>  8);
+	pData[11] = (uint8_t)(hmsc->scsi_blk_size);
+
+	hmsc->bot_data_length = MIN(READ_FORMAT_CAPACITY_DATA_LEN, (params[7] << 8) | params[8]);
+	return 0;
+}
+
+/**
+ * @brief  SCSI_ModeSense6
+ *         Process Mode Sense6 command: no mode page, the write protection
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_ModeSense6 (USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint8_t *pData = (uint8_t *)hmsc->bot_data;
+
+	USBD_memset(pData, 0, MODE_SENSE6_DATA_LEN);
+	pData[0] = MODE_SENSE6_DATA_LEN - 1;    /* Mode data length */
+	if(SCSI_STORAGE(pdev)->IsWriteProtected(lun) != 0)
+	{
+		pData[2] = 0x80;    /* WP */
+	}
+
+	hmsc->bot_data_length = MIN(MODE_SENSE6_DATA_LEN, params[4]);
+	return 0;
+}
+
+/**
+ * @brief  SCSI_ModeSense10
+ *         Process Mode Sense10 command: no mode page, the write protection
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_ModeSense10 (USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint8_t *pData = (uint8_t *)hmsc->bot_data;
+
+	USBD_memset(pData, 0, MODE_SENSE10_DATA_LEN);
+	pData[1] = MODE_SENSE10_DATA_LEN - 2;    /* Mode data length */
+	if(SCSI_STORAGE(pdev)->IsWriteProtected(lun) != 0)
+	{
+		pData[3] = 0x80;    /* WP */
+	}
+
+	hmsc->bot_data_length = MIN(MODE_SENSE10_DATA_LEN, (params[7] << 8) | params[8]);
+	return 0;
+}
+
+/**
+ * @brief  SCSI_RequestSense
+ *         Process Request Sense command: the oldest sense data not read yet
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_RequestSense (USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint8_t *pData = (uint8_t *)hmsc->bot_data;
+
+	USBD_memset(pData, 0, REQUEST_SENSE_DATA_LEN);
+	pData[0] = 0x70;    /* Current errors, fixed format */
+	pData[7] = REQUEST_SENSE_DATA_LEN - 8;    /* Additional sense length */
+
+	if(hmsc->scsi_sense_head != hmsc->scsi_sense_tail)
+	{
+		pData[2]  = hmsc->scsi_sense[hmsc->scsi_sense_head].Skey;
+		pData[12] = hmsc->scsi_sense[hmsc->scsi_sense_head].ASC;
+		pData[13] = hmsc->scsi_sense[hmsc->scsi_sense_head].ASCQ;
+		hmsc->scsi_sense_head = (hmsc->scsi_sense_head + 1) % MSC_SENSE_DEPTH;
+	}
+
+	hmsc->bot_data_length = MIN(REQUEST_SENSE_DATA_LEN, params[4]);
+	return 0;
+}
+
+/**
+ * @brief  SCSI_SenseCode
+ *         Load the last error code in the error list, the oldest one is
+ *         dropped when the list is full
+ * @param  lun: Logical unit number
+ * @param  sKey: Sense Key
+ * @param  ASC: Additional Sense Key
+ * @retval none
+
+ */
+void SCSI_SenseCode(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t sKey, uint8_t ASC)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+
+	hmsc->scsi_sense[hmsc->scsi_sense_tail].Skey  = sKey;
+	hmsc->scsi_sense[hmsc->scsi_sense_tail].ASC   = ASC;
+	hmsc->scsi_sense[hmsc->scsi_sense_tail].ASCQ  = 0;
+	hmsc->scsi_sense_tail = (hmsc->scsi_sense_tail + 1) % MSC_SENSE_DEPTH;
+	if(hmsc->scsi_sense_tail == hmsc->scsi_sense_head)
+	{
+		hmsc->scsi_sense_head = (hmsc->scsi_sense_head + 1) % MSC_SENSE_DEPTH;
+	}
+}
+
+/**
+ * @brief  SCSI_Read10
+ *         Process Read10 command: checked here, read by the pipeline
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_Read10(USBD_HandleTypeDef  *pdev, uint8_t lun , uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint32_t blk_addr;
+	uint32_t blk_len;
+
+	/* case 10 : Ho <> Di */
+	if ((hmsc->cbw.bmFlags & 0x80) != 0x80)
+	{
+		SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, INVALID_CDB);
+		return -1;
+	}
+
+	if(SCSI_STORAGE(pdev)->IsReady(lun) != 0)
+	{
+		SCSI_SenseCode(pdev, lun, NOT_READY, MEDIUM_NOT_PRESENT);
+		return -1;
+	}
+	if(SCSI_UpdateCapacity(pdev, lun) != 0)
+	{
+		return -1;
+	}
+
+	blk_addr = ((uint32_t)params[2] << 24) | ((uint32_t)params[3] << 16) | ((uint32_t)params[4] << 8) | params[5];
+	blk_len = ((uint32_t)params[7] << 8) | params[8];
+
+	if(SCSI_CheckAddressRange(pdev, lun, blk_addr, blk_len) < 0)
+	{
+		return -1; /* error */
+	}
+
+	/* cases 4,5 : Hi <> Dn */
+	if (hmsc->cbw.dDataLength != blk_len * hmsc->scsi_blk_size)
+	{
+		SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, INVALID_CDB);
+		return -1;
+	}
+
+	if(blk_len != 0)
+	{
+		MSC_BOT_StartPipe(pdev, USBD_MSC_MEDIA_READ, blk_addr, blk_len);
+	}
+	return 0;
+}
+
+/**
+ * @brief  SCSI_Write10
+ *         Process Write10 command: checked here, written by the pipeline
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_Write10 (USBD_HandleTypeDef  *pdev, uint8_t lun , uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+	uint32_t blk_addr;
+	uint32_t blk_len;
+
+	/* case 8 : Hi <> Do */
+	if ((hmsc->cbw.bmFlags & 0x80) == 0x80)
+	{
+		SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, INVALID_CDB);
+		return -1;
+	}
+
+	/* Check whether Media is ready */
+	if(SCSI_STORAGE(pdev)->IsReady(lun) != 0)
+	{
+		SCSI_SenseCode(pdev, lun, NOT_READY, MEDIUM_NOT_PRESENT);
+		return -1;
+	}
+
+	/* Check If media is write-protected */
+	if(SCSI_STORAGE(pdev)->IsWriteProtected(lun) != 0)
+	{
+		SCSI_SenseCode(pdev, lun, DATA_PROTECT, WRITE_PROTECTED);
+		return -1;
+	}
+	if(SCSI_UpdateCapacity(pdev, lun) != 0)
+	{
+		return -1;
+	}
+
+	blk_addr = ((uint32_t)params[2] << 24) | ((uint32_t)params[3] << 16) | ((uint32_t)params[4] << 8) | params[5];
+	blk_len = ((uint32_t)params[7] << 8) | params[8];
+
+	/* check if LBA address is in the right range */
+	if(SCSI_CheckAddressRange(pdev, lun, blk_addr, blk_len) < 0)
+	{
+		return -1; /* error */
+	}
+
+	/* cases 3,11,13 : Hn,Ho <> D0 */
+	if (hmsc->cbw.dDataLength != blk_len * hmsc->scsi_blk_size)
+	{
+		SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, INVALID_CDB);
+		return -1;
+	}
+
+	if(blk_len != 0)
+	{
+		MSC_BOT_StartPipe(pdev, USBD_MSC_MEDIA_WRITE, blk_addr, blk_len);
+	}
+	return 0;
+}
+
+/**
+ * @brief  SCSI_Verify10
+ *         Process Verify10 command, without byte comparison
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_Verify10(USBD_HandleTypeDef  *pdev, uint8_t lun , uint8_t *params)
+{
+	uint32_t blk_addr;
+	uint32_t blk_len;
+
+	if ((params[1] & 0x02) == 0x02)
+	{
+		SCSI_SenseCode (pdev, lun, ILLEGAL_REQUEST, INVALID_FIELED_IN_COMMAND);
+		return -1; /* Error, Verify Mode Not supported*/
+	}
+	if(SCSI_UpdateCapacity(pdev, lun) != 0)
+	{
+		return -1;
+	}
+
+	blk_addr = ((uint32_t)params[2] << 24) | ((uint32_t)params[3] << 16) | ((uint32_t)params[4] << 8) | params[5];
+	blk_len = ((uint32_t)params[7] << 8) | params[8];
+
+	return SCSI_CheckAddressRange(pdev, lun, blk_addr, blk_len);
+}
+
+/**
+ * @brief  SCSI_StartStopUnit
+ *         Process Start Stop Unit command: stopping or ejecting the medium
+ *         writes back what the storage keeps
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_StartStopUnit(USBD_HandleTypeDef  *pdev, uint8_t lun , uint8_t *params)
+{
+	if ((params[4] & 0x01) == 0)
+	{
+		return SCSI_SynchronizeCache10(pdev, lun, params);
+	}
+	return 0;
+}
+
+/**
+ * @brief  SCSI_SynchronizeCache10
+ *         Process Synchronize Cache10 command: the whole storage is synced,
+ *         whatever the range
+ * @param  lun: Logical unit number
+ * @param  params: Command parameters
+ * @retval status
+ */
+static int8_t SCSI_SynchronizeCache10(USBD_HandleTypeDef  *pdev, uint8_t lun , uint8_t *params)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+
+	/* Without a data stage only, the CSW follows the sync */
+	if (hmsc->cbw.dDataLength == 0)
+	{
+		MSC_BOT_StartPipe(pdev, USBD_MSC_MEDIA_SYNC, 0, 0);
+	}
+	return 0;
+}
+
+/**
+ * @brief  SCSI_CheckAddressRange
+ *         Check address range
+ * @param  lun: Logical unit number
+ * @param  blk_offset: first block address
+ * @param  blk_nbr: number of block to be processed
+ * @retval status
+ */
+static int8_t SCSI_CheckAddressRange (USBD_HandleTypeDef *pdev, uint8_t lun , uint32_t blk_offset , uint32_t blk_nbr)
+{
+	USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;
+
+	if ((blk_offset > hmsc->scsi_blk_nbr) || (blk_nbr > hmsc->scsi_blk_nbr - blk_offset))
+	{
+		SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, ADDRESS_OUT_OF_RANGE);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @}
+ */
+
+
+/**
+ * @}
+ */
+
+
+/**
+ * @}
+ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
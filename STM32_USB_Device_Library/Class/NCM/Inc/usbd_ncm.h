@@ -0,0 +1,192 @@
+/**
+  ******************************************************************************
+  * @file    usbd_ncm.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   header file for the usbd_ncm.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_NCM_H
+#define __USB_NCM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_ncm
+  * @brief This file is the Header file for usbd_ncm.c
+  * @{
+  */
+
+
+/** @defgroup usbd_ncm_Exported_Defines
+  * @{
+  */
+#define NCM_IN_EP                                     0x81  /* EP1 for data IN */
+#define NCM_OUT_EP                                    0x01  /* EP1 for data OUT */
+#define NCM_CMD_EP                                    0x82  /* EP2 for NCM notifications */
+
+#define NCM_DATA_FS_MAX_PACKET_SIZE                   64  /* Endpoint IN & OUT Packet size */
+#define NCM_CMD_PACKET_SIZE                           16  /* Longest notification, CONNECTION_SPEED_CHANGE */
+
+#define USB_NCM_CONFIG_DESC_SIZ                       86
+#define NCM_MAC_STRING_INDEX                          0x06  /* iMACAddress, after the USBD_IDX_xxx_STR of usbd_desc.c */
+
+/* NTB16 parameters, the same in both directions. Datagrams start 2 bytes
+past a word boundary so that the IP header behind the Ethernet header is
+word aligned. */
+#define NCM_NTB_MAX_SIZE                              4096  /* dwNtbInMaxSize and dwNtbOutMaxSize */
+#define NCM_NTB_MAX_DATAGRAMS                         16    /* Per NTB, wNtbOutMaxDatagrams */
+#define NCM_NDP_DIVISOR                               4
+#define NCM_NDP_PAYLOAD_REMAINDER                     2
+#define NCM_NDP_ALIGNMENT                             4
+
+#define NCM_NTH16_SIGNATURE                           0x484D434EU  /* "NCMH" */
+#define NCM_NDP16_SIGNATURE                           0x304D434EU  /* "NCM0", no CRC */
+#define NCM_NTH16_SIZE                                12
+#define NCM_NDP16_HEADER_SIZE                         8
+
+/*---------------------------------------------------------------------*/
+/*  NCM definitions                                                    */
+/*---------------------------------------------------------------------*/
+#define NCM_SET_ETHERNET_PACKET_FILTER                0x43
+#define NCM_GET_NTB_PARAMETERS                        0x80
+#define NCM_GET_NTB_FORMAT                            0x83
+#define NCM_SET_NTB_FORMAT                            0x84
+#define NCM_GET_NTB_INPUT_SIZE                        0x85
+#define NCM_SET_NTB_INPUT_SIZE                        0x86
+#define NCM_RESET_FUNCTION                            0x05
+
+#define NCM_NOTIFY_NETWORK_CONNECTION                 0x00
+#define NCM_NOTIFY_CONNECTION_SPEED_CHANGE            0x2A
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/**
+  * @}
+  */
+typedef struct _USBD_NCM_Itf
+{
+  int8_t (* Init)          (void);
+  int8_t (* DeInit)        (void);
+  int8_t (* Link)          (uint8_t);                 /* 1 when the host selects the data interface, 0 when it leaves it */
+  int8_t (* Receive)       (uint8_t *, uint32_t *);   /* NTB received, USBD_NCM_ParseNtb finds its datagrams */
+  int8_t (* TransmitCplt)  (uint8_t *, uint32_t *);   /* NTB sent or aborted */
+  int8_t (* GetMacAddress) (uint8_t *);               /* 6 bytes, the host side address of iMACAddress */
+
+}USBD_NCM_ItfTypeDef;
+
+/* Datagram of a received NTB, offset from its start */
+typedef struct
+{
+  uint16_t Offset;
+  uint16_t Length;
+}USBD_NCM_DatagramTypeDef;
+
+typedef struct
+{
+  uint32_t data[8];                 /* EP0 requests, force 32bits alignment */
+  uint32_t Notify[4];               /* Notification on the command endpoint */
+  uint8_t  CmdOpCode;
+  uint8_t  CmdLength;
+  uint8_t  NotifyState;             /* Notifications left to send */
+  uint8_t  NotifyBusy;              /* One is in flight */
+  uint8_t  DataItf;                 /* Data interface number, 0xFF until the host selects it */
+  uint8_t  DataAlt;
+  uint8_t  *RxBuffer;
+  uint32_t RxLength;
+
+  /* NTB being filled with datagrams, and the one in flight */
+  uint8_t  *TxNtb[2];
+  uint8_t  TxFill;
+  uint8_t  TxWriting;               /* A datagram is being copied into TxNtb[TxFill] */
+  uint16_t TxLength;                /* Bytes used in TxNtb[TxFill], 0 when empty */
+  uint16_t TxCount;                 /* Datagrams in TxNtb[TxFill] */
+  uint16_t TxMaxSize;               /* NTB size limit set by the host */
+  uint16_t TxSequence;
+  uint8_t  *TxBuffer;               /* NTB in flight */
+  uint32_t TxBufferLength;
+
+  __IO uint32_t TxState;
+  __IO uint32_t RxState;
+}
+USBD_NCM_HandleTypeDef;
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_NCM;
+#define USBD_NCM_CLASS    &USBD_NCM
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_NCM_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+                                      USBD_NCM_ItfTypeDef *fops);
+
+uint8_t  USBD_NCM_SetTxBuffers       (USBD_HandleTypeDef   *pdev,
+                                      uint8_t  *pbuff0,
+                                      uint8_t  *pbuff1);
+
+uint8_t  USBD_NCM_ReceiveNtb         (USBD_HandleTypeDef *pdev,
+                                      uint8_t  *pbuff,
+                                      uint16_t size);
+
+uint8_t  USBD_NCM_TransmitFrame      (USBD_HandleTypeDef *pdev,
+                                      const uint8_t  *pbuff,
+                                      uint16_t length);
+
+uint8_t  USBD_NCM_ParseNtb           (const uint8_t *pbuff,
+                                      uint32_t length,
+                                      USBD_NCM_DatagramTypeDef *datagram,
+                                      uint16_t *count);
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_NCM_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,1063 @@
+/**
+ ******************************************************************************
+ * @file    usbd_ncm.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB NCM Class:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as NCM Device
+ *           - NTB16 transfers on the data endpoints
+ *           - Command IN transfer (class requests management)
+ *           - Error management
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                                NCM Class Driver Description
+ *          ===================================================================
+ *           This driver manages the "Universal Serial Bus Communications Class
+ *           Subclass Specification for Network Control Model Devices Revision 1.0
+ *           November 24, 2010"
+ *           This driver implements the following aspects of the specification:
+ *             - Configuration descriptor management, with the Ethernet Networking
+ *               and NCM functional descriptors
+ *             - Data interface with alternate settings 0 (no endpoints) and 1
+ *             - NTB16 only, NDPs without CRC
+ *             - GET_NTB_PARAMETERS, GET/SET_NTB_INPUT_SIZE, GET/SET_NTB_FORMAT,
+ *               SET_ETHERNET_PACKET_FILTER and RESET_FUNCTION requests
+ *             - NETWORK_CONNECTION and CONNECTION_SPEED_CHANGE notifications
+ *
+ *           Frames to send are copied into an NTB, sent at once if the IN
+ *           endpoint is idle, or else gathered with the following ones until
+ *           the NTB in flight completes. Received NTBs are handed whole to the
+ *           interface, USBD_NCM_ParseNtb finds their datagrams.
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_ncm.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+#include "usbd_ll_ex.h"
+#include "usbd_netops.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+
+/** @defgroup USBD_NCM
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_NCM_Private_TypesDefinitions
+ * @{
+ */
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_NCM_Private_Defines
+ * @{
+ */
+#if (USBD_NET_CLASS == USBD_NET_CLASS_NCM) && (USBD_SUPPORT_USER_STRING != 1)
+#error "USBD_NCM needs USBD_SUPPORT_USER_STRING for its iMACAddress string"
+#endif
+
+#define NCM_NTB_PARAMETERS_SIZE                       28
+#define NCM_NTB_MIN_INPUT_SIZE                        2048    /* Least the host may set */
+#define NCM_LINK_SPEED                                12000000U
+
+/* Transmitted NTBs: NTH16, one NDP16 with room for every datagram, then the
+datagrams */
+#define NCM_TX_NDP_OFFSET                             NCM_NTH16_SIZE
+#define NCM_TX_NDP_MAX_SIZE                           (NCM_NDP16_HEADER_SIZE + 4 * (NCM_NTB_MAX_DATAGRAMS + 1))
+#define NCM_TX_FIRST_DATAGRAM                         USBD_NCM_Align(NCM_TX_NDP_OFFSET + NCM_TX_NDP_MAX_SIZE)
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_NCM_Private_Macros
+ * @{
+ */
+/* Next datagram offset, wNdpInDivisor and wNdpInPayloadRemainder */
+#define USBD_NCM_Align(offset)                        ((((offset) + NCM_NDP_DIVISOR - 1 - NCM_NDP_PAYLOAD_REMAINDER) & ~(NCM_NDP_DIVISOR - 1)) + NCM_NDP_PAYLOAD_REMAINDER)
+
+/* Little endian fields of received NTBs, at any alignment */
+#define USBD_NCM_Get16(p)                             ((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8))
+#define USBD_NCM_Get32(p)                             (USBD_NCM_Get16(p) | (USBD_NCM_Get16((p) + 2) << 16))
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_NCM_Private_FunctionPrototypes
+ * @{
+ */
+
+
+static uint8_t  USBD_NCM_Init (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_NCM_DeInit (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_NCM_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_NCM_DataIn (USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  USBD_NCM_DataOut (USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  USBD_NCM_EP0_RxReady (USBD_HandleTypeDef *pdev);
+
+static void  USBD_NCM_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static uint8_t  USBD_NCM_SendNtb (USBD_HandleTypeDef *pdev, USBD_NCM_HandleTypeDef *hncm);
+
+static void  USBD_NCM_Reset (USBD_HandleTypeDef *pdev, USBD_NCM_HandleTypeDef *hncm);
+
+static void  USBD_NCM_Notify (USBD_HandleTypeDef *pdev, USBD_NCM_HandleTypeDef *hncm);
+
+static uint8_t  *USBD_NCM_GetFSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_NCM_GetHSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_NCM_GetOtherSpeedCfgDesc (uint16_t *length);
+
+uint8_t  *USBD_NCM_GetDeviceQualifierDescriptor (uint16_t *length);
+
+#if (USBD_SUPPORT_USER_STRING == 1)
+static uint8_t  *USBD_NCM_GetUsrStrDescriptor (USBD_HandleTypeDef *pdev, uint8_t index, uint16_t *length);
+#endif
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_NCM_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+		USB_LEN_DEV_QUALIFIER_DESC,
+		USB_DESC_TYPE_DEVICE_QUALIFIER,
+		0x00,
+		0x02,
+		0x00,
+		0x00,
+		0x00,
+		0x40,
+		0x01,
+		0x00,
+};
+
+/* iMACAddress, 12 hexadecimal digits */
+__ALIGN_BEGIN static uint8_t USBD_NCM_StrDesc[2 + 2 * 12] __ALIGN_END;
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_NCM_Private_Variables
+ * @{
+ */
+
+
+/* NCM interface class callbacks structure */
+USBD_ClassTypeDef  USBD_NCM =
+{
+		USBD_NCM_Init,
+		USBD_NCM_DeInit,
+		USBD_NCM_Setup,
+		NULL,                 /* EP0_TxSent, */
+		USBD_NCM_EP0_RxReady,
+		USBD_NCM_DataIn,
+		USBD_NCM_DataOut,
+		NULL,
+		NULL,
+		NULL,
+		USBD_NCM_GetHSCfgDesc,
+		USBD_NCM_GetFSCfgDesc,
+		USBD_NCM_GetOtherSpeedCfgDesc,
+		USBD_NCM_GetDeviceQualifierDescriptor,
+#if (USBD_SUPPORT_USER_STRING == 1)
+		USBD_NCM_GetUsrStrDescriptor,
+#endif
+};
+
+/* USB NCM device Configuration Descriptor */
+__ALIGN_BEGIN uint8_t USBD_NCM_CfgFSDesc[USB_NCM_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+		//SIZE: 9+9+5+5+13+6+7+9+9+7+7=86
+		/*Configuration Descriptor*/
+		0x09,   /* bLength: Configuration Descriptor size */
+		USB_DESC_TYPE_CONFIGURATION,      /* bDescriptorType: Configuration */
+		USB_NCM_CONFIG_DESC_SIZ,                /* wTotalLength:no of returned bytes */
+		0x00,
+		0x02,   /* bNumInterfaces: 2 interface */
+		0x01,   /* bConfigurationValue: Configuration value */
+		0x00,   /* iConfiguration: Index of string descriptor describing the configuration */
+		0xC0,   /* bmAttributes: self powered */
+		0xFA,   /* MaxPower 0 mA */
+
+		///INTERFACE DESCRIPTOR(0)
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x00,    ///bInterfaceNumber: Interface Number
+		0x00,    ///bAlternateSetting: Alternate setting for this interface
+		0x01,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x02,    ///iInterfaceClass: Class Code: Communications
+		0x0D,    ///iInterfaceSubClass: Network Control Model
+		0x00,    ///bInterfaceProtocol: No encapsulated commands
+		0x00,    ///iInterface: String index
+
+		///HEADER FUNCTIONAL DESCRIPTOR
+		0x05,    ///bFunctionLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x00,    ///bDescriptorSubtype: Header
+		0x20,    ///bcdCDC: 1.20
+		0x01,
+
+		///UNION FUNCTIONAL DESCRIPTOR
+		0x05,    ///bFunctionLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x06,    ///bDescriptorSubtype: Union
+		0x00,    ///bControlInterface, renumbered by the composite layer
+		0x01,    ///bSubordinateInterface0, renumbered by the composite layer
+
+		///ETHERNET NETWORKING FUNCTIONAL DESCRIPTOR
+		0x0D,    ///bFunctionLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x0F,    ///bDescriptorSubtype: Ethernet Networking
+		NCM_MAC_STRING_INDEX,    ///iMACAddress
+		0x00,    ///bmEthernetStatistics: none
+		0x00,
+		0x00,
+		0x00,
+		0xEA,    ///wMaxSegmentSize: 1514
+		0x05,
+		0x00,    ///wNumberMCFilters: none, every multicast frame is passed
+		0x00,
+		0x00,    ///bNumberPowerFilters
+
+		///NCM FUNCTIONAL DESCRIPTOR
+		0x06,    ///bFunctionLength
+		0x24,    ///bDescriptorType: CS_INTERFACE
+		0x1A,    ///bDescriptorSubtype: NCM
+		0x00,    ///bcdNcmVersion: 1.00
+		0x01,
+		0x00,    ///bmNetworkCapabilities: none of the optional requests
+
+		///ENDPOINT DESCRIPTOR(0)
+		0x07,    					//bLength: Length of this descriptor
+		0x05,    					//bDescriptorType: Endpoint Descriptor Type
+		NCM_CMD_EP,    				//bEndpointAddress: Endpoint address (IN,EP2)
+		0x03,    					//bmAttributes: Transfer Type: INTERRUPT_TRANSFER
+		NCM_CMD_PACKET_SIZE,    	//wMaxPacketSize: Endpoint Size
+		0x00,    					//wMaxPacketSize: Endpoint Size
+		0x10,    					//bIntervall: Polling Intervall
+
+		///INTERFACE DESCRIPTOR(1), ALTERNATE SETTING 0: no traffic
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x01,    ///bInterfaceNumber: Interface Number
+		0x00,    ///bAlternateSetting: Alternate setting for this interface
+		0x00,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x0A,    ///iInterfaceClass: Class Code: CDC_DATA
+		0x00,    ///iInterfaceSubClass: SubClass Code
+		0x01,    ///bInterfaceProtocol: Network Transfer Block
+		0x00,    ///iInterface: String index
+
+		///INTERFACE DESCRIPTOR(1), ALTERNATE SETTING 1: NTBs
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x01,    ///bInterfaceNumber: Interface Number
+		0x01,    ///bAlternateSetting: Alternate setting for this interface
+		0x02,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0x0A,    ///iInterfaceClass: Class Code: CDC_DATA
+		0x00,    ///iInterfaceSubClass: SubClass Code
+		0x01,    ///bInterfaceProtocol: Network Transfer Block
+		0x00,    ///iInterface: String index
+
+		///ENDPOINT DESCRIPTOR(1)
+		0x07,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		NCM_IN_EP,    ///bEndpointAddress: Endpoint address (IN,EP1)
+		0x02,    ///bmAttributes: Transfer Type: BULK_TRANSFER
+		NCM_DATA_FS_MAX_PACKET_SIZE,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///bIntervall: Polling Intervall
+
+		///ENDPOINT DESCRIPTOR(2)
+		0x07,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		NCM_OUT_EP,    ///bEndpointAddress: Endpoint address (OUT,EP1)
+		0x02,    ///bmAttributes: Transfer Type: BULK_TRANSFER
+		NCM_DATA_FS_MAX_PACKET_SIZE,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///bIntervall: Polling Intervall
+		/*---------------------------------------------------------------------------*/
+} ;
+
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_NCM_Private_Functions
+ * @{
+ */
+
+/**
+ * @brief  USBD_NCM_Init
+ *         Initialize the NCM interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_NCM_Init (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+	USBD_NCM_HandleTypeDef   *hncm;
+
+	/* Open EP IN */
+	USBD_LL_OpenEP(pdev,
+			NCM_IN_EP,
+			USBD_EP_TYPE_BULK,
+			NCM_DATA_FS_MAX_PACKET_SIZE);
+
+	/* Open EP OUT */
+	USBD_LL_OpenEP(pdev,
+			NCM_OUT_EP,
+			USBD_EP_TYPE_BULK,
+			NCM_DATA_FS_MAX_PACKET_SIZE);
+
+	/* Open Command IN EP */
+	USBD_LL_OpenEP(pdev,
+			NCM_CMD_EP,
+			USBD_EP_TYPE_INTR,
+			NCM_CMD_PACKET_SIZE);
+
+
+	pdev->pClassData = USBD_malloc(sizeof (USBD_NCM_HandleTypeDef));
+
+	if(pdev->pClassData == NULL)
+	{
+		ret = 1;
+	}
+	else
+	{
+		hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+		USBD_memset(hncm, 0, sizeof (USBD_NCM_HandleTypeDef));
+		hncm->CmdOpCode = 0xFF;
+		hncm->DataItf = 0xFF;
+		hncm->TxMaxSize = NCM_NTB_MAX_SIZE;
+
+		/* Init  physical Interface components, it gives the NTB buffers.
+		Reception is armed by the interface once the host selects the data
+		interface. */
+		((USBD_NCM_ItfTypeDef *)pdev->pUserData)->Init();
+	}
+	return ret;
+}
+
+/**
+ * @brief  USBD_NCM_DeInit
+ *         DeInitialize the NCM layer
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_NCM_DeInit (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+
+	/* Stop the NTB being received, its buffer goes back to the interface */
+	USBD_LLEx_Abort(pdev, NCM_OUT_EP);
+
+	/* Close EP IN */
+	USBD_LL_CloseEP(pdev,
+			NCM_IN_EP);
+
+	/* Close EP OUT */
+	USBD_LL_CloseEP(pdev,
+			NCM_OUT_EP);
+
+	/* Close Command IN EP */
+	USBD_LL_CloseEP(pdev,
+			NCM_CMD_EP);
+
+
+	/* DeInit  physical Interface components */
+	if(pdev->pClassData != NULL)
+	{
+		((USBD_NCM_ItfTypeDef *)pdev->pUserData)->DeInit();
+		USBD_free(pdev->pClassData);
+		pdev->pClassData = NULL;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_NCM_Setup
+ *         Handle the NCM specific requests
+ * @param  pdev: instance
+ * @param  req: usb requests
+ * @retval status
+ */
+static uint8_t  USBD_NCM_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+	USBD_NCM_HandleTypeDef   *hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+	uint16_t *data16 = (uint16_t *)hncm->data;
+	uint8_t itf = LOBYTE(req->wIndex);
+	uint8_t alt = LOBYTE(req->wValue);
+
+	switch (req->bmRequest & USB_REQ_TYPE_MASK)
+	{
+	case USB_REQ_TYPE_CLASS :
+		switch (req->bRequest)
+		{
+		case NCM_GET_NTB_PARAMETERS:
+			data16[0] = NCM_NTB_PARAMETERS_SIZE;		//wLength
+			data16[1] = 0x0001;							//bmNtbFormatsSupported: NTB16
+			hncm->data[1] = NCM_NTB_MAX_SIZE;			//dwNtbInMaxSize
+			data16[4] = NCM_NDP_DIVISOR;				//wNdpInDivisor
+			data16[5] = NCM_NDP_PAYLOAD_REMAINDER;		//wNdpInPayloadRemainder
+			data16[6] = NCM_NDP_ALIGNMENT;				//wNdpInAlignment
+			data16[7] = 0;								//wReserved
+			hncm->data[4] = NCM_NTB_MAX_SIZE;			//dwNtbOutMaxSize
+			data16[10] = NCM_NDP_DIVISOR;				//wNdpOutDivisor
+			data16[11] = NCM_NDP_PAYLOAD_REMAINDER;		//wNdpOutPayloadRemainder
+			data16[12] = NCM_NDP_ALIGNMENT;				//wNdpOutAlignment
+			data16[13] = NCM_NTB_MAX_DATAGRAMS;			//wNtbOutMaxDatagrams
+			USBD_CtlSendData (pdev, (uint8_t *)hncm->data, MIN(NCM_NTB_PARAMETERS_SIZE, req->wLength));
+			break;
+
+		case NCM_GET_NTB_INPUT_SIZE:
+			hncm->data[0] = hncm->TxMaxSize;
+			USBD_CtlSendData (pdev, (uint8_t *)hncm->data, MIN(4, req->wLength));
+			break;
+
+		case NCM_SET_NTB_INPUT_SIZE:
+			if((req->wLength < 4) || (req->wLength > sizeof (hncm->data)))
+			{
+				USBD_CtlError (pdev, req);
+				return USBD_FAIL;
+			}
+			hncm->CmdOpCode = req->bRequest;
+			hncm->CmdLength = req->wLength;
+			USBD_CtlPrepareRx (pdev, (uint8_t *)hncm->data, req->wLength);
+			break;
+
+		case NCM_GET_NTB_FORMAT:
+			hncm->data[0] = 0;							//NTB16
+			USBD_CtlSendData (pdev, (uint8_t *)hncm->data, MIN(2, req->wLength));
+			break;
+
+		case NCM_SET_NTB_FORMAT:
+			if(req->wValue != 0)
+			{
+				/* NTB32 is not supported */
+				USBD_CtlError (pdev, req);
+				return USBD_FAIL;
+			}
+			break;
+
+		case NCM_SET_ETHERNET_PACKET_FILTER:
+			/* Every frame goes to the IP stack, which filters them */
+			break;
+
+		case NCM_RESET_FUNCTION:
+			hncm->TxMaxSize = NCM_NTB_MAX_SIZE;
+			USBD_NCM_Reset(pdev, hncm);
+			break;
+
+		default:
+			USBD_CtlError (pdev, req);
+			return USBD_FAIL;
+		}
+		break;
+
+	case USB_REQ_TYPE_STANDARD:
+		switch (req->bRequest)
+		{
+		case USB_REQ_GET_INTERFACE :
+			hncm->data[0] = (itf == hncm->DataItf) ? hncm->DataAlt : 0;
+			USBD_CtlSendData (pdev, (uint8_t *)hncm->data, 1);
+			break;
+
+		case USB_REQ_SET_INTERFACE :
+			if(alt > 1)
+			{
+				USBD_CtlError (pdev, req);
+				return USBD_FAIL;
+			}
+			if(alt == 1)
+			{
+				hncm->DataItf = itf;
+			}
+			else if(itf != hncm->DataItf)
+			{
+				/* Communication interface, it only has alternate setting 0 */
+				break;
+			}
+
+			/* Either way the function starts over, with no NTB pending */
+			USBD_NCM_Reset(pdev, hncm);
+			hncm->DataAlt = alt;
+			((USBD_NCM_ItfTypeDef *)pdev->pUserData)->Link(alt);
+			if(alt == 1)
+			{
+				hncm->NotifyState = 2;
+				if(hncm->NotifyBusy == 0)
+				{
+					USBD_NCM_Notify(pdev, hncm);
+				}
+			}
+			break;
+		}
+
+	default:
+		break;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_NCM_DataIn
+ *         Data sent on non-control IN endpoint. Only the notifications on the
+ *         command endpoint end here, NTBs complete in USBD_NCM_TxCplt.
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t  USBD_NCM_DataIn (USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+	USBD_NCM_HandleTypeDef   *hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+
+	if(hncm == NULL)
+	{
+		return USBD_FAIL;
+	}
+	if(epnum == (NCM_CMD_EP & 0x7F))
+	{
+		hncm->NotifyBusy = 0;
+		if(hncm->NotifyState != 0)
+		{
+			USBD_NCM_Notify(pdev, hncm);
+		}
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_NCM_DataOut
+ *         NTB received on the OUT endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t  USBD_NCM_DataOut (USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+	USBD_NCM_HandleTypeDef   *hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+
+	if(pdev->pClassData != NULL)
+	{
+		/* Get the received data length */
+		hncm->RxLength = USBD_LL_GetRxDataSize (pdev, epnum);
+
+		((USBD_NCM_ItfTypeDef *)pdev->pUserData)->Receive(hncm->RxBuffer, &hncm->RxLength);
+
+		return USBD_OK;
+	}
+	else
+	{
+		return USBD_FAIL;
+	}
+}
+
+/**
+ * @brief  USBD_NCM_EP0_RxReady
+ *         Data stage of a class request received
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t  USBD_NCM_EP0_RxReady (USBD_HandleTypeDef *pdev)
+{
+	USBD_NCM_HandleTypeDef   *hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+
+	if((hncm != NULL) && (hncm->CmdOpCode != 0xFF))
+	{
+		if(hncm->CmdOpCode == NCM_SET_NTB_INPUT_SIZE)
+		{
+			/* dwNtbInMaxSize, wNtbInMaxDatagrams is not supported. Larger
+			than the NTB buffers is capped, below the minimum ignored. */
+			if(hncm->data[0] >= NCM_NTB_MIN_INPUT_SIZE)
+			{
+				hncm->TxMaxSize = MIN(hncm->data[0], NCM_NTB_MAX_SIZE);
+			}
+		}
+		hncm->CmdOpCode = 0xFF;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_NCM_GetFSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_NCM_GetFSCfgDesc (uint16_t *length)
+{
+	*length = sizeof (USBD_NCM_CfgFSDesc);
+	return USBD_NCM_CfgFSDesc;
+}
+
+/**
+ * @brief  USBD_NCM_GetHSCfgDesc
+ *         Return configuration descriptor, the OTG FS core only runs at full
+ *         speed
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_NCM_GetHSCfgDesc (uint16_t *length)
+{
+	return USBD_NCM_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  USBD_NCM_GetOtherSpeedCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_NCM_GetOtherSpeedCfgDesc (uint16_t *length)
+{
+	return USBD_NCM_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  DeviceQualifierDescriptor
+ *         return Device Qualifier descriptor
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+uint8_t  *USBD_NCM_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+	*length = sizeof (USBD_NCM_DeviceQualifierDesc);
+	return USBD_NCM_DeviceQualifierDesc;
+}
+
+#if (USBD_SUPPORT_USER_STRING == 1)
+/**
+ * @brief  USBD_NCM_GetUsrStrDescriptor
+ *         Return the iMACAddress string descriptor
+ * @param  pdev: device instance
+ * @param  index: string index
+ * @param  length: pointer data length, 0 for another string
+ * @retval pointer to descriptor buffer, NULL for another string
+ */
+static uint8_t  *USBD_NCM_GetUsrStrDescriptor (USBD_HandleTypeDef *pdev, uint8_t index, uint16_t *length)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	char string[13];
+	uint8_t mac[6];
+	uint8_t i;
+
+	if((index != NCM_MAC_STRING_INDEX) || (pdev->pUserData == NULL))
+	{
+		*length = 0;
+		return NULL;
+	}
+
+	((USBD_NCM_ItfTypeDef *)pdev->pUserData)->GetMacAddress(mac);
+	for(i = 0; i < 6; i++)
+	{
+		string[2 * i] = hex[mac[i] >> 4];
+		string[2 * i + 1] = hex[mac[i] & 0x0F];
+	}
+	string[12] = 0;
+
+	USBD_GetString((uint8_t *)string, USBD_NCM_StrDesc, length);
+	return USBD_NCM_StrDesc;
+}
+#endif
+
+/**
+ * @brief  USBD_NCM_RegisterInterface
+ * @param  pdev: device instance
+ * @param  fops: NCM Interface callback
+ * @retval status
+ */
+uint8_t  USBD_NCM_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+		USBD_NCM_ItfTypeDef *fops)
+{
+	uint8_t  ret = USBD_FAIL;
+
+	if(fops != NULL)
+	{
+		pdev->pUserData= fops;
+		ret = USBD_OK;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_NCM_SetTxBuffers
+ *         Give the two NTB buffers frames are gathered in, word aligned and
+ *         NCM_NTB_MAX_SIZE bytes long
+ * @param  pdev: device instance
+ * @param  pbuff0: first NTB buffer
+ * @param  pbuff1: second NTB buffer
+ * @retval status
+ */
+uint8_t  USBD_NCM_SetTxBuffers  (USBD_HandleTypeDef   *pdev,
+		uint8_t  *pbuff0,
+		uint8_t  *pbuff1)
+{
+	USBD_NCM_HandleTypeDef   *hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+
+	hncm->TxNtb[0] = pbuff0;
+	hncm->TxNtb[1] = pbuff1;
+	hncm->TxFill = 0;
+	hncm->TxLength = 0;
+	hncm->TxCount = 0;
+
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_NCM_ReceiveNtb
+ *         prepare OUT Endpoint for an NTB: the transfer ends with the short
+ *         packet closing it, or once size bytes are received
+ * @param  pdev: device instance
+ * @param  pbuff: Rx Buffer
+ * @param  size: Rx Buffer size, NCM_NTB_MAX_SIZE
+ * @retval status
+ */
+uint8_t  USBD_NCM_ReceiveNtb(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t size)
+{
+	USBD_NCM_HandleTypeDef   *hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+
+	if(pdev->pClassData != NULL)
+	{
+		hncm->RxBuffer = pbuff;
+		USBD_LL_PrepareReceive(pdev,
+				NCM_OUT_EP,
+				pbuff,
+				size);
+		return USBD_OK;
+	}
+	else
+	{
+		return USBD_FAIL;
+	}
+}
+
+/**
+ * @brief  USBD_NCM_TransmitFrame
+ *         Copy an Ethernet frame into the NTB being filled. The NTB is sent
+ *         at once if the IN endpoint is idle, or else when the one in flight
+ *         completes, with the frames added meanwhile.
+ * @param  pdev: device instance
+ * @param  pbuff: Ethernet frame, free again on return
+ * @param  length: frame length
+ * @retval status, USBD_BUSY while the NTB being filled is full
+ */
+uint8_t  USBD_NCM_TransmitFrame(USBD_HandleTypeDef *pdev, const uint8_t *pbuff, uint16_t length)
+{
+	USBD_NCM_HandleTypeDef   *hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+	uint16_t *entry;
+	uint8_t *ntb;
+	uint32_t offset;
+	uint32_t primask;
+	uint8_t ret = USBD_OK;
+
+	/* The last byte is kept for the padding of USBD_NCM_SendNtb */
+	if((hncm == NULL) || (hncm->DataAlt == 0) || (hncm->TxNtb[0] == NULL) ||
+			(length == 0) || (NCM_TX_FIRST_DATAGRAM + length >= hncm->TxMaxSize))
+	{
+		return USBD_FAIL;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	offset = (hncm->TxCount == 0) ? NCM_TX_FIRST_DATAGRAM : USBD_NCM_Align(hncm->TxLength);
+	if((hncm->TxCount == NCM_NTB_MAX_DATAGRAMS) || (offset + length >= hncm->TxMaxSize))
+	{
+		/* Only while an NTB is in flight, an idle endpoint gets them at once */
+		__set_PRIMASK(primask);
+		return USBD_BUSY;
+	}
+	ntb = hncm->TxNtb[hncm->TxFill];
+	entry = (uint16_t *)(ntb + NCM_TX_NDP_OFFSET + NCM_NDP16_HEADER_SIZE) + 2 * hncm->TxCount;
+	hncm->TxCount++;
+	hncm->TxLength = offset + length;
+	hncm->TxWriting = 1;
+	__set_PRIMASK(primask);
+
+	/* Copied with the interrupt enabled, USBD_NCM_TxCplt leaves the NTB
+	alone meanwhile */
+	USBD_NetOps_Copy(ntb + offset, pbuff, length);
+	entry[0] = offset;								//wDatagramIndex
+	entry[1] = length;								//wDatagramLength
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	hncm->TxWriting = 0;
+	if(hncm->TxState == 0)
+	{
+		ret = USBD_NCM_SendNtb(pdev, hncm);
+	}
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_NCM_SendNtb
+ *         Close the NTB being filled and send it, the other one is filled
+ *         next. Called from the USB interrupt, or with it masked.
+ * @param  pdev: device instance
+ * @param  hncm: class handle
+ * @retval status
+ */
+static uint8_t  USBD_NCM_SendNtb (USBD_HandleTypeDef *pdev, USBD_NCM_HandleTypeDef *hncm)
+{
+	uint8_t *ntb = hncm->TxNtb[hncm->TxFill];
+	uint16_t *nth = (uint16_t *)ntb;
+	uint16_t *ndp = (uint16_t *)(ntb + NCM_TX_NDP_OFFSET);
+	uint32_t length = hncm->TxLength;
+
+	if(hncm->TxCount == 0)
+	{
+		return USBD_OK;
+	}
+
+	*(uint32_t *)&nth[0] = NCM_NTH16_SIGNATURE;		//dwSignature
+	nth[2] = NCM_NTH16_SIZE;							//wHeaderLength
+	nth[3] = hncm->TxSequence++;						//wSequence
+	nth[4] = length;									//wBlockLength
+	nth[5] = NCM_TX_NDP_OFFSET;							//wNdpIndex
+
+	*(uint32_t *)&ndp[0] = NCM_NDP16_SIGNATURE;		//dwSignature
+	ndp[2] = NCM_NDP16_HEADER_SIZE + 4 * (hncm->TxCount + 1);	//wLength
+	ndp[3] = 0;											//wNextNdpIndex
+	ndp[4 + 2 * hncm->TxCount] = 0;						//Null entry ending the table
+	ndp[5 + 2 * hncm->TxCount] = 0;
+
+	/* The host reads up to its NTB input size and a transfer ending on a
+	full packet before it needs a zero length packet, a zero byte is sent
+	instead, outside of wBlockLength */
+	if(((length % NCM_DATA_FS_MAX_PACKET_SIZE) == 0) && (length < hncm->TxMaxSize))
+	{
+		ntb[length++] = 0;
+	}
+
+	hncm->TxBuffer = ntb;
+	hncm->TxBufferLength = length;
+	hncm->TxFill ^= 1;
+	hncm->TxLength = 0;
+	hncm->TxCount = 0;
+
+	/* Tx Transfer in progress */
+	hncm->TxState = 1;
+	if(USBD_LLEx_Transmit(pdev, NCM_IN_EP, ntb, length, USBD_NCM_TxCplt, NULL) != USBD_OK)
+	{
+		/* The frames are lost, as on a busy network */
+		hncm->TxState = 0;
+		return USBD_FAIL;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_NCM_TxCplt
+ *         NTB sent (or aborted) on the IN endpoint, the frames gathered
+ *         meanwhile follow at once
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  USBD_NCM_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_NCM_HandleTypeDef   *hncm = (USBD_NCM_HandleTypeDef*) pdev->pClassData;
+
+	if(hncm != NULL)
+	{
+		hncm->TxState = 0;
+
+		if(((USBD_NCM_ItfTypeDef *)pdev->pUserData)->TransmitCplt != NULL)
+		{
+			((USBD_NCM_ItfTypeDef *)pdev->pUserData)->TransmitCplt(xfer->pbuf, &xfer->actual);
+		}
+
+		/* A frame being copied sends the NTB itself when done */
+		if(hncm->TxWriting == 0)
+		{
+			USBD_NCM_SendNtb(pdev, hncm);
+		}
+	}
+}
+
+/**
+ * @brief  USBD_NCM_Reset
+ *         Drop the NTB being filled, the one in flight and the one being
+ *         received, and start the sequence over. The interface re-arms
+ *         reception from its Link callback.
+ * @param  pdev: device instance
+ * @param  hncm: class handle
+ * @retval None
+ */
+static void  USBD_NCM_Reset (USBD_HandleTypeDef *pdev, USBD_NCM_HandleTypeDef *hncm)
+{
+	hncm->TxLength = 0;
+	hncm->TxCount = 0;
+	hncm->TxSequence = 0;
+	if(hncm->TxState != 0)
+	{
+		USBD_LLEx_Abort(pdev, NCM_IN_EP);
+	}
+	/* The core no longer writes into the receive buffer once this returns */
+	USBD_LLEx_Abort(pdev, NCM_OUT_EP);
+	hncm->RxBuffer = NULL;
+}
+
+/**
+ * @brief  USBD_NCM_Notify
+ *         Send the next notification due: CONNECTION_SPEED_CHANGE, then
+ *         NETWORK_CONNECTION
+ * @param  pdev: device instance
+ * @param  hncm: class handle
+ * @retval None
+ */
+static void  USBD_NCM_Notify (USBD_HandleTypeDef *pdev, USBD_NCM_HandleTypeDef *hncm)
+{
+	uint8_t *notify = (uint8_t *)hncm->Notify;
+	uint16_t length = 8;
+
+	notify[0] = 0xA1;									//bmRequestType
+	notify[2] = 0;										//wValue
+	notify[3] = 0;
+	notify[4] = hncm->DataItf - 1;						//wIndex: communication interface
+	notify[5] = 0;
+	notify[6] = 0;										//wLength
+	notify[7] = 0;
+
+	if(hncm->NotifyState == 2)
+	{
+		notify[1] = NCM_NOTIFY_CONNECTION_SPEED_CHANGE;
+		notify[6] = 8;
+		hncm->Notify[2] = NCM_LINK_SPEED;				//DLBitRate
+		hncm->Notify[3] = NCM_LINK_SPEED;				//ULBitRate
+		length = 16;
+	}
+	else
+	{
+		notify[1] = NCM_NOTIFY_NETWORK_CONNECTION;
+		notify[2] = hncm->DataAlt;						//Connected while the data interface is on
+	}
+	hncm->NotifyState--;
+	hncm->NotifyBusy = 1;
+	USBD_LL_Transmit(pdev, NCM_CMD_EP, notify, length);
+}
+
+/**
+ * @brief  USBD_NCM_ParseNtb
+ *         Find the datagrams of a received NTB16, following its chain of
+ *         NDPs. Runs in any context, it only reads the NTB.
+ * @param  pbuff: NTB
+ * @param  length: received length
+ * @param  datagram: datagrams found, offsets from pbuff
+ * @param  count: room in datagram on entry, datagrams found on return
+ * @retval USBD_OK, USBD_BUSY when datagrams beyond the room are left out, or
+ *         USBD_FAIL when the NTB is malformed and none is returned
+ */
+uint8_t  USBD_NCM_ParseNtb(const uint8_t *pbuff, uint32_t length, USBD_NCM_DatagramTypeDef *datagram, uint16_t *count)
+{
+	uint16_t room = *count;
+	uint16_t found = 0;
+	uint32_t block, ndp, ndp_length, entry, index, dg_length;
+	uint8_t ndps;
+
+	*count = 0;
+	if((length < NCM_NTH16_SIZE) || (USBD_NCM_Get32(pbuff) != NCM_NTH16_SIGNATURE) ||
+			(USBD_NCM_Get16(pbuff + 4) != NCM_NTH16_SIZE))
+	{
+		return USBD_FAIL;
+	}
+	/* Shorter than the transfer when the host pads it */
+	block = USBD_NCM_Get16(pbuff + 8);
+	if((block < NCM_NTH16_SIZE) || (block > length))
+	{
+		return USBD_FAIL;
+	}
+
+	/* A chain looping back is cut after as many NDPs as datagrams */
+	ndp = USBD_NCM_Get16(pbuff + 10);
+	for(ndps = 0; ndp != 0; ndps++)
+	{
+		if((ndps == NCM_NTB_MAX_DATAGRAMS) || ((ndp % NCM_NDP_ALIGNMENT) != 0) || (ndp < NCM_NTH16_SIZE) ||
+				(ndp + NCM_NDP16_HEADER_SIZE > block))
+		{
+			return USBD_FAIL;
+		}
+		ndp_length = USBD_NCM_Get16(pbuff + ndp + 4);
+		if((USBD_NCM_Get32(pbuff + ndp) != NCM_NDP16_SIGNATURE) || (ndp_length < NCM_NDP16_HEADER_SIZE + 8) ||
+				((ndp_length % 4) != 0) || (ndp + ndp_length > block))
+		{
+			return USBD_FAIL;
+		}
+
+		/* Up to the null entry, or the end of the NDP */
+		for(entry = ndp + NCM_NDP16_HEADER_SIZE; entry < ndp + ndp_length; entry += 4)
+		{
+			index = USBD_NCM_Get16(pbuff + entry);
+			dg_length = USBD_NCM_Get16(pbuff + entry + 2);
+			if((index == 0) || (dg_length == 0))
+			{
+				break;
+			}
+			if(index + dg_length > block)
+			{
+				return USBD_FAIL;
+			}
+			if(found == room)
+			{
+				*count = found;
+				return USBD_BUSY;
+			}
+			datagram[found].Offset = index;
+			datagram[found].Length = dg_length;
+			found++;
+		}
+		ndp = USBD_NCM_Get16(pbuff + ndp + 6);
+	}
+
+	*count = found;
+	return USBD_OK;
+}
+
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
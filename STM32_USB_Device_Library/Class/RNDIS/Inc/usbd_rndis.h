@@ -78,6 +78,7 @@ enum{
 #define RNDIS_CMD_PACKET_SIZE                         8  /* Control Endpoint Packet size */
 
 #define USB_RNDIS_CONFIG_DESC_SIZ                     62
+#define RNDIS_PACKET_MSG_HEADER_SIZE                  44  /* REMOTE_NDIS_PACKET_MSG header preceding each frame */
 #define RNDIS_DATA_HS_IN_PACKET_SIZE                  RNDIS_DATA_HS_MAX_PACKET_SIZE
 #define RNDIS_DATA_HS_OUT_PACKET_SIZE                 RNDIS_DATA_HS_MAX_PACKET_SIZE
 
@@ -123,6 +124,7 @@ typedef struct _USBD_RNDIS_Itf
   int8_t (* DeInit)        (void);
   int8_t (* Control)       (uint8_t, uint8_t * , uint16_t);
   int8_t (* Receive)       (uint8_t *, uint32_t *);
+  int8_t (* TransmitCplt)  (uint8_t *, uint32_t *);
 
 }USBD_RNDIS_ItfTypeDef;
 
@@ -136,6 +138,7 @@ typedef struct
   uint8_t  *TxBuffer;
   uint32_t RxLength;
   uint32_t TxLength;
+  uint32_t TxHeader[RNDIS_PACKET_MSG_HEADER_SIZE/4];
 
   __IO uint32_t TxState;
   __IO uint32_t RxState;
@@ -177,8 +180,16 @@ uint8_t  USBD_RNDIS_SetRxBuffer        (USBD_HandleTypeDef   *pdev,
 
 uint8_t  USBD_RNDIS_ReceivePacket      (USBD_HandleTypeDef *pdev);
 
+uint8_t  USBD_RNDIS_ReceiveFrame       (USBD_HandleTypeDef *pdev,
+                                      uint8_t  *pbuff,
+                                      uint16_t size);
+
 uint8_t  USBD_RNDIS_TransmitPacket     (USBD_HandleTypeDef *pdev);
 
+uint8_t  USBD_RNDIS_TransmitFrame      (USBD_HandleTypeDef *pdev,
+                                      uint8_t  *pbuff,
+                                      uint16_t length);
+
 uint8_t  USBD_RNDIS_TransmitControl(USBD_HandleTypeDef *pdev, uint8_t *buff, uint16_t length);
 
 /**
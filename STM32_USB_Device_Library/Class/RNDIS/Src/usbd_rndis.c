@@ -62,6 +62,7 @@
 #include "../inc/usbd_rndis.h"
 #include "usbd_desc.h"
 #include "usbd_ctlreq.h"
+#include "usbd_ll_ex.h"
 
 
 /** @addtogroup STM32_USB_DEVICE_LIBRARY
@@ -116,6 +117,8 @@ static uint8_t  USBD_RNDIS_DataOut (USBD_HandleTypeDef *pdev, uint8_t epnum);
 
 static uint8_t  USBD_RNDIS_EP0_RxReady (USBD_HandleTypeDef *pdev);
 
+static void  USBD_RNDIS_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
 static uint8_t  *USBD_RNDIS_GetFSCfgDesc (uint16_t *length);
 
 static uint8_t  *USBD_RNDIS_GetHSCfgDesc (uint16_t *length);
@@ -167,6 +170,9 @@ USBD_ClassTypeDef  USBD_RNDIS =
 		USBD_RNDIS_GetFSCfgDesc,
 		USBD_RNDIS_GetOtherSpeedCfgDesc,
 		USBD_RNDIS_GetDeviceQualifierDescriptor,
+#if (USBD_SUPPORT_USER_STRING == 1)
+		NULL,
+#endif
 };
 
 /* USB RNDIS device Configuration Descriptor */
@@ -567,8 +573,8 @@ static uint8_t  USBD_RNDIS_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef
 		{
 			if (req->bmRequest & 0x80)
 			{
+				/* The interface sends the response, only it knows its length */
 				((USBD_RNDIS_ItfTypeDef *)pdev->pUserData)->Control(req->bRequest, (uint8_t *)hrndis->data, req->wLength);
-				USBD_CtlSendData (pdev, (uint8_t *)hrndis->data, req->wLength);
 			}
 			else
 			{
@@ -604,20 +610,16 @@ static uint8_t  USBD_RNDIS_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef
 
 /**
  * @brief  USBD_RNDIS_DataIn
- *         Data sent on non-control IN endpoint
+ *         Data sent on non-control IN endpoint. Only the notifications on the
+ *         command endpoint end here, data packets complete in USBD_RNDIS_TxCplt.
  * @param  pdev: device instance
  * @param  epnum: endpoint number
  * @retval status
  */
 static uint8_t  USBD_RNDIS_DataIn (USBD_HandleTypeDef *pdev, uint8_t epnum)
 {
-	USBD_RNDIS_HandleTypeDef   *hrndis = (USBD_RNDIS_HandleTypeDef*) pdev->pClassData;
-
 	if(pdev->pClassData != NULL)
 	{
-
-		hrndis->TxState = 0;
-
 		return USBD_OK;
 	}
 	else
@@ -803,10 +805,16 @@ uint8_t  USBD_RNDIS_TransmitPacket(USBD_HandleTypeDef *pdev)
 			hrndis->TxState = 1;
 
 			/* Transmit next packet */
-			USBD_LL_Transmit(pdev,
+			if(USBD_LLEx_Transmit(pdev,
 					RNDIS_IN_EP,
 					hrndis->TxBuffer,
-					hrndis->TxLength);
+					hrndis->TxLength,
+					USBD_RNDIS_TxCplt,
+					NULL) != USBD_OK)
+			{
+				hrndis->TxState = 0;
+				return USBD_BUSY;
+			}
 
 			return USBD_OK;
 		}
@@ -822,6 +830,86 @@ uint8_t  USBD_RNDIS_TransmitPacket(USBD_HandleTypeDef *pdev)
 }
 
 
+/**
+ * @brief  USBD_RNDIS_TransmitFrame
+ *         Send an Ethernet frame in a REMOTE_NDIS_PACKET_MSG. The header is
+ *         built in the class handle and gathered with the frame, which must
+ *         stay valid until the TransmitCplt callback.
+ * @param  pdev: device instance
+ * @param  pbuff: Ethernet frame
+ * @param  length: frame length
+ * @retval status, USBD_FAIL when the frame cannot be sent without a copy
+ */
+uint8_t  USBD_RNDIS_TransmitFrame(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t length)
+{
+	USBD_RNDIS_HandleTypeDef   *hrndis = (USBD_RNDIS_HandleTypeDef*) pdev->pClassData;
+	USBD_LLEx_SegmentTypeDef segment[2];
+
+	if(pdev->pClassData == NULL)
+	{
+		return USBD_FAIL;
+	}
+	if(hrndis->TxState != 0)
+	{
+		return USBD_BUSY;
+	}
+
+	/* Tx Transfer in progress */
+	hrndis->TxState = 1;
+
+	hrndis->TxHeader[0] = RNDIS_MSG_PACKET;							//MessageType
+	hrndis->TxHeader[1] = length + RNDIS_PACKET_MSG_HEADER_SIZE;	//MessageLength
+	hrndis->TxHeader[2] = RNDIS_PACKET_MSG_HEADER_SIZE - 8;			//DataOffset
+	hrndis->TxHeader[3] = length;									//DataLength
+	hrndis->TxHeader[4] = 0;										//OOBDataOffset
+	hrndis->TxHeader[5] = 0;										//OOBDataLength
+	hrndis->TxHeader[6] = 0;										//NumOOBDataElements
+	hrndis->TxHeader[7] = 0;										//PerPacketInfoOffset
+	hrndis->TxHeader[8] = 0;										//PerPacketInfoLength
+	hrndis->TxHeader[9] = 0;										//VcHandle
+	hrndis->TxHeader[10] = 0;										//Reserved
+
+	hrndis->TxBuffer = pbuff;
+	hrndis->TxLength = length;
+
+	segment[0].pbuf = (uint8_t *)hrndis->TxHeader;
+	segment[0].length = RNDIS_PACKET_MSG_HEADER_SIZE;
+	segment[1].pbuf = pbuff;
+	segment[1].length = length;
+
+	if(USBD_LLEx_TransmitGather(pdev, RNDIS_IN_EP, segment, 2, USBD_RNDIS_TxCplt, NULL) != USBD_OK)
+	{
+		hrndis->TxState = 0;
+		return USBD_FAIL;
+	}
+
+	return USBD_OK;
+}
+
+
+/**
+ * @brief  USBD_RNDIS_TxCplt
+ *         Data packet sent (or aborted) on the IN endpoint
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  USBD_RNDIS_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	USBD_RNDIS_HandleTypeDef   *hrndis = (USBD_RNDIS_HandleTypeDef*) pdev->pClassData;
+
+	if(hrndis != NULL)
+	{
+		hrndis->TxState = 0;
+
+		if(((USBD_RNDIS_ItfTypeDef *)pdev->pUserData)->TransmitCplt != NULL)
+		{
+			((USBD_RNDIS_ItfTypeDef *)pdev->pUserData)->TransmitCplt(hrndis->TxBuffer, &hrndis->TxLength);
+		}
+	}
+}
+
+
 /**
  * @brief  USBD_RNDIS_ReceivePacket
  *         prepare OUT Endpoint for reception
@@ -859,6 +947,34 @@ uint8_t  USBD_RNDIS_ReceivePacket(USBD_HandleTypeDef *pdev)
 	}
 }
 
+/**
+ * @brief  USBD_RNDIS_ReceiveFrame
+ *         prepare OUT Endpoint for a whole message: the transfer ends with
+ *         the short packet closing it, or once size bytes are received
+ * @param  pdev: device instance
+ * @param  pbuff: Rx Buffer
+ * @param  size: Rx Buffer size, a multiple of the packet size
+ * @retval status
+ */
+uint8_t  USBD_RNDIS_ReceiveFrame(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t size)
+{
+	USBD_RNDIS_HandleTypeDef   *hrndis = (USBD_RNDIS_HandleTypeDef*) pdev->pClassData;
+
+	if(pdev->pClassData != NULL)
+	{
+		hrndis->RxBuffer = pbuff;
+		USBD_LL_PrepareReceive(pdev,
+				RNDIS_OUT_EP,
+				pbuff,
+				size);
+		return USBD_OK;
+	}
+	else
+	{
+		return USBD_FAIL;
+	}
+}
+
 
 
 
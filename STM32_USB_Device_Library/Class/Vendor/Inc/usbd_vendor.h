@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file    usbd_vendor.h
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   header file for the usbd_vendor.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_VENDOR_H
+#define __USB_VENDOR_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_vendor
+  * @brief This file is the Header file for usbd_vendor.c
+  * @{
+  */
+
+
+/** @defgroup usbd_vendor_Exported_Defines
+  * @{
+  */
+#define VENDOR_IN_EP                                  0x81  /* EP1 for data IN, renumbered by the composite layer */
+#define VENDOR_OUT_EP                                 0x01  /* EP1 for data OUT, renumbered by the composite layer */
+
+#define VENDOR_DATA_FS_MAX_PACKET_SIZE                64  /* Endpoint IN & OUT Packet size */
+#define VENDOR_CMD_MAX_SIZE                           64  /* Longest data stage of a vendor request to the interface */
+
+#define USB_VENDOR_CONFIG_DESC_SIZ                    32
+
+/*---------------------------------------------------------------------*/
+/*  MS OS 2.0 definitions                                              */
+/*---------------------------------------------------------------------*/
+#define VENDOR_MS_OS_20_VENDOR_CODE                   0x20  /* bMS_VendorCode of the platform capability */
+#define VENDOR_MS_OS_20_DESCRIPTOR_INDEX              0x07
+#define VENDOR_MS_OS_20_SET_SIZ                       0xB2
+#define VENDOR_BOS_DESC_SIZ                           40
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/**
+  * @}
+  */
+typedef struct _USBD_VENDOR_Itf
+{
+  int8_t (* Init)          (void);                                      /* Configured, OUT buffers may be queued */
+  int8_t (* DeInit)        (void);                                      /* Every queued buffer was given back */
+  int8_t (* Control)       (USBD_SetupReqTypedef *, uint8_t *);         /* Vendor request to the interface and its data */
+  int8_t (* Receive)       (uint8_t *, uint32_t *);                     /* OUT buffer filled, length 0 when aborted */
+  int8_t (* TransmitCplt)  (uint8_t *, uint32_t *);                     /* IN buffer sent, length 0 when aborted */
+
+}USBD_VENDOR_ItfTypeDef;
+
+
+typedef struct
+{
+  uint32_t data[VENDOR_CMD_MAX_SIZE/4];      /* EP0 requests, force 32bits alignment */
+  USBD_SetupReqTypedef CmdRequest;           /* Waiting for its data stage */
+  uint8_t  CmdPending;
+}
+USBD_VENDOR_HandleTypeDef;
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_VENDOR;
+#define USBD_VENDOR_CLASS    &USBD_VENDOR
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_VENDOR_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+                                         USBD_VENDOR_ItfTypeDef *fops);
+
+uint8_t  USBD_VENDOR_DeviceRequest      (USBD_HandleTypeDef *pdev,
+                                         USBD_SetupReqTypedef *req);
+
+uint8_t  USBD_VENDOR_Transmit           (USBD_HandleTypeDef *pdev,
+                                         uint8_t  *pbuff,
+                                         uint32_t length);
+
+uint8_t  USBD_VENDOR_Receive            (USBD_HandleTypeDef *pdev,
+                                         uint8_t  *pbuff,
+                                         uint32_t size);
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_VENDOR_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
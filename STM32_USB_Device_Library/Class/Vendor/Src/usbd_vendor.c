@@ -0,0 +1,676 @@
+/**
+ ******************************************************************************
+ * @file    usbd_vendor.c
+ * @author  Luiz Renault
+ * @version V1.0.0
+ * @date    19-October-2026
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of a vendor specific bulk function:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as a vendor specific interface, bound to WinUSB
+ *             without an INF through the MS OS 2.0 descriptors
+ *           - Queued zero-copy IN and OUT bulk transfers
+ *           - Vendor requests to the interface
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                                Vendor Class Driver Description
+ *          ===================================================================
+ *           One interface (class FFh) with a bulk IN and a bulk OUT endpoint,
+ *           for libusb on Linux and macOS and WinUSB on Windows 8.1 and later.
+ *           This driver implements the following aspects of the
+ *           "Microsoft OS 2.0 Descriptors Specification":
+ *             - BOS descriptor with the MS OS 2.0 platform capability
+ *             - Descriptor set with the WINUSB compatible ID and the
+ *               DeviceInterfaceGUIDs property of the function
+ *
+ *           Transfers are queued on the endpoints (usbd_ll_ex.h), up to
+ *           USBD_LLEX_QUEUE_DEPTH per direction: the next buffer is started
+ *           as soon as one completes, while the interface refills or
+ *           consumes that one. Buffers belong to the caller again when the
+ *           interface is told they completed. The bulk streams have no
+ *           message boundaries, an IN transfer ending on a full packet is
+ *           not followed by a zero length packet unless one is queued.
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../inc/usbd_vendor.h"
+#include "../../Composite/inc/usbd_composite.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+#include "usbd_ll_ex.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+
+/** @defgroup USBD_VENDOR
+ * @brief usbd core module
+ * @{
+ */
+
+/** @defgroup USBD_VENDOR_Private_TypesDefinitions
+ * @{
+ */
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_VENDOR_Private_Defines
+ * @{
+ */
+#define VENDOR_MS_OS_20_FIRST_INTERFACE               22    /* bFirstInterface in the descriptor set */
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_VENDOR_Private_Macros
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+
+/** @defgroup USBD_VENDOR_Private_FunctionPrototypes
+ * @{
+ */
+
+
+static uint8_t  USBD_VENDOR_Init (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_VENDOR_DeInit (USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t  USBD_VENDOR_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_VENDOR_EP0_RxReady (USBD_HandleTypeDef *pdev);
+
+static void  USBD_VENDOR_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static void  USBD_VENDOR_RxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer);
+
+static uint8_t  *USBD_VENDOR_GetFSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_VENDOR_GetHSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_VENDOR_GetOtherSpeedCfgDesc (uint16_t *length);
+
+uint8_t  *USBD_VENDOR_GetDeviceQualifierDescriptor (uint16_t *length);
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_VENDOR_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+		USB_LEN_DEV_QUALIFIER_DESC,
+		USB_DESC_TYPE_DEVICE_QUALIFIER,
+		0x00,
+		0x02,
+		0x00,
+		0x00,
+		0x00,
+		0x40,
+		0x01,
+		0x00,
+};
+
+/* BOS descriptor, in place of the one of usbd_desc.c */
+__ALIGN_BEGIN static uint8_t USBD_VENDOR_BOSDesc[VENDOR_BOS_DESC_SIZ] __ALIGN_END =
+{
+		0x05,    ///bLength
+		USB_DESC_TYPE_BOS,    ///bDescriptorType: BOS
+		LOBYTE(VENDOR_BOS_DESC_SIZ),    ///wTotalLength
+		HIBYTE(VENDOR_BOS_DESC_SIZ),
+		0x02,    ///bNumDeviceCaps
+
+		///USB 2.0 EXTENSION CAPABILITY
+		0x07,    ///bLength
+		0x10,    ///bDescriptorType: Device Capability
+		0x02,    ///bDevCapabilityType: USB 2.0 Extension
+#if (USBD_LPM_ENABLED == 1)
+		0x02,    ///bmAttributes: LPM
+#else
+		0x00,    ///bmAttributes
+#endif
+		0x00,
+		0x00,
+		0x00,
+
+		///MS OS 2.0 PLATFORM CAPABILITY
+		0x1C,    ///bLength
+		0x10,    ///bDescriptorType: Device Capability
+		0x05,    ///bDevCapabilityType: Platform
+		0x00,    ///bReserved
+		0xDF, 0x60, 0xDD, 0xD8,    ///PlatformCapabilityUUID: D8DD60DF-4589-4CC7-9CD2-659D9E648A9F
+		0x89, 0x45, 0xC7, 0x4C,
+		0x9C, 0xD2, 0x65, 0x9D,
+		0x9E, 0x64, 0x8A, 0x9F,
+		0x00, 0x00, 0x03, 0x06,    ///dwWindowsVersion: Windows 8.1
+		LOBYTE(VENDOR_MS_OS_20_SET_SIZ),    ///wMSOSDescriptorSetTotalLength
+		HIBYTE(VENDOR_MS_OS_20_SET_SIZ),
+		VENDOR_MS_OS_20_VENDOR_CODE,    ///bMS_VendorCode
+		0x00,    ///bAltEnumCode: none
+};
+
+/* MS OS 2.0 descriptor set, bFirstInterface is set when it is requested */
+__ALIGN_BEGIN static uint8_t USBD_VENDOR_MsOs20Desc[VENDOR_MS_OS_20_SET_SIZ] __ALIGN_END =
+{
+		//SIZE: 10+8+8+20+132=178
+		///DESCRIPTOR SET HEADER
+		0x0A, 0x00,    ///wLength
+		0x00, 0x00,    ///wDescriptorType: MS_OS_20_SET_HEADER_DESCRIPTOR
+		0x00, 0x00, 0x03, 0x06,    ///dwWindowsVersion: Windows 8.1
+		LOBYTE(VENDOR_MS_OS_20_SET_SIZ),    ///wTotalLength
+		HIBYTE(VENDOR_MS_OS_20_SET_SIZ),
+
+		///CONFIGURATION SUBSET HEADER
+		0x08, 0x00,    ///wLength
+		0x01, 0x00,    ///wDescriptorType: MS_OS_20_SUBSET_HEADER_CONFIGURATION
+		0x00,    ///bConfigurationValue: first configuration (index)
+		0x00,    ///bReserved
+		0xA8, 0x00,    ///wTotalLength: 8+8+20+132
+
+		///FUNCTION SUBSET HEADER
+		0x08, 0x00,    ///wLength
+		0x02, 0x00,    ///wDescriptorType: MS_OS_20_SUBSET_HEADER_FUNCTION
+		0x00,    ///bFirstInterface, set to the interface of the composite device
+		0x00,    ///bReserved
+		0xA0, 0x00,    ///wSubsetLength: 8+20+132
+
+		///COMPATIBLE ID
+		0x14, 0x00,    ///wLength
+		0x03, 0x00,    ///wDescriptorType: MS_OS_20_FEATURE_COMPATBLE_ID
+		'W', 'I', 'N', 'U', 'S', 'B', 0x00, 0x00,    ///CompatibleID
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,    ///SubCompatibleID
+
+		///REGISTRY PROPERTY
+		0x84, 0x00,    ///wLength
+		0x04, 0x00,    ///wDescriptorType: MS_OS_20_FEATURE_REG_PROPERTY
+		0x07, 0x00,    ///wPropertyDataType: REG_MULTI_SZ
+		0x2A, 0x00,    ///wPropertyNameLength
+		'D', 0x00, 'e', 0x00, 'v', 0x00, 'i', 0x00,    ///PropertyName: DeviceInterfaceGUIDs
+		'c', 0x00, 'e', 0x00, 'I', 0x00, 'n', 0x00,
+		't', 0x00, 'e', 0x00, 'r', 0x00, 'f', 0x00,
+		'a', 0x00, 'c', 0x00, 'e', 0x00, 'G', 0x00,
+		'U', 0x00, 'I', 0x00, 'D', 0x00, 's', 0x00,
+		0x00, 0x00,
+		0x50, 0x00,    ///wPropertyDataLength
+		'{', 0x00, '3', 0x00, 'C', 0x00, '9', 0x00,    ///PropertyData: the GUID applications open the device with
+		'E', 0x00, '5', 0x00, 'F', 0x00, '4', 0x00,
+		'A', 0x00, '-', 0x00, '7', 0x00, 'B', 0x00,
+		'2', 0x00, '1', 0x00, '-', 0x00, '4', 0x00,
+		'D', 0x00, '8', 0x00, 'E', 0x00, '-', 0x00,
+		'A', 0x00, '6', 0x00, 'C', 0x00, '3', 0x00,
+		'-', 0x00, '1', 0x00, '9', 0x00, 'F', 0x00,
+		'0', 0x00, 'E', 0x00, '2', 0x00, 'B', 0x00,
+		'7', 0x00, 'D', 0x00, '5', 0x00, 'A', 0x00,
+		'4', 0x00, '}', 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_VENDOR_Private_Variables
+ * @{
+ */
+
+
+/* Vendor interface class callbacks structure */
+USBD_ClassTypeDef  USBD_VENDOR =
+{
+		USBD_VENDOR_Init,
+		USBD_VENDOR_DeInit,
+		USBD_VENDOR_Setup,
+		NULL,                 /* EP0_TxSent, */
+		USBD_VENDOR_EP0_RxReady,
+		NULL,                 /* DataIn, every transfer is queued */
+		NULL,                 /* DataOut, every transfer is queued */
+		NULL,
+		NULL,
+		NULL,
+		USBD_VENDOR_GetHSCfgDesc,
+		USBD_VENDOR_GetFSCfgDesc,
+		USBD_VENDOR_GetOtherSpeedCfgDesc,
+		USBD_VENDOR_GetDeviceQualifierDescriptor,
+#if (USBD_SUPPORT_USER_STRING == 1)
+		NULL,
+#endif
+};
+
+/* USB Vendor device Configuration Descriptor */
+__ALIGN_BEGIN uint8_t USBD_VENDOR_CfgFSDesc[USB_VENDOR_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+		//SIZE: 9+9+7+7=32
+		/*Configuration Descriptor*/
+		0x09,   /* bLength: Configuration Descriptor size */
+		USB_DESC_TYPE_CONFIGURATION,      /* bDescriptorType: Configuration */
+		USB_VENDOR_CONFIG_DESC_SIZ,                /* wTotalLength:no of returned bytes */
+		0x00,
+		0x01,   /* bNumInterfaces: 1 interface */
+		0x01,   /* bConfigurationValue: Configuration value */
+		0x00,   /* iConfiguration: Index of string descriptor describing the configuration */
+		0xC0,   /* bmAttributes: self powered */
+		0xFA,   /* MaxPower 0 mA */
+
+		///INTERFACE DESCRIPTOR(0)
+		0x09,    ///bLength: Length of this descriptor
+		0x04,    ///bDescriptorType: Interface Descriptor Type
+		0x00,    ///bInterfaceNumber: Interface Number
+		0x00,    ///bAlternateSetting: Alternate setting for this interface
+		0x02,    ///bNumEndpoints: Number of endpoints in this interface excluding endpoint 0
+		0xFF,    ///iInterfaceClass: Class Code: Vendor specific
+		0x00,    ///iInterfaceSubClass: SubClass Code
+		0x00,    ///bInterfaceProtocol: Protocol Code
+		0x00,    ///iInterface: String index
+
+		///ENDPOINT DESCRIPTOR(1)
+		0x07,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		VENDOR_IN_EP,    ///bEndpointAddress: Endpoint address (IN,EP1)
+		0x02,    ///bmAttributes: Transfer Type: BULK_TRANSFER
+		VENDOR_DATA_FS_MAX_PACKET_SIZE,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///bIntervall: Polling Intervall
+
+		///ENDPOINT DESCRIPTOR(2)
+		0x07,    ///bLength: Length of this descriptor
+		0x05,    ///bDescriptorType: Endpoint Descriptor Type
+		VENDOR_OUT_EP,    ///bEndpointAddress: Endpoint address (OUT,EP1)
+		0x02,    ///bmAttributes: Transfer Type: BULK_TRANSFER
+		VENDOR_DATA_FS_MAX_PACKET_SIZE,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///wMaxPacketSize: Endpoint Size
+		0x00,    ///bIntervall: Polling Intervall
+		/*---------------------------------------------------------------------------*/
+} ;
+
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_VENDOR_Private_Functions
+ * @{
+ */
+
+/**
+ * @brief  USBD_VENDOR_Init
+ *         Initialize the Vendor interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_VENDOR_Init (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+
+	/* Open EP IN */
+	USBD_LL_OpenEP(pdev,
+			VENDOR_IN_EP,
+			USBD_EP_TYPE_BULK,
+			VENDOR_DATA_FS_MAX_PACKET_SIZE);
+
+	/* Open EP OUT */
+	USBD_LL_OpenEP(pdev,
+			VENDOR_OUT_EP,
+			USBD_EP_TYPE_BULK,
+			VENDOR_DATA_FS_MAX_PACKET_SIZE);
+
+
+	pdev->pClassData = USBD_malloc(sizeof (USBD_VENDOR_HandleTypeDef));
+
+	if(pdev->pClassData == NULL)
+	{
+		ret = 1;
+	}
+	else
+	{
+		USBD_memset(pdev->pClassData, 0, sizeof (USBD_VENDOR_HandleTypeDef));
+
+		/* Init  physical Interface components, it queues the first OUT
+		buffers */
+		((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->Init();
+	}
+	return ret;
+}
+
+/**
+ * @brief  USBD_VENDOR_DeInit
+ *         DeInitialize the Vendor layer. Closing the endpoints gives the
+ *         queued buffers back to the interface.
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t  USBD_VENDOR_DeInit (USBD_HandleTypeDef *pdev,
+		uint8_t cfgidx)
+{
+	uint8_t ret = 0;
+
+	/* Close EP IN */
+	USBD_LL_CloseEP(pdev,
+			VENDOR_IN_EP);
+
+	/* Close EP OUT */
+	USBD_LL_CloseEP(pdev,
+			VENDOR_OUT_EP);
+
+
+	/* DeInit  physical Interface components */
+	if(pdev->pClassData != NULL)
+	{
+		((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->DeInit();
+		USBD_free(pdev->pClassData);
+		pdev->pClassData = NULL;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_VENDOR_Setup
+ *         Handle the vendor requests to the interface. A request to the
+ *         host is answered with wLength bytes filled in by the interface.
+ * @param  pdev: instance
+ * @param  req: usb requests
+ * @retval status
+ */
+static uint8_t  USBD_VENDOR_Setup (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+	USBD_VENDOR_HandleTypeDef   *hvendor = (USBD_VENDOR_HandleTypeDef*) pdev->pClassData;
+
+	if(hvendor == NULL)
+	{
+		USBD_CtlError (pdev, req);
+		return USBD_FAIL;
+	}
+
+	switch (req->bmRequest & USB_REQ_TYPE_MASK)
+	{
+	case USB_REQ_TYPE_VENDOR :
+		if(req->wLength > VENDOR_CMD_MAX_SIZE)
+		{
+			USBD_CtlError (pdev, req);
+			return USBD_FAIL;
+		}
+		if((req->wLength == 0) || (req->bmRequest & 0x80))
+		{
+			if(((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->Control(req, (uint8_t *)hvendor->data) != USBD_OK)
+			{
+				USBD_CtlError (pdev, req);
+				return USBD_FAIL;
+			}
+			if(req->wLength != 0)
+			{
+				USBD_CtlSendData (pdev, (uint8_t *)hvendor->data, req->wLength);
+			}
+		}
+		else
+		{
+			hvendor->CmdRequest = *req;
+			hvendor->CmdPending = 1;
+			USBD_CtlPrepareRx (pdev, (uint8_t *)hvendor->data, req->wLength);
+		}
+		break;
+
+	case USB_REQ_TYPE_STANDARD:
+		switch (req->bRequest)
+		{
+		case USB_REQ_GET_INTERFACE :
+			hvendor->data[0] = 0;
+			USBD_CtlSendData (pdev, (uint8_t *)hvendor->data, 1);
+			break;
+
+		case USB_REQ_SET_INTERFACE :
+			if(LOBYTE(req->wValue) != 0)
+			{
+				USBD_CtlError (pdev, req);
+				return USBD_FAIL;
+			}
+			break;
+		}
+		break;
+
+	default:
+		break;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_VENDOR_EP0_RxReady
+ *         Data stage of a vendor request received
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t  USBD_VENDOR_EP0_RxReady (USBD_HandleTypeDef *pdev)
+{
+	USBD_VENDOR_HandleTypeDef   *hvendor = (USBD_VENDOR_HandleTypeDef*) pdev->pClassData;
+
+	if((hvendor != NULL) && (hvendor->CmdPending != 0))
+	{
+		((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->Control(&hvendor->CmdRequest, (uint8_t *)hvendor->data);
+		hvendor->CmdPending = 0;
+	}
+	return USBD_OK;
+}
+
+/**
+ * @brief  USBD_VENDOR_TxCplt
+ *         IN buffer sent, or aborted
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  USBD_VENDOR_TxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	uint32_t length = (xfer->status == USBD_OK) ? xfer->actual : 0;
+
+	((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->TransmitCplt(xfer->pbuf, &length);
+}
+
+/**
+ * @brief  USBD_VENDOR_RxCplt
+ *         OUT buffer filled, ended by a short packet, or aborted
+ * @param  pdev: device instance
+ * @param  xfer: finished transfer
+ * @retval None
+ */
+static void  USBD_VENDOR_RxCplt (USBD_HandleTypeDef *pdev, USBD_LLEx_XferTypeDef *xfer)
+{
+	uint32_t length = (xfer->status == USBD_OK) ? xfer->actual : 0;
+
+	((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->Receive(xfer->pbuf, &length);
+}
+
+/**
+ * @brief  USBD_VENDOR_GetFSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_VENDOR_GetFSCfgDesc (uint16_t *length)
+{
+	*length = sizeof (USBD_VENDOR_CfgFSDesc);
+	return USBD_VENDOR_CfgFSDesc;
+}
+
+/**
+ * @brief  USBD_VENDOR_GetHSCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_VENDOR_GetHSCfgDesc (uint16_t *length)
+{
+	return USBD_VENDOR_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  USBD_VENDOR_GetOtherSpeedCfgDesc
+ *         Return configuration descriptor
+ * @param  speed : current device speed
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t  *USBD_VENDOR_GetOtherSpeedCfgDesc (uint16_t *length)
+{
+	return USBD_VENDOR_GetFSCfgDesc(length);
+}
+
+/**
+ * @brief  DeviceQualifierDescriptor
+ *         return Device Qualifier descriptor
+ * @param  length : pointer data length
+ * @retval pointer to descriptor buffer
+ */
+uint8_t  *USBD_VENDOR_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+	*length = sizeof (USBD_VENDOR_DeviceQualifierDesc);
+	return USBD_VENDOR_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  USBD_VENDOR_RegisterInterface
+ * @param  pdev: device instance
+ * @param  fops: Vendor Interface callback
+ * @retval status
+ */
+uint8_t  USBD_VENDOR_RegisterInterface  (USBD_HandleTypeDef   *pdev,
+		USBD_VENDOR_ItfTypeDef *fops)
+{
+	uint8_t  ret = USBD_FAIL;
+
+	if(fops != NULL)
+	{
+		pdev->pUserData= fops;
+		ret = USBD_OK;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_VENDOR_DeviceRequest
+ *         Device recipient requests, given to USBD_COMPOSITE_RegisterDeviceRequest:
+ *         the BOS descriptor and the MS OS 2.0 descriptor set. Both are
+ *         read before the device is configured.
+ * @param  pdev: device instance
+ * @param  req: usb requests
+ * @retval USBD_OK if the request was handled, USBD_FAIL otherwise
+ */
+uint8_t  USBD_VENDOR_DeviceRequest (USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+	switch (req->bmRequest & USB_REQ_TYPE_MASK)
+	{
+	case USB_REQ_TYPE_STANDARD:
+		if((req->bRequest == USB_REQ_GET_DESCRIPTOR) && (HIBYTE(req->wValue) == USB_DESC_TYPE_BOS))
+		{
+			if(req->wLength != 0)
+			{
+				USBD_CtlSendData (pdev, USBD_VENDOR_BOSDesc, MIN(VENDOR_BOS_DESC_SIZ, req->wLength));
+			}
+			return USBD_OK;
+		}
+		break;
+
+	case USB_REQ_TYPE_VENDOR:
+		if((req->bmRequest & 0x80) && (req->bRequest == VENDOR_MS_OS_20_VENDOR_CODE) &&
+				(req->wIndex == VENDOR_MS_OS_20_DESCRIPTOR_INDEX))
+		{
+			USBD_VENDOR_MsOs20Desc[VENDOR_MS_OS_20_FIRST_INTERFACE] = USBD_COMPOSITE_GetFirstInterface(&USBD_VENDOR);
+			if(req->wLength != 0)
+			{
+				USBD_CtlSendData (pdev, USBD_VENDOR_MsOs20Desc, MIN(VENDOR_MS_OS_20_SET_SIZ, req->wLength));
+			}
+			return USBD_OK;
+		}
+		break;
+
+	default:
+		break;
+	}
+	return USBD_FAIL;
+}
+
+/**
+ * @brief  USBD_VENDOR_Transmit
+ *         Queue an IN transfer of a buffer, sent as it is. Callable from
+ *         task context and from the interface callbacks.
+ * @param  pdev: device instance
+ * @param  pbuff: data, owned by the class until TransmitCplt
+ * @param  length: data length, 0 for a zero length packet
+ * @retval status, USBD_BUSY while USBD_LLEX_QUEUE_DEPTH transfers are queued
+ */
+uint8_t  USBD_VENDOR_Transmit(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint32_t length)
+{
+	USBD_COMPOSITE_ContextTypeDef context;
+	uint32_t primask;
+	uint8_t ret = USBD_FAIL;
+
+	/* The device handle holds the context of the first class outside of
+	the USB interrupt */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if((USBD_COMPOSITE_SelectClass(pdev, &USBD_VENDOR, &context) == USBD_OK) && (pdev->pClassData != NULL))
+	{
+		ret = USBD_LLEx_Transmit(pdev, VENDOR_IN_EP, pbuff, length, USBD_VENDOR_TxCplt, NULL);
+	}
+	USBD_COMPOSITE_RestoreClass(pdev, &context);
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+/**
+ * @brief  USBD_VENDOR_Receive
+ *         Queue an OUT transfer into a buffer: it completes once size bytes
+ *         are received, or with the short packet ending the host transfer.
+ *         Callable from task context and from the interface callbacks.
+ * @param  pdev: device instance
+ * @param  pbuff: buffer, owned by the class until Receive
+ * @param  size: buffer size, a multiple of VENDOR_DATA_FS_MAX_PACKET_SIZE
+ * @retval status, USBD_BUSY while USBD_LLEX_QUEUE_DEPTH transfers are queued
+ */
+uint8_t  USBD_VENDOR_Receive(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint32_t size)
+{
+	USBD_COMPOSITE_ContextTypeDef context;
+	uint32_t primask;
+	uint8_t ret = USBD_FAIL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if((USBD_COMPOSITE_SelectClass(pdev, &USBD_VENDOR, &context) == USBD_OK) && (pdev->pClassData != NULL))
+	{
+		ret = USBD_LLEx_PrepareReceive(pdev, VENDOR_OUT_EP, pbuff, size, USBD_VENDOR_RxCplt, NULL);
+	}
+	USBD_COMPOSITE_RestoreClass(pdev, &context);
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
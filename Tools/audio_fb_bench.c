@@ -0,0 +1,205 @@
+/**
+  ******************************************************************************
+  * @file    audio_fb_bench.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Simulation of the asynchronous audio feedback (usbd_audio_fb.h)
+  *          between a host and a sink whose clocks drift apart.
+  ******************************************************************************
+  * @attention
+  *
+  * Build:  gcc -O2 -Wall -I../STM32_USB_Device_Library/App/Inc -o audio_fb_bench \
+  *             audio_fb_bench.c ../STM32_USB_Device_Library/App/Src/usbd_audio_fb.c
+  * Usage:  audio_fb_bench [-t seconds] [-r refresh_log2]
+  *
+  * The host sends one packet per frame, the samples of the last feedback
+  * value it read plus the fraction it carries, and reads the feedback
+  * every 2^refresh frames, at least once per feedback window. The sink
+  * plays at 48 kHz off by a few hundred ppm and takes its samples in
+  * bursts, a DMA half buffer at a time, once the target level is reached,
+  * as usbd_audio_if.c does. The buffer level is checked at every frame
+  * once settled: the sink must never run dry or overflow, and the latency
+  * must stay within a burst and a packet of the target.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "usbd_audio_fb.h"
+
+#define FREQ                48000
+#define TARGET              192           /* 4 ms, AUDIO_LATENCY_MS */
+#define WINDOW_LOG2         6             /* AUDIO_FB_WINDOW_LOG2 */
+#define PACKET_MAX          (FREQ / 1000 + 1)
+#define CAPACITY            (2 * TARGET + 2 * PACKET_MAX)
+#define SETTLE_FRAMES       5000
+
+typedef struct
+{
+  uint32_t underruns;
+  uint32_t overruns;
+  uint32_t level_min;
+  uint32_t level_max;
+  double   fb_mean;                       /* Samples per frame, settled */
+} Result;
+
+static void simulate(int ppm, uint32_t burst, uint32_t frames, uint8_t refresh, Result *res)
+{
+  USBD_AUDIO_FbTypeDef fb;
+  double period = 1e6 / (FREQ * (1.0 + ppm * 1e-6));   /* Sink sample period, ns / 1000 */
+  double next_burst = burst * period;                  /* Time of the next burst, us */
+  double arrival;
+  uint32_t host_fb;
+  uint32_t acc = 0;
+  uint32_t level = 0;
+  uint32_t clock = 0;
+  uint32_t n;
+  uint8_t playing = 0;
+  uint8_t packet_done;
+  double fb_sum = 0;
+  uint32_t f;
+
+  memset(res, 0, sizeof(*res));
+  res->level_min = UINT32_MAX;
+  USBD_AUDIO_Fb_Init(&fb, FREQ, TARGET, WINDOW_LOG2);
+  host_fb = fb.value;
+
+  for (f = 0; f < frames; f++)
+  {
+    /* SOF */
+    USBD_AUDIO_Fb_Frame(&fb, clock, level);
+    if ((f & ((1U << refresh) - 1)) == 0)
+    {
+      host_fb = fb.value;
+    }
+    if (f >= SETTLE_FRAMES)
+    {
+      if (level < res->level_min)
+      {
+        res->level_min = level;
+      }
+      if (level > res->level_max)
+      {
+        res->level_max = level;
+      }
+      fb_sum += host_fb / (double)(1 << USBD_AUDIO_FB_FRAC);
+    }
+
+    /* The packet lands somewhere in the frame, the bursts in time order */
+    arrival = f * 1000.0 + 300.0 + (f * 7919 % 400);
+    packet_done = 0;
+    while (!packet_done || (next_burst < (f + 1) * 1000.0))
+    {
+      if (!packet_done && ((next_burst >= arrival) || (next_burst >= (f + 1) * 1000.0)))
+      {
+        acc += host_fb;
+        n = acc >> USBD_AUDIO_FB_FRAC;
+        acc &= (1U << USBD_AUDIO_FB_FRAC) - 1;
+        if (n > PACKET_MAX)
+        {
+          n = PACKET_MAX;
+        }
+        if (level + n > CAPACITY)
+        {
+          res->overruns++;
+          n = CAPACITY - level;
+        }
+        level += n;
+        packet_done = 1;
+        continue;
+      }
+
+      /* Burst: silence until primed, as AUDIO_Read_FS */
+      if (!playing && (level >= TARGET))
+      {
+        playing = 1;
+      }
+      if (playing)
+      {
+        if (level < burst)
+        {
+          res->underruns++;
+          playing = 0;
+          level = 0;
+        }
+        else
+        {
+          level -= burst;
+        }
+      }
+      clock += burst;
+      next_burst += burst * period;
+    }
+  }
+  res->fb_mean = fb_sum / (frames - SETTLE_FRAMES);
+}
+
+int main(int argc, char **argv)
+{
+  static const int ppms[] = { -1000, -250, 0, 250, 1000 };
+  static const uint32_t bursts[] = { 1, 48, 96 };
+  uint32_t seconds = 600;
+  uint8_t refresh = 5;
+  uint32_t errors = 0;
+  uint32_t slack;
+  Result res;
+  unsigned p;
+  unsigned b;
+  int i;
+
+  for (i = 1; i + 1 < argc; i += 2)
+  {
+    if (strcmp(argv[i], "-t") == 0)
+    {
+      seconds = strtoul(argv[i + 1], NULL, 0);
+    }
+    else if (strcmp(argv[i], "-r") == 0)
+    {
+      refresh = (uint8_t)strtoul(argv[i + 1], NULL, 0);
+    }
+    else
+    {
+      break;
+    }
+  }
+  /* A read per window at least, as AUDIO_FB_REFRESH */
+  if ((i != argc) || (seconds < 10) || (refresh >= WINDOW_LOG2))
+  {
+    fprintf(stderr, "usage: %s [-t seconds >= 10] [-r refresh_log2 0..%d]\n", argv[0], WINDOW_LOG2 - 1);
+    return 2;
+  }
+
+  printf("%6s %6s %10s %6s %6s %9s %9s\n", "ppm", "burst", "fb", "min", "max", "underrun", "overrun");
+  for (p = 0; p < sizeof(ppms) / sizeof(ppms[0]); p++)
+  {
+    for (b = 0; b < sizeof(bursts) / sizeof(bursts[0]); b++)
+    {
+      simulate(ppms[p], bursts[b], seconds * 1000, refresh, &res);
+      printf("%6d %6u %10.5f %6u %6u %9u %9u\n", ppms[p], (unsigned)bursts[b], res.fb_mean,
+             (unsigned)res.level_min, (unsigned)res.level_max,
+             (unsigned)res.underruns, (unsigned)res.overruns);
+
+      /* Within a burst and a packet of the target */
+      slack = bursts[b] + PACKET_MAX;
+      if ((res.underruns != 0) || (res.overruns != 0) ||
+          (res.level_min + slack < TARGET) || (res.level_max > TARGET + slack))
+      {
+        errors++;
+      }
+    }
+  }
+
+  if (errors != 0)
+  {
+    printf("%u errors\n", (unsigned)errors);
+    return 1;
+  }
+  printf("Correctness: OK\n");
+  return 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
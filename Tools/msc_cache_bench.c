@@ -0,0 +1,518 @@
+/**
+  ******************************************************************************
+  * @file    msc_cache_bench.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Correctness test and benchmark of the mass storage block cache
+  *          (usbd_msc_cache.h) against a simulated flash storage.
+  ******************************************************************************
+  * @attention
+  *
+  * Native build:
+  *
+  *   gcc -O2 -Wall -I../STM32_USB_Device_Library/App/Inc -o msc_cache_bench \
+  *       msc_cache_bench.c ../STM32_USB_Device_Library/App/Src/usbd_msc_cache.c
+  *
+  * Usage:  msc_cache_bench [-c cache_blocks] [-l line_blocks] [-s seed]
+  *
+  * The storage is modelled as a managed flash with an erase unit of one
+  * cache line: every access costs a command overhead, reads a time per
+  * block, and writes erase and program every erase unit they touch, the
+  * blocks not written being read and programmed again. The bus moves a
+  * block in the time of a full speed bulk transfer and the media task
+  * works in parallel with it, as in usbd_msc_if.c: the read ahead runs
+  * while the data of the previous read is sent, the write back in the
+  * quiet periods of the host.
+  *
+  * Random reads, writes, write backs and syncs of every line geometry are
+  * first checked against a reference image, then the workloads of a host
+  * browsing and copying files are timed with and without the cache.
+  * Times are simulated, the same on every machine.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "usbd_msc_cache.h"
+
+#define BLK_SIZE            512
+#define DISK_BLOCKS         16380         /* 8 MB, not a whole number of lines */
+
+/* Storage timing, microseconds */
+#define CMD_US              100.0         /* Command and busy polling */
+#define READ_BLK_US         25.0          /* Array read of a block */
+#define PROG_BLK_US         50.0          /* Program of a block */
+#define ERASE_US            1000.0        /* Erase of an erase unit */
+
+/* Bus timing, microseconds */
+#define USB_BLK_US          450.0         /* 512 bytes of full speed bulk data */
+#define USB_CMD_US          250.0         /* CBW and CSW */
+
+#define WRITEBACK_US        250000.0      /* configMSC_CACHE_WRITEBACK_MS */
+
+#define CHECK_OPS           20000
+
+typedef struct
+{
+  uint32_t reads;
+  uint32_t writes;
+  uint32_t erases;
+  double   now;                           /* Storage clock */
+} Flash;
+
+typedef struct
+{
+  USBD_MSC_CacheTypeDef *cache;           /* NULL: direct storage accesses */
+  double   host;                          /* Host ready for the next command */
+  double   media;                         /* Media task free */
+} Session;
+
+static uint8_t *flash_data;
+static uint8_t *ref_data;
+static uint16_t erase_blocks;
+static Flash flash;
+static int errors;
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static int8_t flash_read(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+{
+  (void)lun;
+  if ((blk_len == 0) || (blk_addr + blk_len > DISK_BLOCKS))
+  {
+    return -1;
+  }
+  memcpy(buf, flash_data + blk_addr * BLK_SIZE, (size_t)blk_len * BLK_SIZE);
+  flash.reads++;
+  flash.now += CMD_US + READ_BLK_US * blk_len;
+  return 0;
+}
+
+static int8_t flash_write(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+{
+  uint32_t unit;
+  uint32_t last;
+  uint32_t count;
+  uint32_t first;
+  uint32_t end;
+
+  (void)lun;
+  if ((blk_len == 0) || (blk_addr + blk_len > DISK_BLOCKS))
+  {
+    return -1;
+  }
+  memcpy(flash_data + blk_addr * BLK_SIZE, buf, (size_t)blk_len * BLK_SIZE);
+  flash.writes++;
+  flash.now += CMD_US;
+
+  last = (blk_addr + blk_len - 1) / erase_blocks;
+  for (unit = blk_addr / erase_blocks; unit <= last; unit++)
+  {
+    first = unit * erase_blocks;
+    end = first + erase_blocks;
+    if (first < blk_addr)
+    {
+      first = blk_addr;
+    }
+    if (end > blk_addr + blk_len)
+    {
+      end = blk_addr + blk_len;
+    }
+    count = end - first;
+    flash.erases++;
+    flash.now += ERASE_US + PROG_BLK_US * erase_blocks + READ_BLK_US * (erase_blocks - count);
+  }
+  return 0;
+}
+
+static void disk_reset(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < (uint32_t)DISK_BLOCKS * BLK_SIZE; i++)
+  {
+    flash_data[i] = (uint8_t)(i * 7 + (i >> 9));
+  }
+  memcpy(ref_data, flash_data, (size_t)DISK_BLOCKS * BLK_SIZE);
+  memset(&flash, 0, sizeof(flash));
+}
+
+static void fill(uint8_t *buf, uint32_t len)
+{
+  uint32_t i;
+
+  for (i = 0; i < len; i++)
+  {
+    buf[i] = (uint8_t)rng();
+  }
+}
+
+static double max(double a, double b)
+{
+  return (a > b) ? a : b;
+}
+
+/* READ(10): storage, then bus while the read ahead runs */
+static void session_read(Session *s, uint32_t blk_addr, uint16_t blk_len)
+{
+  static uint8_t buf[USBD_MSC_CACHE_MAX_LINE_BLOCKS * 8 * BLK_SIZE];
+  int8_t ret;
+
+  flash.now = max(s->host, s->media);
+  if (s->cache != NULL)
+  {
+    ret = USBD_MSC_Cache_Read(s->cache, 0, buf, blk_addr, blk_len);
+  }
+  else
+  {
+    ret = flash_read(0, buf, blk_addr, blk_len);
+  }
+  if ((ret != 0) || (memcmp(buf, ref_data + blk_addr * BLK_SIZE, (size_t)blk_len * BLK_SIZE) != 0))
+  {
+    if (errors++ < 10)
+    {
+      printf("read %u+%u: %s\n", (unsigned)blk_addr, blk_len, (ret != 0) ? "failed" : "wrong data");
+    }
+  }
+  s->host = flash.now + USB_BLK_US * blk_len + USB_CMD_US;
+  if (s->cache != NULL)
+  {
+    USBD_MSC_Cache_ReadAhead(s->cache);
+  }
+  s->media = flash.now;
+}
+
+/* WRITE(10): bus, then storage */
+static void session_write(Session *s, uint32_t blk_addr, uint16_t blk_len)
+{
+  static uint8_t buf[USBD_MSC_CACHE_MAX_LINE_BLOCKS * 8 * BLK_SIZE];
+  int8_t ret;
+
+  fill(buf, (uint32_t)blk_len * BLK_SIZE);
+  memcpy(ref_data + blk_addr * BLK_SIZE, buf, (size_t)blk_len * BLK_SIZE);
+
+  flash.now = max(s->host + USB_BLK_US * blk_len, s->media);
+  if (s->cache != NULL)
+  {
+    ret = USBD_MSC_Cache_Write(s->cache, 0, buf, blk_addr, blk_len);
+  }
+  else
+  {
+    ret = flash_write(0, buf, blk_addr, blk_len);
+  }
+  if ((ret != 0) && (errors++ < 10))
+  {
+    printf("write %u+%u: failed\n", (unsigned)blk_addr, blk_len);
+  }
+  s->host = flash.now + USB_CMD_US;
+  s->media = flash.now;
+}
+
+/* Host quiet for us microseconds, the write back timer may expire */
+static void session_idle(Session *s, double us)
+{
+  s->host += us;
+  if ((s->cache != NULL) && (us >= WRITEBACK_US) && USBD_MSC_Cache_IsDirty(s->cache))
+  {
+    flash.now = max(s->media, s->host - us + WRITEBACK_US);
+    USBD_MSC_Cache_WriteBack(s->cache);
+    s->media = flash.now;
+  }
+}
+
+/* SYNCHRONIZE CACHE(10) */
+static void session_sync(Session *s)
+{
+  flash.now = max(s->host, s->media);
+  if ((s->cache != NULL) && (USBD_MSC_Cache_Sync(s->cache) != 0) && (errors++ < 10))
+  {
+    printf("sync: failed\n");
+  }
+  s->host = flash.now + USB_CMD_US;
+  s->media = flash.now;
+}
+
+static void check_image(const char *what)
+{
+  if (memcmp(flash_data, ref_data, (size_t)DISK_BLOCKS * BLK_SIZE) != 0)
+  {
+    if (errors++ < 10)
+    {
+      printf("%s: storage differs from the reference after sync\n", what);
+    }
+  }
+}
+
+static USBD_MSC_CacheTypeDef *cache_new(uint16_t lines, uint16_t line_blocks)
+{
+  static USBD_MSC_CacheTypeDef cache;
+  static USBD_MSC_CacheLineTypeDef *pLine;
+  static uint8_t *pData;
+
+  free(pLine);
+  free(pData);
+  pLine = malloc(lines * sizeof(*pLine));
+  pData = malloc((size_t)lines * line_blocks * BLK_SIZE);
+  if ((pLine == NULL) || (pData == NULL))
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+  erase_blocks = line_blocks;
+  USBD_MSC_Cache_Init(&cache, flash_read, flash_write, pLine, lines, line_blocks, pData, BLK_SIZE);
+  return &cache;
+}
+
+/* Random accesses, clustered so that lines are hit again, against the
+reference image */
+static void check(void)
+{
+  static const uint16_t line_blocks[] = { 1, 4, 8, 16, 32 };
+  static const uint16_t lines[] = { 1, 3, 8 };
+  Session s;
+  uint32_t blk_addr;
+  uint16_t blk_len;
+  unsigned g;
+  unsigned l;
+  long op;
+
+  for (g = 0; g < sizeof(line_blocks) / sizeof(line_blocks[0]); g++)
+  {
+    for (l = 0; l < sizeof(lines) / sizeof(lines[0]); l++)
+    {
+      disk_reset();
+      memset(&s, 0, sizeof(s));
+      s.cache = cache_new(lines[l], line_blocks[g]);
+
+      for (op = 0; op < CHECK_OPS; op++)
+      {
+        blk_len = 1 + rng() % (2 * line_blocks[g] + 2);
+        if (rng() % 4 == 0)
+        {
+          blk_addr = DISK_BLOCKS - 1 - rng() % (4 * line_blocks[g] + 4);
+        }
+        else
+        {
+          blk_addr = rng() % (16 * line_blocks[g] + 16);
+        }
+        if (blk_addr + blk_len > DISK_BLOCKS)
+        {
+          blk_len = DISK_BLOCKS - blk_addr;
+        }
+
+        switch (rng() % 16)
+        {
+        case 0:
+          session_idle(&s, WRITEBACK_US);
+          break;
+        case 1:
+          session_sync(&s);
+          check_image("check");
+          break;
+        case 2: case 3: case 4: case 5: case 6:
+          session_write(&s, blk_addr, blk_len);
+          break;
+        default:
+          session_read(&s, blk_addr, blk_len);
+          break;
+        }
+      }
+      session_sync(&s);
+      check_image("check");
+    }
+  }
+}
+
+/* FAT and directory blocks read over and over, some file data */
+static void work_browse(Session *s)
+{
+  long i;
+
+  for (i = 0; i < 4000; i++)
+  {
+    if (rng() % 10 == 0)
+    {
+      session_read(s, 1024 + rng() % 8192, 1);
+    }
+    else if (rng() % 2 == 0)
+    {
+      session_read(s, 32 + rng() % 16, 1);
+    }
+    else
+    {
+      session_read(s, 96 + rng() % 8, 1);
+    }
+  }
+}
+
+/* A 4 MB file read in 4 KB commands, MSC_MEDIA_PACKET */
+static void work_read(Session *s, uint32_t start)
+{
+  uint32_t blk;
+
+  for (blk = 0; blk < 8192; blk += 8)
+  {
+    session_read(s, start + blk, 8);
+  }
+}
+
+/* 400 small files of 3 blocks: data, FAT block, directory block, with a
+pause every 20 files and a sync at the end */
+static void work_copy(Session *s)
+{
+  uint32_t file;
+
+  for (file = 0; file < 400; file++)
+  {
+    session_write(s, 1024 + file * 4, 3);
+    session_write(s, 32 + file / 128, 1);
+    session_write(s, 96 + file / 16, 1);
+    if (file % 20 == 19)
+    {
+      session_idle(s, 300000.0);
+    }
+  }
+  session_sync(s);
+}
+
+/* A 4 MB file written in 4 KB commands */
+static void work_write(Session *s)
+{
+  uint32_t blk;
+
+  for (blk = 0; blk < 8192; blk += 8)
+  {
+    session_write(s, 4096 + blk, 8);
+  }
+  session_sync(s);
+}
+
+static void bench(uint16_t cache_blocks, uint16_t line_blocks)
+{
+  static const char *name[] =
+  {
+    "browse, 4000 reads of 1 block",
+    "read 4 MB, aligned",
+    "read 4 MB, from block 63",
+    "copy 400 files of 3 blocks",
+    "write 4 MB, aligned",
+  };
+  USBD_MSC_CacheStatsTypeDef *pStats;
+  Session s;
+  Flash result[2];
+  double time[2];
+  unsigned w;
+  int cached;
+  uint32_t seed = rng_state;
+
+  printf("%u blocks of cache in lines of %u, erase unit of %u blocks\n\n",
+         cache_blocks, line_blocks, line_blocks);
+  printf("%-30s %12s %12s %8s %9s %9s  %s\n", "", "direct ms", "cached ms", "speedup",
+         "accesses", "erases", "cache hits/misses/ahead/bypassed");
+
+  for (w = 0; w < sizeof(name) / sizeof(name[0]); w++)
+  {
+    for (cached = 0; cached < 2; cached++)
+    {
+      rng_state = seed;
+      disk_reset();
+      memset(&s, 0, sizeof(s));
+      s.cache = (cached != 0) ? cache_new(cache_blocks / line_blocks, line_blocks) : NULL;
+      erase_blocks = line_blocks;
+
+      switch (w)
+      {
+      case 0: work_browse(&s); break;
+      case 1: work_read(&s, 1024); break;
+      case 2: work_read(&s, 63); break;
+      case 3: work_copy(&s); break;
+      default: work_write(&s); break;
+      }
+      check_image(name[w]);
+      result[cached] = flash;
+      time[cached] = max(s.host, s.media);
+    }
+
+    pStats = &s.cache->stats;
+    printf("%-30s %12.1f %12.1f %7.2fx %4u/%-4u %4u/%-4u  %u/%u/%u/%u\n", name[w],
+           time[0] / 1000.0, time[1] / 1000.0, time[0] / time[1],
+           (unsigned)(result[0].reads + result[0].writes),
+           (unsigned)(result[1].reads + result[1].writes),
+           (unsigned)result[0].erases, (unsigned)result[1].erases,
+           (unsigned)pStats->read_hits, (unsigned)pStats->read_misses,
+           (unsigned)pStats->read_ahead, (unsigned)pStats->bypassed);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  unsigned cache_blocks = 32;
+  unsigned line_blocks = 8;
+  int i;
+
+  rng_state = 0x2545F491;
+  for (i = 1; i + 1 < argc; i += 2)
+  {
+    if (strcmp(argv[i], "-c") == 0)
+    {
+      cache_blocks = atoi(argv[i + 1]);
+    }
+    else if (strcmp(argv[i], "-l") == 0)
+    {
+      line_blocks = atoi(argv[i + 1]);
+    }
+    else if (strcmp(argv[i], "-s") == 0)
+    {
+      rng_state = strtoul(argv[i + 1], NULL, 0) | 1;
+    }
+    else
+    {
+      break;
+    }
+  }
+  if ((i != argc) || (line_blocks == 0) || (line_blocks > USBD_MSC_CACHE_MAX_LINE_BLOCKS) ||
+      (cache_blocks < line_blocks) || (cache_blocks % line_blocks != 0))
+  {
+    fprintf(stderr, "usage: %s [-c cache_blocks] [-l line_blocks] [-s seed]\n", argv[0]);
+    fprintf(stderr, "  cache_blocks a multiple of line_blocks, line_blocks up to %u\n",
+            USBD_MSC_CACHE_MAX_LINE_BLOCKS);
+    return 2;
+  }
+
+  flash_data = malloc((size_t)DISK_BLOCKS * BLK_SIZE);
+  ref_data = malloc((size_t)DISK_BLOCKS * BLK_SIZE);
+  if ((flash_data == NULL) || (ref_data == NULL))
+  {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+
+  check();
+  if (errors != 0)
+  {
+    printf("%d errors\n", errors);
+    return 1;
+  }
+  printf("Correctness: OK\n\n");
+
+  bench(cache_blocks, line_blocks);
+  if (errors != 0)
+  {
+    printf("%d errors\n", errors);
+    return 1;
+  }
+  return 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,417 @@
+/**
+  ******************************************************************************
+  * @file    msc_reset_test.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Linux libusb test of the Bulk-Only Mass Storage Reset of the mass
+  *          storage function (usbd_msc.c) in the middle of a WRITE(10).
+  ******************************************************************************
+  * @attention
+  *
+  * Build:  gcc -O2 -Wall $(pkg-config --cflags libusb-1.0) -o msc_reset_test
+  *         msc_reset_test.c $(pkg-config --libs libusb-1.0)
+  * Usage:  msc_reset_test [-d vid:pid] [-l lba] [-b blocks] [-p bytes]
+  *         [-n rounds]
+  *
+  * Meant for the RAM disk (MSC_RAMDISK_BLOCKS in usbd_conf.h,
+  * usbd_ramdisk_if.c): the -b blocks from -l are overwritten. Each round
+  * writes pattern A over them, then starts a WRITE(10) of pattern B, sends
+  * only -p bytes of it, leaving a reception armed on the OUT endpoint and
+  * possibly a storage write pending, and resets the function. The device
+  * must then answer TEST UNIT READY, every block read back must hold
+  * either pattern A or pattern B whole, never data of the commands that
+  * followed the reset, and a full WRITE(10) and READ(10) must go through.
+  *
+  * The usb-storage driver is detached from the interface while the test
+  * runs, the device must not be mounted.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <libusb.h>
+
+/* Must match usbd_desc.c */
+#define DEFAULT_VID                     0x29BC
+#define DEFAULT_PID                     0x2020
+
+#define DEFAULT_LBA                     0
+#define DEFAULT_BLOCKS                  32
+#define DEFAULT_ROUNDS                  100
+#define MAX_BLOCK_SIZE                  4096
+#define TIMEOUT_MS                      2000
+
+#define CBW_SIGNATURE                   0x43425355
+#define CSW_SIGNATURE                   0x53425355
+#define CBW_LENGTH                      31
+#define CSW_LENGTH                      13
+#define BOT_RESET                       0xFF
+
+#define SCSI_TEST_UNIT_READY            0x00
+#define SCSI_READ_CAPACITY10            0x25
+#define SCSI_READ10                     0x28
+#define SCSI_WRITE10                    0x2A
+
+static libusb_device_handle *handle;
+static int interface = -1;
+static uint8_t ep_in, ep_out;
+static uint32_t tag;
+static uint32_t block_size;
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int find_interface(void)
+{
+  struct libusb_config_descriptor *config;
+  const struct libusb_interface_descriptor *alt;
+  int i, j;
+
+  if (libusb_get_active_config_descriptor(libusb_get_device(handle), &config) != 0)
+  {
+    return -1;
+  }
+  for (i = 0; (i < config->bNumInterfaces) && (interface < 0); i++)
+  {
+    alt = &config->interface[i].altsetting[0];
+    /* SCSI transparent command set, Bulk-Only Transport */
+    if ((alt->bInterfaceClass != LIBUSB_CLASS_MASS_STORAGE) || (alt->bInterfaceSubClass != 0x06) ||
+        (alt->bInterfaceProtocol != 0x50))
+    {
+      continue;
+    }
+    interface = alt->bInterfaceNumber;
+    for (j = 0; j < alt->bNumEndpoints; j++)
+    {
+      if (alt->endpoint[j].bEndpointAddress & LIBUSB_ENDPOINT_IN)
+      {
+        ep_in = alt->endpoint[j].bEndpointAddress;
+      }
+      else
+      {
+        ep_out = alt->endpoint[j].bEndpointAddress;
+      }
+    }
+  }
+  libusb_free_config_descriptor(config);
+  return ((interface < 0) || (ep_in == 0) || (ep_out == 0)) ? -1 : 0;
+}
+
+/* Sends the CBW of a 10 byte CDB */
+static int send_cbw(uint8_t opcode, uint32_t lba, uint16_t blocks, uint32_t length, int in)
+{
+  uint8_t cbw[CBW_LENGTH];
+  int done, ret;
+
+  memset(cbw, 0, sizeof(cbw));
+  put_le32(&cbw[0], CBW_SIGNATURE);
+  put_le32(&cbw[4], ++tag);
+  put_le32(&cbw[8], length);
+  cbw[12] = in ? 0x80 : 0x00;
+  cbw[14] = 10;
+  cbw[15] = opcode;
+  cbw[17] = lba >> 24;
+  cbw[18] = lba >> 16;
+  cbw[19] = lba >> 8;
+  cbw[20] = lba;
+  cbw[22] = blocks >> 8;
+  cbw[23] = blocks;
+
+  ret = libusb_bulk_transfer(handle, ep_out, cbw, sizeof(cbw), &done, TIMEOUT_MS);
+  if ((ret != 0) || (done != sizeof(cbw)))
+  {
+    fprintf(stderr, "CBW 0x%02x: %s\n", opcode, ret ? libusb_strerror(ret) : "short");
+    return -1;
+  }
+  return 0;
+}
+
+/* Reads the CSW of the last CBW, 0 if the command passed with no residue */
+static int receive_csw(uint8_t opcode)
+{
+  uint8_t csw[CSW_LENGTH];
+  int done, ret;
+
+  ret = libusb_bulk_transfer(handle, ep_in, csw, sizeof(csw), &done, TIMEOUT_MS);
+  if (ret == LIBUSB_ERROR_PIPE)
+  {
+    libusb_clear_halt(handle, ep_in);
+    ret = libusb_bulk_transfer(handle, ep_in, csw, sizeof(csw), &done, TIMEOUT_MS);
+  }
+  if ((ret != 0) || (done != sizeof(csw)) || (get_le32(&csw[0]) != CSW_SIGNATURE) || (get_le32(&csw[4]) != tag))
+  {
+    fprintf(stderr, "CSW 0x%02x: %s\n", opcode, ret ? libusb_strerror(ret) : "bad signature, tag or length");
+    return -1;
+  }
+  if ((csw[12] != 0) || (get_le32(&csw[8]) != 0))
+  {
+    fprintf(stderr, "CSW 0x%02x: status %u, residue %u\n", opcode, csw[12], get_le32(&csw[8]));
+    return -1;
+  }
+  return 0;
+}
+
+static int command(uint8_t opcode, uint32_t lba, uint16_t blocks, uint8_t *data, uint32_t length, int in)
+{
+  int done, ret;
+
+  if (send_cbw(opcode, lba, blocks, length, in) != 0)
+  {
+    return -1;
+  }
+  if (length != 0)
+  {
+    ret = libusb_bulk_transfer(handle, in ? ep_in : ep_out, data, length, &done, TIMEOUT_MS);
+    if (((ret != 0) && (ret != LIBUSB_ERROR_PIPE)) || ((ret == 0) && ((uint32_t)done != length)))
+    {
+      fprintf(stderr, "Data 0x%02x: %s\n", opcode, ret ? libusb_strerror(ret) : "short");
+      return -1;
+    }
+  }
+  return receive_csw(opcode);
+}
+
+/* Bulk-Only Mass Storage Reset, then the halts the host clears after it */
+static int bot_reset(void)
+{
+  int ret;
+
+  ret = libusb_control_transfer(handle, LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_CLASS | LIBUSB_RECIPIENT_INTERFACE,
+                                BOT_RESET, 0, interface, NULL, 0, TIMEOUT_MS);
+  if (ret < 0)
+  {
+    fprintf(stderr, "Bulk-Only Mass Storage Reset: %s\n", libusb_strerror(ret));
+    return -1;
+  }
+  if ((libusb_clear_halt(handle, ep_in) != 0) || (libusb_clear_halt(handle, ep_out) != 0))
+  {
+    fprintf(stderr, "Clear halt failed\n");
+    return -1;
+  }
+  return 0;
+}
+
+/* Block n of a pattern: its LBA and the pattern tag in every word */
+static void fill(uint8_t *data, uint32_t lba, uint16_t blocks, uint32_t pattern)
+{
+  uint32_t n, i;
+
+  for (n = 0; n < blocks; n++)
+  {
+    for (i = 0; i < block_size; i += 4)
+    {
+      put_le32(&data[n * block_size + i], ((lba + n) << 8) ^ pattern ^ i);
+    }
+  }
+}
+
+static int round_trip(int round, uint32_t lba, uint16_t blocks, uint32_t partial, uint8_t *a, uint8_t *b, uint8_t *c)
+{
+  uint32_t length = blocks * block_size;
+  uint32_t pattern_a = 0xA5000000 ^ round;
+  uint32_t pattern_b = 0x5A000000 ^ round;
+  int done, ret;
+  uint32_t n, written = 0;
+
+  fill(a, lba, blocks, pattern_a);
+  fill(b, lba, blocks, pattern_b);
+  if (command(SCSI_WRITE10, lba, blocks, a, length, 0) != 0)
+  {
+    return -1;
+  }
+
+  /* WRITE(10) left halfway, the device still expects data */
+  if (send_cbw(SCSI_WRITE10, lba, blocks, length, 0) != 0)
+  {
+    return -1;
+  }
+  ret = libusb_bulk_transfer(handle, ep_out, b, partial, &done, TIMEOUT_MS);
+  if ((ret != 0) || ((uint32_t)done != partial))
+  {
+    fprintf(stderr, "Partial WRITE(10) data: %s\n", ret ? libusb_strerror(ret) : "short");
+    return -1;
+  }
+  if (bot_reset() != 0)
+  {
+    return -1;
+  }
+
+  if (command(SCSI_TEST_UNIT_READY, 0, 0, NULL, 0, 0) != 0)
+  {
+    fprintf(stderr, "Round %d: no TEST UNIT READY after the reset\n", round);
+    return -1;
+  }
+  if (command(SCSI_READ10, lba, blocks, c, length, 1) != 0)
+  {
+    return -1;
+  }
+  for (n = 0; n < blocks; n++)
+  {
+    if (memcmp(&c[n * block_size], &b[n * block_size], block_size) == 0)
+    {
+      written++;
+    }
+    else if (memcmp(&c[n * block_size], &a[n * block_size], block_size) != 0)
+    {
+      fprintf(stderr, "Round %d: LBA %u holds neither pattern\n", round, lba + n);
+      return -1;
+    }
+  }
+
+  /* The pipeline works again from a clean state */
+  fill(a, lba, blocks, ~pattern_a);
+  if ((command(SCSI_WRITE10, lba, blocks, a, length, 0) != 0) ||
+      (command(SCSI_READ10, lba, blocks, c, length, 1) != 0))
+  {
+    return -1;
+  }
+  if (memcmp(a, c, length) != 0)
+  {
+    fprintf(stderr, "Round %d: WRITE(10) after the reset reads back wrong\n", round);
+    return -1;
+  }
+  return (int)written;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned vid = DEFAULT_VID, pid = DEFAULT_PID;
+  uint32_t lba = DEFAULT_LBA;
+  int blocks = DEFAULT_BLOCKS;
+  int rounds = DEFAULT_ROUNDS;
+  int partial = -1;
+  uint8_t capacity[8];
+  uint8_t *a = NULL, *b = NULL, *c = NULL;
+  uint32_t last_lba;
+  long total_written = 0;
+  int ret = 1;
+  int round, written, opt;
+
+  while ((opt = getopt(argc, argv, "d:l:b:p:n:")) != -1)
+  {
+    switch (opt)
+    {
+    case 'd':
+      if (sscanf(optarg, "%x:%x", &vid, &pid) != 2)
+      {
+        fprintf(stderr, "Bad -d %s\n", optarg);
+        return 1;
+      }
+      break;
+    case 'l':
+      lba = strtoul(optarg, NULL, 0);
+      break;
+    case 'b':
+      blocks = atoi(optarg);
+      break;
+    case 'p':
+      partial = atoi(optarg);
+      break;
+    case 'n':
+      rounds = atoi(optarg);
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-d vid:pid] [-l lba] [-b blocks] [-p bytes] [-n rounds]\n", argv[0]);
+      return 1;
+    }
+  }
+  if ((blocks <= 0) || (blocks > 0xFFFF) || (rounds <= 0))
+  {
+    fprintf(stderr, "Bad block count or rounds\n");
+    return 1;
+  }
+
+  if (libusb_init(NULL) != 0)
+  {
+    fprintf(stderr, "libusb_init failed\n");
+    return 1;
+  }
+  handle = libusb_open_device_with_vid_pid(NULL, vid, pid);
+  if (handle == NULL)
+  {
+    fprintf(stderr, "No device %04x:%04x, or no access to it\n", vid, pid);
+    goto exit;
+  }
+  if (find_interface() != 0)
+  {
+    fprintf(stderr, "No Bulk-Only mass storage interface\n");
+    goto close;
+  }
+  libusb_set_auto_detach_kernel_driver(handle, 1);
+  if (libusb_claim_interface(handle, interface) != 0)
+  {
+    fprintf(stderr, "Cannot claim interface %d\n", interface);
+    goto close;
+  }
+
+  if (command(SCSI_READ_CAPACITY10, 0, 0, capacity, sizeof(capacity), 1) != 0)
+  {
+    goto release;
+  }
+  last_lba = (capacity[0] << 24) | (capacity[1] << 16) | (capacity[2] << 8) | capacity[3];
+  block_size = (capacity[4] << 24) | (capacity[5] << 16) | (capacity[6] << 8) | capacity[7];
+  if ((block_size == 0) || (block_size > MAX_BLOCK_SIZE) || (block_size % 64) || (lba + blocks - 1 > last_lba))
+  {
+    fprintf(stderr, "%u blocks of %u bytes do not fit -l %u -b %d\n", last_lba + 1, block_size, lba, blocks);
+    goto release;
+  }
+  /* Default: past the first media buffer, in the middle of a packet run */
+  if (partial < 0)
+  {
+    partial = (blocks * block_size) / 2 + 64;
+  }
+  if ((partial <= 0) || (partial >= blocks * (int)block_size) || (partial % 64))
+  {
+    fprintf(stderr, "Bad -p %d: whole packets, less than the transfer\n", partial);
+    goto release;
+  }
+
+  a = malloc(blocks * block_size);
+  b = malloc(blocks * block_size);
+  c = malloc(blocks * block_size);
+  if ((a == NULL) || (b == NULL) || (c == NULL))
+  {
+    goto release;
+  }
+  printf("Interface %d, IN 0x%02x, OUT 0x%02x, LBA %u, %d x %u bytes, reset after %d bytes, %d rounds\n",
+         interface, ep_in, ep_out, lba, blocks, block_size, partial, rounds);
+
+  for (round = 0; round < rounds; round++)
+  {
+    written = round_trip(round, lba, blocks, partial, a, b, c);
+    if (written < 0)
+    {
+      printf("FAILED in round %d\n", round);
+      goto release;
+    }
+    total_written += written;
+  }
+  printf("PASSED, %.1f blocks of the interrupted WRITE(10) stored per round\n", (double)total_written / rounds);
+  ret = 0;
+
+release:
+  free(a);
+  free(b);
+  free(c);
+  libusb_release_interface(handle, interface);
+close:
+  libusb_close(handle);
+exit:
+  libusb_exit(NULL);
+  return ret;
+}
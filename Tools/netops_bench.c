@@ -0,0 +1,219 @@
+/**
+  ******************************************************************************
+  * @file    netops_bench.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Correctness test and benchmark of the frame copy and checksum
+  *          kernels (usbd_netops.h).
+  ******************************************************************************
+  * @attention
+  *
+  * Native build, portable C kernels:
+  *
+  *   gcc -O2 -Wall -I../STM32_USB_Device_Library/App/Inc -o netops_bench \
+  *       netops_bench.c ../STM32_USB_Device_Library/App/Src/usbd_netops.c
+  *
+  * Thumb-2 build, LDM/STM and ADCS kernels, run under qemu-arm user mode:
+  *
+  *   arm-linux-gnueabihf-gcc -O2 -Wall -mthumb -march=armv7-a -static \
+  *       -I../STM32_USB_Device_Library/App/Inc -o netops_bench_arm \
+  *       netops_bench.c ../STM32_USB_Device_Library/App/Src/usbd_netops.c
+  *   qemu-arm ./netops_bench_arm
+  *
+  * Usage:  netops_bench [-n iterations]
+  *
+  * Every source and destination alignment and the lengths up to a full
+  * frame are checked against memcpy and a byte wise RFC 1071 sum, then
+  * full frame copies and checksums are timed against memcpy and that
+  * reference. Times under qemu only compare the variants with each other,
+  * cycle counts on the target come from USBD_PROFILING.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "usbd_netops.h"
+
+#define FRAME_SIZE              1514
+#define MAX_LENGTH              (FRAME_SIZE + 64)
+#define ALIGNMENTS              8
+#define DEFAULT_ITERATIONS      100000
+
+static uint8_t src_buffer[MAX_LENGTH + 2 * ALIGNMENTS];
+static uint8_t dst_buffer[MAX_LENGTH + 2 * ALIGNMENTS];
+static uint8_t ref_buffer[MAX_LENGTH + 2 * ALIGNMENTS];
+
+/* Sum of the 16 bit words in memory order, RFC 1071 */
+static uint16_t reference_checksum(uint32_t sum, const uint8_t *p, uint32_t len)
+{
+  uint32_t acc = sum;
+  uint32_t i;
+
+  for (i = 0; i + 1 < len; i += 2)
+  {
+    acc += p[i] | (p[i + 1] << 8);
+    acc = (acc & 0xFFFF) + (acc >> 16);
+  }
+  if (i < len)
+  {
+    acc += p[i];
+    acc = (acc & 0xFFFF) + (acc >> 16);
+  }
+  return (uint16_t)acc;
+}
+
+static void fill(uint8_t *p, uint32_t len)
+{
+  while (len-- != 0)
+  {
+    *p++ = rand();
+  }
+}
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int check(void)
+{
+  uint32_t sa, da, len, sum;
+  int errors = 0;
+
+  for (len = 0; len <= MAX_LENGTH; len += (len < 96) ? 1 : 37)
+  {
+    for (sa = 0; sa < ALIGNMENTS; sa++)
+    {
+      fill(src_buffer, sizeof(src_buffer));
+      sum = rand() & 0xFFFF;
+      if (USBD_NetOps_Checksum(sum, src_buffer + sa, len) != reference_checksum(sum, src_buffer + sa, len))
+      {
+        printf("checksum: length %u, alignment %u\n", len, sa);
+        errors++;
+      }
+
+      for (da = 0; da < ALIGNMENTS; da++)
+      {
+        fill(dst_buffer, sizeof(dst_buffer));
+        memcpy(ref_buffer, dst_buffer, sizeof(ref_buffer));
+        memcpy(ref_buffer + da, src_buffer + sa, len);
+        USBD_NetOps_Copy(dst_buffer + da, src_buffer + sa, len);
+        if (memcmp(dst_buffer, ref_buffer, sizeof(ref_buffer)) != 0)
+        {
+          printf("copy: length %u, alignment %u to %u\n", len, sa, da);
+          errors++;
+        }
+      }
+    }
+
+    /* Frame moved down within its own buffer */
+    if (len + ALIGNMENTS <= MAX_LENGTH)
+    {
+      for (sa = 1; sa < ALIGNMENTS; sa++)
+      {
+        fill(dst_buffer, sizeof(dst_buffer));
+        memcpy(ref_buffer, dst_buffer, sizeof(ref_buffer));
+        memmove(ref_buffer, ref_buffer + sa, len);
+        USBD_NetOps_Copy(dst_buffer, dst_buffer + sa, len);
+        if (memcmp(dst_buffer, ref_buffer, sizeof(ref_buffer)) != 0)
+        {
+          printf("overlapping copy: length %u, offset %u\n", len, sa);
+          errors++;
+        }
+      }
+    }
+  }
+  return errors;
+}
+
+static void bench(long iterations)
+{
+  /* Frame alignments of the RNDIS path: header in front of the frame */
+  static const uint32_t src_align[] = { 0, 2, 2 };
+  static const uint32_t dst_align[] = { 0, 0, 2 };
+  volatile uint16_t sink = 0;
+  double start, t_ref, t_kernel;
+  long i;
+  uint32_t a;
+
+  fill(src_buffer, sizeof(src_buffer));
+  printf("%-34s %10s %10s\n", "", "reference", "netops");
+
+  for (a = 0; a < sizeof(src_align) / sizeof(src_align[0]); a++)
+  {
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+      memcpy(dst_buffer + dst_align[a], src_buffer + src_align[a], FRAME_SIZE);
+      __asm__ volatile ("" : : "r" (dst_buffer) : "memory");
+    }
+    t_ref = now() - start;
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+      USBD_NetOps_Copy(dst_buffer + dst_align[a], src_buffer + src_align[a], FRAME_SIZE);
+      __asm__ volatile ("" : : "r" (dst_buffer) : "memory");
+    }
+    t_kernel = now() - start;
+    printf("copy %u bytes, alignment %u to %u   %7.1f MB/s %7.1f MB/s\n", FRAME_SIZE,
+           src_align[a], dst_align[a], iterations * (double)FRAME_SIZE / t_ref / 1e6,
+           iterations * (double)FRAME_SIZE / t_kernel / 1e6);
+  }
+
+  for (a = 0; a < 2; a++)
+  {
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+      sink += reference_checksum(0, src_buffer + a * 2, FRAME_SIZE);
+    }
+    t_ref = now() - start;
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+      sink += USBD_NetOps_Checksum(0, src_buffer + a * 2, FRAME_SIZE);
+    }
+    t_kernel = now() - start;
+    printf("checksum %u bytes, alignment %u     %7.1f MB/s %7.1f MB/s\n", FRAME_SIZE,
+           a * 2, iterations * (double)FRAME_SIZE / t_ref / 1e6,
+           iterations * (double)FRAME_SIZE / t_kernel / 1e6);
+  }
+  (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+  long iterations = DEFAULT_ITERATIONS;
+  int errors;
+
+  if ((argc == 3) && (strcmp(argv[1], "-n") == 0))
+  {
+    iterations = atol(argv[2]);
+  }
+  else if (argc != 1)
+  {
+    fprintf(stderr, "usage: %s [-n iterations]\n", argv[0]);
+    return 2;
+  }
+
+  printf("%s kernels\n", USBD_NETOPS_ASM ? "Thumb-2" : "C");
+  errors = check();
+  if (errors != 0)
+  {
+    printf("%d errors\n", errors);
+    return 1;
+  }
+  printf("Correctness: OK\n\n");
+  bench(iterations);
+  return 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,296 @@
+/**
+  ******************************************************************************
+  * @file    prng_bench.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Reference vectors, statistical tests and throughput of the
+  *          xoshiro128** generator (prng.h).
+  ******************************************************************************
+  * @attention
+  *
+  * Build:  gcc -O2 -Wall -I.. -o prng_bench prng_bench.c ../prng.c -lm
+  * Usage:  prng_bench [-s seed] [-n megabytes]
+  *
+  * The reference vectors pin the generator to the published xoshiro128**
+  * output, the tests are coarse frequency, runs, correlation and range
+  * checks run on the given seed (0 by default), so that a failure can be
+  * replayed. They catch an implementation error, not a subtle statistical
+  * weakness: use PractRand or TestU01 on the output of vPRNGFill for that.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "prng.h"
+
+#define DEFAULT_MEGABYTES       16
+#define RANGE_BOUND             10
+#define Z_LIMIT                 4.5     /* Two sided, about 7 in a million */
+
+/* xoshiro128** from the state { 1, 2, 3, 4 } */
+static const uint32_t reference_output[] =
+{
+  0x00002d00U, 0x00000000U, 0x005a7080U, 0x04389d80U, 0x79199d9bU, 0x61963b24U
+};
+
+/* After vPRNGJump from { 1, 2, 3, 4 } */
+static const uint32_t reference_jump[] = { 0xa9765206U, 0x797aa168U, 0x5b62e331U, 0x02abd971U };
+
+/* vPRNGSeed(12345), SplitMix64 expansion */
+static const uint32_t reference_seed[] = { 0xa9d111a0U, 0x22118258U, 0xf713f8edU, 0x346edce5U };
+
+static int failures;
+
+static void result(const char *name, double z, const char *detail)
+{
+  int pass = fabs(z) < Z_LIMIT;
+
+  printf("  %-28s z = %7.3f  %-5s %s\n", name, z, pass ? "pass" : "FAIL", detail);
+  failures += !pass;
+}
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int check_vectors(void)
+{
+  PRNGContext_t context = { { 1, 2, 3, 4 } };
+  uint8_t bytes[7];
+  uint32_t words[2];
+  unsigned i;
+  int errors = 0;
+
+  for (i = 0; i < sizeof(reference_output) / sizeof(reference_output[0]); i++)
+  {
+    errors += ulPRNGNext(&context) != reference_output[i];
+  }
+
+  memcpy(context.ulState, (uint32_t[4]){ 1, 2, 3, 4 }, sizeof(context.ulState));
+  vPRNGJump(&context);
+  errors += memcmp(context.ulState, reference_jump, sizeof(reference_jump)) != 0;
+
+  vPRNGSeed(&context, 12345);
+  errors += memcmp(context.ulState, reference_seed, sizeof(reference_seed)) != 0;
+
+  /* vPRNGFill is the little endian output of ulPRNGNext, the tail included */
+  vPRNGSeed(&context, 1);
+  vPRNGFill(&context, bytes, sizeof(bytes));
+  vPRNGSeed(&context, 1);
+  words[0] = ulPRNGNext(&context);
+  words[1] = ulPRNGNext(&context);
+  for (i = 0; i < sizeof(bytes); i++)
+  {
+    errors += bytes[i] != (uint8_t)(words[i / 4] >> (8 * (i % 4)));
+  }
+
+  printf("Reference vectors: %s\n", errors ? "FAIL" : "pass");
+  return errors;
+}
+
+static void statistical_tests(uint64_t seed, size_t megabytes)
+{
+  PRNGContext_t context, stream;
+  size_t words = megabytes * 1024 * 1024 / 4;
+  uint8_t *buffer = malloc(words * 4);
+  uint64_t ones = 0, runs = 1, byte_count[256] = { 0 }, range_count[RANGE_BOUND] = { 0 };
+  double chi2, mean, sxy = 0, sxx = 0, x, prev, expected;
+  uint32_t w, previous_bit, bit, b;
+  size_t i;
+  char detail[64];
+
+  if (buffer == NULL)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+  vPRNGSeed(&context, seed);
+  vPRNGFill(&context, buffer, words * 4);
+  printf("Statistical tests, seed %llu, %zu MB\n", (unsigned long long)seed, megabytes);
+
+  /* Frequency of ones and runs of equal bits over the whole stream */
+  previous_bit = buffer[0] & 1;
+  for (i = 0; i < words * 4; i++)
+  {
+    byte_count[buffer[i]]++;
+    for (b = 0; b < 8; b++)
+    {
+      bit = (buffer[i] >> b) & 1;
+      ones += bit;
+      runs += (bit != previous_bit);
+      previous_bit = bit;
+    }
+  }
+  x = words * 32.0;
+  snprintf(detail, sizeof(detail), "%.6f ones", ones / x);
+  result("monobit", (ones - x / 2) / sqrt(x / 4), detail);
+  snprintf(detail, sizeof(detail), "%llu runs", (unsigned long long)runs);
+  result("runs", (runs - (x + 1) / 2) / sqrt((x - 1) / 4), detail);
+
+  /* Byte frequencies, chi-square with 255 degrees of freedom */
+  expected = words * 4 / 256.0;
+  chi2 = 0;
+  for (i = 0; i < 256; i++)
+  {
+    chi2 += (byte_count[i] - expected) * (byte_count[i] - expected) / expected;
+  }
+  snprintf(detail, sizeof(detail), "chi2 = %.1f, 255 dof", chi2);
+  result("byte frequency", (chi2 - 255) / sqrt(2 * 255), detail);
+
+  /* Lag 1 correlation of the words */
+  mean = 0;
+  for (i = 0; i < words; i++)
+  {
+    memcpy(&w, buffer + 4 * i, 4);
+    mean += w;
+  }
+  mean /= words;
+  memcpy(&w, buffer, 4);
+  prev = w - mean;
+  for (i = 1; i < words; i++)
+  {
+    memcpy(&w, buffer + 4 * i, 4);
+    x = w - mean;
+    sxy += x * prev;
+    sxx += x * x;
+    prev = x;
+  }
+  snprintf(detail, sizeof(detail), "r = %.2e", sxy / sxx);
+  result("serial correlation", sxy / sxx * sqrt((double)words), detail);
+
+  /* ulPRNGRange, chi-square with RANGE_BOUND - 1 degrees of freedom */
+  for (i = 0; i < words; i++)
+  {
+    range_count[ulPRNGRange(&context, RANGE_BOUND)]++;
+  }
+  expected = (double)words / RANGE_BOUND;
+  chi2 = 0;
+  for (i = 0; i < RANGE_BOUND; i++)
+  {
+    chi2 += (range_count[i] - expected) * (range_count[i] - expected) / expected;
+  }
+  snprintf(detail, sizeof(detail), "chi2 = %.1f, %d dof", chi2, RANGE_BOUND - 1);
+  result("range", (chi2 - (RANGE_BOUND - 1)) / sqrt(2 * (RANGE_BOUND - 1)), detail);
+
+  /* Jumped streams are uncorrelated: matching bits between them */
+  vPRNGSeed(&context, seed);
+  stream = context;
+  vPRNGJump(&stream);
+  ones = 0;
+  for (i = 0; i < words; i++)
+  {
+    w = ulPRNGNext(&context) ^ ulPRNGNext(&stream);
+    ones += __builtin_popcount(w);
+  }
+  x = words * 32.0;
+  snprintf(detail, sizeof(detail), "%.6f differing bits", ones / x);
+  result("jumped streams", (ones - x / 2) / sqrt(x / 4), detail);
+
+  free(buffer);
+}
+
+static void throughput(uint64_t seed, size_t megabytes)
+{
+  PRNGContext_t context;
+  size_t words = megabytes * 1024 * 1024 / 4;
+  uint8_t *buffer = malloc(words * 4);
+  volatile uint32_t sink = 0;
+  uint32_t lcg = (uint32_t)seed, acc = 0;
+  double start, t;
+  size_t i;
+
+  if (buffer == NULL)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+  vPRNGSeed(&context, seed);
+  printf("Throughput\n");
+
+  start = now();
+  for (i = 0; i < words; i++)
+  {
+    acc += ulPRNGNext(&context);
+  }
+  t = now() - start;
+  sink = acc;
+  printf("  %-28s %8.1f M words/s\n", "ulPRNGNext", words / t / 1e6);
+
+  start = now();
+  vPRNGFill(&context, buffer, words * 4);
+  t = now() - start;
+  sink = buffer[words];
+  printf("  %-28s %8.1f MB/s\n", "vPRNGFill", words * 4 / t / 1e6);
+
+  start = now();
+  for (i = 0; i < words; i++)
+  {
+    acc += ulPRNGRange(&context, 1000);
+  }
+  t = now() - start;
+  sink = acc;
+  printf("  %-28s %8.1f M values/s\n", "ulPRNGRange(1000)", words / t / 1e6);
+
+  /* The former uxRand, 15 bits per call: three calls per 32 bit word */
+  start = now();
+  for (i = 0; i < words; i++)
+  {
+    lcg = 0x015a4e35U * lcg + 1;
+    acc += (lcg >> 16) & 0x7fff;
+    lcg = 0x015a4e35U * lcg + 1;
+    acc ^= ((lcg >> 16) & 0x7fff) << 15;
+    lcg = 0x015a4e35U * lcg + 1;
+    acc ^= ((lcg >> 16) & 0x3) << 30;
+  }
+  t = now() - start;
+  sink = acc;
+  printf("  %-28s %8.1f M words/s\n", "former LCG, 3 calls per word", words / t / 1e6);
+
+  (void)sink;
+  free(buffer);
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t seed = 0;
+  size_t megabytes = DEFAULT_MEGABYTES;
+  int arg;
+
+  for (arg = 1; arg < argc; arg++)
+  {
+    if ((strcmp(argv[arg], "-s") == 0) && (arg + 1 < argc))
+    {
+      seed = strtoull(argv[++arg], NULL, 0);
+    }
+    else if ((strcmp(argv[arg], "-n") == 0) && (arg + 1 < argc))
+    {
+      megabytes = strtoul(argv[++arg], NULL, 0);
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [-s seed] [-n megabytes]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (megabytes == 0)
+  {
+    megabytes = 1;
+  }
+
+  failures = check_vectors();
+  statistical_tests(seed, megabytes);
+  throughput(seed, megabytes);
+  return failures ? 1 : 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
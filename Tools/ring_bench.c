@@ -0,0 +1,245 @@
+/**
+  ******************************************************************************
+  * @file    ring_bench.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Concurrency test and throughput of the byte ring (usbd_ring.h)
+  *          that the CDC function streams through.
+  ******************************************************************************
+  * @attention
+  *
+  * Build:  gcc -O2 -Wall -pthread -I../STM32_USB_Device_Library/App/Inc \
+  *             -o ring_bench ring_bench.c ../STM32_USB_Device_Library/App/Src/usbd_ring.c
+  * Usage:  ring_bench [-n megabytes] [-s seed]
+  *
+  * A producer and a consumer thread stream a byte sequence through rings
+  * of several sizes, the way the CDC function does:
+  *  - The producer reserves a random minimum, as the OUT endpoint needs a
+  *    whole packet, and commits a random part of it in one or two steps.
+  *  - The consumer peeks past data already in use, as the IN endpoint
+  *    queues a second transfer behind the first, and releases it later.
+  * Every byte read is checked against the sequence. Throughput is that of
+  * the host, it compares ring sizes and not the target.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "usbd_ring.h"
+
+#define DEFAULT_MEGABYTES   64
+
+typedef struct
+{
+  USBD_RingTypeDef ring;
+  uint64_t total;                         /* Bytes to stream */
+  uint32_t max_min;                       /* Largest minimum reserved */
+  uint32_t seed;
+  uint64_t errors;                        /* Consumer checks */
+  uint64_t short_reserve;                 /* Producer got less than asked */
+  uint64_t waits;                         /* Producer found no space */
+} Test;
+
+static uint32_t rng(uint32_t *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static void *producer(void *arg)
+{
+  Test *test = arg;
+  uint32_t state = test->seed;
+  uint64_t sent = 0;
+  uint32_t min;
+  uint32_t len;
+  uint32_t n;
+  uint32_t first;
+  uint32_t i;
+  uint8_t *p;
+
+  while (sent < test->total)
+  {
+    min = 1 + rng(&state) % test->max_min;
+    p = USBD_Ring_Reserve(&test->ring, min, &len);
+    if (p == NULL)
+    {
+      test->waits++;
+      sched_yield();
+      continue;
+    }
+    if (len < min)
+    {
+      test->short_reserve++;
+    }
+    n = 1 + rng(&state) % len;
+    if (n > test->total - sent)
+    {
+      n = (uint32_t)(test->total - sent);
+    }
+    for (i = 0; i < n; i++)
+    {
+      p[i] = (uint8_t)((sent + i) * 131 >> 3);
+    }
+
+    /* Sometimes in two commits of the same reservation */
+    first = ((n > 1) && (rng(&state) & 1)) ? n / 2 : n;
+    USBD_Ring_Commit(&test->ring, first);
+    if (first != n)
+    {
+      USBD_Ring_Commit(&test->ring, n - first);
+    }
+    sent += n;
+  }
+  return NULL;
+}
+
+static void *consumer(void *arg)
+{
+  Test *test = arg;
+  uint32_t state = test->seed ^ 0x9E3779B9;
+  uint64_t received = 0;
+  uint32_t in_use = 0;                    /* Peeked, not released yet */
+  uint32_t count;
+  uint32_t len;
+  uint32_t n;
+  uint32_t i;
+  uint8_t *p;
+
+  while (received < test->total)
+  {
+    count = USBD_Ring_Count(&test->ring);
+    if ((count >= test->ring.size) || (count < in_use))
+    {
+      test->errors++;
+    }
+
+    p = USBD_Ring_Peek(&test->ring, in_use, &len);
+    if (p != NULL)
+    {
+      n = 1 + rng(&state) % len;
+      for (i = 0; i < n; i++)
+      {
+        if (p[i] != (uint8_t)((received + in_use + i) * 131 >> 3))
+        {
+          test->errors++;
+        }
+      }
+      in_use += n;
+    }
+    else if (in_use == 0)
+    {
+      sched_yield();
+      continue;
+    }
+
+    /* Release the oldest part, or keep it in use a while longer */
+    if ((p == NULL) || (rng(&state) % 4 == 0))
+    {
+      n = 1 + rng(&state) % in_use;
+      USBD_Ring_Release(&test->ring, n);
+      in_use -= n;
+      received += n;
+    }
+  }
+  return NULL;
+}
+
+static double run(uint32_t size, uint32_t max_min, uint64_t total, uint32_t seed, Test *test)
+{
+  static uint8_t buffer[1 << 16];
+  pthread_t threads[2];
+  struct timespec t0;
+  struct timespec t1;
+
+  memset(test, 0, sizeof(*test));
+  USBD_Ring_Init(&test->ring, buffer, size);
+  test->total = total;
+  test->max_min = max_min;
+  test->seed = seed;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  pthread_create(&threads[0], NULL, producer, test);
+  pthread_create(&threads[1], NULL, consumer, test);
+  pthread_join(threads[0], NULL);
+  pthread_join(threads[1], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  if (USBD_Ring_Count(&test->ring) != 0)
+  {
+    test->errors++;
+  }
+  return (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+  static const uint32_t sizes[] = { 2, 3, 65, 100, 1024, 4096, 65536 };
+  uint64_t megabytes = DEFAULT_MEGABYTES;
+  uint32_t seed = 1;
+  uint32_t max_min;
+  uint64_t total;
+  uint64_t errors = 0;
+  double seconds;
+  Test test;
+  unsigned s;
+  int i;
+
+  for (i = 1; i + 1 < argc; i += 2)
+  {
+    if (strcmp(argv[i], "-n") == 0)
+    {
+      megabytes = strtoull(argv[i + 1], NULL, 0);
+    }
+    else if (strcmp(argv[i], "-s") == 0)
+    {
+      seed = strtoul(argv[i + 1], NULL, 0) | 1;
+    }
+    else
+    {
+      break;
+    }
+  }
+  if (i != argc)
+  {
+    fprintf(stderr, "usage: %s [-n megabytes] [-s seed]\n", argv[0]);
+    return 2;
+  }
+
+  printf("%8s %8s %10s %10s %8s\n", "size", "min", "MB/s", "waits", "errors");
+  for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+  {
+    /* Up to a packet, and no more than an empty ring always has in one
+    piece wherever its indexes are */
+    max_min = ((sizes[s] - 1) / 2 < 64) ? (sizes[s] - 1) / 2 : 64;
+    if (max_min == 0)
+    {
+      max_min = 1;
+    }
+    total = (sizes[s] < 1024) ? megabytes << 14 : megabytes << 20;
+    seconds = run(sizes[s], max_min, total, seed + s, &test);
+    printf("%8u %8u %10.1f %10llu %8llu\n", (unsigned)sizes[s], (unsigned)max_min,
+           total / seconds / 1e6, (unsigned long long)test.waits,
+           (unsigned long long)(test.errors + test.short_reserve));
+    errors += test.errors + test.short_reserve;
+  }
+
+  if (errors != 0)
+  {
+    printf("%llu errors\n", (unsigned long long)errors);
+    return 1;
+  }
+  printf("Correctness: OK\n");
+  return 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
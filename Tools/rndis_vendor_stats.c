@@ -0,0 +1,358 @@
+/**
+  ******************************************************************************
+  * @file    rndis_vendor_stats.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Linux host reader of the RNDIS vendor statistics OIDs
+  *          (usbd_rndis_if.h).
+  ******************************************************************************
+  * @attention
+  *
+  * Build:  gcc -O2 -Wall -o rndis_vendor_stats rndis_vendor_stats.c
+  * Usage:  rndis_vendor_stats [-i interface] [-d | -t] /dev/bus/usb/BBB/DDD
+  *
+  * Finds BBB/DDD with lsusb. Driver counters (-d) and per task statistics
+  * (-t) are printed, both by default.
+  *
+  * The RNDIS control channel belongs to the host network driver, so the
+  * tool detaches it from the communication interface, initializes the
+  * device itself, queries the vendor OIDs and reattaches the driver. The
+  * network link goes down and comes back while it runs, so the counters
+  * that are reset on reconnection are not among those reported. Needs
+  * write access to the device node, usually root.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/usbdevice_fs.h>
+
+/* Must match rndis.h and usbd_rndis_if.h */
+#define RNDIS_MSG_INIT                  0x00000002U
+#define RNDIS_MSG_QUERY                 0x00000004U
+#define RNDIS_MSG_COMPLETION            0x80000000U
+#define RNDIS_STATUS_SUCCESS            0x00000000U
+
+#define RNDIS_OID_VENDOR_DRIVER_STATS   0xFF757801U
+#define RNDIS_OID_VENDOR_TASK_STATS     0xFF757802U
+#define RNDIS_VENDOR_STATS_VERSION      1
+#define RNDIS_VENDOR_TASK_NAME_LEN      16
+#define RNDIS_VENDOR_TASK_SIZE          (RNDIS_VENDOR_TASK_NAME_LEN + 16)
+
+#define SEND_ENCAPSULATED_COMMAND       0x00
+#define GET_ENCAPSULATED_RESPONSE       0x01
+
+#define CONTROL_TIMEOUT_MS              1000
+#define RESPONSE_POLLS                  1000
+#define RESPONSE_SIZE                   512
+
+/* RNDIS_VendorStatsTypeDef, in order */
+static const char *driver_fields[] =
+{
+  "Version", "Size", "Uptime [ms]", "RxFrames", "TxFrames", "TxZeroCopy",
+  "RxDropNoBuffer", "RxDropIpQueue", "RxDropOversize", "RxDropRunt",
+  "RxFiltered", "TxBusy", "TxDrop", "TxQueued", "TxQueueHighWater",
+  "TxQueueBusy", "RxPending", "NetBuffersFree", "NetBuffersMinFree",
+  "UsbEventsLost", "IsrCount", "IsrCyclesMin", "IsrCyclesAvg",
+  "IsrCyclesMax", "EmacStackHighWater", "StaticPoolHighWater", "EmacWakeups",
+  "RxPolling", "RxBatches", "RxFlowStalls", "RxFlowStalled", "RxChecksumChecked",
+  "RxChecksumErrors"
+};
+
+/* eTaskState */
+static const char *task_states[] =
+{
+  "running", "ready", "blocked", "suspended", "deleted"
+};
+
+static int fd = -1;
+static int interface;
+static uint32_t request_id;
+
+static uint32_t get32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put32(uint8_t *p, uint32_t value)
+{
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+  p[3] = value >> 24;
+}
+
+static int control(uint8_t request_type, uint8_t request, void *data, uint16_t length)
+{
+  struct usbdevfs_ctrltransfer transfer =
+  {
+    .bRequestType = request_type,
+    .bRequest = request,
+    .wValue = 0,
+    .wIndex = interface,
+    .wLength = length,
+    .timeout = CONTROL_TIMEOUT_MS,
+    .data = data,
+  };
+
+  return ioctl(fd, USBDEVFS_CONTROL, &transfer);
+}
+
+static void driver_ioctl(int code)
+{
+  struct usbdevfs_ioctl command =
+  {
+    .ifno = interface,
+    .ioctl_code = code,
+    .data = NULL,
+  };
+
+  /* ENODATA: no driver to detach */
+  if ((ioctl(fd, USBDEVFS_IOCTL, &command) < 0) && (errno != ENODATA))
+  {
+    perror(code == USBDEVFS_DISCONNECT ? "detach driver" : "attach driver");
+  }
+}
+
+/* Sends an RNDIS message and returns the length of its completion in
+response, or -1 */
+static int transact(uint8_t *message, uint32_t length, uint8_t *response)
+{
+  int received, poll;
+
+  put32(message + 8, ++request_id);
+  if (control(0x21, SEND_ENCAPSULATED_COMMAND, message, length) < 0)
+  {
+    perror("send encapsulated command");
+    return -1;
+  }
+
+  /* The notification endpoint is not read, the response is polled: a
+  single zero byte means it is not available yet */
+  for (poll = 0; poll < RESPONSE_POLLS; poll++)
+  {
+    received = control(0xA1, GET_ENCAPSULATED_RESPONSE, response, RESPONSE_SIZE);
+    if (received < 0)
+    {
+      perror("get encapsulated response");
+      return -1;
+    }
+    if ((received >= 16) && (get32(response) == (get32(message) | RNDIS_MSG_COMPLETION)) &&
+        (get32(response + 8) == request_id))
+    {
+      return received;
+    }
+    usleep(1000);
+  }
+  fprintf(stderr, "no response to message %08X\n", get32(message));
+  return -1;
+}
+
+/* Returns the information buffer of the OID and its length, or NULL */
+static const uint8_t *query(uint32_t oid, uint8_t *response, uint32_t *length)
+{
+  uint8_t message[28] = { 0 };
+  uint32_t offset;
+  int received;
+
+  put32(message, RNDIS_MSG_QUERY);
+  put32(message + 4, sizeof(message));
+  put32(message + 12, oid);
+  put32(message + 20, 20);
+  received = transact(message, sizeof(message), response);
+  if (received < 0)
+  {
+    return NULL;
+  }
+  if ((received < 24) || (get32(response + 12) != RNDIS_STATUS_SUCCESS))
+  {
+    fprintf(stderr, "OID %08X: not supported by the device (status %08X)\n", oid,
+            (received >= 16) ? get32(response + 12) : 0);
+    return NULL;
+  }
+
+  /* The offset counts from the RequestId field */
+  *length = get32(response + 16);
+  offset = 8 + get32(response + 20);
+  if (offset + *length > (uint32_t)received)
+  {
+    fprintf(stderr, "OID %08X: truncated response\n", oid);
+    return NULL;
+  }
+  return response + offset;
+}
+
+static int print_driver_stats(void)
+{
+  uint8_t response[RESPONSE_SIZE];
+  const uint8_t *info;
+  uint32_t length, size, i;
+
+  info = query(RNDIS_OID_VENDOR_DRIVER_STATS, response, &length);
+  if (info == NULL)
+  {
+    return 1;
+  }
+  if ((length < 8) || (get32(info) != RNDIS_VENDOR_STATS_VERSION))
+  {
+    fprintf(stderr, "driver statistics: unknown version\n");
+    return 1;
+  }
+
+  /* Fields appended by newer firmware are shown by index only */
+  size = get32(info + 4);
+  if (size > length)
+  {
+    size = length;
+  }
+  printf("Driver statistics\n");
+  for (i = 2; i < size / 4; i++)
+  {
+    if (i < sizeof(driver_fields) / sizeof(driver_fields[0]))
+    {
+      printf("  %-20s %10u\n", driver_fields[i], get32(info + 4 * i));
+    }
+    else
+    {
+      printf("  field %-14u %10u\n", i, get32(info + 4 * i));
+    }
+  }
+  return 0;
+}
+
+static int print_task_stats(void)
+{
+  uint8_t response[RESPONSE_SIZE];
+  char name[RNDIS_VENDOR_TASK_NAME_LEN + 1];
+  const uint8_t *info, *task;
+  uint32_t length, count, total, run_time, state, i;
+
+  info = query(RNDIS_OID_VENDOR_TASK_STATS, response, &length);
+  if (info == NULL)
+  {
+    return 1;
+  }
+  if ((length < 12) || (get32(info) != RNDIS_VENDOR_STATS_VERSION))
+  {
+    fprintf(stderr, "task statistics: unknown version\n");
+    return 1;
+  }
+  count = get32(info + 4);
+  total = get32(info + 8);
+  if (12 + count * RNDIS_VENDOR_TASK_SIZE > length)
+  {
+    fprintf(stderr, "task statistics: truncated\n");
+    return 1;
+  }
+  if (count == 0)
+  {
+    printf("No task statistics, more tasks than the firmware reports\n");
+    return 0;
+  }
+
+  printf("%-16s %10s %6s %6s %4s  %s\n", "Task", "Run time", "CPU", "Stack", "Prio", "State");
+  for (i = 0; i < count; i++)
+  {
+    task = info + 12 + i * RNDIS_VENDOR_TASK_SIZE;
+    memcpy(name, task, RNDIS_VENDOR_TASK_NAME_LEN);
+    name[RNDIS_VENDOR_TASK_NAME_LEN] = 0;
+    run_time = get32(task + 16);
+    state = get32(task + 28);
+    printf("%-16s %10u %5.1f%% %6u %4u  %s\n", name, run_time,
+           (total != 0) ? run_time * 100.0 / total : 0.0, get32(task + 20), get32(task + 24),
+           (state < sizeof(task_states) / sizeof(task_states[0])) ? task_states[state] : "?");
+  }
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *path = NULL;
+  uint8_t message[24] = { 0 };
+  uint8_t response[RESPONSE_SIZE];
+  int driver = 1, tasks = 1;
+  int status = 1;
+  int arg;
+
+  for (arg = 1; arg < argc; arg++)
+  {
+    if ((strcmp(argv[arg], "-i") == 0) && (arg + 1 < argc))
+    {
+      interface = atoi(argv[++arg]);
+    }
+    else if (strcmp(argv[arg], "-d") == 0)
+    {
+      tasks = 0;
+    }
+    else if (strcmp(argv[arg], "-t") == 0)
+    {
+      driver = 0;
+    }
+    else if (path == NULL)
+    {
+      path = argv[arg];
+    }
+    else
+    {
+      path = NULL;
+      break;
+    }
+  }
+  if ((path == NULL) || (driver + tasks == 0))
+  {
+    fprintf(stderr, "usage: %s [-i interface] [-d | -t] /dev/bus/usb/BBB/DDD\n", argv[0]);
+    return 2;
+  }
+
+  fd = open(path, O_RDWR);
+  if (fd < 0)
+  {
+    perror(path);
+    return 1;
+  }
+  driver_ioctl(USBDEVFS_DISCONNECT);
+  if (ioctl(fd, USBDEVFS_CLAIMINTERFACE, &interface) < 0)
+  {
+    perror("claim interface");
+    driver_ioctl(USBDEVFS_CONNECT);
+    close(fd);
+    return 1;
+  }
+
+  put32(message, RNDIS_MSG_INIT);
+  put32(message + 4, sizeof(message));
+  put32(message + 12, 1);
+  put32(message + 16, 0);
+  put32(message + 20, 16384);
+  if (transact(message, sizeof(message), response) >= 0)
+  {
+    status = 0;
+    if (driver)
+    {
+      status |= print_driver_stats();
+    }
+    if (tasks)
+    {
+      if (driver)
+      {
+        printf("\n");
+      }
+      status |= print_task_stats();
+    }
+  }
+
+  ioctl(fd, USBDEVFS_RELEASEINTERFACE, &interface);
+  driver_ioctl(USBDEVFS_CONNECT);
+  close(fd);
+  return status;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,295 @@
+/**
+  ******************************************************************************
+  * @file    usbd_log_decode.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Host formatter of the USB device binary log (usbd_log.h).
+  ******************************************************************************
+  * @attention
+  *
+  * Build:  gcc -O2 -Wall -o usbd_log_decode usbd_log_decode.c
+  * Usage:  usbd_log_decode -r rodata.bin -a address [-c clock_hz] usbd_log.bin
+  *
+  * The log only holds format string addresses, so the firmware constants
+  * are needed to print it. Extract them from the ELF file of the dumped
+  * firmware, with the address they are linked at:
+  *
+  *   arm-none-eabi-objcopy -O binary -j .rodata firmware.elf rodata.bin
+  *   arm-none-eabi-objdump -h firmware.elf | grep .rodata
+  *
+  * and dump the ring, e.g. from gdb:
+  *
+  *   dump binary value usbd_log.bin USBD_Log
+  *
+  * Every message still in the ring is printed, whether or not the log task
+  * already formatted it.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Must match usbd_log.h */
+#define LOG_MAGIC               0x474F4C55U
+#define LOG_VERSION             1
+#define LOG_HEADER_SIZE         28
+#define LOG_ENTRY_SIZE          32
+#define LOG_MAX_ARGS            4
+
+static const char *level_prefix[] = { "", "ERROR: ", "DEBUG : " };
+
+static uint8_t *rodata;
+static long rodata_size;
+static uint32_t rodata_address;
+
+static uint32_t get32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint8_t *load(const char *path, long *size)
+{
+  FILE *file = fopen(path, "rb");
+  uint8_t *image;
+
+  if (file == NULL)
+  {
+    perror(path);
+    exit(1);
+  }
+  fseek(file, 0, SEEK_END);
+  *size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  image = malloc(*size + 1);
+  if ((image == NULL) || (fread(image, 1, *size, file) != (size_t)*size))
+  {
+    fprintf(stderr, "%s: read error\n", path);
+    exit(1);
+  }
+  image[*size] = 0;
+  fclose(file);
+  return image;
+}
+
+/* Returns the firmware string at address, NULL if it is not in .rodata */
+static const char *string_at(uint32_t address)
+{
+  uint32_t offset = address - rodata_address;
+
+  if ((address < rodata_address) || (offset >= (uint32_t)rodata_size))
+  {
+    return NULL;
+  }
+  /* The image is NUL terminated past its end */
+  return (const char *)rodata + offset;
+}
+
+/* printf with 32 bit target arguments */
+static void print_message(const char *fmt, const uint32_t *arg)
+{
+  char spec[32];
+  size_t len;
+  int n = 0;
+  const char *s;
+
+  while (*fmt != 0)
+  {
+    if (*fmt != '%')
+    {
+      putchar(*fmt++);
+      continue;
+    }
+    if (fmt[1] == '%')
+    {
+      putchar('%');
+      fmt += 2;
+      continue;
+    }
+
+    /* Flags, width and precision are kept, length modifiers dropped */
+    len = 0;
+    spec[len++] = *fmt++;
+    while ((*fmt != 0) && (strchr("-+ #0123456789.", *fmt) != NULL) && (len < sizeof(spec) - 3))
+    {
+      spec[len++] = *fmt++;
+    }
+    while ((*fmt != 0) && (strchr("hlLqjzt", *fmt) != NULL))
+    {
+      fmt++;
+    }
+    if (*fmt == 0)
+    {
+      break;
+    }
+    spec[len++] = *fmt;
+    spec[len] = 0;
+
+    if (n >= LOG_MAX_ARGS)
+    {
+      printf("<?>");
+    }
+    else
+    {
+      switch (*fmt)
+      {
+      case 'd':
+      case 'i':
+      case 'c':
+        printf(spec, (int32_t)arg[n]);
+        break;
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o':
+        printf(spec, arg[n]);
+        break;
+      case 'p':
+        printf("0x%08X", arg[n]);
+        break;
+      case 's':
+        s = string_at(arg[n]);
+        if (s != NULL)
+        {
+          printf(spec, s);
+        }
+        else
+        {
+          printf("<0x%08X>", arg[n]);
+        }
+        break;
+      default:
+        printf("<%s:0x%08X>", spec, arg[n]);
+        break;
+      }
+    }
+    n++;
+    fmt++;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  const char *path = NULL;
+  const char *rodata_path = NULL;
+  double clock = 0;
+  uint8_t *image;
+  long size;
+  uint32_t entry_size, depth, seq, rd, first, i;
+  uint32_t last = 0;
+  int started = 0;
+  int arg;
+
+  for (arg = 1; arg < argc; arg++)
+  {
+    if ((strcmp(argv[arg], "-r") == 0) && (arg + 1 < argc))
+    {
+      rodata_path = argv[++arg];
+    }
+    else if ((strcmp(argv[arg], "-a") == 0) && (arg + 1 < argc))
+    {
+      rodata_address = strtoul(argv[++arg], NULL, 0);
+    }
+    else if ((strcmp(argv[arg], "-c") == 0) && (arg + 1 < argc))
+    {
+      clock = atof(argv[++arg]);
+    }
+    else if (path == NULL)
+    {
+      path = argv[arg];
+    }
+    else
+    {
+      path = NULL;
+      break;
+    }
+  }
+  if ((path == NULL) || (rodata_path == NULL))
+  {
+    fprintf(stderr, "usage: %s -r rodata.bin -a address [-c clock_hz] usbd_log.bin\n", argv[0]);
+    return 2;
+  }
+
+  rodata = load(rodata_path, &rodata_size);
+  image = load(path, &size);
+
+  if ((size < LOG_HEADER_SIZE) || (get32(image) != LOG_MAGIC) || (get16(image + 4) != LOG_VERSION))
+  {
+    fprintf(stderr, "%s: not a version %d USB log\n", path, LOG_VERSION);
+    return 1;
+  }
+  entry_size = get16(image + 6);
+  depth = get32(image + 8);
+  if (clock == 0)
+  {
+    clock = get32(image + 12);
+  }
+  seq = get32(image + 16);
+  rd = get32(image + 20);
+  if ((entry_size < LOG_ENTRY_SIZE) || (depth == 0) || ((depth & (depth - 1)) != 0) ||
+      (size < LOG_HEADER_SIZE + (long)depth * entry_size))
+  {
+    fprintf(stderr, "%s: truncated or corrupt log\n", path);
+    return 1;
+  }
+  if (clock == 0)
+  {
+    clock = 1e6;
+    fprintf(stderr, "%s: unknown timestamp clock, times in cycles\n", path);
+  }
+
+  first = (seq > depth) ? seq - depth : 0;
+  printf("%u messages written, %u formatted on target, %u reported lost\n\n",
+         seq, rd, get32(image + 24));
+
+  for (i = first; i != seq; i++)
+  {
+    const uint8_t *entry = image + LOG_HEADER_SIZE + (i & (depth - 1)) * entry_size;
+    uint32_t args[LOG_MAX_ARGS];
+    uint32_t timestamp = get32(entry + 4);
+    uint8_t level = entry[12];
+    const char *fmt;
+    int n;
+
+    if (get32(entry) != i + 1)
+    {
+      printf("[%8u] <incomplete>\n", i);
+      continue;
+    }
+    for (n = 0; n < LOG_MAX_ARGS; n++)
+    {
+      args[n] = get32(entry + 16 + 4 * n);
+    }
+
+    printf("[%8u +%9.0f us] %s", i, started ? (uint32_t)(timestamp - last) * 1e6 / clock : 0.0,
+           level_prefix[(level < 3) ? level : 0]);
+    last = timestamp;
+    started = 1;
+
+    fmt = string_at(get32(entry + 8));
+    if (fmt != NULL)
+    {
+      print_message(fmt, args);
+    }
+    else
+    {
+      printf("<format at 0x%08X not in .rodata> %08X %08X %08X %08X", get32(entry + 8),
+             args[0], args[1], args[2], args[3]);
+    }
+    printf("\n");
+  }
+
+  free(image);
+  free(rodata);
+  return 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,282 @@
+/**
+  ******************************************************************************
+  * @file    usbd_trace_decode.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Host decoder of the USB device binary trace (usbd_trace.h).
+  ******************************************************************************
+  * @attention
+  *
+  * Build:  gcc -O2 -Wall -o usbd_trace_decode usbd_trace_decode.c
+  * Usage:  usbd_trace_decode [-c clock_hz] usbd_trace.bin
+  *
+  * The input is a raw dump of the USBD_Trace variable, e.g. from gdb:
+  *
+  *   dump binary value usbd_trace.bin USBD_Trace
+  *
+  * Events are printed oldest first with their time since the first event and
+  * since the previous one. Slots overwritten while being dumped, or reserved
+  * but not yet written, are reported as torn.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Must match usbd_trace.h */
+#define TRACE_MAGIC             0x43525455U
+#define TRACE_VERSION           1
+#define TRACE_HEADER_SIZE       24
+#define TRACE_ENTRY_SIZE        16
+
+enum
+{
+  TRACE_SETUP = 1,
+  TRACE_EP_SUBMIT,
+  TRACE_EP_COMPLETE,
+  TRACE_EP_BUSY,
+  TRACE_BUS,
+  TRACE_EVENT_LOST,
+  TRACE_RNDIS_MSG,
+  TRACE_EMAC_NOTIFY,
+  TRACE_NETBUF_FAIL,
+  TRACE_USER,
+  TRACE_TYPES
+};
+
+static const char *type_names[TRACE_TYPES] =
+{
+  "?", "SETUP", "SUBMIT", "COMPLETE", "BUSY", "BUS", "LOST",
+  "RNDIS", "EMAC", "NETBUF", "USER"
+};
+
+/* usbd_conf.c USBD_LL_EventIdTypeDef */
+static const char *ll_event_names[] =
+{
+  "setup", "data out", "data in", "sof", "reset", "suspend", "resume",
+  "iso out incomplete", "iso in incomplete", "connect", "disconnect"
+};
+
+static const char *std_request_names[] =
+{
+  "GET_STATUS", "CLEAR_FEATURE", "?", "SET_FEATURE", "?", "SET_ADDRESS",
+  "GET_DESCRIPTOR", "SET_DESCRIPTOR", "GET_CONFIGURATION",
+  "SET_CONFIGURATION", "GET_INTERFACE", "SET_INTERFACE", "SYNCH_FRAME"
+};
+
+static const char *rndis_msg_names[] =
+{
+  "?", "PACKET", "INITIALIZE", "HALT", "QUERY", "SET", "RESET", "INDICATE",
+  "KEEPALIVE"
+};
+
+static const char *usbd_status_names[] = { "OK", "BUSY", "FAIL" };
+
+static uint32_t get32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static const char *name(const char **table, size_t count, uint32_t index)
+{
+  return (index < count) ? table[index] : "?";
+}
+
+#define NAME(table, index)      name(table, sizeof(table) / sizeof(table[0]), (index))
+
+static void print_details(uint8_t type, uint8_t ep, uint32_t arg0, uint32_t arg1)
+{
+  uint32_t rndis_type;
+
+  switch (type)
+  {
+  case TRACE_SETUP:
+    printf("bmRequestType=%02X bRequest=%02X", arg0 & 0xFF, (arg0 >> 8) & 0xFF);
+    if ((arg0 & 0x60) == 0)
+    {
+      printf(" %-17s", NAME(std_request_names, (arg0 >> 8) & 0xFF));
+    }
+    else
+    {
+      printf(" %-17s", (arg0 & 0x60) == 0x20 ? "class" : "vendor");
+    }
+    printf(" wValue=%04X wIndex=%04X wLength=%u", arg0 >> 16, arg1 & 0xFFFF, arg1 >> 16);
+    break;
+
+  case TRACE_EP_SUBMIT:
+    printf("ep=%02X len=%u queued=%u", ep, arg0, arg1);
+    break;
+
+  case TRACE_EP_COMPLETE:
+    printf("ep=%02X len=%u", ep, arg0);
+    break;
+
+  case TRACE_EP_BUSY:
+    printf("ep=%02X status=%s len=%u", ep, NAME(usbd_status_names, arg0), arg1);
+    break;
+
+  case TRACE_BUS:
+    printf("%s param=%u", NAME(ll_event_names, arg0), arg1);
+    break;
+
+  case TRACE_EVENT_LOST:
+    printf("%s ep=%02X", NAME(ll_event_names, arg0), ep);
+    break;
+
+  case TRACE_RNDIS_MSG:
+    rndis_type = arg0 & 0x7FFFFFFF;
+    printf("%s%s id=%u", NAME(rndis_msg_names, rndis_type), (arg0 & 0x80000000) ? "_CMPLT" : "", arg1);
+    break;
+
+  case TRACE_EMAC_NOTIFY:
+    printf("events=%08X%s%s rx=%u", arg0, (arg0 & 0x01) ? " RX" : "", (arg0 & 0x02) ? " TX_DONE" : "", arg1);
+    break;
+
+  case TRACE_NETBUF_FAIL:
+    printf("size=%u", arg0);
+    break;
+
+  default:
+    printf("ep=%02X arg0=%08X arg1=%08X", ep, arg0, arg1);
+    break;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  const char *path = NULL;
+  double clock = 0;
+  FILE *file;
+  uint8_t *image;
+  long size;
+  uint32_t depth, entry_size, seq, first, i;
+  uint32_t counts[TRACE_TYPES] = { 0 };
+  uint32_t torn = 0;
+  uint32_t last = 0;
+  uint64_t elapsed = 0;
+  int started = 0;
+  int arg;
+
+  for (arg = 1; arg < argc; arg++)
+  {
+    if ((strcmp(argv[arg], "-c") == 0) && (arg + 1 < argc))
+    {
+      clock = atof(argv[++arg]);
+    }
+    else if (path == NULL)
+    {
+      path = argv[arg];
+    }
+    else
+    {
+      path = NULL;
+      break;
+    }
+  }
+  if (path == NULL)
+  {
+    fprintf(stderr, "usage: %s [-c clock_hz] usbd_trace.bin\n", argv[0]);
+    return 2;
+  }
+
+  file = fopen(path, "rb");
+  if (file == NULL)
+  {
+    perror(path);
+    return 1;
+  }
+  fseek(file, 0, SEEK_END);
+  size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  image = malloc(size > 0 ? size : 1);
+  if ((image == NULL) || (size < TRACE_HEADER_SIZE) || (fread(image, 1, size, file) != (size_t)size))
+  {
+    fprintf(stderr, "%s: cannot read trace header\n", path);
+    return 1;
+  }
+  fclose(file);
+
+  if ((get32(image) != TRACE_MAGIC) || (get16(image + 4) != TRACE_VERSION))
+  {
+    fprintf(stderr, "%s: not a version %d USB trace\n", path, TRACE_VERSION);
+    return 1;
+  }
+  entry_size = get16(image + 6);
+  depth = get32(image + 8);
+  if (clock == 0)
+  {
+    clock = get32(image + 12);
+  }
+  seq = get32(image + 20);
+  if ((entry_size < TRACE_ENTRY_SIZE) || (depth == 0) || ((depth & (depth - 1)) != 0) ||
+      (size < TRACE_HEADER_SIZE + (long)depth * entry_size))
+  {
+    fprintf(stderr, "%s: truncated or corrupt trace\n", path);
+    return 1;
+  }
+  if (clock == 0)
+  {
+    fprintf(stderr, "%s: unknown timestamp clock, use -c\n", path);
+    return 1;
+  }
+
+  first = (seq > depth) ? seq - depth : 0;
+  printf("%u events recorded, %u in the ring, %s, clock %.0f Hz\n\n",
+         seq, seq - first, get32(image + 16) ? "running" : "frozen", clock);
+  printf("%8s %14s %12s  %-8s\n", "seq", "time [us]", "delta [us]", "event");
+
+  for (i = first; i != seq; i++)
+  {
+    const uint8_t *entry = image + TRACE_HEADER_SIZE + (i & (depth - 1)) * entry_size;
+    uint32_t timestamp = get32(entry);
+    uint8_t type = entry[4];
+    uint32_t delta;
+
+    if (get16(entry + 6) != (uint16_t)i)
+    {
+      printf("%8u %14s %12s  torn\n", i, "", "");
+      torn++;
+      continue;
+    }
+
+    /* 32 bit cycle counter, events are assumed less than a wrap apart */
+    delta = started ? timestamp - last : 0;
+    elapsed += delta;
+    last = timestamp;
+    started = 1;
+
+    printf("%8u %14.3f %12.3f  %-8s ", i, elapsed * 1e6 / clock, delta * 1e6 / clock,
+           (type < TRACE_TYPES) ? type_names[type] : "?");
+    print_details(type, entry[5], get32(entry + 8), get32(entry + 12));
+    printf("\n");
+
+    counts[(type < TRACE_TYPES) ? type : 0]++;
+  }
+
+  printf("\n");
+  for (i = 1; i < TRACE_TYPES; i++)
+  {
+    if (counts[i] != 0)
+    {
+      printf("%-8s %u\n", type_names[i], counts[i]);
+    }
+  }
+  if (torn != 0)
+  {
+    printf("%-8s %u\n", "torn", torn);
+  }
+
+  free(image);
+  return 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,481 @@
+/**
+  ******************************************************************************
+  * @file    vendor_bench.c
+  * @author  Luiz Renault
+  * @version V1.0.0
+  * @date    19-October-2026
+  * @brief   Linux libusb throughput test of the vendor bulk function
+  *          (usbd_vendor.h, usbd_vendor_if.h).
+  ******************************************************************************
+  * @attention
+  *
+  * Build:  gcc -O2 -Wall $(pkg-config --cflags libusb-1.0) -o vendor_bench
+  *         vendor_bench.c $(pkg-config --libs libusb-1.0)
+  * Usage:  vendor_bench [-d vid:pid] [-m in|out|both] [-t seconds]
+  *         [-s size] [-n transfers] [-c] [-o]
+  *
+  * Keeps -n transfers of -s bytes in flight on each endpoint under test for
+  * -t seconds and prints the throughput. IN data is the test pattern of
+  * VENDOR_REQ_SET_SOURCE, -c checks it; OUT data is counted and dropped by
+  * the device. The device counters are printed at the end. -o prints the
+  * BOS descriptor and the MS OS 2.0 descriptor set Windows binds WinUSB
+  * with, instead of a test.
+  *
+  * The vendor interface has no kernel driver, a udev rule giving access to
+  * the device is enough, for example:
+  *   SUBSYSTEM=="usb", ATTR{idVendor}=="29bc", ATTR{idProduct}=="2020", MODE="0666"
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <libusb.h>
+
+/* Must match usbd_desc.c, usbd_vendor.h and usbd_vendor_if.h */
+#define DEFAULT_VID                     0x29BC
+#define DEFAULT_PID                     0x2020
+#define VENDOR_REQ_SET_SOURCE           0x01
+#define VENDOR_REQ_GET_STATS            0x02
+#define VENDOR_REQ_RESET_STATS          0x03
+#define VENDOR_PATTERN_WORDS            512
+#define VENDOR_MS_OS_20_DESCRIPTOR_INDEX 0x07
+
+#define DEFAULT_SECONDS                 5
+#define DEFAULT_SIZE                    16384
+#define DEFAULT_TRANSFERS               4
+#define MAX_TRANSFERS                   32
+#define CONTROL_TIMEOUT_MS              1000
+
+/* VENDOR_StatsTypeDef, in order */
+static const char *stats_fields[] =
+{
+  "TxBytes", "TxTransfers", "TxBusy", "RxBytes", "RxTransfers", "Aborted"
+};
+
+/* MS OS 2.0 platform capability UUID, as in the BOS descriptor */
+static const uint8_t ms_os_20_uuid[16] =
+{
+  0xDF, 0x60, 0xDD, 0xD8, 0x89, 0x45, 0xC7, 0x4C,
+  0x9C, 0xD2, 0x65, 0x9D, 0x9E, 0x64, 0x8A, 0x9F
+};
+
+typedef struct
+{
+  const char *name;
+  uint8_t ep;
+  int pending;
+  uint64_t bytes;
+  uint64_t transfers;
+  uint32_t errors;
+} stream_t;
+
+static libusb_device_handle *handle;
+static int interface = -1;
+static volatile int running;
+static int check;
+static int check_locked;
+static uint32_t check_word;
+static uint64_t check_errors;
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int vendor_out(uint8_t request, uint16_t value)
+{
+  int ret = libusb_control_transfer(handle, LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_INTERFACE,
+                                    request, value, interface, NULL, 0, CONTROL_TIMEOUT_MS);
+
+  if (ret < 0)
+  {
+    fprintf(stderr, "Vendor request %u: %s\n", request, libusb_strerror(ret));
+  }
+  return ret;
+}
+
+/* Word n of the IN stream is n % VENDOR_PATTERN_WORDS, from wherever the
+device was when the test started */
+static void check_pattern(const uint8_t *p, int length)
+{
+  uint32_t word;
+  int i;
+
+  for (i = 0; i + 4 <= length; i += 4)
+  {
+    word = p[i] | (p[i + 1] << 8) | (p[i + 2] << 16) | ((uint32_t)p[i + 3] << 24);
+    if (!check_locked)
+    {
+      check_locked = 1;
+      check_word = word;
+    }
+    if (word != check_word)
+    {
+      if (check_errors++ < 8)
+      {
+        fprintf(stderr, "Pattern: 0x%08x instead of 0x%08x\n", word, check_word);
+      }
+      check_word = word;
+    }
+    check_word = (check_word + 1) % VENDOR_PATTERN_WORDS;
+  }
+}
+
+static void LIBUSB_CALL transfer_done(struct libusb_transfer *transfer)
+{
+  stream_t *stream = transfer->user_data;
+
+  if (transfer->status == LIBUSB_TRANSFER_COMPLETED)
+  {
+    stream->bytes += transfer->actual_length;
+    stream->transfers++;
+    if (check && (stream->ep & LIBUSB_ENDPOINT_IN))
+    {
+      check_pattern(transfer->buffer, transfer->actual_length);
+    }
+  }
+  else if (transfer->status != LIBUSB_TRANSFER_CANCELLED)
+  {
+    stream->errors++;
+  }
+
+  if (running && (transfer->status == LIBUSB_TRANSFER_COMPLETED) && (libusb_submit_transfer(transfer) == 0))
+  {
+    return;
+  }
+  stream->pending--;
+}
+
+static int find_interface(uint8_t *ep_in, uint8_t *ep_out)
+{
+  struct libusb_config_descriptor *config;
+  const struct libusb_interface_descriptor *alt;
+  int i, j;
+
+  if (libusb_get_active_config_descriptor(libusb_get_device(handle), &config) != 0)
+  {
+    return -1;
+  }
+  for (i = 0; (i < config->bNumInterfaces) && (interface < 0); i++)
+  {
+    alt = &config->interface[i].altsetting[0];
+    if (alt->bInterfaceClass != LIBUSB_CLASS_VENDOR_SPEC)
+    {
+      continue;
+    }
+    interface = alt->bInterfaceNumber;
+    for (j = 0; j < alt->bNumEndpoints; j++)
+    {
+      if ((alt->endpoint[j].bmAttributes & 0x03) != LIBUSB_TRANSFER_TYPE_BULK)
+      {
+        continue;
+      }
+      if (alt->endpoint[j].bEndpointAddress & LIBUSB_ENDPOINT_IN)
+      {
+        *ep_in = alt->endpoint[j].bEndpointAddress;
+      }
+      else
+      {
+        *ep_out = alt->endpoint[j].bEndpointAddress;
+      }
+    }
+  }
+  libusb_free_config_descriptor(config);
+  return ((interface < 0) || (*ep_in == 0) || (*ep_out == 0)) ? -1 : 0;
+}
+
+static void hexdump(const uint8_t *p, int length)
+{
+  int i;
+
+  for (i = 0; i < length; i++)
+  {
+    printf("%02x%s", p[i], ((i % 16) == 15) || (i == length - 1) ? "\n" : " ");
+  }
+}
+
+/* BOS descriptor and the MS OS 2.0 descriptor set it points to */
+static int dump_descriptors(void)
+{
+  uint8_t bos[256];
+  uint8_t set[1024];
+  uint8_t vendor_code = 0;
+  uint16_t set_length = 0;
+  int length, i;
+
+  length = libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN, LIBUSB_REQUEST_GET_DESCRIPTOR, LIBUSB_DT_BOS << 8, 0,
+                                   bos, sizeof(bos), CONTROL_TIMEOUT_MS);
+  if (length < 5)
+  {
+    fprintf(stderr, "BOS descriptor: %s\n", length < 0 ? libusb_strerror(length) : "too short");
+    return 1;
+  }
+  printf("BOS descriptor, %d bytes:\n", length);
+  hexdump(bos, length);
+
+  for (i = 5; i + 2 < length; i += bos[i])
+  {
+    if (bos[i] == 0)
+    {
+      break;
+    }
+    if ((bos[i] == 28) && (bos[i + 2] == 0x05) && (memcmp(&bos[i + 4], ms_os_20_uuid, 16) == 0))
+    {
+      set_length = bos[i + 24] | (bos[i + 25] << 8);
+      vendor_code = bos[i + 26];
+    }
+  }
+  if (set_length == 0)
+  {
+    fprintf(stderr, "No MS OS 2.0 platform capability\n");
+    return 1;
+  }
+
+  length = libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+                                   vendor_code, 0, VENDOR_MS_OS_20_DESCRIPTOR_INDEX, set,
+                                   set_length < sizeof(set) ? set_length : sizeof(set), CONTROL_TIMEOUT_MS);
+  if (length < 0)
+  {
+    fprintf(stderr, "MS OS 2.0 descriptor set: %s\n", libusb_strerror(length));
+    return 1;
+  }
+  printf("MS OS 2.0 descriptor set, vendor code 0x%02x, %d of %u bytes:\n", vendor_code, length, set_length);
+  hexdump(set, length);
+  return (length == set_length) ? 0 : 1;
+}
+
+static void print_stats(void)
+{
+  uint8_t data[sizeof(stats_fields) / sizeof(stats_fields[0]) * 4];
+  unsigned i;
+  int length;
+
+  length = libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_INTERFACE,
+                                   VENDOR_REQ_GET_STATS, 0, interface, data, sizeof(data), CONTROL_TIMEOUT_MS);
+  if (length != sizeof(data))
+  {
+    fprintf(stderr, "Device counters: %s\n", length < 0 ? libusb_strerror(length) : "short reply");
+    return;
+  }
+  printf("Device counters:\n");
+  for (i = 0; i < sizeof(stats_fields) / sizeof(stats_fields[0]); i++)
+  {
+    printf("  %-12s %u\n", stats_fields[i],
+           data[4 * i] | (data[4 * i + 1] << 8) | (data[4 * i + 2] << 16) | ((uint32_t)data[4 * i + 3] << 24));
+  }
+}
+
+static int start_stream(stream_t *stream, struct libusb_transfer **transfers, int count, int size)
+{
+  uint32_t *buffer;
+  int i, k;
+
+  for (i = 0; i < count; i++)
+  {
+    buffer = malloc(size);
+    transfers[i] = libusb_alloc_transfer(0);
+    if ((buffer == NULL) || (transfers[i] == NULL))
+    {
+      return -1;
+    }
+    for (k = 0; k < size / 4; k++)
+    {
+      buffer[k] = k % VENDOR_PATTERN_WORDS;
+    }
+    libusb_fill_bulk_transfer(transfers[i], handle, stream->ep, (uint8_t *)buffer, size, transfer_done, stream, 0);
+    if (libusb_submit_transfer(transfers[i]) != 0)
+    {
+      return -1;
+    }
+    stream->pending++;
+  }
+  return 0;
+}
+
+static void report(const stream_t *stream, double seconds)
+{
+  printf("%-4s %10.3f MB/s  %12llu bytes  %8llu transfers  %u errors\n", stream->name,
+         stream->bytes / seconds / 1e6, (unsigned long long)stream->bytes,
+         (unsigned long long)stream->transfers, stream->errors);
+}
+
+int main(int argc, char **argv)
+{
+  stream_t in = { "IN", 0, 0, 0, 0, 0 };
+  stream_t out = { "OUT", 0, 0, 0, 0, 0 };
+  struct libusb_transfer *in_transfers[MAX_TRANSFERS] = { NULL };
+  struct libusb_transfer *out_transfers[MAX_TRANSFERS] = { NULL };
+  struct timeval tv = { 0, 100000 };
+  unsigned vid = DEFAULT_VID, pid = DEFAULT_PID;
+  const char *mode = "both";
+  int seconds = DEFAULT_SECONDS;
+  int size = DEFAULT_SIZE;
+  int count = DEFAULT_TRANSFERS;
+  int descriptors = 0;
+  int test_in, test_out;
+  int ret = 1;
+  int i, opt;
+  double start, elapsed;
+
+  while ((opt = getopt(argc, argv, "d:m:t:s:n:co")) != -1)
+  {
+    switch (opt)
+    {
+    case 'd':
+      if (sscanf(optarg, "%x:%x", &vid, &pid) != 2)
+      {
+        fprintf(stderr, "Bad -d %s\n", optarg);
+        return 1;
+      }
+      break;
+    case 'm':
+      mode = optarg;
+      break;
+    case 't':
+      seconds = atoi(optarg);
+      break;
+    case 's':
+      size = atoi(optarg);
+      break;
+    case 'n':
+      count = atoi(optarg);
+      break;
+    case 'c':
+      check = 1;
+      break;
+    case 'o':
+      descriptors = 1;
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-d vid:pid] [-m in|out|both] [-t seconds] [-s size] [-n transfers] [-c] [-o]\n", argv[0]);
+      return 1;
+    }
+  }
+  test_in = !strcmp(mode, "in") || !strcmp(mode, "both");
+  test_out = !strcmp(mode, "out") || !strcmp(mode, "both");
+  /* Whole packets, so that the pattern check sees whole words */
+  if ((!test_in && !test_out) || (seconds <= 0) || (size <= 0) || (size % 64) || (count <= 0) || (count > MAX_TRANSFERS))
+  {
+    fprintf(stderr, "Bad mode, duration, size (a multiple of 64) or transfer count\n");
+    return 1;
+  }
+
+  if (libusb_init(NULL) != 0)
+  {
+    fprintf(stderr, "libusb_init failed\n");
+    return 1;
+  }
+  handle = libusb_open_device_with_vid_pid(NULL, vid, pid);
+  if (handle == NULL)
+  {
+    fprintf(stderr, "No device %04x:%04x, or no access to it\n", vid, pid);
+    goto exit;
+  }
+
+  if (descriptors)
+  {
+    ret = dump_descriptors();
+    goto close;
+  }
+
+  if (find_interface(&in.ep, &out.ep) != 0)
+  {
+    fprintf(stderr, "No vendor interface with bulk IN and OUT endpoints\n");
+    goto close;
+  }
+  libusb_set_auto_detach_kernel_driver(handle, 1);
+  if (libusb_claim_interface(handle, interface) != 0)
+  {
+    fprintf(stderr, "Cannot claim interface %d\n", interface);
+    goto close;
+  }
+  printf("Interface %d, IN 0x%02x, OUT 0x%02x, %d x %d bytes in flight, %d s\n",
+         interface, in.ep, out.ep, count, size, seconds);
+
+  vendor_out(VENDOR_REQ_RESET_STATS, 0);
+  if (test_in && (vendor_out(VENDOR_REQ_SET_SOURCE, 1) < 0))
+  {
+    goto release;
+  }
+
+  running = 1;
+  if ((test_in && (start_stream(&in, in_transfers, count, size) != 0)) ||
+      (test_out && (start_stream(&out, out_transfers, count, size) != 0)))
+  {
+    fprintf(stderr, "Cannot start the transfers\n");
+    running = 0;
+  }
+  start = now();
+  while (running && (now() - start < seconds))
+  {
+    libusb_handle_events_timeout(NULL, &tv);
+  }
+  elapsed = now() - start;
+  running = 0;
+
+  /* The source keeps the IN endpoint busy, the transfers left are cancelled */
+  for (i = 0; i < count; i++)
+  {
+    if (in_transfers[i] != NULL)
+    {
+      libusb_cancel_transfer(in_transfers[i]);
+    }
+    if (out_transfers[i] != NULL)
+    {
+      libusb_cancel_transfer(out_transfers[i]);
+    }
+  }
+  while ((in.pending > 0) || (out.pending > 0))
+  {
+    libusb_handle_events_timeout(NULL, &tv);
+  }
+  if (test_in)
+  {
+    vendor_out(VENDOR_REQ_SET_SOURCE, 0);
+  }
+
+  if (test_in)
+  {
+    report(&in, elapsed);
+  }
+  if (test_out)
+  {
+    report(&out, elapsed);
+  }
+  if (check)
+  {
+    printf("Pattern errors: %llu\n", (unsigned long long)check_errors);
+  }
+  print_stats();
+  ret = (in.errors || out.errors || check_errors) ? 1 : 0;
+
+  for (i = 0; i < count; i++)
+  {
+    if (in_transfers[i] != NULL)
+    {
+      free(in_transfers[i]->buffer);
+      libusb_free_transfer(in_transfers[i]);
+    }
+    if (out_transfers[i] != NULL)
+    {
+      free(out_transfers[i]->buffer);
+      libusb_free_transfer(out_transfers[i]);
+    }
+  }
+
+release:
+  libusb_release_interface(handle, interface);
+close:
+  libusb_close(handle);
+exit:
+  libusb_exit(NULL);
+  return ret;
+}
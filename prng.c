@@ -0,0 +1,130 @@
+#include <string.h>
+#include "prng.h"
+
+/* xoshiro128** 1.1 by David Blackman and Sebastiano Vigna: 32 bits per call
+from 128 bits of state, period 2^128 - 1, a handful of single cycle
+instructions on a Cortex-M4. */
+
+static uint32_t prvRotl( uint32_t ulValue, uint32_t ulShift )
+{
+	return ( ulValue << ulShift ) | ( ulValue >> ( 32U - ulShift ) );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvSplitMix64( uint64_t *pullState )
+{
+uint64_t ullZ;
+
+	ullZ = ( *pullState += 0x9e3779b97f4a7c15ULL );
+	ullZ = ( ullZ ^ ( ullZ >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+	ullZ = ( ullZ ^ ( ullZ >> 27 ) ) * 0x94d049bb133111ebULL;
+	return ullZ ^ ( ullZ >> 31 );
+}
+/*-----------------------------------------------------------*/
+
+void vPRNGSeed( PRNGContext_t *pxContext, uint64_t ullSeed )
+{
+uint64_t ullWord;
+
+	/* SplitMix64 spreads any seed, 0 included, over the whole state. */
+	ullWord = prvSplitMix64( &ullSeed );
+	pxContext->ulState[ 0 ] = ( uint32_t ) ullWord;
+	pxContext->ulState[ 1 ] = ( uint32_t ) ( ullWord >> 32 );
+	ullWord = prvSplitMix64( &ullSeed );
+	pxContext->ulState[ 2 ] = ( uint32_t ) ullWord;
+	pxContext->ulState[ 3 ] = ( uint32_t ) ( ullWord >> 32 );
+
+	/* The only state the generator cannot leave. */
+	if( ( pxContext->ulState[ 0 ] | pxContext->ulState[ 1 ] | pxContext->ulState[ 2 ] | pxContext->ulState[ 3 ] ) == 0U )
+	{
+		pxContext->ulState[ 0 ] = 1U;
+	}
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulPRNGNext( PRNGContext_t *pxContext )
+{
+uint32_t *pulS = pxContext->ulState;
+const uint32_t ulResult = prvRotl( pulS[ 1 ] * 5U, 7 ) * 9U;
+const uint32_t ulT = pulS[ 1 ] << 9;
+
+	pulS[ 2 ] ^= pulS[ 0 ];
+	pulS[ 3 ] ^= pulS[ 1 ];
+	pulS[ 1 ] ^= pulS[ 2 ];
+	pulS[ 0 ] ^= pulS[ 3 ];
+	pulS[ 2 ] ^= ulT;
+	pulS[ 3 ] = prvRotl( pulS[ 3 ], 11 );
+
+	return ulResult;
+}
+/*-----------------------------------------------------------*/
+
+void vPRNGJump( PRNGContext_t *pxContext )
+{
+static const uint32_t ulJump[ 4 ] = { 0x8764000bUL, 0xf542d2d3UL, 0x6fa035c3UL, 0x77f2db5bUL };
+uint32_t ulS[ 4 ] = { 0U, 0U, 0U, 0U };
+int i, b;
+
+	/* Advances by 2^64 calls: contexts copied from one seed and jumped 1, 2,
+	3... times give streams that do not overlap, e.g. one per task. */
+	for( i = 0; i < 4; i++ )
+	{
+		for( b = 0; b < 32; b++ )
+		{
+			if( ( ulJump[ i ] & ( 1UL << b ) ) != 0U )
+			{
+				ulS[ 0 ] ^= pxContext->ulState[ 0 ];
+				ulS[ 1 ] ^= pxContext->ulState[ 1 ];
+				ulS[ 2 ] ^= pxContext->ulState[ 2 ];
+				ulS[ 3 ] ^= pxContext->ulState[ 3 ];
+			}
+			( void ) ulPRNGNext( pxContext );
+		}
+	}
+	memcpy( pxContext->ulState, ulS, sizeof( ulS ) );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulPRNGRange( PRNGContext_t *pxContext, uint32_t ulBound )
+{
+uint64_t ullProduct;
+uint32_t ulThreshold;
+
+	/* Uniform in [0, ulBound), without the bias of a modulo (Lemire).  The
+	rejection loop runs again with a probability below ulBound / 2^32. */
+	if( ulBound == 0U )
+	{
+		return 0U;
+	}
+	ullProduct = ( uint64_t ) ulPRNGNext( pxContext ) * ulBound;
+	if( ( uint32_t ) ullProduct < ulBound )
+	{
+		ulThreshold = ( uint32_t ) ( -ulBound ) % ulBound;
+		while( ( uint32_t ) ullProduct < ulThreshold )
+		{
+			ullProduct = ( uint64_t ) ulPRNGNext( pxContext ) * ulBound;
+		}
+	}
+	return ( uint32_t ) ( ullProduct >> 32 );
+}
+/*-----------------------------------------------------------*/
+
+void vPRNGFill( PRNGContext_t *pxContext, void *pvBuffer, size_t uxLength )
+{
+uint8_t *pucBuffer = ( uint8_t * ) pvBuffer;
+uint32_t ulValue;
+
+	while( uxLength >= sizeof( ulValue ) )
+	{
+		ulValue = ulPRNGNext( pxContext );
+		memcpy( pucBuffer, &ulValue, sizeof( ulValue ) );
+		pucBuffer += sizeof( ulValue );
+		uxLength -= sizeof( ulValue );
+	}
+	if( uxLength != 0U )
+	{
+		ulValue = ulPRNGNext( pxContext );
+		memcpy( pucBuffer, &ulValue, uxLength );
+	}
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,32 @@
+#ifndef PRNG_H
+#define PRNG_H
+
+/* xoshiro128** pseudo random number generator, see prng.c.  Not suitable for
+anything that must be unpredictable: use xApplicationGetRandomNumber for that.
+Free of FreeRTOS dependencies so that Tools/prng_bench builds on the host. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Generator state, one per user: a context must not be used by several
+tasks at once without a critical section around the calls. */
+typedef struct xPRNG_CONTEXT
+{
+	uint32_t ulState[ 4 ];
+} PRNGContext_t;
+
+void vPRNGSeed( PRNGContext_t *pxContext, uint64_t ullSeed );
+void vPRNGJump( PRNGContext_t *pxContext );
+uint32_t ulPRNGNext( PRNGContext_t *pxContext );
+uint32_t ulPRNGRange( PRNGContext_t *pxContext, uint32_t ulBound );
+void vPRNGFill( PRNGContext_t *pxContext, void *pvBuffer, size_t uxLength );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRNG_H */
@@ -1,44 +1,166 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "STM32F4xx.h"
+#include "FreeRTOS_IP.h"
+#include "prng.h"
 
-/* Use by the pseudo random number generator. */
-static UBaseType_t ulNextRand;
+/* Random numbers come from the hardware RNG, clocked by the same 48 MHz PLL
+output as the USB OTG FS core.  Its interrupt keeps a pool of
+configRAND_POOL_SIZE values topped up, so taking one never waits on the
+generator. */
+#ifndef configRAND_POOL_SIZE
+	#define configRAND_POOL_SIZE	8
+#endif
+
+#if( ( configRAND_POOL_SIZE & ( configRAND_POOL_SIZE - 1 ) ) != 0 )
+	#error configRAND_POOL_SIZE must be a power of two
+#endif
+
+/* Used by uxRand, shared by all tasks.  Callers wanting a reproducible
+sequence, or many values, keep a PRNGContext_t of their own.  Until it is
+seeded from the hardware the sequence is fixed, but not stuck at 0. */
+static PRNGContext_t xRandContext = { { 1UL, 2UL, 3UL, 4UL } };
 static RNG_HandleTypeDef hrng;
 
-static void prvSRand( UBaseType_t ulSeed )
+/* Values are written at ulPoolHead by the RNG interrupt and taken at
+ulPoolTail, ucRefilling is set while the interrupt is enabled. */
+static volatile uint32_t ulPool[ configRAND_POOL_SIZE ];
+static volatile uint32_t ulPoolHead = 0, ulPoolTail = 0;
+static volatile uint8_t ucRefilling = 0;
+
+static void prvRandInit( void )
 {
-	/* Utility function to seed the pseudo random number generator. */
-	ulNextRand = ulSeed;
+static BaseType_t xInitialised = pdFALSE;
+
+	if( xInitialised == pdFALSE )
+	{
+		__HAL_RCC_RNG_CLK_ENABLE();
+		hrng.Instance = RNG;
+		HAL_RNG_Init( &hrng );
+
+		/* No FreeRTOS API is used by the interrupt, any priority will do. */
+		HAL_NVIC_SetPriority( HASH_RNG_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY, 0 );
+		HAL_NVIC_EnableIRQ( HASH_RNG_IRQn );
+
+		ucRefilling = 1;
+		HAL_RNG_GenerateRandomNumber_IT( &hrng );
+		xInitialised = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void HASH_RNG_IRQHandler( void )
+{
+	HAL_RNG_IRQHandler( &hrng );
+}
+/*-----------------------------------------------------------*/
+
+void HAL_RNG_ReadyDataCallback( RNG_HandleTypeDef *pxRng, uint32_t ulRandom32bit )
+{
+	ulPool[ ulPoolHead % configRAND_POOL_SIZE ] = ulRandom32bit;
+	ulPoolHead++;
+
+	/* Stop once the pool is full, xApplicationGetRandomNumber restarts. */
+	if( ( ulPoolHead - ulPoolTail ) < configRAND_POOL_SIZE )
+	{
+		HAL_RNG_GenerateRandomNumber_IT( pxRng );
+	}
+	else
+	{
+		ucRefilling = 0;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void HAL_RNG_ErrorCallback( RNG_HandleTypeDef *pxRng )
+{
+	/* A seed or clock error: restart the generator, as the reference manual
+	prescribes, and resume the refill. */
+	pxRng->State = HAL_RNG_STATE_READY;
+	__HAL_RNG_DISABLE( pxRng );
+	__HAL_RNG_ENABLE( pxRng );
+	HAL_RNG_GenerateRandomNumber_IT( pxRng );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xApplicationGetRandomNumber( uint32_t *pulNumber )
+{
+uint32_t ulTail;
+BaseType_t xReturn = pdFALSE;
+
+	/* Any task may take a value, the RNG interrupt is masked meanwhile. */
+	taskENTER_CRITICAL();
+	prvRandInit();
+
+	ulTail = ulPoolTail;
+	if( ulTail != ulPoolHead )
+	{
+		*pulNumber = ulPool[ ulTail % configRAND_POOL_SIZE ];
+		ulPool[ ulTail % configRAND_POOL_SIZE ] = 0;
+		ulPoolTail = ulTail + 1;
+		xReturn = pdTRUE;
+
+		if( ucRefilling == 0 )
+		{
+			ucRefilling = 1;
+			HAL_RNG_GenerateRandomNumber_IT( &hrng );
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	/* pdFALSE if taken faster than the RNG produces, the caller retries
+	later. */
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulApplicationGetNextSequenceNumber( uint32_t ulSourceAddress,
+											 uint16_t usSourcePort,
+											 uint32_t ulDestinationAddress,
+											 uint16_t usDestinationPort )
+{
+uint32_t ulNumber;
+
+	( void ) ulSourceAddress;
+	( void ) usSourcePort;
+	( void ) ulDestinationAddress;
+	( void ) usDestinationPort;
+
+	/* An unpredictable initial sequence number for every connection.  0 tells
+	the stack none is available, it retries the connection later. */
+	if( xApplicationGetRandomNumber( &ulNumber ) == pdFALSE )
+	{
+		ulNumber = 0;
+	}
+	return ulNumber;
 }
 /*-----------------------------------------------------------*/
 
 UBaseType_t uxRand( void )
 {
-const uint32_t ulMultiplier = 0x015a4e35UL, ulIncrement = 1UL;
-static BaseType_t xInitialised = pdFALSE;
+static BaseType_t xSeeded = pdFALSE;
+uint32_t ulSeed[ 2 ];
+UBaseType_t uxNumber;
 
-	/* Don't initialise until the scheduler is running, as the timeout in the
-	random number generator uses the tick count. */
-	if( xInitialised == pdFALSE )
+	/* Seeded from the hardware RNG once it has produced two values, the
+	sequence is not worth protecting beyond that. */
+	if( xSeeded == pdFALSE )
 	{
-		if( xTaskGetSchedulerState() !=  taskSCHEDULER_NOT_STARTED )
+		if( ( xApplicationGetRandomNumber( &ulSeed[ 0 ] ) != pdFALSE ) &&
+			( xApplicationGetRandomNumber( &ulSeed[ 1 ] ) != pdFALSE ) )
 		{
-//		RNG_HandleTypeDef xRND;
-		uint32_t ulSeed;
-
-			/* Generate a random number with which to seed the local pseudo random
-			number generating function. */
-//			HAL_RNG_Init( &xRND );
-			HAL_RNG_GenerateRandomNumber( &hrng, &ulSeed );
-			prvSRand( ulSeed );
-			xInitialised = pdTRUE;
+			taskENTER_CRITICAL();
+			vPRNGSeed( &xRandContext, ( ( uint64_t ) ulSeed[ 1 ] << 32 ) | ulSeed[ 0 ] );
+			xSeeded = pdTRUE;
+			taskEXIT_CRITICAL();
 		}
 	}
 
-	/* Utility function to generate a pseudo random number. */
+	/* 32 bits per call. */
+	taskENTER_CRITICAL();
+	uxNumber = ( UBaseType_t ) ulPRNGNext( &xRandContext );
+	taskEXIT_CRITICAL();
 
-	ulNextRand = ( ulMultiplier * ulNextRand ) + ulIncrement;
-	return( ( int ) ( ulNextRand >> 16UL ) & 0x7fffUL );
+	return uxNumber;
 }
 /*-----------------------------------------------------------*/